@@ -3,9 +3,11 @@
 #include "lqHelper.h"
 #include "lqSaveLASDialog.h"
 #include "lqSelectLidarFrameDialog.h"
+#include "LASFileWriter.h"
 #include "vtkLASFileWriter.h"
 
 #include <vtkNew.h>
+#include <vtkPolyData.h>
 #include <vtkSMDoubleVectorProperty.h>
 #include <vtkSMProxy.h>
 #include <vtkSMSourceProxy.h>
@@ -124,6 +126,30 @@ bool lqSaveLASReaction::saveFrame(vtkSMProxy * lidar, int start, int stop)
     // We export one file per frame
     // We could export several frames in a single file
     // by using "SetFirstFrame" and "SetLastFrame" functions of the vtkLasWriter
+
+    // The frames are decoded once in the background and written with the same steps
+    // as vtkLASFileWriter, by a single thread as the projections are not thread safe
+    const bool useLatLonForOut = exportType == vtkLASFileWriter::EXPORT_LATLONG;
+    auto encode = [=](vtkPolyData* frame, const std::string& filename) {
+      LASFileWriter lasWriter;
+      lasWriter.SetWriteSRS(writeSrs);
+      lasWriter.SetWriteColor(writeColor);
+      if (!lasWriter.Open(filename.c_str()))
+      {
+        return false;
+      }
+      lasWriter.SetPrecision(useLatLonForOut ? 1e-8 : 1e-3, 1e-3);
+      lasWriter.SetGeoConversionUTM(utmZone, useLatLonForOut);
+      lasWriter.SetOrigin(0, 0, 0);
+      lasWriter.WriteFrame(frame);
+      lasWriter.Close();
+      return true;
+    };
+    if (this->ExportFrameRange(lidar, start, stop, 1, encode))
+    {
+      return true;
+    }
+
     auto* tsv = vtkSMDoubleVectorProperty::SafeDownCast(lidar->GetProperty("TimestepValues"));
 
     QProgressDialog progress("Saving files...", "Abort", 0, stop-start);
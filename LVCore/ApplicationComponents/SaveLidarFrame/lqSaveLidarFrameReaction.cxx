@@ -1,12 +1,19 @@
 #include "lqSaveLidarFrameReaction.h"
 
+#include <algorithm>
 #include <sstream>
 #include <chrono>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkPVTrivialProducer.h>
 #include <vtkSMDoubleVectorProperty.h>
 #include <vtkSMPropertyHelper.h>
 #include <vtkSMProxyManager.h>
+#include <vtkSMSessionProxyManager.h>
 #include <vtkSMSourceProxy.h>
 #include <vtkSMWriterFactory.h>
 
@@ -18,11 +25,16 @@
 #include <pqProxyWidgetDialog.h>
 #include <pqPVApplicationCore.h>
 
+#include <QCoreApplication>
 #include <QFileDialog>
 #include <QProgressDialog>
+#include <QSet>
+#include <QThread>
 #include <QDebug>
 
+#include "LidarFrameExporter.h"
 #include "lqHelper.h"
+#include "vtkPCDWriter.h"
 #include "lqSelectLidarFrameDialog.h"
 #include "lqSensorListWidget.h"
 
@@ -206,7 +218,7 @@ bool lqSaveLidarFrameReaction::saveFrame(vtkSMProxy * lidar, int start, int stop
     writer->UpdateVTKObjects();
     writer->UpdatePipeline(timestep_bakup);
   }
-  else
+  else if (!this->ExportFrameRange(lidar, start, stop, writer))
   {
     auto* tsv = vtkSMDoubleVectorProperty::SafeDownCast(lidarProxy->GetProperty("TimestepValues"));
     QProgressDialog progress("Saving files...", "Abort", 0, stop-start);
@@ -230,6 +242,164 @@ bool lqSaveLidarFrameReaction::saveFrame(vtkSMProxy * lidar, int start, int stop
   return true;
 }
 
+//-----------------------------------------------------------------------------
+bool lqSaveLidarFrameReaction::ExportFrameRange(vtkSMProxy* lidar, int start, int stop,
+                                                int numberOfEncodingThreads,
+                                                const EncodeFunction& encode)
+{
+  auto* reader = vtkLidarReader::SafeDownCast(lidar->GetClientSideObject());
+  auto* tsv = vtkSMDoubleVectorProperty::SafeDownCast(lidar->GetProperty("TimestepValues"));
+  if (!reader || !tsv || start < 0 || start > stop ||
+      stop >= static_cast<int>(tsv->GetNumberOfElements()))
+  {
+    return false;
+  }
+
+  // The timesteps match consecutive frames of the reader catalog
+  const int firstFrame = reader->GetFrameIndexForTimestep(tsv->GetElement(start));
+  const int lastFrame = reader->GetFrameIndexForTimestep(tsv->GetElement(stop));
+  if (lastFrame - firstFrame != stop - start)
+  {
+    return false;
+  }
+
+  // The frames may be saved in any order, so the file names are generated beforehand.
+  // GenerateFileName only avoids the existing files, also avoid the ones of this export.
+  std::vector<std::string> fileNames;
+  QSet<QString> usedNames;
+  for (int i = start; i <= stop; ++i)
+  {
+    const QString fileName = this->GenerateFileName(this->BaseName, tsv->GetElement(i));
+    const QString stem = fileName.left(fileName.size() - this->Extension.size() - 1);
+    QString uniqueName = fileName;
+    for (int suffix = 1; usedNames.contains(uniqueName) ||
+           (uniqueName != fileName && QFileInfo(QFile(uniqueName)).exists()); ++suffix)
+    {
+      uniqueName = stem + "_" + QString::number(suffix) + "." + this->Extension;
+    }
+    usedNames.insert(uniqueName);
+    fileNames.push_back((this->FolderPath + "/" + uniqueName).toStdString());
+  }
+
+  LidarFrameExporter exporter(reader);
+  exporter.SetNumberOfEncodingThreads(numberOfEncodingThreads);
+  bool started = exporter.Start(firstFrame, lastFrame,
+    [&encode, &fileNames, firstFrame](int frameIndex, vtkPolyData* frame) {
+      return encode(frame, fileNames[frameIndex - firstFrame]);
+    });
+  if (!started)
+  {
+    return false;
+  }
+
+  QProgressDialog progress("Saving files...", "Abort", 0, stop - start + 1);
+  progress.setWindowModality(Qt::ApplicationModal);
+  while (!exporter.IsFinished())
+  {
+    // Only does something when the frames are saved on this thread
+    exporter.Poll();
+
+    const int framesDone = exporter.GetNumberOfFramesDone();
+    if (framesDone != progress.value())
+    {
+      progress.setValue(framesDone);
+    }
+    else
+    {
+      QCoreApplication::processEvents();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    if (progress.wasCanceled())
+    {
+      exporter.Abort();
+    }
+  }
+
+  if (!exporter.Wait() && !progress.wasCanceled())
+  {
+    qCritical() << "Failed to save the frames" << start << "to" << stop;
+  }
+  progress.setValue(stop - start + 1);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool lqSaveLidarFrameReaction::ExportFrameRange(vtkSMProxy* lidar, int start, int stop,
+                                                vtkSMSourceProxy* writer)
+{
+  if (!vtkLidarReader::SafeDownCast(lidar->GetClientSideObject()))
+  {
+    return false;
+  }
+
+  EncodeFunction encode = this->CreateConcurrentEncoder(writer);
+  if (encode)
+  {
+    const int numberOfEncodingThreads = std::max(1, QThread::idealThreadCount() / 2);
+    return this->ExportFrameRange(lidar, start, stop, numberOfEncodingThreads, encode);
+  }
+
+  // Otherwise a private copy of the writer proxy saves the decoded frames in order, on this
+  // thread, so that the writer given by the caller keeps its input.
+  // Its input is a producer holding the current frame.
+  vtkSMSessionProxyManager* pxm = vtkSMProxyManager::GetProxyManager()->GetActiveSessionProxyManager();
+  vtkSmartPointer<vtkSMSourceProxy> producer;
+  producer.TakeReference(vtkSMSourceProxy::SafeDownCast(pxm->NewProxy("sources", "PVTrivialProducer")));
+  vtkSmartPointer<vtkSMSourceProxy> frameWriter;
+  frameWriter.TakeReference(
+    vtkSMSourceProxy::SafeDownCast(pxm->NewProxy(writer->GetXMLGroup(), writer->GetXMLName())));
+  if (!producer || !frameWriter)
+  {
+    return false;
+  }
+  producer->UpdateVTKObjects();
+  auto* producerObject = vtkPVTrivialProducer::SafeDownCast(producer->GetClientSideObject());
+  if (!producerObject)
+  {
+    return false;
+  }
+
+  // Same settings as the writer, except the input
+  frameWriter->Copy(writer, "vtkSMProxyProperty");
+  vtkSMPropertyHelper(frameWriter, "Input").Set(producer, 0);
+  frameWriter->UpdateVTKObjects();
+
+  encode = [frameWriter, producerObject](vtkPolyData* frame, const std::string& fileName) {
+    producerObject->SetOutput(frame);
+    vtkSMPropertyHelper(frameWriter, "FileName").Set(fileName.c_str());
+    frameWriter->UpdateVTKObjects();
+    frameWriter->UpdatePipeline();
+    return true;
+  };
+  return this->ExportFrameRange(lidar, start, stop, 0, encode);
+}
+
+//-----------------------------------------------------------------------------
+lqSaveLidarFrameReaction::EncodeFunction lqSaveLidarFrameReaction::CreateConcurrentEncoder(
+  vtkSMSourceProxy* writer)
+{
+  auto* pcdWriter = vtkPCDWriter::SafeDownCast(writer->GetClientSideObject());
+  if (!pcdWriter)
+  {
+    return EncodeFunction();
+  }
+
+  // Each frame is saved by its own writer, with the settings of the proxy
+  const bool binary = pcdWriter->GetBinary();
+  const bool compressed = pcdWriter->GetCompressed();
+  const int precision = pcdWriter->GetFloatPointPrecision();
+  return [binary, compressed, precision](vtkPolyData* frame, const std::string& fileName) {
+    vtkNew<vtkPCDWriter> frameWriter;
+    frameWriter->SetBinary(binary);
+    frameWriter->SetCompressed(compressed);
+    frameWriter->SetFloatPointPrecision(precision);
+    frameWriter->SetFileName(fileName.c_str());
+    frameWriter->SetInputData(frame);
+    return frameWriter->Write() == 1;
+  };
+}
+
 //-----------------------------------------------------------------------------
 QString lqSaveLidarFrameReaction::GenerateFileName(QString baseName, double timestep)
 {
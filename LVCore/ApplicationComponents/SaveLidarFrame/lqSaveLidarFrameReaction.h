@@ -5,9 +5,13 @@
 
 #include <vtkSmartPointer.h>
 
+#include <functional>
+#include <string>
+
 #include "lqapplicationcomponents_export.h"
 
 class pqPipelineSource;
+class vtkPolyData;
 class vtkSMSourceProxy;
 class vtkSMProxy;
 
@@ -20,6 +24,9 @@ class vtkSMProxy;
 * - current frame
 * - all frame
 * - frame interval
+*
+* Frame intervals of a LidarReader are decoded once in the background with a
+* LidarFrameExporter, instead of updating the pipeline for each frame.
 */
 class LQAPPLICATIONCOMPONENTS_EXPORT lqSaveLidarFrameReaction : public pqReaction
 {
@@ -53,6 +60,9 @@ public slots:
   virtual void onTriggered() override;
 
 protected:
+  //! Save a frame to the given file, return false on error
+  using EncodeFunction = std::function<bool(vtkPolyData* frame, const std::string& fileName)>;
+
   /**
    * Create the writer.
    * Overwrite this function to change the writer default settings
@@ -70,6 +80,32 @@ protected:
    */
   virtual bool GetFolderAndBaseNameFromUser(vtkSMProxy * lidar);
 
+  /**
+   * Create a function saving a frame without the writer proxy, so that several frames
+   * can be saved at the same time from the export threads.
+   * Return an empty function if the writer does not support it, the frames are
+   * then saved in order through the writer proxy, on the GUI thread.
+   * Overwrite this function to support other writers. The default handles `PCDWriter`.
+   */
+  virtual EncodeFunction CreateConcurrentEncoder(vtkSMSourceProxy* writer);
+
+  /**
+   * Save the timesteps [start; stop] of the lidar with encode, decoding the frames
+   * only once in the background. encode is called from numberOfEncodingThreads threads,
+   * or in frame order on the GUI thread if it is 0.
+   * Return false if the lidar can not be exported this way (not a LidarReader),
+   * the frames must then be saved by updating the pipeline.
+   */
+  bool ExportFrameRange(vtkSMProxy* lidar, int start, int stop,
+                        int numberOfEncodingThreads, const EncodeFunction& encode);
+
+  /**
+   * Save the timesteps [start; stop] of the lidar with the writer, see ExportFrameRange above.
+   * Uses CreateConcurrentEncoder if possible, a copy of the writer proxy otherwise.
+   * The writer itself is left untouched.
+   */
+  bool ExportFrameRange(vtkSMProxy* lidar, int start, int stop, vtkSMSourceProxy* writer);
+
 
   // True if the user only select a directory where all exported files will be saved (with default filename)
   bool UseDirectory;
@@ -399,8 +399,8 @@ void lqLidarCoreManager::saveFramesToLAS(vtkLidarReader* reader, vtkPolyData* po
   writer.SetGeoConversionUTM(utmZone, isLatLon);
   writer.SetOrigin(easting, northing, height);
 
-  QProgressDialog progress("Exporting LAS...", "Abort Export", startFrame,
-    startFrame + (endFrame - startFrame) * 2, getMainWindow());
+  // Single pass: the bounding box and the number of points are stored when closing the file
+  QProgressDialog progress("Exporting LAS...", "Abort Export", startFrame, endFrame, getMainWindow());
   progress.setWindowModality(Qt::WindowModal);
 
   reader->Open();
@@ -414,25 +414,10 @@ void lqLidarCoreManager::saveFramesToLAS(vtkLidarReader* reader, vtkPolyData* po
       return;
     }
 
-    const vtkSmartPointer<vtkPolyData>& data = reader->GetFrame(frame);
-    writer.UpdateMetaData(data.GetPointer());
-  }
-
-  writer.FlushMetaData();
-
-  for (int frame = startFrame; frame <= endFrame; ++frame)
-  {
-    progress.setValue(endFrame + (frame - startFrame));
-
-    if (progress.wasCanceled())
-    {
-      reader->Close();
-      return;
-    }
-
     const vtkSmartPointer<vtkPolyData>& data = reader->GetFrame(frame);
     writer.WriteFrame(data.GetPointer());
   }
+  writer.Close();
 
   reader->Close();
 }
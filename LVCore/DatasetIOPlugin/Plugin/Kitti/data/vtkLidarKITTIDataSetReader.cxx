@@ -5,13 +5,15 @@
 #include <vtkInformation.h>
 #include <vtkPoints.h>
 #include <vtkPointData.h>
-#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
 #include <vtkPolyData.h>
 #include <vtkMath.h>
 
+#include <cmath>
 #include <sstream>
 
 #include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 namespace  {
 //-----------------------------------------------------------------------------
@@ -47,6 +49,13 @@ typedef struct point {
   float z;
   float intensity;
 } point_t;
+
+//-----------------------------------------------------------------------------
+// Same as atan2(y, x) < 0, without computing the angle
+inline bool IsBelowXAxis(float x, float y)
+{
+  return y < 0 || (y == 0 && std::signbit(y) && (x < 0 || (x == 0 && std::signbit(x))));
+}
 }
 
 //-----------------------------------------------------------------------------
@@ -99,86 +108,96 @@ vtkSmartPointer<vtkPolyData> vtkLidarKITTIDataSetReader::GetFrame(int frameNumbe
   points->GetData()->SetName("Points_m_XYZ");
   poly->SetPoints(points.GetPointer());
 
-  vtkSmartPointer<vtkDoubleArray> xArray = CreateDataArray<vtkDoubleArray>("X", poly);
-  vtkSmartPointer<vtkDoubleArray> yArray = CreateDataArray<vtkDoubleArray>("Y", poly);
-  vtkSmartPointer<vtkDoubleArray> zArray = CreateDataArray<vtkDoubleArray>("Z", poly);
-  vtkSmartPointer<vtkDoubleArray> intensityArray = CreateDataArray<vtkDoubleArray>("intensity", poly);
-  vtkSmartPointer<vtkDoubleArray> azimutArray = CreateDataArray<vtkDoubleArray>("azimuth", poly);
-  vtkSmartPointer<vtkDoubleArray> elevationArray = CreateDataArray<vtkDoubleArray>("elevation", poly);
-  vtkSmartPointer<vtkDoubleArray> radiusArray = CreateDataArray<vtkDoubleArray>("radius", poly);
-  vtkSmartPointer<vtkDoubleArray> idArray = CreateDataArray<vtkDoubleArray>("laser_id", poly);
-  vtkSmartPointer<vtkDoubleArray> timestamp = CreateDataArray<vtkDoubleArray>("timestamp", poly);
-  vtkSmartPointer<vtkDoubleArray> adjustedTime = CreateDataArray<vtkDoubleArray>("adjustedtime", poly);
-
-  int startFrame = std::max(0, frameNumber);
-  for (int i = startFrame; i <= frameNumber; i++)
+  // produce path to the required .bin file
+  std::stringstream ss;
+  ss << std::setw(this->NumberOfFileNameDigits) << std::setfill('0') << frameNumber;
+  std::string filename = this->GetFileName() + ss.str() + ".bin";
+
+  // Map the file instead of reading it, the points are then read directly from memory
+  boost::iostreams::mapped_file_source file;
+  try
   {
-    // produce path to the required .bin file
-    std::stringstream ss;
-    ss << std::setw(this->NumberOfFileNameDigits) << std::setfill('0') << i;
-    std::string filename = this->GetFileName() + ss.str() + ".bin";
-
-    std::ifstream is;
-    is.open(filename, ios::binary|ios::in);
-    // get length of file:
-    is.seekg(0, ios::end);
-    int length = is.tellg();
-    is.seekg(0, ios::beg);
-
-    // variable used to detect a laser jump
-    double old_thetaProj = 0;
-    int laser_id = 0;
-
-    // buffer used to read the points
-    char buffer[16];
-    const int nbPoints = length / 16;
-    for (int i = 0; i < nbPoints; i++)
+    // an empty file can not be mapped, and has no points anyway
+    boost::system::error_code error;
+    if (boost::filesystem::file_size(filename, error) > 0 || error)
     {
-      is.read(buffer, 16);
-      point_t* pt;
-      pt = reinterpret_cast<point_t*>(buffer);
-      double x = pt->x;
-      double y = pt->y;
-      double z = pt->z;
-
-      double radius = sqrt(x*x + y*y + z*z);
-      double thetaProj = 180 / vtkMath::Pi() * std::atan2(pt->y, pt->x);
-      double azimut = 180 / vtkMath::Pi() * std::atan2(pt->x, pt->y);
-
-      if (azimut < 0)
-        azimut = 360 + azimut;
+      file.open(filename);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    vtkErrorMacro("Could not open " << filename << ": " << e.what());
+  }
+  const point_t* pts = file.is_open() ? reinterpret_cast<const point_t*>(file.data()) : nullptr;
+  vtkIdType nbPoints = pts ? static_cast<vtkIdType>(file.size() / sizeof(point_t)) : 0;
 
-      if(old_thetaProj < 0 && thetaProj >= 0)
+  // The lasers are stored one after the other, each one starting below the x axis
+  // and ending above it: a new laser starts each time the points cross the x axis
+  std::vector<unsigned char> laserIds(nbPoints);
+  bool wasBelow = false;
+  int laser_id = 0;
+  for (vtkIdType i = 0; i < nbPoints; i++)
+  {
+    const bool isBelow = IsBelowXAxis(pts[i].x, pts[i].y);
+    if (wasBelow && !isBelow)
+    {
+      laser_id++;
+      if (laser_id >= this->NbrLaser)
       {
-        laser_id++;
-        if (laser_id >= this->NbrLaser)
-        {
-          vtkErrorMacro("An error occur while parsing the frame, more than 64 lasers where detected. The last point won't be processed");
-          break;
-        }
+        vtkErrorMacro("An error occur while parsing the frame, more than 64 lasers where detected. The last point won't be processed");
+        nbPoints = i;
+        break;
       }
-      double projRadius = std::sqrt(pt->x * pt->x + pt->y * pt->y);
-      double elevation = 180 / vtkMath::Pi() * std::atan2(pt->z, projRadius);
-
-      double time = azimut / 360.0;
-
-      // fill the polydata
-      points->InsertNextPoint(pt->x, pt->y, pt->z);
-      xArray->InsertNextValue(pt->x);
-      yArray->InsertNextValue(pt->y);
-      zArray->InsertNextValue(pt->z);
-      radiusArray->InsertNextValue(radius);
-      intensityArray->InsertNextValue(pt->intensity);
-      azimutArray->InsertNextValue(azimut);
-      idArray->InsertNextValue(laser_id);
-      elevationArray->InsertNextValue(elevation);
-      timestamp->InsertNextValue(time);
-      adjustedTime->InsertNextValue(time);
-
-      // update old azimut
-      old_thetaProj = thetaProj;
     }
-    is.close();
+    laserIds[i] = static_cast<unsigned char>(laser_id);
+    wasBelow = isBelow;
+  }
+
+  // The data is float32, so are the arrays
+  points->SetNumberOfPoints(nbPoints);
+  auto createArray = [&](const char* name) {
+    vtkSmartPointer<vtkFloatArray> array = CreateDataArray<vtkFloatArray>(name, poly);
+    array->SetNumberOfValues(nbPoints);
+    return array->GetPointer(0);
+  };
+  float* xyz = static_cast<vtkFloatArray*>(points->GetData())->GetPointer(0);
+  float* xArray = createArray("X");
+  float* yArray = createArray("Y");
+  float* zArray = createArray("Z");
+  float* intensityArray = createArray("intensity");
+  float* azimutArray = createArray("azimuth");
+  float* elevationArray = createArray("elevation");
+  float* radiusArray = createArray("radius");
+  float* idArray = createArray("laser_id");
+  float* timestamp = createArray("timestamp");
+  float* adjustedTime = createArray("adjustedtime");
+
+  // fill the polydata in a single pass
+  const float radToDeg = static_cast<float>(180 / vtkMath::Pi());
+  for (vtkIdType i = 0; i < nbPoints; i++)
+  {
+    const float x = pts[i].x;
+    const float y = pts[i].y;
+    const float z = pts[i].z;
+    const float projRadius2 = x * x + y * y;
+
+    float azimut = radToDeg * std::atan2(x, y);
+    azimut += azimut < 0 ? 360.f : 0.f;
+    const float time = azimut / 360.f;
+
+    xyz[3 * i] = x;
+    xyz[3 * i + 1] = y;
+    xyz[3 * i + 2] = z;
+    xArray[i] = x;
+    yArray[i] = y;
+    zArray[i] = z;
+    intensityArray[i] = pts[i].intensity;
+    radiusArray[i] = std::sqrt(projRadius2 + z * z);
+    azimutArray[i] = azimut;
+    elevationArray[i] = radToDeg * std::atan2(z, std::sqrt(projRadius2));
+    idArray[i] = laserIds[i];
+    timestamp[i] = time;
+    adjustedTime[i] = time;
   }
 
   poly->SetVerts(NewVertexCells(poly->GetNumberOfPoints()));
@@ -3,11 +3,12 @@
 #include <vtkInformationVector.h>
 #include <vtkInformation.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 
+#include <cstdio>
 #include <vector>
-#include <fstream>
 #include <sstream>
 
 #include <boost/filesystem.hpp>
@@ -16,19 +17,45 @@ namespace
 {
 
 /*
- * @brief WriteToBinaryFile writes the information to export in a binary file
+ * @brief WriteToBinaryFile writes the information to export in a binary file,
+ * in a single write
+ * @return false if the file could not be written
  * */
-void WriteToBinaryFile(std::vector<float> &inData, const std::string &filename)
+bool WriteToBinaryFile(const std::vector<float> &inData, const std::string &filename)
 {
-  std::ofstream fout(filename, std::ios::out | std::ios::binary);
-  if (!fout.is_open())
+  std::FILE* file = std::fopen(filename.c_str(), "wb");
+  if (!file)
   {
-    std::cout << "Error: could not open file " << filename << " for writing." << std::endl;
+    return false;
   }
-  else
+  const size_t written = std::fwrite(inData.data(), sizeof(float), inData.size(), file);
+  return std::fclose(file) == 0 && written == inData.size();
+}
+
+/*
+ * @brief FillColumn writes the n values of a single component array to the
+ * column of a n x 4 row-major matrix, divided by divisor
+ * */
+template <typename T>
+void FillColumn(const T* values, vtkIdType n, int numberOfComponents, float divisor, float* column)
+{
+  for (vtkIdType i = 0; i < n; ++i)
   {
-    fout.write(reinterpret_cast<char*>(&inData[0]), inData.size() * sizeof(float));
-    fout.close();
+    column[4 * i] = static_cast<float>(values[i * numberOfComponents]) / divisor;
+  }
+}
+
+/*
+ * @brief FillPositions writes n points to the first 3 columns of a n x 4 row-major matrix
+ * */
+template <typename T>
+void FillPositions(const T* points, vtkIdType n, float* data)
+{
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    data[4 * i] = static_cast<float>(points[3 * i]);
+    data[4 * i + 1] = static_cast<float>(points[3 * i + 1]);
+    data[4 * i + 2] = static_cast<float>(points[3 * i + 2]);
   }
 }
 }
@@ -98,26 +125,45 @@ void vtkLidarKITTIDataSetWriter::SetFolderName(const std::string &foldername)
   return;
 }
 
-std::vector<float> vtkLidarKITTIDataSetWriter::ParseCloudData(vtkSmartPointer<vtkPolyData> cloud, vtkDataArray* intensity)
+//-----------------------------------------------------------------------------
+bool vtkLidarKITTIDataSetWriter::ParseCloudData(vtkPolyData* cloud, vtkDataArray* intensity,
+                                                std::vector<float>& dataToWrite)
 {
-  std::vector<float> dataToWrite(4 * cloud->GetNumberOfPoints());
+  const vtkIdType nbPoints = cloud->GetNumberOfPoints();
+  dataToWrite.resize(4 * nbPoints);
+  if (nbPoints == 0)
+  {
+    return true;
+  }
+  if (intensity->GetNumberOfTuples() < nbPoints)
+  {
+    vtkErrorMacro(<< "The intensity array has less values than the number of points.");
+    return false;
+  }
 
-  for (int pointIndex = 0; pointIndex < cloud->GetNumberOfPoints(); ++pointIndex)
+  // Read the arrays directly, whatever their type
+  vtkDataArray* points = cloud->GetPoints()->GetData();
+  switch (points->GetDataType())
   {
-    double* pos = cloud->GetPoint(pointIndex);
-    float ptIntensity = static_cast<float>(intensity->GetTuple1(pointIndex));
-    if (this->NormalizeIntensity)
-    {
-      ptIntensity /= this->InputIntensityMaxValue;
-    }
+    vtkTemplateMacro(FillPositions(static_cast<const VTK_TT*>(points->GetVoidPointer(0)),
+                                   nbPoints, dataToWrite.data()));
+    default:
+      vtkErrorMacro(<< "Unsupported points type.");
+      return false;
+  }
 
-    dataToWrite[4 * pointIndex] = static_cast<float>(pos[0]);
-    dataToWrite[4 * pointIndex + 1] = static_cast<float>(pos[1]);
-    dataToWrite[4 * pointIndex + 2] = static_cast<float>(pos[2]);
-    dataToWrite[4 * pointIndex + 3] = ptIntensity;
+  const float divisor = this->NormalizeIntensity ? this->InputIntensityMaxValue : 1.f;
+  switch (intensity->GetDataType())
+  {
+    vtkTemplateMacro(FillColumn(static_cast<const VTK_TT*>(intensity->GetVoidPointer(0)),
+                                nbPoints, intensity->GetNumberOfComponents(), divisor,
+                                dataToWrite.data() + 3));
+    default:
+      vtkErrorMacro(<< "Unsupported intensity array type.");
+      return false;
   }
 
-  return dataToWrite;
+  return true;
 }
 
 //-----------------------------------------------------------------------------
@@ -147,10 +193,16 @@ int vtkLidarKITTIDataSetWriter::RequestData(vtkInformation *, vtkInformationVect
     return 1;
   }
 
-  // Data for the .bin file are stored in a std::vector to make it easier to use
-  std::vector<float> dataToWrite = this->ParseCloudData(inCloud, intensity);
+  // Data for the .bin file are stored in a std::vector kept between the frames
+  if (!this->ParseCloudData(inCloud, intensity, this->DataToWrite))
+  {
+    return 1;
+  }
 
-  WriteToBinaryFile(dataToWrite, frameFileName);
+  if (!WriteToBinaryFile(this->DataToWrite, frameFileName))
+  {
+    vtkErrorMacro(<< "Could not write the file " << frameFileName);
+  }
 
   return VTK_OK;
 }
@@ -8,6 +8,7 @@
 #include <vtkNew.h>
 
 #include <string>
+#include <vector>
 
 /*
  * @brief vtkLidarKITTIDataSetWriter writes point clouds in KITTI Format
@@ -54,9 +55,10 @@ protected:
   /*
    * @brief ParseCloudData parses a point cloud vtkPolyData to retrieve information
    * to export as a vector of floats containing (x, y, z, intensity) for each
-   * point.
+   * point. The point and intensity arrays are read directly from their buffers.
+   * @return false if the arrays can not be read
    * */
-  std::vector<float> ParseCloudData(vtkSmartPointer<vtkPolyData> cloud, vtkDataArray* intensity);
+  bool ParseCloudData(vtkPolyData* cloud, vtkDataArray* intensity, std::vector<float>& dataToWrite);
 
   int RequestUpdateExtent(vtkInformation *, vtkInformationVector **, vtkInformationVector*) override;
 
@@ -76,6 +78,9 @@ protected:
   bool NormalizeIntensity = 1;
   float InputIntensityMaxValue = 255.;
 
+  // Buffer of the frame to write, kept to avoid an allocation per frame
+  std::vector<float> DataToWrite;
+
 
 private:
   vtkLidarKITTIDataSetWriter(const vtkLidarKITTIDataSetWriter&) = delete;
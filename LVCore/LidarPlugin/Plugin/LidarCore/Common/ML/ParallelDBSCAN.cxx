@@ -0,0 +1,513 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+#include "ParallelDBSCAN.h"
+
+#include "ParallelTools.h"
+
+#include <nanoflann.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+//! Minimum number of points handled by each thread
+constexpr vtkIdType MinPointsPerThread = 2048;
+//! Number of points processed by a thread before fetching more
+constexpr vtkIdType Grain = 256;
+
+//-----------------------------------------------------------------------------
+//! Squared distance, computed as nanoflann::L2_Adaptor does to find the same neighbors
+template <typename T>
+inline double SquaredDistance(const T* a, const T* b)
+{
+  double result = 0.;
+  for (int i = 0; i < 3; ++i)
+  {
+    const double diff = static_cast<double>(a[i]) - static_cast<double>(b[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+//! nanoflann result set forwarding each neighbor to a function
+template <typename F>
+class CallbackResultSet
+{
+public:
+  CallbackResultSet(double radius, F& function)
+    : Radius(radius)
+    , Function(function)
+  {
+  }
+
+  inline bool addPoint(double, size_t index)
+  {
+    this->Function(static_cast<uint32_t>(index));
+    ++this->Count;
+    return true;
+  }
+  inline double worstDist() const { return this->Radius; }
+  inline bool full() const { return true; }
+  inline size_t size() const { return this->Count; }
+
+private:
+  double Radius;
+  F& Function;
+  size_t Count = 0;
+};
+
+//-----------------------------------------------------------------------------
+//! Radius search using a kd-tree on the flat points, built like DBSCAN<T> does
+template <typename T>
+class KDTreeNeighborhood
+{
+public:
+  KDTreeNeighborhood(const T* points, size_t numberOfPoints, double epsilon)
+    : Data{ points, numberOfPoints }
+    , Index(3, this->Data, nanoflann::KDTreeSingleIndexAdaptorParams(10))
+    , Epsilon(epsilon)
+  {
+    this->Index.buildIndex();
+    this->Params.sorted = false;
+  }
+
+  template <typename F>
+  void Query(size_t index, F&& function) const
+  {
+    const T* p = this->Data.Points + 3 * index;
+    const double query[3] = { static_cast<double>(p[0]), static_cast<double>(p[1]),
+      static_cast<double>(p[2]) };
+    CallbackResultSet<F> resultSet(this->Epsilon, function);
+    this->Index.radiusSearchCustomCallback(query, resultSet, this->Params);
+  }
+
+private:
+  struct Adaptor
+  {
+    const T* Points;
+    size_t NumberOfPoints;
+
+    inline size_t kdtree_get_point_count() const { return this->NumberOfPoints; }
+    inline double kdtree_get_pt(const size_t index, const size_t dim) const
+    {
+      return static_cast<double>(this->Points[3 * index + dim]);
+    }
+    template <class BBOX>
+    bool kdtree_get_bbox(BBOX&) const
+    {
+      return false;
+    }
+  };
+  using Metric = nanoflann::L2_Adaptor<double, Adaptor, double>;
+  using Tree = nanoflann::KDTreeSingleIndexAdaptor<Metric, Adaptor, 3, size_t>;
+
+  Adaptor Data;
+  Tree Index;
+  double Epsilon;
+  nanoflann::SearchParams Params;
+};
+
+//-----------------------------------------------------------------------------
+/**
+ * Radius search using a hash of voxels of size sqrt(epsilon): the neighbors of a point
+ * are in the 27 voxels around it. Faster than the kd-tree when epsilon is small
+ * compared to the extent of the cloud.
+ */
+template <typename T>
+class VoxelGridNeighborhood
+{
+public:
+  VoxelGridNeighborhood(const T* points, size_t numberOfPoints, double epsilon)
+    : Points(points)
+    , Epsilon(epsilon)
+  {
+    // Slightly larger than the radius so that the rounding errors can not hide a neighbor
+    this->VoxelSize = std::sqrt(epsilon) * (1. + 1e-6);
+
+    double minPt[3] = { points[0], points[1], points[2] };
+    double maxPt[3] = { points[0], points[1], points[2] };
+    for (size_t i = 0; i < numberOfPoints; ++i)
+    {
+      for (int dim = 0; dim < 3; ++dim)
+      {
+        const double value = points[3 * i + dim];
+        if (!std::isfinite(value))
+        {
+          return;
+        }
+        minPt[dim] = std::min(minPt[dim], value);
+        maxPt[dim] = std::max(maxPt[dim], value);
+      }
+    }
+    for (int dim = 0; dim < 3; ++dim)
+    {
+      this->Origin[dim] = minPt[dim];
+      if ((maxPt[dim] - minPt[dim]) / this->VoxelSize >= MaxVoxel)
+      {
+        return;
+      }
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys(numberOfPoints);
+    for (size_t i = 0; i < numberOfPoints; ++i)
+    {
+      int64_t voxel[3];
+      this->GetVoxel(i, voxel);
+      keys[i] = { Key(voxel[0], voxel[1], voxel[2]), static_cast<uint32_t>(i) };
+    }
+    std::sort(keys.begin(), keys.end());
+
+    this->SortedPoints.resize(numberOfPoints);
+    this->Voxels.reserve(numberOfPoints);
+    for (size_t i = 0; i < numberOfPoints; ++i)
+    {
+      this->SortedPoints[i] = keys[i].second;
+      if (i == 0 || keys[i].first != keys[i - 1].first)
+      {
+        this->Voxels[keys[i].first] = { static_cast<uint32_t>(i), static_cast<uint32_t>(i) };
+      }
+      ++this->Voxels[keys[i].first].second;
+    }
+    this->Valid = true;
+  }
+
+  //! False if the cloud is too large for the voxel size, or has invalid points
+  bool IsValid() const { return this->Valid; }
+
+  template <typename F>
+  void Query(size_t index, F&& function) const
+  {
+    const T* p = this->Points + 3 * index;
+    int64_t voxel[3];
+    this->GetVoxel(index, voxel);
+    for (int64_t z = std::max<int64_t>(voxel[2] - 1, 0); z <= voxel[2] + 1; ++z)
+    {
+      for (int64_t y = std::max<int64_t>(voxel[1] - 1, 0); y <= voxel[1] + 1; ++y)
+      {
+        for (int64_t x = std::max<int64_t>(voxel[0] - 1, 0); x <= voxel[0] + 1; ++x)
+        {
+          auto it = this->Voxels.find(Key(x, y, z));
+          if (it == this->Voxels.end())
+          {
+            continue;
+          }
+          for (uint32_t i = it->second.first; i < it->second.second; ++i)
+          {
+            const uint32_t neighbor = this->SortedPoints[i];
+            if (SquaredDistance(p, this->Points + 3 * neighbor) < this->Epsilon)
+            {
+              function(neighbor);
+            }
+          }
+        }
+      }
+    }
+  }
+
+private:
+  static constexpr int BitsPerAxis = 21;
+  static constexpr int64_t MaxVoxel = (int64_t(1) << BitsPerAxis) - 2;
+
+  static inline uint64_t Key(int64_t x, int64_t y, int64_t z)
+  {
+    return static_cast<uint64_t>(x) | (static_cast<uint64_t>(y) << BitsPerAxis) |
+      (static_cast<uint64_t>(z) << (2 * BitsPerAxis));
+  }
+
+  inline void GetVoxel(size_t index, int64_t voxel[3]) const
+  {
+    for (int dim = 0; dim < 3; ++dim)
+    {
+      voxel[dim] = static_cast<int64_t>(
+        std::floor((this->Points[3 * index + dim] - this->Origin[dim]) / this->VoxelSize));
+    }
+  }
+
+  const T* Points;
+  double Epsilon;
+  double VoxelSize;
+  double Origin[3] = { 0., 0., 0. };
+  bool Valid = false;
+  std::vector<uint32_t> SortedPoints;
+  std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> Voxels;
+};
+
+//-----------------------------------------------------------------------------
+//! No point has a neighbor, not even itself, when epsilon is not positive
+struct EmptyNeighborhood
+{
+  template <typename F>
+  void Query(size_t, F&&) const
+  {
+  }
+};
+}
+
+//-----------------------------------------------------------------------------
+ParallelDBSCAN::ParallelDBSCAN(double epsilon, double minPts)
+  : Epsilon(epsilon)
+  , MinPts(static_cast<unsigned int>(minPts))
+{
+}
+
+//-----------------------------------------------------------------------------
+int ParallelDBSCAN::GetNumberOfThreadsToUse(size_t numberOfPoints) const
+{
+  return ParallelTools::GetNumberOfThreadsToUse(this->NumberOfThreads, numberOfPoints, MinPointsPerThread);
+}
+
+//-----------------------------------------------------------------------------
+uint32_t ParallelDBSCAN::Find(uint32_t index)
+{
+  // Path halving, each node can only be moved closer to its root
+  for (;;)
+  {
+    uint32_t parent = this->Parent[index].load(std::memory_order_relaxed);
+    if (parent == index)
+    {
+      return index;
+    }
+    const uint32_t grandParent = this->Parent[parent].load(std::memory_order_relaxed);
+    if (grandParent != parent)
+    {
+      this->Parent[index].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+    }
+    index = grandParent;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ParallelDBSCAN::Union(uint32_t a, uint32_t b)
+{
+  // The root with the larger index is linked to the other one, so that the
+  // roots are the first point of their tree, whatever the order of the unions
+  for (;;)
+  {
+    a = this->Find(a);
+    b = this->Find(b);
+    if (a == b)
+    {
+      return;
+    }
+    if (a < b)
+    {
+      std::swap(a, b);
+    }
+    uint32_t expected = a;
+    if (this->Parent[a].compare_exchange_strong(expected, b))
+    {
+      return;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+const std::vector<int>& ParallelDBSCAN::Fit(const T* points, size_t numberOfPoints)
+{
+  this->NbCluster = 0;
+  this->Labels.assign(numberOfPoints, 0);
+  if (numberOfPoints == 0)
+  {
+    return this->Labels;
+  }
+
+  // DBSCAN<T> keeps the points strictly closer than epsilon: none, if it is not positive
+  if (!(this->Epsilon > 0.))
+  {
+    this->Cluster(EmptyNeighborhood(), numberOfPoints);
+    return this->Labels;
+  }
+
+  if (this->Search == NeighborSearch::VoxelGrid)
+  {
+    VoxelGridNeighborhood<T> grid(points, numberOfPoints, this->Epsilon);
+    if (grid.IsValid())
+    {
+      this->Cluster(grid, numberOfPoints);
+      return this->Labels;
+    }
+  }
+  KDTreeNeighborhood<T> tree(points, numberOfPoints, this->Epsilon);
+  this->Cluster(tree, numberOfPoints);
+  return this->Labels;
+}
+
+//-----------------------------------------------------------------------------
+template <typename Neighborhood>
+void ParallelDBSCAN::Cluster(const Neighborhood& neighborhood, size_t numberOfPoints)
+{
+  const int threads = this->GetNumberOfThreadsToUse(numberOfPoints);
+  const unsigned int minPts = this->MinPts;
+
+  // Count the neighbors of each point
+  this->NeighborCount.resize(numberOfPoints);
+  ParallelTools::ParallelFor(numberOfPoints, Grain, threads, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+    {
+      uint32_t count = 0;
+      neighborhood.Query(i, [&count](uint32_t) { ++count; });
+      this->NeighborCount[i] = count;
+    }
+  });
+
+  // Only the core points, which expand their cluster, are merged. The neighbors
+  // of the other ones are kept to find the cluster which reaches them first.
+  auto isCore = [this, minPts](size_t i) { return this->NeighborCount[i] > minPts; };
+  this->NeighborOffset.resize(numberOfPoints + 1);
+  this->NeighborOffset[0] = 0;
+  for (size_t i = 0; i < numberOfPoints; ++i)
+  {
+    this->NeighborOffset[i + 1] =
+      this->NeighborOffset[i] + (isCore(i) ? 0 : this->NeighborCount[i]);
+  }
+  this->Neighbors.resize(this->NeighborOffset[numberOfPoints]);
+
+  if (this->ParentCapacity < numberOfPoints)
+  {
+    this->Parent.reset(new std::atomic<uint32_t>[numberOfPoints]);
+    this->ParentCapacity = numberOfPoints;
+  }
+  for (size_t i = 0; i < numberOfPoints; ++i)
+  {
+    this->Parent[i].store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+  }
+
+  ParallelTools::ParallelFor(numberOfPoints, Grain, threads, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i)
+    {
+      const uint32_t index = static_cast<uint32_t>(i);
+      if (isCore(i))
+      {
+        neighborhood.Query(i, [&](uint32_t neighbor) {
+          if (neighbor < index && isCore(neighbor))
+          {
+            this->Union(index, neighbor);
+          }
+        });
+      }
+      else
+      {
+        uint32_t* neighbors = this->Neighbors.data() + this->NeighborOffset[i];
+        neighborhood.Query(i, [&neighbors](uint32_t neighbor) { *neighbors++ = neighbor; });
+      }
+    }
+  });
+
+  this->Label(numberOfPoints);
+}
+
+//-----------------------------------------------------------------------------
+void ParallelDBSCAN::Label(size_t numberOfPoints)
+{
+  const unsigned int minPts = this->MinPts;
+  auto isCore = [this, minPts](size_t i) { return this->NeighborCount[i] > minPts; };
+  auto neighborsBegin = [this](size_t i) { return this->Neighbors.data() + this->NeighborOffset[i]; };
+  auto neighborsEnd = [this](size_t i) { return this->Neighbors.data() + this->NeighborOffset[i + 1]; };
+
+  // Replay the seeds of DBSCAN<T> in index order. A seed starts a new cluster
+  // if no previous cluster has reached it:
+  // - a core seed claims its whole set of merged core points
+  // - a seed which is not core claims the core sets around it, which can not have
+  //   been claimed yet, and its other neighbors. Labels holds the first of these
+  //   claims for the non core points.
+  this->ClusterOfRoot.assign(numberOfPoints, 0);
+  this->Seeds.clear();
+  int nbCluster = 0;
+  for (size_t i = 0; i < numberOfPoints; ++i)
+  {
+    if (isCore(i))
+    {
+      const uint32_t root = this->Find(static_cast<uint32_t>(i));
+      if (this->ClusterOfRoot[root] == 0)
+      {
+        this->ClusterOfRoot[root] = ++nbCluster;
+        this->Seeds.push_back(static_cast<uint32_t>(i));
+      }
+      continue;
+    }
+    if (this->NeighborCount[i] < minPts || this->Labels[i] != 0)
+    {
+      continue;
+    }
+    const bool reached = std::any_of(neighborsBegin(i), neighborsEnd(i), [&](uint32_t neighbor) {
+      return isCore(neighbor) && this->ClusterOfRoot[this->Find(neighbor)] != 0;
+    });
+    if (reached)
+    {
+      continue;
+    }
+
+    ++nbCluster;
+    this->Seeds.push_back(static_cast<uint32_t>(i));
+    this->Labels[i] = nbCluster;
+    for (const uint32_t* it = neighborsBegin(i); it != neighborsEnd(i); ++it)
+    {
+      if (isCore(*it))
+      {
+        this->ClusterOfRoot[this->Find(*it)] = nbCluster;
+      }
+      else if (this->Labels[*it] == 0)
+      {
+        this->Labels[*it] = nbCluster;
+      }
+    }
+  }
+  this->NbCluster = nbCluster;
+
+  // A core point belongs to the cluster of its set. A non core point belongs to the
+  // first cluster reaching it. DBSCAN<T> marks it as noise when visiting it, and
+  // only a seed can then claim it back: the clusters started after it must have
+  // their seed among its neighbors.
+  ParallelTools::ParallelFor(numberOfPoints, Grain, this->GetNumberOfThreadsToUse(numberOfPoints),
+    [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+      {
+        if (isCore(i))
+        {
+          this->Labels[i] = this->ClusterOfRoot[this->Find(static_cast<uint32_t>(i))];
+          continue;
+        }
+        int label = this->Labels[i];
+        for (const uint32_t* it = neighborsBegin(i); it != neighborsEnd(i); ++it)
+        {
+          if (!isCore(*it))
+          {
+            continue;
+          }
+          const int cluster = this->ClusterOfRoot[this->Find(*it)];
+          if (label != 0 && label <= cluster)
+          {
+            continue;
+          }
+          const uint32_t seed = this->Seeds[cluster - 1];
+          if (seed < i || std::find(neighborsBegin(i), neighborsEnd(i), seed) != neighborsEnd(i))
+          {
+            label = cluster;
+          }
+        }
+        this->Labels[i] = label;
+      }
+    });
+}
+
+template const std::vector<int>& ParallelDBSCAN::Fit<float>(const float*, size_t);
+template const std::vector<int>& ParallelDBSCAN::Fit<double>(const double*, size_t);
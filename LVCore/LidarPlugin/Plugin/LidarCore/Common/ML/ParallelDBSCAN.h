@@ -0,0 +1,101 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+#ifndef PARALLEL_DBSCAN_H
+#define PARALLEL_DBSCAN_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "LidarCoreModule.h"
+
+/**
+ * @brief Multi-threaded DBSCAN, giving the same labels as DBSCAN<T>.
+ *
+ * The points are read in place from a flat xyz array. Instead of storing the
+ * neighbors of every point:
+ * - the neighbors are counted by parallel radius queries
+ * - the core points are merged by a lock-free union-find during a second query pass,
+ *   only the neighbors of the non core points (at most MinPts each) are kept
+ * - the clusters are then numbered by a sequential pass following the visit order of DBSCAN<T>
+ *
+ * Same conventions as DBSCAN<T>: two points are neighbors if their squared distance
+ * is lower than Epsilon, a point is its own neighbor, the label 0 is noise and the
+ * clusters are numbered from 1.
+ * The neighbors are searched with a kd-tree (nanoflann) or a voxel hash grid, both
+ * give the same neighbors. The number of points is limited to 2^32 - 1.
+ */
+class LIDARCORE_EXPORT ParallelDBSCAN
+{
+public:
+  enum class NeighborSearch
+  {
+    KDTree = 0,
+    VoxelGrid = 1
+  };
+
+  ParallelDBSCAN(double epsilon, double minPts);
+
+  void SetEpsilon(double value) { this->Epsilon = value; }
+  void SetMinPts(double value) { this->MinPts = static_cast<unsigned int>(value); }
+
+  //! Number of threads used, 0 to use all the cores
+  void SetNumberOfThreads(int value) { this->NumberOfThreads = value; }
+
+  void SetNeighborSearch(NeighborSearch value) { this->Search = value; }
+
+  /**
+   * @brief Fit run the clustering on numberOfPoints points stored as x0 y0 z0 x1 y1 z1 ...
+   * @return the label of each point, valid until the next call
+   */
+  template <typename T>
+  const std::vector<int>& Fit(const T* points, size_t numberOfPoints);
+
+  int GetNbCluster() const { return this->NbCluster; }
+
+private:
+  int GetNumberOfThreadsToUse(size_t numberOfPoints) const;
+  //! Count the neighbors, merge the core points and store the neighbors of the others
+  template <typename Neighborhood>
+  void Cluster(const Neighborhood& neighborhood, size_t numberOfPoints);
+  //! Find the root of a point in the union-find forest. Thread safe.
+  uint32_t Find(uint32_t index);
+  //! Merge the trees of two points. Thread safe.
+  void Union(uint32_t a, uint32_t b);
+  //! Number the clusters in the same order as DBSCAN<T>, once the core points are merged
+  void Label(size_t numberOfPoints);
+
+  double Epsilon;
+  unsigned int MinPts;
+  int NumberOfThreads = 0;
+  NeighborSearch Search = NeighborSearch::KDTree;
+  int NbCluster = 0;
+
+  // Buffers kept between the calls, to avoid reallocating them for each frame
+  std::vector<uint32_t> NeighborCount;                /*!< including the point itself */
+  std::unique_ptr<std::atomic<uint32_t>[]> Parent;    /*!< union-find forest of the core points */
+  size_t ParentCapacity = 0;
+  std::vector<size_t> NeighborOffset;                 /*!< first neighbor of each non core point */
+  std::vector<uint32_t> Neighbors;                    /*!< neighbors of the non core points */
+  std::vector<int> ClusterOfRoot;                     /*!< cluster of each union-find root */
+  std::vector<uint32_t> Seeds;                        /*!< point starting each cluster */
+  std::vector<int> Labels;
+};
+
+#endif // PARALLEL_DBSCAN_H
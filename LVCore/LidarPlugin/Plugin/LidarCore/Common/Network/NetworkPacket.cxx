@@ -31,7 +31,28 @@ NetworkPacket* NetworkPacket::BuildEthernetIP4UDP(const unsigned char* payload,
                                                  uint16_t destinationPort,
                                                  uint64_t macAddress)
 {
-  NetworkPacket* packet = new NetworkPacket();
+  return NetworkPacket::BuildEthernetIP4UDP(payload, payloadSize, sourceIPv4BigEndian,
+                                            sourcePort, destinationPort, macAddress, nullptr);
+}
+
+//------------------------------------------------------------------------------
+NetworkPacket* NetworkPacket::BuildEthernetIP4UDP(const unsigned char* payload,
+                                                 std::size_t payloadSize,
+                                                 std::array<unsigned char, 4> sourceIPv4BigEndian,
+                                                 uint16_t sourcePort,
+                                                 uint16_t destinationPort,
+                                                 uint64_t macAddress,
+                                                 const std::shared_ptr<NetworkPacketPool>& pool)
+{
+  NetworkPacket* packet = pool ? pool->Acquire() : nullptr;
+  if (!packet)
+  {
+    if (pool)
+    {
+      pool->IncrementNumberOfMisses();
+    }
+    packet = new NetworkPacket();
+  }
   gettimeofday(&packet->ReceptionTime, nullptr);
 
   packet->PacketData.resize(sizeof(Ethernet_IPV4_UDP_Header) + payloadSize);
@@ -87,3 +108,74 @@ unsigned int NetworkPacket::GetPayloadSize() const
   // last - first + 1
   return (this->GetPacketSize() - 1) - this->PayloadStart + 1;
 }
+
+//------------------------------------------------------------------------------
+void NetworkPacket::AddReference()
+{
+  this->ReferenceCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+void NetworkPacket::Release()
+{
+  if (this->ReferenceCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+  {
+    return;
+  }
+  if (this->Pool)
+  {
+    this->Pool->Recycle(this);
+  }
+  else
+  {
+    delete this;
+  }
+}
+
+//------------------------------------------------------------------------------
+NetworkPacketPool::NetworkPacketPool(std::size_t numberOfSlots)
+{
+  this->Slots.reserve(numberOfSlots);
+  this->FreeSlots.reserve(numberOfSlots);
+  for (std::size_t i = 0; i < numberOfSlots; ++i)
+  {
+    this->Slots.emplace_back(new NetworkPacket());
+    this->FreeSlots.push_back(this->Slots.back().get());
+  }
+}
+
+//------------------------------------------------------------------------------
+NetworkPacket* NetworkPacketPool::Acquire()
+{
+  NetworkPacket* packet = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(this->FreeSlotsMutex);
+    if (this->FreeSlots.empty())
+    {
+      return nullptr;
+    }
+    packet = this->FreeSlots.back();
+    this->FreeSlots.pop_back();
+  }
+  packet->ReferenceCount.store(1, std::memory_order_relaxed);
+  packet->Pool = this->shared_from_this();
+  return packet;
+}
+
+//------------------------------------------------------------------------------
+std::size_t NetworkPacketPool::GetNumberOfSlotsInUse()
+{
+  std::lock_guard<std::mutex> lock(this->FreeSlotsMutex);
+  return this->Slots.size() - this->FreeSlots.size();
+}
+
+//------------------------------------------------------------------------------
+void NetworkPacketPool::Recycle(NetworkPacket* packet)
+{
+  // The last packet in use may hold the last reference to the pool,
+  // so release it only once the slot is back in the free list
+  std::shared_ptr<NetworkPacketPool> self;
+  self.swap(packet->Pool);
+  std::lock_guard<std::mutex> lock(this->FreeSlotsMutex);
+  this->FreeSlots.push_back(packet);
+}
@@ -23,8 +23,12 @@
 #else
 #include <sys/time.h>
 #endif
-#include <vector>
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <boost/endian/arithmetic.hpp>
 
@@ -72,6 +76,17 @@ struct Ethernet_IPV4_UDP_Header
 };
 #pragma pack(pop)
 
+class NetworkPacketPool;
+
+/**
+ * \class NetworkPacket
+ * \brief A received UDP datagram, with synthesized Ethernet/IPv4/UDP headers.
+ *
+ * Packets are reference counted so that several threads (decoding, recording)
+ * can share the same packet without copying it. A packet is created with one
+ * reference, each user must call Release() once done with it. Packets built
+ * from a NetworkPacketPool go back to the pool instead of being freed.
+ */
 class NetworkPacket
 {
 public:
@@ -82,6 +97,24 @@ public:
                                            uint16_t destinationPort,
                                            uint64_t macAddress);
 
+  /**
+   * @brief BuildEthernetIP4UDP same as above, but the packet is taken from the pool.
+   * A heap allocated packet is returned if all the slots of the pool are in use.
+   */
+  static NetworkPacket* BuildEthernetIP4UDP(const unsigned char* payload,
+                                           std::size_t payloadSize,
+                                           std::array<unsigned char, 4> sourceIPv4BigEndian,
+                                           uint16_t sourcePort,
+                                           uint16_t destinationPort,
+                                           uint64_t macAddress,
+                                           const std::shared_ptr<NetworkPacketPool>& pool);
+
+  //! Add a user to this packet, which must call Release() once done
+  void AddReference();
+
+  //! Remove a user, the packet is recycled or deleted when there is no user left
+  void Release();
+
   // Note that the memory zone returned by P->GetPayloadData() has a lifetime equal
   // to the instance P of NetworkPacket (no copy is done), and must not be freed
   // by the user of NetworkPacket
@@ -91,13 +124,57 @@ public:
   unsigned int GetPayloadSize() const;
   struct timeval ReceptionTime;
 
+  ~NetworkPacket() = default;
+
 private:
+  friend class NetworkPacketPool;
   NetworkPacket() = default; // prevent construction without using a static constructor
+  NetworkPacket(const NetworkPacket&) = delete; // share it with AddReference instead
+  void operator=(const NetworkPacket&) = delete;
+
   unsigned int PayloadStart = 0;
-  // should you want to switch PacketData to a C array,
-  // ensure care that the copy constructor copies it.
+  // The capacity of the vector is kept when a pooled packet is recycled,
+  // so that reusing a slot does not allocate memory.
   std::vector<unsigned char> PacketData;
+
+  std::atomic<int> ReferenceCount{ 1 };
+  //! Pool owning this packet, null for heap allocated packets or free slots
+  std::shared_ptr<NetworkPacketPool> Pool;
 };
 
+/**
+ * \class NetworkPacketPool
+ * \brief Fixed number of NetworkPacket slots reused by the receiver,
+ *        to avoid a memory allocation for each received datagram.
+ *
+ * The pool must be owned by a shared_ptr, as the packets in use keep it alive.
+ */
+class NetworkPacketPool : public std::enable_shared_from_this<NetworkPacketPool>
+{
+public:
+  explicit NetworkPacketPool(std::size_t numberOfSlots);
+
+  /**
+   * @brief Acquire take a free slot, with one reference
+   * @return nullptr if all the slots are in use
+   */
+  NetworkPacket* Acquire();
+
+  std::size_t GetNumberOfSlots() const { return this->Slots.size(); }
+  std::size_t GetNumberOfSlotsInUse();
+
+  //! Number of packets which had to be allocated because the pool was empty
+  uint64_t GetNumberOfMisses() const { return this->Misses; }
+  void IncrementNumberOfMisses() { this->Misses++; }
+
+private:
+  friend class NetworkPacket;
+  void Recycle(NetworkPacket* packet);
+
+  std::vector<std::unique_ptr<NetworkPacket>> Slots;
+  std::vector<NetworkPacket*> FreeSlots;
+  std::mutex FreeSlotsMutex;
+  std::atomic<uint64_t> Misses{ 0 };
+};
 
 #endif // NETWORKPACKET_H
@@ -2,7 +2,9 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
 #include <boost/endian/arithmetic.hpp>
+#include <boost/endian/conversion.hpp>
 
 bool IPHeaderFunctions::getFragmentInfo(unsigned char const * data, FragmentInfo & fragmentInfo)
 {
@@ -247,6 +249,154 @@ void vtkPacketFileReader::SetFilePosition(fpos_t* position)
 #endif
 }
   
+namespace
+{
+#ifdef _MSC_VER
+int64_t TellOffset(FILE* f) { return _ftelli64(f); }
+bool SeekOffset(FILE* f, int64_t offset) { return _fseeki64(f, offset, SEEK_SET) == 0; }
+#else
+int64_t TellOffset(FILE* f) { return ftello(f); }
+bool SeekOffset(FILE* f, int64_t offset) { return fseeko(f, offset, SEEK_SET) == 0; }
+#endif
+
+// Layout of the classic pcap format, see https://wiki.wireshark.org/Development/LibpcapFileFormat
+const int64_t PcapGlobalHeaderSize = 24;
+const int64_t PcapRecordHeaderSize = 16;
+const uint32_t PcapMaximumRecordSize = 262144;
+
+struct PcapRecordHeader
+{
+  uint32_t Seconds;
+  uint32_t SubSeconds;
+  uint32_t CapturedLength;
+  uint32_t OriginalLength;
+};
+
+uint32_t SwapIfNeeded(uint32_t value, bool swap)
+{
+  return swap ? boost::endian::endian_reverse(value) : value;
+}
+
+bool ReadRecordHeader(FILE* f, int64_t offset, bool swap, PcapRecordHeader& header)
+{
+  uint32_t fields[4];
+  if (!SeekOffset(f, offset) || fread(fields, sizeof(fields), 1, f) != 1)
+  {
+    return false;
+  }
+  header.Seconds = SwapIfNeeded(fields[0], swap);
+  header.SubSeconds = SwapIfNeeded(fields[1], swap);
+  header.CapturedLength = SwapIfNeeded(fields[2], swap);
+  header.OriginalLength = SwapIfNeeded(fields[3], swap);
+  return true;
+}
+}
+
+//-----------------------------------------------------------------------------
+int64_t vtkPacketFileReader::GetFileOffset()
+{
+#ifdef _MSC_VER
+  fpos_t position;
+  pcap_fgetpos(this->PCAPFile, &position);
+  return static_cast<int64_t>(position);
+#else
+  return TellOffset(pcap_file(this->PCAPFile));
+#endif
+}
+
+//-----------------------------------------------------------------------------
+bool vtkPacketFileReader::SetFileOffset(int64_t offset)
+{
+#ifdef _MSC_VER
+  fpos_t position = offset;
+  return pcap_fsetpos(this->PCAPFile, &position) == 0;
+#else
+  return SeekOffset(pcap_file(this->PCAPFile), offset);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int64_t vtkPacketFileReader::FindNextRecordOffset(const std::string& filename, int64_t offset)
+{
+  FILE* f = fopen(filename.c_str(), "rb");
+  if (!f)
+  {
+    return -1;
+  }
+
+  int64_t result = -1;
+  uint32_t globalHeader[6];
+  if (fread(globalHeader, sizeof(globalHeader), 1, f) == 1 &&
+      SeekOffset(f, 0) && fseek(f, 0, SEEK_END) == 0)
+  {
+    const int64_t fileSize = TellOffset(f);
+    const uint32_t magic = globalHeader[0];
+    const bool swap = magic == 0xd4c3b2a1 || magic == 0x4d3cb2a1;
+    const bool nanoseconds = magic == 0xa1b23c4d || magic == 0x4d3cb2a1;
+    const bool supported = swap || magic == 0xa1b2c3d4 || magic == 0xa1b23c4d;
+    uint32_t snapLength = SwapIfNeeded(globalHeader[4], swap);
+    if (snapLength == 0 || snapLength > PcapMaximumRecordSize)
+    {
+      snapLength = PcapMaximumRecordSize;
+    }
+
+    PcapRecordHeader first;
+    if (!supported)
+    {
+      result = -1;
+    }
+    else if (offset <= PcapGlobalHeaderSize)
+    {
+      result = PcapGlobalHeaderSize;
+    }
+    else if (!ReadRecordHeader(f, PcapGlobalHeaderSize, swap, first))
+    {
+      result = fileSize;
+    }
+    else
+    {
+      // A record header is plausible if its lengths are consistent and
+      // if its timestamp is close to the one of the first record
+      auto isPlausible = [&](const PcapRecordHeader& header) {
+        return header.SubSeconds < (nanoseconds ? 1000000000u : 1000000u) &&
+          header.CapturedLength > 0 && header.CapturedLength <= snapLength &&
+          header.CapturedLength <= header.OriginalLength &&
+          header.OriginalLength <= PcapMaximumRecordSize &&
+          header.Seconds + 86400u >= first.Seconds &&
+          header.Seconds <= first.Seconds + 365u * 86400u;
+      };
+
+      // Number of consecutive valid headers required to accept a candidate
+      const int chainLength = 16;
+      for (int64_t candidate = offset; candidate + PcapRecordHeaderSize <= fileSize && result < 0; ++candidate)
+      {
+        int64_t position = candidate;
+        int validated = 0;
+        PcapRecordHeader header;
+        while (validated < chainLength && position + PcapRecordHeaderSize <= fileSize &&
+               ReadRecordHeader(f, position, swap, header) && isPlausible(header))
+        {
+          position += PcapRecordHeaderSize + header.CapturedLength;
+          validated++;
+        }
+        // The chain may also end exactly at the end of the file
+        if (validated == chainLength || (validated > 0 && position == fileSize))
+        {
+          result = candidate;
+        }
+      }
+      if (result < 0 && offset >= fileSize - PcapRecordHeaderSize)
+      {
+        result = fileSize;
+      }
+    }
+  }
+
+  fclose(f);
+  return result;
+}
+
+//-----------------------------------------------------------------------------
 bool vtkPacketFileReader::NextPacket(const unsigned char*& data, unsigned int& dataLength, double& timeSinceStart,
   pcap_pkthdr** headerReference, unsigned int* dataHeaderLength )
 {
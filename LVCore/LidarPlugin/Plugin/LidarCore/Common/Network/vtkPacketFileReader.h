@@ -39,6 +39,7 @@
 
 #include <pcap.h>
 #include <string>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <vector>
@@ -151,6 +152,30 @@ public:
   void GetFilePosition(fpos_t* position);
   void SetFilePosition(fpos_t* position);
 
+  /**
+   * @brief GetFileOffset return the current position as a byte offset in the capture file.
+   * Contrary to fpos_t, offsets can be compared and computed.
+   */
+  int64_t GetFileOffset();
+
+  /**
+   * @brief SetFileOffset move to a byte offset of the capture file,
+   * which must be the start of a packet record, see FindNextRecordOffset.
+   * Returns true is successful.
+   */
+  bool SetFileOffset(int64_t offset);
+
+  /**
+   * @brief FindNextRecordOffset search the first packet record starting at or after offset,
+   * in a classic pcap file (pcapng is not supported). As the records are not aligned,
+   * a candidate is only accepted if it is followed by a chain of valid record headers.
+   * @param[in] filename pcap file name.
+   * @param[in] offset byte offset where to start the search.
+   * Returns the offset of the record, the file size if there is no record after offset,
+   * or -1 if the file format is not supported or no record could be identified.
+  */
+  static int64_t FindNextRecordOffset(const std::string& filename, int64_t offset);
+
   /**
    * @brief Read next UDP payload of the capture.
    * @param[in] data A pointer to the first byte of UDP Payload.
@@ -14,8 +14,21 @@
 
 #include "vtkPacketFileWriter.h"
 
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
 
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+namespace
+{
+// Size of the pcap file header and of each packet record header
+constexpr uint64_t PcapFileHeaderSize = 24;
+constexpr uint64_t PcapRecordHeaderSize = 16;
+}
+
 #ifdef WIN32
 char *wchar2char(const wchar_t* source)
 {
@@ -76,7 +89,32 @@ bool vtkPacketFileWriter::Open(const std::string& filename)
   this->PCAPDump = pcap_dump_open(this->PCAPFile, path);
   delete [] path;
 #else
-  this->PCAPDump = pcap_dump_open(this->PCAPFile, filename.c_str());
+  // Open the file ourselves to control its buffering and allocation
+  FILE* file = std::fopen(filename.c_str(), "wb");
+  if (!file)
+  {
+    this->LastError = std::strerror(errno);
+    pcap_close(this->PCAPFile);
+    this->PCAPFile = 0;
+    return false;
+  }
+  if (this->BufferSize > 0)
+  {
+    this->Buffer.reset(new char[this->BufferSize]);
+    std::setvbuf(file, this->Buffer.get(), _IOFBF, this->BufferSize);
+  }
+#ifdef __linux__
+  if (this->PreallocationSize > 0)
+  {
+    // Failure only means that the file system can not reserve the space in advance
+    fallocate(fileno(file), FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(this->PreallocationSize));
+  }
+#endif
+  this->PCAPDump = pcap_dump_fopen(this->PCAPFile, file);
+  if (!this->PCAPDump)
+  {
+    std::fclose(file);
+  }
 #endif
 
   if (!this->PCAPDump)
@@ -84,10 +122,12 @@ bool vtkPacketFileWriter::Open(const std::string& filename)
     this->LastError = pcap_geterr(this->PCAPFile);
     pcap_close(this->PCAPFile);
     this->PCAPFile = 0;
+    this->Buffer.reset();
     return false;
   }
 
   this->FileName = filename;
+  this->BytesWritten = PcapFileHeaderSize;
   return true;
 }
 
@@ -106,9 +146,17 @@ void vtkPacketFileWriter::Close()
     this->PCAPFile = 0;
     this->PCAPDump = 0;
     this->FileName.clear();
+    // Only once the file is closed, as it may still use the buffer
+    this->Buffer.reset();
   }
 }
 
+//--------------------------------------------------------------------------------
+bool vtkPacketFileWriter::Flush()
+{
+  return this->PCAPDump && pcap_dump_flush(this->PCAPDump) == 0;
+}
+
 //--------------------------------------------------------------------------------
 const std::string& vtkPacketFileWriter::GetLastError()
 {
@@ -136,6 +184,7 @@ bool vtkPacketFileWriter::WritePacket(const NetworkPacket& packet)
   header.ts = packet.ReceptionTime;
 
   pcap_dump((u_char*)this->PCAPDump, &header, packet.GetPacketData());
+  this->BytesWritten += PcapRecordHeaderSize + header.caplen;
   return true;
 }
 
@@ -144,5 +193,6 @@ bool vtkPacketFileWriter::WritePacket(const NetworkPacket& packet)
 bool vtkPacketFileWriter::WritePacket(pcap_pkthdr* packetHeader, const unsigned char* packetData)
 {
   pcap_dump((u_char*)this->PCAPDump, packetHeader, packetData);
+  this->BytesWritten += PcapRecordHeaderSize + packetHeader->caplen;
   return true;
 }
@@ -36,6 +36,8 @@
 #include "NetworkPacket.h"
 
 #include <pcap.h>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -59,12 +61,36 @@ public:
   bool WritePacket(const NetworkPacket& packet);
   bool WritePacket(pcap_pkthdr* packetHeader, const unsigned char* packetData);
 
+  // Write the buffered packets to the disk
+  bool Flush();
+
+  // Size of the write buffer of the files opened afterward, 0 for the default one.
+  // A large buffer turns the packets into a few large writes.
+  // Not supported on Windows, where the file is opened by pcap.
+  void SetBufferSize(size_t bytes) { this->BufferSize = bytes; }
+  size_t GetBufferSize() const { return this->BufferSize; }
+
+  // Disk space reserved for the files opened afterward, 0 to disable.
+  // The file size is not changed, only its blocks are allocated
+  // so that the recording does not fragment. Only supported on Linux,
+  // Open still succeeds if the reservation fails.
+  void SetPreallocationSize(uint64_t bytes) { this->PreallocationSize = bytes; }
+  uint64_t GetPreallocationSize() const { return this->PreallocationSize; }
+
+  // Size of the file written so far, including the pcap headers
+  uint64_t GetNumberOfBytesWritten() const { return this->BytesWritten; }
+
 protected:
   pcap_t* PCAPFile;
   pcap_dumper_t* PCAPDump;
 
   std::string FileName;
   std::string LastError;
+
+  size_t BufferSize = 0;
+  std::unique_ptr<char[]> Buffer;
+  uint64_t PreallocationSize = 0;
+  uint64_t BytesWritten = 0;
 };
 
 #endif
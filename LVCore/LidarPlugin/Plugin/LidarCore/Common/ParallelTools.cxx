@@ -0,0 +1,66 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+#include "ParallelTools.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace ParallelTools
+{
+//-----------------------------------------------------------------------------
+int GetNumberOfThreadsToUse(int numberOfThreads, vtkIdType numberOfItems, vtkIdType minItemsPerThread)
+{
+  if (numberOfThreads <= 0)
+  {
+    numberOfThreads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  const vtkIdType maxThreads = numberOfItems / std::max<vtkIdType>(1, minItemsPerThread) + 1;
+  return static_cast<int>(std::max<vtkIdType>(1, std::min<vtkIdType>(numberOfThreads, maxThreads)));
+}
+
+//-----------------------------------------------------------------------------
+void ParallelFor(vtkIdType size, vtkIdType grain, int numberOfThreads,
+  const std::function<void(vtkIdType, vtkIdType)>& function)
+{
+  grain = std::max<vtkIdType>(1, grain);
+  if (numberOfThreads <= 1 || size <= grain)
+  {
+    function(0, size);
+    return;
+  }
+
+  std::atomic<vtkIdType> next(0);
+  auto worker = [&]() {
+    for (vtkIdType begin = next.fetch_add(grain); begin < size; begin = next.fetch_add(grain))
+    {
+      function(begin, std::min(size, begin + grain));
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int i = 1; i < numberOfThreads; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+}
+}
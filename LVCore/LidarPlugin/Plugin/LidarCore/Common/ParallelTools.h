@@ -0,0 +1,45 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+#ifndef PARALLEL_TOOLS_H
+#define PARALLEL_TOOLS_H
+
+#include <functional>
+
+#include <vtkType.h>
+
+#include "LidarCoreModule.h"
+
+namespace ParallelTools
+{
+/**
+ * @brief GetNumberOfThreadsToUse number of threads to process numberOfItems items,
+ *        each thread handling at least minItemsPerThread items
+ * @param numberOfThreads the number of threads requested, 0 or less to use all the cores
+ */
+LIDARCORE_EXPORT int GetNumberOfThreadsToUse(int numberOfThreads, vtkIdType numberOfItems,
+  vtkIdType minItemsPerThread);
+
+/**
+ * @brief ParallelFor call function on the chunks [begin, end) of [0, size), of grain items at most.
+ *        The chunks are fetched by numberOfThreads threads, the calling one included,
+ *        so that the threads finishing first process the remaining chunks.
+ */
+LIDARCORE_EXPORT void ParallelFor(vtkIdType size, vtkIdType grain, int numberOfThreads,
+  const std::function<void(vtkIdType, vtkIdType)>& function);
+}
+
+#endif // PARALLEL_TOOLS_H
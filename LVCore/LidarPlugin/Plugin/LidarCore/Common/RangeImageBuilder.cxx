@@ -0,0 +1,338 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+#include "RangeImageBuilder.h"
+
+#include <vtkDataArray.h>
+#include <vtkMath.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace
+{
+//! Minimum number of points handled by each thread
+constexpr vtkIdType MinPointsPerThread = 4096;
+
+//-----------------------------------------------------------------------------
+template <typename TId>
+void MapStructured(RangeImageBuilder& builder, const TId* ids, vtkIdType numberOfPoints,
+  int numberOfLasers, const std::vector<int>& rowOfLaser)
+{
+  builder.MapPoints(numberOfPoints, [&](vtkIdType pointId) {
+    const double id = static_cast<double>(ids[pointId]);
+    // Also drops the NaN ids
+    if (!(id >= 0.))
+    {
+      return std::make_pair(-1, -1);
+    }
+    const vtkIdType structuredId = static_cast<vtkIdType>(id);
+    const int column = static_cast<int>(structuredId / numberOfLasers);
+    const int row = rowOfLaser[structuredId % numberOfLasers];
+    return std::make_pair(column, row);
+  });
+}
+
+//-----------------------------------------------------------------------------
+template <typename TAzimuth, typename TLaser>
+void MapSpherical(RangeImageBuilder& builder, const TAzimuth* azimuth, const TLaser* laserIds,
+  vtkIdType numberOfPoints, const std::vector<int>& rowOfLaser)
+{
+  const double numberOfLasers = static_cast<double>(rowOfLaser.size());
+  const double width = builder.GetWidth();
+  builder.MapPoints(numberOfPoints, [&](vtkIdType pointId) {
+    const double laser = static_cast<double>(laserIds[pointId]);
+    const double column = std::floor(static_cast<double>(azimuth[pointId]) / 36000.0 * width);
+    if (!(laser >= 0. && laser < numberOfLasers) || !(column >= 0. && column < width))
+    {
+      return std::make_pair(-1, -1);
+    }
+    return std::make_pair(static_cast<int>(column), rowOfLaser[static_cast<int>(laser)]);
+  });
+}
+
+//-----------------------------------------------------------------------------
+template <typename TAzimuth>
+void MapSpherical(RangeImageBuilder& builder, const TAzimuth* azimuth, vtkDataArray* laserIds,
+  const std::vector<int>& rowOfLaser)
+{
+  const vtkIdType numberOfPoints = laserIds->GetNumberOfTuples();
+  const int laserComponents = laserIds->GetNumberOfComponents();
+  switch (laserIds->GetDataType())
+  {
+    vtkTemplateMacro(
+      // Only the first component is used, as GetTuple1 would
+      std::vector<VTK_TT> firstComponent;
+      const VTK_TT* laserPointer = static_cast<const VTK_TT*>(laserIds->GetVoidPointer(0));
+      if (laserComponents != 1)
+      {
+        firstComponent.resize(numberOfPoints);
+        for (vtkIdType i = 0; i < numberOfPoints; ++i)
+        {
+          firstComponent[i] = laserPointer[i * laserComponents];
+        }
+        laserPointer = firstComponent.data();
+      }
+      MapSpherical(builder, azimuth, laserPointer, numberOfPoints, rowOfLaser));
+  }
+}
+
+//-----------------------------------------------------------------------------
+//! Value written in a channel for a point
+template <typename TIn>
+struct ValueOf
+{
+  const TIn* Values;
+  int Components;
+  double operator()(vtkIdType pointId) const
+  {
+    return static_cast<double>(this->Values[pointId * this->Components]);
+  }
+};
+
+template <typename TIn>
+struct RangeOf
+{
+  const TIn* Points;
+  double operator()(vtkIdType pointId) const
+  {
+    const TIn* p = this->Points + 3 * pointId;
+    const double x = p[0], y = p[1], z = p[2];
+    return std::sqrt(x * x + y * y + z * z);
+  }
+};
+
+template <typename TIn>
+struct ElevationOf
+{
+  const TIn* Points;
+  double operator()(vtkIdType pointId) const
+  {
+    const TIn* p = this->Points + 3 * pointId;
+    const double x = p[0], y = p[1], z = p[2];
+    return vtkMath::DegreesFromRadians(std::atan2(z, std::sqrt(x * x + y * y)));
+  }
+};
+
+//-----------------------------------------------------------------------------
+//! Fill the rows [firstRow, lastRow) of an image, the points being grouped by row
+template <typename TOut, typename Value>
+void FillRows(TOut* image, const Value& value, int width, vtkIdType firstRow, vtkIdType lastRow,
+  const vtkIdType* sortedPoints, const vtkIdType* rowStart, const vtkIdType* pointPixel)
+{
+  std::fill(image + firstRow * width, image + lastRow * width, TOut(0));
+  for (vtkIdType k = rowStart[firstRow]; k < rowStart[lastRow]; ++k)
+  {
+    const vtkIdType pointId = sortedPoints[k];
+    image[pointPixel[pointId]] = static_cast<TOut>(value(pointId));
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename Value>
+void FillRows(void* image, int imageType, const Value& value, int width, vtkIdType firstRow,
+  vtkIdType lastRow, const vtkIdType* sortedPoints, const vtkIdType* rowStart,
+  const vtkIdType* pointPixel)
+{
+  switch (imageType)
+  {
+    vtkTemplateMacro(FillRows(static_cast<VTK_TT*>(image), value, width, firstRow, lastRow,
+      sortedPoints, rowStart, pointPixel));
+  }
+}
+}
+
+//-----------------------------------------------------------------------------
+void RangeImageBuilder::SetDimensions(int width, int height)
+{
+  this->Width = std::max(0, width);
+  this->Height = std::max(0, height);
+  this->PointPixel.clear();
+}
+
+//-----------------------------------------------------------------------------
+int RangeImageBuilder::GetNumberOfThreadsToUse(vtkIdType numberOfItems) const
+{
+  return ParallelTools::GetNumberOfThreadsToUse(this->NumberOfThreads, numberOfItems, MinPointsPerThread);
+}
+
+//-----------------------------------------------------------------------------
+bool RangeImageBuilder::MapStructuredPoints(vtkDataArray* pointIds, int numberOfLasers,
+  const std::vector<int>& rowOfLaser)
+{
+  if (!pointIds || pointIds->GetNumberOfComponents() != 1 || numberOfLasers <= 0 ||
+    static_cast<int>(rowOfLaser.size()) != numberOfLasers)
+  {
+    return false;
+  }
+
+  switch (pointIds->GetDataType())
+  {
+    vtkTemplateMacro(MapStructured(*this, static_cast<const VTK_TT*>(pointIds->GetVoidPointer(0)),
+      pointIds->GetNumberOfTuples(), numberOfLasers, rowOfLaser));
+    default:
+      return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool RangeImageBuilder::MapSphericalPoints(vtkDataArray* azimuth, vtkDataArray* laserIds,
+  const std::vector<int>& rowOfLaser)
+{
+  if (!azimuth || !laserIds || azimuth->GetNumberOfComponents() != 1 ||
+    azimuth->GetNumberOfTuples() != laserIds->GetNumberOfTuples())
+  {
+    return false;
+  }
+
+  switch (azimuth->GetDataType())
+  {
+    vtkTemplateMacro(MapSpherical(*this, static_cast<const VTK_TT*>(azimuth->GetVoidPointer(0)),
+      laserIds, rowOfLaser));
+    default:
+      return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void RangeImageBuilder::AddValueChannel(vtkDataArray* values, vtkDataArray* image)
+{
+  this->Channels.push_back({ ChannelType::Value, values, image });
+}
+
+//-----------------------------------------------------------------------------
+void RangeImageBuilder::AddRangeChannel(vtkDataArray* points, vtkDataArray* image)
+{
+  this->Channels.push_back({ ChannelType::Range, points, image });
+}
+
+//-----------------------------------------------------------------------------
+void RangeImageBuilder::AddElevationChannel(vtkDataArray* points, vtkDataArray* image)
+{
+  this->Channels.push_back({ ChannelType::Elevation, points, image });
+}
+
+//-----------------------------------------------------------------------------
+void RangeImageBuilder::SortByRow()
+{
+  // Counting sort, stable so that the last point of a pixel is still written last
+  this->RowStart.assign(this->Height + 1, 0);
+  for (vtkIdType pixel : this->PointPixel)
+  {
+    if (pixel >= 0)
+    {
+      ++this->RowStart[pixel / this->Width + 1];
+    }
+  }
+  for (int row = 0; row < this->Height; ++row)
+  {
+    this->RowStart[row + 1] += this->RowStart[row];
+  }
+
+  this->SortedPoints.resize(this->RowStart[this->Height]);
+  std::vector<vtkIdType> cursor(this->RowStart.begin(), this->RowStart.end() - 1);
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(this->PointPixel.size());
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    const vtkIdType pixel = this->PointPixel[pointId];
+    if (pixel >= 0)
+    {
+      this->SortedPoints[cursor[pixel / this->Width]++] = pointId;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool RangeImageBuilder::Fill()
+{
+  const vtkIdType numberOfPixels = static_cast<vtkIdType>(this->Width) * this->Height;
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(this->PointPixel.size());
+  for (const Channel& channel : this->Channels)
+  {
+    const int sourceComponents = channel.Type == ChannelType::Value ? 1 : 3;
+    if (!channel.Image || channel.Image->GetNumberOfComponents() != 1 ||
+      channel.Image->GetNumberOfTuples() != numberOfPixels || !channel.Source ||
+      channel.Source->GetNumberOfTuples() != numberOfPoints ||
+      (channel.Type != ChannelType::Value &&
+        channel.Source->GetNumberOfComponents() != sourceComponents))
+    {
+      return false;
+    }
+  }
+  if (numberOfPixels == 0)
+  {
+    return true;
+  }
+
+  this->SortByRow();
+
+  // Enough rows per task to balance the threads, without one task per row
+  const int threads = this->GetNumberOfThreadsToUse(std::max(numberOfPoints, numberOfPixels));
+  const vtkIdType rowsPerTask = std::max<vtkIdType>(1, this->Height / (4 * threads));
+  const vtkIdType* sortedPoints = this->SortedPoints.data();
+  const vtkIdType* rowStart = this->RowStart.data();
+  const vtkIdType* pointPixel = this->PointPixel.data();
+  const int width = this->Width;
+
+  // The buffers are fetched here, GetVoidPointer may not be thread safe for all arrays
+  struct Buffers
+  {
+    ChannelType Type;
+    const void* Source;
+    int SourceType;
+    int SourceComponents;
+    void* Image;
+    int ImageType;
+  };
+  std::vector<Buffers> buffers;
+  for (const Channel& channel : this->Channels)
+  {
+    buffers.push_back({ channel.Type, channel.Source->GetVoidPointer(0),
+      channel.Source->GetDataType(), channel.Source->GetNumberOfComponents(),
+      channel.Image->GetVoidPointer(0), channel.Image->GetDataType() });
+  }
+
+  ParallelTools::ParallelFor(this->Height, rowsPerTask, threads, [&](vtkIdType firstRow, vtkIdType lastRow) {
+    for (const Buffers& channel : buffers)
+    {
+      switch (channel.SourceType)
+      {
+        vtkTemplateMacro(
+          const VTK_TT* source = static_cast<const VTK_TT*>(channel.Source);
+          if (channel.Type == ChannelType::Value)
+          {
+            FillRows(channel.Image, channel.ImageType,
+              ValueOf<VTK_TT>{ source, channel.SourceComponents }, width, firstRow, lastRow,
+              sortedPoints, rowStart, pointPixel);
+          }
+          else if (channel.Type == ChannelType::Range)
+          {
+            FillRows(channel.Image, channel.ImageType, RangeOf<VTK_TT>{ source }, width,
+              firstRow, lastRow, sortedPoints, rowStart, pointPixel);
+          }
+          else
+          {
+            FillRows(channel.Image, channel.ImageType, ElevationOf<VTK_TT>{ source }, width,
+              firstRow, lastRow, sortedPoints, rowStart, pointPixel);
+          });
+      }
+    }
+  });
+  return true;
+}
@@ -0,0 +1,144 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+#ifndef RANGE_IMAGE_BUILDER_H
+#define RANGE_IMAGE_BUILDER_H
+
+#include <vector>
+
+#include <vtkType.h>
+
+#include "LidarCoreModule.h"
+#include "ParallelTools.h"
+
+class vtkDataArray;
+
+/**
+ * @brief Rasterize a point cloud into one or several images of the same size,
+ *        writing the image buffers directly.
+ *
+ * The pixel of each point is first computed, in parallel, by one of the Map
+ * functions. Fill then writes all the channels in a single pass: the points are
+ * grouped by image row (counting sort, O(N)) and each thread fills its own rows.
+ *
+ * Pixels are stored row by row (pixel = column + row * width), as in vtkImageData.
+ * Pixels without any point are set to 0. When several points fall in the same
+ * pixel, the last one is kept, as when the points are written one by one.
+ */
+class LIDARCORE_EXPORT RangeImageBuilder
+{
+public:
+  //! Number of threads used, 0 to use all the cores
+  void SetNumberOfThreads(int value) { this->NumberOfThreads = value; }
+
+  //! Size of the images, this invalidates the mapped points
+  void SetDimensions(int width, int height);
+  int GetWidth() const { return this->Width; }
+  int GetHeight() const { return this->Height; }
+
+  /**
+   * @brief MapPoints compute the pixel of each point, in parallel
+   * @param pixelOfPoint function returning the column and row of a point
+   *        as std::pair<int, int>, points out of the image are dropped
+   */
+  template <typename F>
+  void MapPoints(vtkIdType numberOfPoints, F pixelOfPoint);
+
+  /**
+   * @brief MapStructuredPoints map the points of a sensor giving a structured index
+   *        to each point: column = id / numberOfLasers, row = rowOfLaser[id % numberOfLasers]
+   * @return false if the arguments are not consistent
+   */
+  bool MapStructuredPoints(vtkDataArray* pointIds, int numberOfLasers,
+    const std::vector<int>& rowOfLaser);
+
+  /**
+   * @brief MapSphericalPoints map the points on a cylinder: the azimuth angle
+   *        (in hundredth of degrees) gives the column, the laser the row.
+   * @return false if the arguments are not consistent
+   */
+  bool MapSphericalPoints(vtkDataArray* azimuth, vtkDataArray* laserIds,
+    const std::vector<int>& rowOfLaser);
+
+  //! Remove all the channels
+  void ClearChannels() { this->Channels.clear(); }
+
+  //! Fill image with the first component of values
+  void AddValueChannel(vtkDataArray* values, vtkDataArray* image);
+  //! Fill image with the distance of the points to the origin
+  void AddRangeChannel(vtkDataArray* points, vtkDataArray* image);
+  //! Fill image with the elevation angle of the points, in degrees
+  void AddElevationChannel(vtkDataArray* points, vtkDataArray* image);
+
+  /**
+   * @brief Fill write all the channels, for the points mapped by the last Map call.
+   *        The images must have width * height tuples of one component.
+   * @return false if an image or a values array does not have the expected size
+   */
+  bool Fill();
+
+private:
+  enum class ChannelType
+  {
+    Value,
+    Range,
+    Elevation
+  };
+
+  struct Channel
+  {
+    ChannelType Type;
+    vtkDataArray* Source;
+    vtkDataArray* Image;
+  };
+
+  int GetNumberOfThreadsToUse(vtkIdType numberOfItems) const;
+  //! Group the mapped points by row, keeping their order
+  void SortByRow();
+
+  int NumberOfThreads = 0;
+  int Width = 0;
+  int Height = 0;
+  std::vector<Channel> Channels;
+
+  // Buffers kept between the calls, to avoid reallocating them for each frame
+  std::vector<vtkIdType> PointPixel; /*!< pixel of each point, -1 if dropped */
+  std::vector<vtkIdType> RowStart;   /*!< first point of each row in SortedPoints */
+  std::vector<vtkIdType> SortedPoints;
+};
+
+//-----------------------------------------------------------------------------
+template <typename F>
+void RangeImageBuilder::MapPoints(vtkIdType numberOfPoints, F pixelOfPoint)
+{
+  this->PointPixel.resize(numberOfPoints);
+  const int width = this->Width;
+  const int height = this->Height;
+  const int threads = this->GetNumberOfThreadsToUse(numberOfPoints);
+  ParallelTools::ParallelFor(numberOfPoints, 1024, threads, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType pointId = begin; pointId < end; ++pointId)
+    {
+      const auto pixel = pixelOfPoint(pointId);
+      const bool inside = pixel.first >= 0 && pixel.first < width &&
+        pixel.second >= 0 && pixel.second < height;
+      this->PointPixel[pointId] = inside
+        ? pixel.first + static_cast<vtkIdType>(pixel.second) * width
+        : -1;
+    }
+  });
+}
+
+#endif // RANGE_IMAGE_BUILDER_H
@@ -21,90 +21,111 @@
 #include "vtkPatch/vtkCustomQuaternionInterpolator.h"
 #include "vtkTransform.h"
 #include "vtkPatch/vtkCustomTupleInterpolator.h"
-#include <list>
-#include <vector>
-#include <set>
 #include <algorithm>
-#include <iterator>
+#include <cmath>
+#include <vector>
 
 vtkStandardNewMacro(vtkCustomTransformInterpolator);
 
-// PIMPL STL encapsulation for list of transforms, and list of
-// quaternions. This just keeps track of all the data the user specifies,
-// which is later dumped into the interpolators.
-struct vtkQTransform
+namespace
 {
-  double Time;
-  double P[3];
-  double S[3];
-  vtkQuaterniond Q;
-
-  vtkQTransform()
+//----------------------------------------------------------------------------
+// Position, scale and unit quaternion (with a positive w) of a transform
+void DecomposeTransform(vtkTransform* xform, double P[3], double S[3], vtkQuaterniond& Q)
+{
+  if (!xform)
   {
-    this->Time = 0.0;
-    this->P[0] = this->P[1] = this->P[2] = 0.0;
-    this->S[0] = this->S[1] = this->S[2] = 0.0;
+    P[0] = P[1] = P[2] = 0.0;
+    S[0] = S[1] = S[2] = 0.0;
+    Q.ToIdentity();
+    return;
   }
-  vtkQTransform(double t, vtkTransform* xform)
+  xform->GetPosition(P);
+  xform->GetScale(S);
+  double q[4];
+  xform->GetOrientationWXYZ(q); // Rotation (in degrees) around unit vector
+  q[0] = vtkMath::RadiansFromDegrees(q[0]);
+  Q.SetRotationAngleAndAxis(q[0], q + 1);
+  if (Q.GetW() < 0.0)
   {
-    this->Time = t;
-    if (xform)
-    {
-      xform->GetPosition(this->P);
-      xform->GetScale(this->S);
-      double q[4];
-      xform->GetOrientationWXYZ(q); // Rotation (in degrees) around unit vector
-      q[0] = vtkMath::RadiansFromDegrees(q[0]);
-      this->Q.SetRotationAngleAndAxis(q[0], q + 1);
-
-      if (this->Q.GetW() < 0.0)
-      {
-        this->Q = this->Q * -1;
-      }
-    }
-    else
-    {
-      this->P[0] = this->P[1] = this->P[2] = 0.0;
-      this->S[0] = this->S[1] = this->S[2] = 0.0;
-    }
+    Q = Q * -1;
   }
-};
+}
 
-class vtkQTransformComparator
+//----------------------------------------------------------------------------
+// Row major 4x4 matrix of the transform Translate(P) * Rotate(Q) * Scale(S)
+void ComposeMatrix(const double P[3], const double S[3], const vtkQuaterniond& Q, double M[16])
 {
-public:
-  bool operator () ( const vtkQTransform& transform1,
-                     const vtkQTransform& transform2 )
+  double R[3][3];
+  Q.Normalized().ToMatrix3x3(R);
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
     {
-      return transform1.Time < transform2.Time;
+      M[4 * i + j] = R[i][j] * S[j];
     }
-};
+    M[4 * i + 3] = P[i];
+  }
+  M[12] = M[13] = M[14] = 0.0;
+  M[15] = 1.0;
+}
 
-// The list is arranged in increasing order in T
-class vtkTransformList : public std::list<vtkQTransform>
+//----------------------------------------------------------------------------
+// Cubic Hermite curve with Catmull-Rom tangents (Kochanek spline with null
+// tension, bias and continuity) through the poses i - 1 .. i + 2, at T in [0, 1]
+double CatmullRom(const double* values, int stride, size_t i, size_t nb, double T)
 {
-};
-typedef vtkTransformList::iterator TransformListIterator;
+  const double p1 = values[i * stride];
+  const double p2 = values[(i + 1) * stride];
+  const double p0 = i > 0 ? values[(i - 1) * stride] : p1;
+  const double p3 = i + 2 < nb ? values[(i + 2) * stride] : p2;
+  const double m1 = i > 0 ? 0.5 * (p2 - p0) : p2 - p1;
+  const double m2 = i + 2 < nb ? 0.5 * (p3 - p1) : p2 - p1;
+  const double T2 = T * T;
+  const double T3 = T2 * T;
+  return (2 * T3 - 3 * T2 + 1) * p1 + (T3 - 2 * T2 + T) * m1
+    + (-2 * T3 + 3 * T2) * p2 + (T3 - T2) * m2;
+}
+}
 
 //----------------------------------------------------------------------------
-std::vector<std::vector<double> > vtkCustomTransformInterpolator::GetTransformList()
+vtkQuaterniond vtkCustomTransformInterpolator::GetOrientation(size_t n) const
 {
-  this->InitializeInterpolation();
+  return vtkQuaterniond(this->Orientations[4 * n], this->Orientations[4 * n + 1],
+    this->Orientations[4 * n + 2], this->Orientations[4 * n + 3]);
+}
 
+//----------------------------------------------------------------------------
+void vtkCustomTransformInterpolator::SetPose(size_t n, double t, vtkTransform* xform)
+{
+  double P[3], S[3];
+  vtkQuaterniond Q;
+  DecomposeTransform(xform, P, S, Q);
+  this->Times[n] = t;
+  std::copy(P, P + 3, this->Positions.begin() + 3 * n);
+  std::copy(S, S + 3, this->Scales.begin() + 3 * n);
+  for (int k = 0; k < 4; ++k)
+  {
+    this->Orientations[4 * n + k] = Q[k];
+  }
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::vector<double> > vtkCustomTransformInterpolator::GetTransformList()
+{
   std::vector<std::vector<double> > transforms;
-  // Okay, insert in sorted order
-  for (TransformListIterator iter = this->TransformList->begin(); iter != this->TransformList->end(); ++iter)
+  for (size_t n = 0; n < this->Times.size(); ++n)
   {
     std::vector<double> currentTransform(7, 0);
     // time
-    currentTransform[0] = iter->Time;
+    currentTransform[0] = this->Times[n];
     // position
-    currentTransform[4] = iter->P[0];
-    currentTransform[5] = iter->P[1];
-    currentTransform[6] = iter->P[2];
+    currentTransform[4] = this->Positions[3 * n];
+    currentTransform[5] = this->Positions[3 * n + 1];
+    currentTransform[6] = this->Positions[3 * n + 2];
     // orientation
     double A[3][3];
-    iter->Q.ToMatrix3x3(A);
+    this->GetOrientation(n).ToMatrix3x3(A);
     currentTransform[1] = std::atan2(A[2][1], A[2][2]);
     currentTransform[2] = -std::asin(A[2][0]);
     currentTransform[3] = std::atan2(A[1][0], A[0][0]);
@@ -121,21 +142,17 @@ vtkCustomTransformInterpolator::vtkCustomTransformInterpolator()
   // Set up the interpolation
   this->InterpolationType = INTERPOLATION_TYPE_SPLINE;
 
-  // Spline interpolation
+  // Interpolators of the manual mode
   this->PositionInterpolator = vtkCustomTupleInterpolator::New();
   this->ScaleInterpolator = vtkCustomTupleInterpolator::New();
   this->RotationInterpolator = vtkCustomQuaternionInterpolator::New();
 
-  // Quaternion interpolation
-  this->TransformList = new vtkTransformList;
   this->Initialized = 0;
 }
 
 //----------------------------------------------------------------------------
 vtkCustomTransformInterpolator::~vtkCustomTransformInterpolator()
 {
-  delete this->TransformList;
-
   if (this->PositionInterpolator)
   {
     this->PositionInterpolator->Delete();
@@ -178,7 +195,7 @@ vtkMTimeType vtkCustomTransformInterpolator::GetMTime()
 //----------------------------------------------------------------------------
 int vtkCustomTransformInterpolator::GetNumberOfTransforms()
 {
-  return static_cast<int>(this->TransformList->size());
+  return static_cast<int>(this->Times.size());
 }
 
 //----------------------------------------------------------------------------
@@ -186,52 +203,45 @@ void vtkCustomTransformInterpolator::GetSample(int n,
                                               vtkTransform *xform,
                                               double& xformTime)
 {
-  if (this->TransformList->empty())
-  {
-    return;
-  }
-
-  this->InitializeInterpolation();
-
-  if (n < 0 || n >= static_cast<int>(this->TransformVector.size()))
+  if (n < 0 || n >= static_cast<int>(this->Times.size()))
   {
     return;
   }
 
   // Get the transform
   xform->Identity();
-  xform->Translate(this->TransformVector[n].P);
+  xform->Translate(&this->Positions[3 * n]);
   double Q[4];
-  Q[0] = vtkMath::DegreesFromRadians(this->TransformVector[n].Q.GetRotationAngleAndAxis(Q+1));
+  Q[0] = vtkMath::DegreesFromRadians(this->GetOrientation(n).GetRotationAngleAndAxis(Q+1));
   xform->RotateWXYZ(Q[0],Q+1);
-  xform->Scale(this->TransformVector[n].S);
+  xform->Scale(&this->Scales[3 * n]);
 
-  xformTime = this->TransformVector[n].Time;
+  xformTime = this->Times[n];
 }
 
 //----------------------------------------------------------------------------
 double vtkCustomTransformInterpolator::GetMinimumT()
 {
-  if (this->TransformList->empty())
+  if (this->Times.empty())
   {
     return -VTK_FLOAT_MAX;
   }
   else
   {
-    return this->TransformList->front().Time;
+    return this->Times.front();
   }
 }
 
 //----------------------------------------------------------------------------
 double vtkCustomTransformInterpolator::GetMaximumT()
 {
-  if (this->TransformList->empty())
+  if (this->Times.empty())
   {
     return VTK_FLOAT_MAX;
   }
   else
   {
-    return this->TransformList->back().Time;
+    return this->Times.back();
   }
 }
 
@@ -244,45 +254,39 @@ double vtkCustomTransformInterpolator::GetPeriod()
 //----------------------------------------------------------------------------
 void vtkCustomTransformInterpolator::Initialize()
 {
-  this->TransformList->clear();
+  this->Times.clear();
+  this->Positions.clear();
+  this->Scales.clear();
+  this->Orientations.clear();
+  this->Cursor = 0;
+  this->Modified();
 }
 
 //----------------------------------------------------------------------------
 void vtkCustomTransformInterpolator::AddTransform(double t, vtkTransform* xform)
 {
-  int size = static_cast<int>(this->TransformList->size());
-
-  // Check special cases: t at beginning or end of list
-  if (size <= 0 || t < this->TransformList->front().Time)
-  {
-    this->TransformList->push_front(vtkQTransform(t, xform));
-    return;
-  }
-  else if (t > this->TransformList->back().Time)
+  // Transforms usually come in increasing time order: append them
+  size_t n = this->Times.size();
+  if (n == 0 || t > this->Times.back())
   {
-    this->TransformList->push_back(vtkQTransform(t, xform));
-    return;
+    this->Times.push_back(t);
+    this->Positions.resize(3 * (n + 1));
+    this->Scales.resize(3 * (n + 1));
+    this->Orientations.resize(4 * (n + 1));
   }
-  else if (size == 1 && t == this->TransformList->back().Time)
-  {
-    this->TransformList->front() = vtkQTransform(t, xform);
-    return;
-  }
-
-  // Okay, insert in sorted order
-  TransformListIterator iter = this->TransformList->begin();
-  TransformListIterator nextIter = ++(this->TransformList->begin());
-  for (int i = 0; i < (size - 1); i++, ++iter, ++nextIter)
+  else
   {
-    if (t == iter->Time)
-    {
-      (*iter) = vtkQTransform(t, xform);
-    }
-    else if (t > iter->Time && t < nextIter->Time)
+    // Replace the transform at t, or insert it in sorted order
+    n = std::lower_bound(this->Times.begin(), this->Times.end(), t) - this->Times.begin();
+    if (this->Times[n] != t)
     {
-      this->TransformList->insert(nextIter, vtkQTransform(t, xform));
+      this->Times.insert(this->Times.begin() + n, t);
+      this->Positions.insert(this->Positions.begin() + 3 * n, 3, 0.0);
+      this->Scales.insert(this->Scales.begin() + 3 * n, 3, 0.0);
+      this->Orientations.insert(this->Orientations.begin() + 4 * n, 4, 0.0);
     }
   }
+  this->SetPose(n, t, xform);
 
   this->Modified();
 }
@@ -305,19 +309,20 @@ void vtkCustomTransformInterpolator::AddTransform(double t, vtkProp3D* prop3D)
 //----------------------------------------------------------------------------
 void vtkCustomTransformInterpolator::RemoveTransform(double t)
 {
-  if (t < this->TransformList->front().Time || t > this->TransformList->back().Time)
+  auto iter = std::lower_bound(this->Times.begin(), this->Times.end(), t);
+  if (iter == this->Times.end() || *iter != t)
   {
     return;
   }
 
-  TransformListIterator iter = this->TransformList->begin();
-  for (; iter->Time != t && iter != this->TransformList->end(); ++iter)
-  {
-  }
-  if (iter != this->TransformList->end())
-  {
-    this->TransformList->erase(iter);
-  }
+  const size_t n = iter - this->Times.begin();
+  this->Times.erase(iter);
+  this->Positions.erase(this->Positions.begin() + 3 * n, this->Positions.begin() + 3 * (n + 1));
+  this->Scales.erase(this->Scales.begin() + 3 * n, this->Scales.begin() + 3 * (n + 1));
+  this->Orientations.erase(this->Orientations.begin() + 4 * n,
+                           this->Orientations.begin() + 4 * (n + 1));
+  this->Cursor = 0;
+  this->Modified();
 }
 
 //----------------------------------------------------------------------------
@@ -377,7 +382,7 @@ void vtkCustomTransformInterpolator::SetRotationInterpolator(vtkCustomQuaternion
 //----------------------------------------------------------------------------
 void vtkCustomTransformInterpolator::InitializeInterpolation()
 {
-  if (this->TransformList->empty())
+  if (this->Times.empty())
   {
     return;
   }
@@ -398,32 +403,6 @@ void vtkCustomTransformInterpolator::InitializeInterpolation()
       this->RotationInterpolator = vtkCustomQuaternionInterpolator::New();
     }
 
-    if (this->InterpolationType == INTERPOLATION_TYPE_LINEAR
-             || this->InterpolationType == INTERPOLATION_TYPE_NEAREST
-             || this->InterpolationType == INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED)
-    {
-      this->PositionInterpolator->SetInterpolationTypeToLinear();
-      this->ScaleInterpolator->SetInterpolationTypeToLinear();
-      this->RotationInterpolator->SetInterpolationTypeToLinear();
-      this->TransformVector.clear();
-      this->TransformVector.resize(0);
-      std::list<vtkQTransform>::iterator transform;
-      for (transform = this->TransformList->begin(); transform != this->TransformList->end(); ++transform)
-      {
-        this->TransformVector.push_back(*transform);
-      }
-    }
-    else if (this->InterpolationType == INTERPOLATION_TYPE_SPLINE)
-    {
-      this->PositionInterpolator->SetInterpolationTypeToSpline();
-      this->ScaleInterpolator->SetInterpolationTypeToSpline();
-      this->RotationInterpolator->SetInterpolationTypeToSpline();
-    }
-    else
-    {
-      ; // manual override, user manipulates interpolators directly
-    }
-
     this->PositionInterpolator->Initialize();
     this->ScaleInterpolator->Initialize();
     this->RotationInterpolator->Initialize();
@@ -432,47 +411,28 @@ void vtkCustomTransformInterpolator::InitializeInterpolation()
     this->ScaleInterpolator->SetNumberOfComponents(3);
 
     // Okay, now we can load the interpolators with data
-    // Initialize the data pointers
-    int nb = this->TransformList->size();
-    double *time = new double[nb];
-    double **Position = new double*[3];
-    double **Scale = new double*[3];
+    const size_t nb = this->Times.size();
+    std::vector<double> Position[3], Scale[3];
     for (int k = 0; k < 3; ++k)
     {
-      Position[k] = new double[nb];
-      Scale[k] = new double[nb];
+      Position[k].resize(nb);
+      Scale[k].resize(nb);
     }
-
-    // Fill the data pointers
-    TransformListIterator iter = this->TransformList->begin();
-    int count = 0;
-    for ( ; iter != this->TransformList->end(); ++iter)
+    for (size_t n = 0; n < nb; ++n)
     {
-      /*this->PositionInterpolator->AddTuple(iter->Time,iter->P);
-      this->ScaleInterpolator->AddTuple(iter->Time,iter->S);*/
-      Position[0][count] = iter->P[0];
-      Position[1][count] = iter->P[1];
-      Position[2][count] = iter->P[2];
-      Scale[0][count] = iter->S[0];
-      Scale[1][count] = iter->S[1];
-      Scale[2][count] = iter->S[2];
-      time[count] = iter->Time;
-      this->RotationInterpolator->AddQuaternion(iter->Time,iter->Q);
-      count++;
+      for (int k = 0; k < 3; ++k)
+      {
+        Position[k][n] = this->Positions[3 * n + k];
+        Scale[k][n] = this->Scales[3 * n + k];
+      }
+      this->RotationInterpolator->AddQuaternion(this->Times[n], this->GetOrientation(n));
     }
 
     // Fill the interpolators
-    this->PositionInterpolator->FillFromData(nb, time, Position);
-    this->ScaleInterpolator->FillFromData(nb, time, Scale);
-
-    for (int k = 0; k < 3; ++k)
-    {
-      delete [] Position[k];
-      delete [] Scale[k];
-    }
-
-    delete [] Position;
-    delete [] Scale;
+    double* PositionData[3] = { Position[0].data(), Position[1].data(), Position[2].data() };
+    double* ScaleData[3] = { Scale[0].data(), Scale[1].data(), Scale[2].data() };
+    this->PositionInterpolator->FillFromData(static_cast<int>(nb), this->Times.data(), PositionData);
+    this->ScaleInterpolator->FillFromData(static_cast<int>(nb), this->Times.data(), ScaleData);
 
     this->Initialized = 1;
     this->InitializeTime.Modified();
@@ -480,107 +440,164 @@ void vtkCustomTransformInterpolator::InitializeInterpolation()
 }
 
 //----------------------------------------------------------------------------
-void vtkCustomTransformInterpolator::InterpolateTransform(double t, vtkTransform* xform)
+size_t vtkCustomTransformInterpolator::FindInterval(double t)
 {
-  if (this->TransformList->empty())
+  const size_t last = this->Times.size() - 2;
+  // Successive queries are usually close in time, try around the previous one first
+  size_t i = std::min(this->Cursor, last);
+  if (this->Times[i] <= t)
   {
+    if (t <= this->Times[i + 1])
+    {
+      return this->Cursor = i;
+    }
+    if (i < last && t <= this->Times[i + 2])
+    {
+      return this->Cursor = i + 1;
+    }
+  }
+
+  // Index of the first time greater than t, minus one
+  i = std::upper_bound(this->Times.begin(), this->Times.end(), t) - this->Times.begin();
+  i = i > 0 ? i - 1 : 0;
+  return this->Cursor = std::min(i, last);
+}
+
+//----------------------------------------------------------------------------
+void vtkCustomTransformInterpolator::InterpolatePose(double t, double P[3], double S[3],
+                                                     vtkQuaterniond& Q)
+{
+  const size_t nb = this->Times.size();
+  t = std::max(this->Times.front(), std::min(t, this->Times.back()));
+
+  if (nb == 1)
+  {
+    std::copy(&this->Positions[0], &this->Positions[0] + 3, P);
+    std::copy(&this->Scales[0], &this->Scales[0] + 3, S);
+    Q = this->GetOrientation(0);
     return;
   }
 
+  const size_t i = this->FindInterval(t);
   if (this->InterpolationType == INTERPOLATION_TYPE_NEAREST
       || this->InterpolationType == INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED)
   {
-    this->InterpolateTransformNearest(t, xform);
+    // First transform not before t
+    size_t n = this->Times[i] == t ? i : i + 1;
+    if (this->InterpolationType == INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED)
+    {
+      // Take the previous transform to have a low bounded nearest interpolator
+      n = n > 0 ? n - 1 : n;
+    }
+    else if (n > 0 && t - this->Times[n - 1] <= this->Times[n] - t)
+    {
+      // Keep the closest in time to t
+      --n;
+    }
+    std::copy(&this->Positions[3 * n], &this->Positions[3 * n] + 3, P);
+    std::copy(&this->Scales[3 * n], &this->Scales[3 * n] + 3, S);
+    Q = this->GetOrientation(n);
     return;
   }
 
-  // Make sure the xform and this class are initialized properly
-  xform->Identity();
-  this->InitializeInterpolation();
-
-  // Evaluate the interpolators
-  if (t < this->TransformList->front().Time)
+  const double T = (t - this->Times[i]) / (this->Times[i + 1] - this->Times[i]);
+  const vtkQuaterniond q1 = this->GetOrientation(i);
+  const vtkQuaterniond q2 = this->GetOrientation(i + 1);
+  if (this->InterpolationType == INTERPOLATION_TYPE_SPLINE && nb > 2)
   {
-    t = this->TransformList->front().Time;
-  }
+    for (int k = 0; k < 3; ++k)
+    {
+      P[k] = CatmullRom(&this->Positions[k], 3, i, nb, T);
+      S[k] = CatmullRom(&this->Scales[k], 3, i, nb, T);
+    }
 
-  else if (t > this->TransformList->back().Time)
+    // Squad interpolation, duplicating the first and last quaternions
+    const vtkQuaterniond ai = i > 0 ? this->GetOrientation(i - 1).InnerPoint(q1, q2) : q1;
+    const vtkQuaterniond bi = i + 2 < nb ? q1.InnerPoint(q2, this->GetOrientation(i + 2)) : q2;
+    const vtkQuaterniond qc = q1.Slerp(T, q2);
+    const vtkQuaterniond qd = ai.Slerp(T, bi);
+    Q = qc.Slerp(2.0 * T * (1.0 - T), qd).Normalized();
+  }
+  else
   {
-    t = this->TransformList->back().Time;
+    for (int k = 0; k < 3; ++k)
+    {
+      P[k] = (1 - T) * this->Positions[3 * i + k] + T * this->Positions[3 * (i + 1) + k];
+      S[k] = (1 - T) * this->Scales[3 * i + k] + T * this->Scales[3 * (i + 1) + k];
+    }
+    Q = q1.Slerp(T, q2);
   }
-
-  double P[3], S[3], Q[4];
-  vtkQuaterniond q;
-  this->PositionInterpolator->InterpolateTupleDichotomic(t, P);
-  this->ScaleInterpolator->InterpolateTupleDichotomic(t, S);
-  this->RotationInterpolator->InterpolateQuaternion(t, q);
-  Q[0] = vtkMath::DegreesFromRadians(q.GetRotationAngleAndAxis(Q + 1));
-
-  xform->Translate(P);
-  xform->RotateWXYZ(Q[0], Q + 1);
-  xform->Scale(S);
 }
 
 //----------------------------------------------------------------------------
-void vtkCustomTransformInterpolator::InterpolateTransformNearest(double t,
-                                                    vtkTransform *xform)
+void vtkCustomTransformInterpolator::InterpolateTransform(double t, vtkTransform* xform)
 {
-  if (this->TransformList->empty())
+  if (this->Times.empty())
   {
     return;
   }
 
-  // Make sure the xform and this class are initialized properly
+  // Make sure the xform is initialized properly
   xform->Identity();
-  this->InitializeInterpolation();
 
-  if (this->TransformVector.size() < 2)
+  if (this->InterpolationType == INTERPOLATION_TYPE_MANUAL)
   {
+    // The interpolators are configured by the user
+    this->InitializeInterpolation();
+    t = std::max(this->Times.front(), std::min(t, this->Times.back()));
+
+    double P[3], S[3], Q[4];
+    vtkQuaterniond q;
+    this->PositionInterpolator->InterpolateTupleDichotomic(t, P);
+    this->ScaleInterpolator->InterpolateTupleDichotomic(t, S);
+    this->RotationInterpolator->InterpolateQuaternion(t, q);
+    Q[0] = vtkMath::DegreesFromRadians(q.GetRotationAngleAndAxis(Q + 1));
+
+    xform->Translate(P);
+    xform->RotateWXYZ(Q[0], Q + 1);
+    xform->Scale(S);
     return;
   }
 
-  // vtkQTransform order relation based on the Time
-  vtkQTransformComparator comparatorTimeTransform;
-
-  // Get the low bound to procees to a nearest
-  // low bounded interpolator
-  vtkQTransform transform;
-  transform.Time = t;
-  std::vector<vtkQTransform>::iterator lowerBound;
-  lowerBound = std::lower_bound(this->TransformVector.begin(), this->TransformVector.end(), transform, comparatorTimeTransform);
+  double P[3], S[3], M[16];
+  vtkQuaterniond q;
+  this->InterpolatePose(t, P, S, q);
+  ComposeMatrix(P, S, q, M);
+  xform->SetMatrix(M);
+}
 
-  if (this->InterpolationType == INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED)
+//----------------------------------------------------------------------------
+void vtkCustomTransformInterpolator::InterpolateMany(vtkIdType n, const double* times,
+                                                     double* matrices)
+{
+  if (this->Times.empty())
   {
-    // Are we before the first node? If not take the
-    // previous transform to have a low bounded nearest
-    // interpolator.
-    if (!(lowerBound == this->TransformVector.begin()))
+    for (vtkIdType k = 0; k < n; ++k)
     {
-      lowerBound--;
+      vtkMatrix4x4::Identity(matrices + 16 * k);
     }
+    return;
   }
-  else // i.e. this->InterpolationType == INTERPOLATION_TYPE_NEAREST
-  {
-    // Unless the lowerBound is the first one, we have to compare it with
-    // its predecessor to keep the closest in time to t.
 
-    // Because t has already been clamped,
-    // lowerBound->Time - t should be positive
-    // but adding std::abs makes the code more robust.
-    if (lowerBound != this->TransformVector.begin() &&
-        t - (lowerBound - 1)->Time <= std::abs(lowerBound->Time - t))
+  if (this->InterpolationType == INTERPOLATION_TYPE_MANUAL)
+  {
+    vtkTransform* xform = vtkTransform::New();
+    for (vtkIdType k = 0; k < n; ++k)
     {
-      lowerBound--;
+      this->InterpolateTransform(times[k], xform);
+      vtkMatrix4x4::DeepCopy(matrices + 16 * k, xform->GetMatrix());
     }
+    xform->Delete();
+    return;
   }
 
-  // Get the transform
-  xform->Identity();
-  xform->Translate(lowerBound->P);
-  double Q[4];
-  Q[0] = vtkMath::DegreesFromRadians(lowerBound->Q.GetRotationAngleAndAxis(Q+1));
-  xform->RotateWXYZ(Q[0],Q+1);
-  xform->Scale(lowerBound->S);
+  double P[3], S[3];
+  vtkQuaterniond q;
+  for (vtkIdType k = 0; k < n; ++k)
+  {
+    this->InterpolatePose(times[k], P, S, q);
+    ComposeMatrix(P, S, q, matrices + 16 * k);
+  }
 }
 
 //----------------------------------------------------------------------------
@@ -36,18 +36,23 @@
 // modified to perform linear versus spline interpolation, and/or different
 // spline basis functions can be specified.
 //
+// The transforms are stored in time order in flat arrays (time, position,
+// scale and quaternion), which are directly interpolated in the linear, spline
+// and nearest modes. The interval of the previous query is tried first, so that
+// queries with increasing times, the usual case, do not need any search.
+//
 // .SECTION Caveats
-// The interpolator classes are initialized when the InterpolateTransform()
-// is called. Any changes to the interpolators, or additions to the list of
-// transforms to be interpolated, causes a reinitialization of the
-// interpolators the next time InterpolateTransform() is invoked. Thus the
-// best performance is obtained by 1) configuring the interpolators, 2) adding
-// all the transforms, and 3) finally performing interpolation.
+// The separate interpolators are only used in the manual mode. They are
+// initialized when InterpolateTransform() is called. Any changes to the
+// interpolators, or additions to the list of transforms to be interpolated,
+// causes a reinitialization of the interpolators the next time
+// InterpolateTransform() is invoked.
 
 #ifndef __vtkCustomTransformInterpolator_h
 #define __vtkCustomTransformInterpolator_h
 
 #include <vtkObject.h>
+#include <vtkQuaternion.h>
 #include <vector>
 
 #include "LidarCoreModule.h"
@@ -57,8 +62,6 @@ class vtkMatrix4x4;
 class vtkProp3D;
 class vtkCustomTupleInterpolator;
 class vtkCustomQuaternionInterpolator;
-class vtkTransformList;
-struct vtkQTransform;
 
 class LIDARCORE_EXPORT vtkCustomTransformInterpolator : public vtkObject
 {
@@ -112,6 +115,12 @@ public:
   // (min,max) values, then t is clamped.
   void InterpolateTransform(double t, vtkTransform* xform);
 
+  // Description:
+  // Interpolate the transforms at n times, and write their 4x4 matrices
+  // (row major, 16 doubles each) to matrices. This avoids creating a
+  // vtkTransform per time, and is fastest when the times are increasing.
+  void InterpolateMany(vtkIdType n, const double* times, double* matrices);
+
   // Description:
   // Return the transform list
   std::vector<std::vector<double> > GetTransformList();
@@ -180,7 +189,13 @@ protected:
 
   // Control the interpolation type
   int InterpolationType;
-  void InterpolateTransformNearest(double t, vtkTransform *xform);
+
+  // Interpolate the stored transforms at t (clamped), except in manual mode
+  void InterpolatePose(double t, double P[3], double S[3], vtkQuaterniond& Q);
+
+  // Index i of the interval [Times[i], Times[i+1]] containing t, which
+  // must be in the time range. Needs at least two transforms.
+  size_t FindInterval(double t);
 
   // Interpolators
   vtkCustomTupleInterpolator* PositionInterpolator;
@@ -192,9 +207,14 @@ protected:
   vtkTimeStamp InitializeTime;
   void InitializeInterpolation();
 
-  // Keep track of inserted data
-  vtkTransformList* TransformList;
-  std::vector<vtkQTransform> TransformVector;
+  // Keep track of inserted data, in increasing time order
+  std::vector<double> Times;
+  std::vector<double> Positions;    // x y z per transform
+  std::vector<double> Scales;       // x y z per transform
+  std::vector<double> Orientations; // unit quaternion w x y z per transform
+  size_t Cursor = 0;                // interval of the last query
+  vtkQuaterniond GetOrientation(size_t n) const;
+  void SetPose(size_t n, double t, vtkTransform* xform);
 
 private:
   vtkCustomTransformInterpolator(const vtkCustomTransformInterpolator&); // Not implemented.
@@ -17,63 +17,74 @@
 
 #include "vtkDBSCANClustering.h"
 #include "vtkHelper.h"
-#include "DBSCAN.h"
 
 // VTK
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
 #include <vtkPolyData.h>
 
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkIntArray.h>
 #include <vtkSmartPointer.h>
 
 // STD
-#include <iostream>
-#include <vector>
+#include <algorithm>
+#include <limits>
 
 // Implementation of the New function
 vtkStandardNewMacro(vtkDBSCANClustering)
 
-
-using vector_of_vectors = std::vector<std::vector<double>>;
-namespace
-{
-vector_of_vectors PointCloudToStdVector(vtkSmartPointer<vtkPolyData> cloud)
-{
-  vector_of_vectors points;
-  points.reserve(cloud->GetNumberOfPoints());
-  for (unsigned int pointIdx = 0; pointIdx < cloud->GetNumberOfPoints(); ++pointIdx)
-  {
-    double* p = cloud->GetPoint(pointIdx);
-    std::vector<double> apoint = {p[0], p[1], p[2]};
-    points.push_back(apoint);
-  }
-  return points;
-}
-}
-
 //-----------------------------------------------------------------------------
 int vtkDBSCANClustering::RequestData(vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector, vtkInformationVector *outputVector)
 {
-  auto dbscan = DBSCAN<double>{this->Epsilon, this->MinPts};
-
   // IO
   vtkPolyData* pointCloud = vtkPolyData::GetData(inputVector[0]->GetInformationObject(0));
   vtkPolyData* outCloud = vtkPolyData::GetData(outputVector->GetInformationObject(0));
 
   outCloud->DeepCopy(pointCloud);
-  std::vector<int> pointLabels = dbscan.fit(PointCloudToStdVector(outCloud));
+  const vtkIdType nbPoints = outCloud->GetNumberOfPoints();
+  if (static_cast<unsigned long long>(nbPoints) >= std::numeric_limits<uint32_t>::max())
+  {
+    vtkErrorMacro("Too many points to cluster: " << nbPoints);
+    return 0;
+  }
 
-  auto clusterArray = createArray<vtkIntArray>("cluster", 1, outCloud->GetNumberOfPoints());
-  outCloud->GetPointData()->AddArray(clusterArray);
-  clusterArray->Fill(-1);
+  this->Clustering.SetEpsilon(this->Epsilon);
+  this->Clustering.SetMinPts(this->MinPts);
+  this->Clustering.SetNumberOfThreads(this->NumberOfThreads);
+  this->Clustering.SetNeighborSearch(this->UseVoxelGrid ? ParallelDBSCAN::NeighborSearch::VoxelGrid
+                                                        : ParallelDBSCAN::NeighborSearch::KDTree);
 
-  for (unsigned int pointIdx = 0; pointIdx < outCloud->GetNumberOfPoints(); ++pointIdx)
+  // Cluster the points in place when possible
+  const std::vector<int>* pointLabels = nullptr;
+  vtkDataArray* data = nbPoints > 0 ? outCloud->GetPoints()->GetData() : nullptr;
+  auto floatData = vtkFloatArray::SafeDownCast(data);
+  auto doubleData = vtkDoubleArray::SafeDownCast(data);
+  if (floatData)
   {
-    clusterArray->SetTuple1(pointIdx, pointLabels[pointIdx]);
+    pointLabels = &this->Clustering.Fit(floatData->GetPointer(0), nbPoints);
   }
+  else if (doubleData)
+  {
+    pointLabels = &this->Clustering.Fit(doubleData->GetPointer(0), nbPoints);
+  }
+  else
+  {
+    this->PointsBuffer.resize(3 * nbPoints);
+    for (vtkIdType pointIdx = 0; pointIdx < nbPoints; ++pointIdx)
+    {
+      outCloud->GetPoint(pointIdx, &this->PointsBuffer[3 * pointIdx]);
+    }
+    pointLabels = &this->Clustering.Fit(this->PointsBuffer.data(), nbPoints);
+  }
+
+  auto clusterArray = createArray<vtkIntArray>("cluster", 1, nbPoints);
+  outCloud->GetPointData()->AddArray(clusterArray);
+  std::copy(pointLabels->begin(), pointLabels->end(), clusterArray->GetPointer(0));
 
   return 1;
-}
\ No newline at end of file
+}
@@ -20,13 +20,16 @@
 #define VTK_DBSCAN_CLUSTERING_H
 
 // LOCAL
-#include "DBSCAN.h"
+#include "ParallelDBSCAN.h"
 
 // VTK
 #include <vtkPolyData.h>
 #include <vtkPolyDataAlgorithm.h>
 #include <vtkSmartPointer.h>
 
+// STD
+#include <vector>
+
 #include "LidarCoreModule.h"
 
 class LIDARCORE_EXPORT vtkDBSCANClustering : public vtkPolyDataAlgorithm
@@ -35,9 +38,25 @@ public:
   static vtkDBSCANClustering *New();
   vtkTypeMacro(vtkDBSCANClustering, vtkPolyDataAlgorithm)
 
+  /**
+   * Two points are neighbors if their squared distance is lower than Epsilon
+   */
   vtkSetMacro(Epsilon, double);
   vtkSetMacro(MinPts, double);
 
+  /**
+   * Number of threads used for the clustering, 0 to use all the cores
+   */
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
+  /**
+   * Search the neighbors with a voxel grid instead of a kd-tree.
+   * Faster when Epsilon is small compared to the size of the cloud, same result.
+   */
+  vtkSetMacro(UseVoxelGrid, bool);
+  vtkGetMacro(UseVoxelGrid, bool);
+
 protected:
   vtkDBSCANClustering() = default;
   ~vtkDBSCANClustering() = default;
@@ -50,6 +69,12 @@ private:
 
   double Epsilon = 0.5;
   double MinPts = 5;
+  int NumberOfThreads = 0;
+  bool UseVoxelGrid = false;
+
+  // Kept between the frames to reuse its buffers
+  ParallelDBSCAN Clustering{ 0.5, 5 };
+  std::vector<double> PointsBuffer;
 };
 
 #endif // VTK_DBSCAN_CLUSTERING_H
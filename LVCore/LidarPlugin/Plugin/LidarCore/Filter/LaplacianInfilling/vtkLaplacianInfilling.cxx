@@ -22,12 +22,15 @@
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <limits>
 
 // VTK
 #include <vtkObjectFactory.h>
 #include <vtkImageData.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkXMLImageDataWriter.h>
 
@@ -40,6 +43,46 @@
 // Implementation of the New function
 vtkStandardNewMacro(vtkLaplacianInfilling)
 
+namespace
+{
+//-----------------------------------------------------------------------------
+template <typename T>
+void ReadFirstComponent(const T* data, int nbComponents, vtkIdType nbValues, double* values)
+{
+  for (vtkIdType i = 0; i < nbValues; ++i)
+  {
+    values[i] = static_cast<double>(data[i * nbComponents]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void WriteFirstComponent(const double* values, vtkIdType nbValues, int nbComponents, T* data)
+{
+  for (vtkIdType i = 0; i < nbValues; ++i)
+  {
+    data[i * nbComponents] = static_cast<T>(values[i]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+double Dot(const std::vector<double>& a, const std::vector<double>& b)
+{
+  double result = 0.;
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    result += a[i] * b[i];
+  }
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+bool IsKnown(double value)
+{
+  return std::abs(value) > std::numeric_limits<double>::epsilon();
+}
+}
+
 //-----------------------------------------------------------------------------
 int vtkLaplacianInfilling::RequestData(vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector, vtkInformationVector *outputVector)
@@ -47,12 +90,58 @@ int vtkLaplacianInfilling::RequestData(vtkInformation *vtkNotUsed(request),
   // Get the input
   vtkImageData * inputImage = vtkImageData::GetData(inputVector[0]->GetInformationObject(0));
 
-  // Get the output
+  // Get the output, with its own copy of the scalars which are modified
   vtkImageData* outputImage = vtkImageData::GetData(outputVector->GetInformationObject(0));
   outputImage->ShallowCopy(inputImage);
+  vtkDataArray* inputScalars = inputImage->GetPointData()->GetScalars();
+  if (!inputScalars)
+  {
+    vtkErrorMacro("The input image has no scalars");
+    return 0;
+  }
+  vtkSmartPointer<vtkDataArray> scalars;
+  scalars.TakeReference(inputScalars->NewInstance());
+  scalars->DeepCopy(inputScalars);
+  outputImage->GetPointData()->SetScalars(scalars);
 
   int xBound = outputImage->GetDimensions()[0];
   int yBound = outputImage->GetDimensions()[1];
+  const vtkIdType nbPixels = static_cast<vtkIdType>(xBound) * yBound;
+  const int nbComponents = scalars->GetNumberOfComponents();
+
+  // Typed access to the first component of the pixels of the first slice
+  this->Values.resize(nbPixels);
+  switch (scalars->GetDataType())
+  {
+    vtkTemplateMacro(ReadFirstComponent(static_cast<const VTK_TT*>(scalars->GetVoidPointer(0)),
+      nbComponents, nbPixels, this->Values.data()));
+    default:
+      vtkErrorMacro("Unsupported scalar type " << scalars->GetDataTypeAsString());
+      return 0;
+  }
+
+  if (this->Solver == SOLVER::ConjugateGradient)
+  {
+    this->SolveConjugateGradient(xBound, yBound);
+  }
+  else
+  {
+    this->SolveDirect(xBound, yBound);
+  }
+
+  switch (scalars->GetDataType())
+  {
+    vtkTemplateMacro(WriteFirstComponent(this->Values.data(), nbPixels, nbComponents,
+      static_cast<VTK_TT*>(scalars->GetVoidPointer(0))));
+  }
+  scalars->Modified();
+
+  return 1;
+}
+
+//-----------------------------------------------------------------------------
+void vtkLaplacianInfilling::SolveDirect(int xBound, int yBound)
+{
   int nParams = xBound * yBound;
 
   Eigen::SparseMatrix<double> Laplacian(nParams, nParams);
@@ -67,8 +156,8 @@ int vtkLaplacianInfilling::RequestData(vtkInformation *vtkNotUsed(request),
       int flattenIndex = x + xBound * y;
 
       // check if the current pixel has a value
-      double value = inputImage->GetScalarComponentAsDouble(x, y, 0, 0);
-      if ((std::abs(value) > std::numeric_limits<double>::epsilon()))
+      double value = this->Values[flattenIndex];
+      if (IsKnown(value))
       {
         // we don't want this value to be modified
         // contraint: xi = yi
@@ -117,19 +206,177 @@ int vtkLaplacianInfilling::RequestData(vtkInformation *vtkNotUsed(request),
 
   // Solving:
   Eigen::SparseLU< Eigen::SparseMatrix<double> > solver(Laplacian);
-  Eigen::MatrixXd X = solver.solve(Y);
+  Eigen::VectorXd X = solver.solve(Y);
 
   // X contains the Dirichlet solution function
   // values i.e: 0-values pixel are filled with
   // laplacian
-  for (int x = 0; x < xBound; ++x)
+  for (int flattenIndex = 0; flattenIndex < nParams; ++flattenIndex)
+  {
+    this->Values[flattenIndex] = X(flattenIndex);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkLaplacianInfilling::SolveConjugateGradient(int xBound, int yBound)
+{
+  const vtkIdType nbPixels = static_cast<vtkIdType>(xBound) * yBound;
+
+  // Number the missing pixels, the known ones are the boundary conditions
+  this->UnknownIndex.assign(nbPixels, -1);
+  this->Unknowns.clear();
+  for (vtkIdType pixel = 0; pixel < nbPixels; ++pixel)
+  {
+    if (!IsKnown(this->Values[pixel]))
+    {
+      this->UnknownIndex[pixel] = static_cast<int>(this->Unknowns.size());
+      this->Unknowns.push_back(pixel);
+    }
+  }
+  const size_t nbUnknowns = this->Unknowns.size();
+
+  // Discrete laplacian restricted to the missing pixels:
+  // degree * x_i - sum(x_j, missing neighbors j) = sum(known neighbors values)
+  this->UnknownNeighbors.assign(4 * nbUnknowns, -1);
+  this->Degree.assign(nbUnknowns, 0.);
+  this->B.assign(nbUnknowns, 0.);
+  for (size_t i = 0; i < nbUnknowns; ++i)
+  {
+    const vtkIdType pixel = this->Unknowns[i];
+    const int x = static_cast<int>(pixel % xBound);
+    const int y = static_cast<int>(pixel / xBound);
+    const bool hasNeighbor[4] = { x != 0, x != xBound - 1, y != 0, y != yBound - 1 };
+    const vtkIdType neighborOffset[4] = { -1, 1, -xBound, xBound };
+    for (int n = 0; n < 4; ++n)
+    {
+      if (!hasNeighbor[n])
+      {
+        continue;
+      }
+      const vtkIdType neighbor = pixel + neighborOffset[n];
+      this->Degree[i] += 1.;
+      if (this->UnknownIndex[neighbor] >= 0)
+      {
+        this->UnknownNeighbors[4 * i + n] = this->UnknownIndex[neighbor];
+      }
+      else
+      {
+        this->B[i] += this->Values[neighbor];
+      }
+    }
+  }
+
+  auto multiply = [this, nbUnknowns](const std::vector<double>& in, std::vector<double>& out) {
+    for (size_t i = 0; i < nbUnknowns; ++i)
+    {
+      double value = this->Degree[i] * in[i];
+      for (int n = 0; n < 4; ++n)
+      {
+        const int neighbor = this->UnknownNeighbors[4 * i + n];
+        if (neighbor >= 0)
+        {
+          value -= in[neighbor];
+        }
+      }
+      out[i] = value;
+    }
+  };
+
+  // Initial guess: the previous solution in streaming playback, otherwise a
+  // linear interpolation between the known pixels of each row
+  this->X.resize(nbUnknowns);
+  const bool warmStart = this->PreviousDimensions[0] == xBound &&
+    this->PreviousDimensions[1] == yBound &&
+    static_cast<vtkIdType>(this->PreviousSolution.size()) == nbPixels;
+  if (warmStart)
+  {
+    for (size_t i = 0; i < nbUnknowns; ++i)
+    {
+      this->X[i] = this->PreviousSolution[this->Unknowns[i]];
+    }
+  }
+  else
   {
     for (int y = 0; y < yBound; ++y)
     {
-      int flattendIndex = x + xBound * y;
-      outputImage->SetScalarComponentFromDouble(x, y, 0, 0, X(flattendIndex));
+      const vtkIdType row = static_cast<vtkIdType>(y) * xBound;
+      int previousKnown = -1;
+      for (int x = 0; x <= xBound; ++x)
+      {
+        if (x < xBound && !IsKnown(this->Values[row + x]))
+        {
+          continue;
+        }
+        // fill the missing pixels between previousKnown and x
+        const double left = previousKnown >= 0 ? this->Values[row + previousKnown] : 0.;
+        const double right = x < xBound ? this->Values[row + x] : left;
+        const double start = previousKnown >= 0 ? left : right;
+        for (int missing = previousKnown + 1; missing < x; ++missing)
+        {
+          const double ratio = static_cast<double>(missing - previousKnown) / (x - previousKnown);
+          this->X[this->UnknownIndex[row + missing]] = start + ratio * (right - start);
+        }
+        previousKnown = x;
+      }
     }
   }
 
-  return 1;
+  // Jacobi preconditioned conjugate gradient
+  this->R.resize(nbUnknowns);
+  this->Z.resize(nbUnknowns);
+  this->P.resize(nbUnknowns);
+  this->AP.resize(nbUnknowns);
+  multiply(this->X, this->AP);
+  for (size_t i = 0; i < nbUnknowns; ++i)
+  {
+    this->R[i] = this->B[i] - this->AP[i];
+  }
+  const double bNorm = std::sqrt(Dot(this->B, this->B));
+  const double rNorm = std::sqrt(Dot(this->R, this->R));
+  const double threshold = this->Tolerance * (bNorm > 0. ? bNorm : rNorm);
+  for (size_t i = 0; i < nbUnknowns; ++i)
+  {
+    this->Z[i] = this->Degree[i] > 0. ? this->R[i] / this->Degree[i] : this->R[i];
+  }
+  this->P = this->Z;
+  double rz = Dot(this->R, this->Z);
+
+  int iteration = 0;
+  for (; iteration < this->MaximumNumberOfIterations; ++iteration)
+  {
+    if (std::sqrt(Dot(this->R, this->R)) <= threshold)
+    {
+      break;
+    }
+    multiply(this->P, this->AP);
+    const double pAp = Dot(this->P, this->AP);
+    if (!(pAp > 0.))
+    {
+      break;
+    }
+    const double alpha = rz / pAp;
+    for (size_t i = 0; i < nbUnknowns; ++i)
+    {
+      this->X[i] += alpha * this->P[i];
+      this->R[i] -= alpha * this->AP[i];
+      this->Z[i] = this->Degree[i] > 0. ? this->R[i] / this->Degree[i] : this->R[i];
+    }
+    const double newRz = Dot(this->R, this->Z);
+    const double beta = newRz / rz;
+    rz = newRz;
+    for (size_t i = 0; i < nbUnknowns; ++i)
+    {
+      this->P[i] = this->Z[i] + beta * this->P[i];
+    }
+  }
+  vtkDebugMacro("Conjugate gradient: " << iteration << " iterations for " << nbUnknowns
+                                       << " missing pixels");
+
+  for (size_t i = 0; i < nbUnknowns; ++i)
+  {
+    this->Values[this->Unknowns[i]] = this->X[i];
+  }
+  this->PreviousSolution = this->Values;
+  this->PreviousDimensions[0] = xBound;
+  this->PreviousDimensions[1] = yBound;
 }
@@ -20,11 +20,19 @@
 // VTK
 #include <vtkImageAlgorithm.h>
 
+// STD
+#include <vector>
+
 #include "LidarCoreModule.h"
 
 /**
  * @brief vtkLaplacianInfilling fill missing data in an image
  *        solving the Dirichlet problem.
+ *
+ * The missing pixels are the ones whose first component is 0. The direct solver
+ * factorizes a system over all the pixels, it is only suitable for small images.
+ * The conjugate gradient solver only treats the missing pixels, and starts from
+ * the solution of the previous frame when the image size does not change.
  */
 class LIDARCORE_EXPORT vtkLaplacianInfilling : public vtkImageAlgorithm
 {
@@ -32,6 +40,24 @@ public:
   static vtkLaplacianInfilling *New();
   vtkTypeMacro(vtkLaplacianInfilling, vtkImageAlgorithm)
 
+  /**
+   * @brief The SOLVER enum to select how the Dirichlet problem is solved
+   */
+  enum SOLVER
+  {
+    Direct = 0,            /*!< sparse LU over all the pixels */
+    ConjugateGradient = 1, /*!< iterative, over the missing pixels only */
+  };
+
+  vtkGetMacro(Solver, int)
+  vtkSetMacro(Solver, int)
+
+  vtkGetMacro(MaximumNumberOfIterations, int)
+  vtkSetMacro(MaximumNumberOfIterations, int)
+
+  vtkGetMacro(Tolerance, double)
+  vtkSetMacro(Tolerance, double)
+
 protected:
   vtkLaplacianInfilling() = default;
   ~vtkLaplacianInfilling() = default;
@@ -41,6 +67,30 @@ protected:
 private:
   vtkLaplacianInfilling(const vtkLaplacianInfilling&) = delete;
   void operator=(const vtkLaplacianInfilling&) = delete;
+
+  //! Solve with a sparse LU over all the pixels
+  void SolveDirect(int xBound, int yBound);
+  //! Solve with a Jacobi preconditioned conjugate gradient over the missing pixels
+  void SolveConjugateGradient(int xBound, int yBound);
+
+  //! Solver used, see SOLVER
+  int Solver = SOLVER::Direct;
+  //! Maximum number of iterations of the iterative solver
+  int MaximumNumberOfIterations = 1000;
+  //! The iterative solver stops when the residual norm is below Tolerance times the right-hand side one
+  double Tolerance = 1e-8;
+
+  //! First component of the image, modified in place by the solvers
+  std::vector<double> Values;
+  //! Solution of the previous frame, used as initial guess by the iterative solver
+  std::vector<double> PreviousSolution;
+  int PreviousDimensions[2] = { 0, 0 };
+
+  // Buffers of the iterative solver, kept between frames
+  std::vector<vtkIdType> Unknowns;
+  std::vector<int> UnknownIndex;
+  std::vector<int> UnknownNeighbors;
+  std::vector<double> Degree, B, X, R, Z, P, AP;
 };
 
 #endif // VTK_LAPLACIAN_INFILLING_H
@@ -17,14 +17,20 @@
 #include "vtkLidarRawSignalImage.h"
 
 #include <vtkObjectFactory.h>
+#include <vtkFloatArray.h>
 #include <vtkImageData.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkTable.h>
 
+#include <algorithm>
+#include <numeric>
+
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkLidarRawSignalImage)
 
@@ -49,7 +55,10 @@ void vtkLidarRawSignalImage::PrintSelf(ostream& os, vtkIndent indent)
   PrintParameter(Origin[0])
   PrintParameter(Origin[1])
   PrintParameter(Origin[2])
-
+  PrintParameter(UseStructuredPointID)
+  PrintParameter(NumberOfLasers)
+  PrintParameter(OutputGeometryChannels)
+  PrintParameter(NumberOfThreads)
 }
 
 //-----------------------------------------------------------------------------
@@ -63,6 +72,8 @@ int vtkLidarRawSignalImage::FillInputPortInformation(int port, vtkInformation *i
   if (port == 1)
   {
     info->Set(vtkDataObject::DATA_TYPE_NAME(), "vtkTable" );
+    // Only used to sort the lasers when filling the image from the structured PointID
+    info->Set(vtkAlgorithm::INPUT_IS_OPTIONAL(), 1);
     return 1;
   }
   return 0;
@@ -76,33 +87,25 @@ int vtkLidarRawSignalImage::RequestData(vtkInformation *vtkNotUsed(request),
   vtkPolyData * input = vtkPolyData::GetData(inputVector[0]->GetInformationObject(0));
   vtkTable* calibration = vtkTable::GetData(inputVector[1]->GetInformationObject(0));
 
-  // Initialize the filter using the provided sensor calibration table
-  if (this->VerticallySortedIndex.size() == 0)
+  // Initialize the filter using the provided sensor calibration table,
+  // the lasers are sorted again only if the calibration changes
+  if (!calibration || calibration->GetMTime() != this->CalibrationTime)
   {
-    if (!this->InitializationFromCalibration(calibration))
+    this->CalibrationTime = 0;
+    if (!calibration && this->UseStructuredPointID)
+    {
+      this->VerticallySortedIndex.clear();
+    }
+    else if (!this->InitializationFromCalibration(calibration))
     {
       return VTK_ERROR;
     }
+    else
+    {
+      this->CalibrationTime = calibration->GetMTime();
+    }
   }
 
-  // Set the spacing according to the angles FoV.
-  // The idea is to have a linear mapping between
-  // the angles and the pixels size so that 360 degrees
-  // correspond to 100 meters
-  // TODO: take into account the fact that the vertical angular
-  // resolution is not constant to avoid distortion
-  this->Spacing[0] = this->Scale * (this->HorizontalFOV * 100.0) / (360.0 * this->Width);
-  this->Spacing[1] = this->Scale * (this->VerticalFOV * 100.0) / (360.0 * this->Height);
-
-  // Get the output image and fill with zeros
-  vtkImageData* outputImage = vtkImageData::GetData(outputVector->GetInformationObject(0));
-  outputImage->SetDimensions(this->Width, this->Height, 1);
-  outputImage->SetSpacing(this->Spacing);
-  outputImage->SetOrigin(this->Origin);
-  outputImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
-  unsigned char* dataPointer = static_cast<unsigned char*>(outputImage->GetScalarPointer());
-  std::fill(dataPointer, dataPointer + this->Height * this->Width, 0);
-
   // Get the required array
   vtkDataArray* arrayToUse = this->GetInputArrayToProcess(0, inputVector);
   if (!arrayToUse)
@@ -110,27 +113,60 @@ int vtkLidarRawSignalImage::RequestData(vtkInformation *vtkNotUsed(request),
     vtkErrorMacro("No input array selected!");
     return 0;
   }
-  vtkDataArray* azimuth = input->GetPointData()->GetArray("azimuth");
-  vtkDataArray* laserIndex = input->GetPointData()->GetArray("laser_id");
-  if (!azimuth || !laserIndex)
+
+  // Compute the pixel of each point
+  this->Builder.SetNumberOfThreads(this->NumberOfThreads);
+  int width = this->Width;
+  int height = this->Height;
+  if (this->UseStructuredPointID)
   {
-    vtkErrorMacro("The input polydata must contain azimuth angles and laser idx data!");
-    return 0;
-  }
+    vtkDataArray* pointIds = input->GetPointData()->GetArray("PointID");
+    if (!pointIds)
+    {
+      vtkErrorMacro("The input polydata must contain the PointID data!");
+      return 0;
+    }
+    const int numberOfLasers = this->NumberOfLasers > 0
+      ? this->NumberOfLasers
+      : static_cast<int>(this->VerticallySortedIndex.size());
+    if (numberOfLasers <= 0)
+    {
+      vtkErrorMacro("The number of lasers must be set when no calibration is provided!");
+      return 0;
+    }
 
-  // Project each point one by one into the image
-  for (unsigned int indexPoint = 0; indexPoint < input->GetNumberOfPoints(); ++indexPoint)
+    // Keep the firing order of the lasers if the calibration does not describe them
+    std::vector<int> rowOfLaser(this->VerticallySortedIndex);
+    if (static_cast<int>(rowOfLaser.size()) != numberOfLasers)
+    {
+      if (!rowOfLaser.empty())
+      {
+        vtkWarningMacro("The calibration does not match the number of lasers, "
+          "the lasers are not sorted vertically.");
+      }
+      rowOfLaser.resize(numberOfLasers);
+      std::iota(rowOfLaser.begin(), rowOfLaser.end(), 0);
+    }
+
+    // One column per firing of the frame
+    const double maxPointId = pointIds->GetNumberOfTuples() > 0 ? pointIds->GetRange(0)[1] : -1.;
+    width = maxPointId >= 0. ? static_cast<int>(maxPointId / numberOfLasers) + 1 : 0;
+    height = numberOfLasers;
+    this->Builder.SetDimensions(width, height);
+    this->Builder.MapStructuredPoints(pointIds, numberOfLasers, rowOfLaser);
+  }
+  else
   {
-    // Get the coordinate of the input point
-    double currPoint[3];
-    input->GetPoint(indexPoint, currPoint);
+    vtkDataArray* azimuth = input->GetPointData()->GetArray("azimuth");
+    vtkDataArray* laserIndex = input->GetPointData()->GetArray("laser_id");
+    if (!azimuth || !laserIndex)
+    {
+      vtkErrorMacro("The input polydata must contain azimuth angles and laser idx data!");
+      return 0;
+    }
 
     // compute w coordinate of the image based
-    // on the azimuth angle
-    double azimuthAngle = azimuth->GetTuple1(indexPoint);
-    int w = std::floor(azimuthAngle / 36000.0 * this->Width);
-
-    // compute the h coordinate of the image based
+    // on the azimuth angle and the h coordinate
     // on the vertically sorted laser index
     // /!\ the spherical grid is then based on the
     // laser index which means that the solid angle
@@ -138,10 +174,53 @@ int vtkLidarRawSignalImage::RequestData(vtkInformation *vtkNotUsed(request),
     // resolution between two consecutives laser. For example,
     // a VLS-128 has a non constant vertical angular resolution
     // resulting in an observed image distorded
-    int idx = laserIndex->GetTuple1(indexPoint);
-    int h = this->VerticallySortedIndex[idx];
-    double value = arrayToUse->GetTuple1(indexPoint);
-    outputImage->SetScalarComponentFromDouble(w, h, 0, 0, value);
+    this->Builder.SetDimensions(width, height);
+    if (!this->Builder.MapSphericalPoints(azimuth, laserIndex, this->VerticallySortedIndex))
+    {
+      vtkErrorMacro("The azimuth and laser idx data must have one value per point!");
+      return 0;
+    }
+  }
+
+  // Set the spacing according to the angles FoV.
+  // The idea is to have a linear mapping between
+  // the angles and the pixels size so that 360 degrees
+  // correspond to 100 meters
+  // TODO: take into account the fact that the vertical angular
+  // resolution is not constant to avoid distortion
+  this->Spacing[0] = this->Scale * (this->HorizontalFOV * 100.0) / (360.0 * std::max(1, width));
+  this->Spacing[1] = this->Scale * (this->VerticalFOV * 100.0) / (360.0 * height);
+
+  // Get the output image, the pixels without points are set to 0 by the builder
+  vtkImageData* outputImage = vtkImageData::GetData(outputVector->GetInformationObject(0));
+  outputImage->SetDimensions(width, height, 1);
+  outputImage->SetSpacing(this->Spacing);
+  outputImage->SetOrigin(this->Origin);
+  outputImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+
+  // Fill all the channels in one pass
+  this->Builder.ClearChannels();
+  this->Builder.AddValueChannel(arrayToUse, outputImage->GetPointData()->GetScalars());
+  if (this->OutputGeometryChannels && input->GetPoints())
+  {
+    vtkDataArray* points = input->GetPoints()->GetData();
+    const vtkIdType numberOfPixels = static_cast<vtkIdType>(width) * height;
+    vtkNew<vtkFloatArray> range;
+    range->SetName("Range");
+    range->SetNumberOfTuples(numberOfPixels);
+    outputImage->GetPointData()->AddArray(range);
+    this->Builder.AddRangeChannel(points, range);
+
+    vtkNew<vtkFloatArray> elevation;
+    elevation->SetName("Elevation");
+    elevation->SetNumberOfTuples(numberOfPixels);
+    outputImage->GetPointData()->AddArray(elevation);
+    this->Builder.AddElevationChannel(points, elevation);
+  }
+  if (!this->Builder.Fill())
+  {
+    vtkErrorMacro("The selected array must have one value per point!");
+    return 0;
   }
 
   return VTK_OK;
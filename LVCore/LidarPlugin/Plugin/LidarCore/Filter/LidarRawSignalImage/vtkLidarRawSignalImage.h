@@ -21,6 +21,7 @@
 #include <vtkImageAlgorithm.h>
 
 #include "LidarCoreModule.h"
+#include "RangeImageBuilder.h"
 
 class vtkTable;
 
@@ -29,6 +30,11 @@ class vtkTable;
  * of a point cloud to create a panorama image.
  *
  * @warning one image column corresponds to one laser.
+ *
+ * The image is filled either from the azimuth and laser_id arrays, or, for the
+ * sensors giving a structured index to each point (PointID), directly from this
+ * index: the column is the firing, the row the laser. The range and elevation
+ * of the points can be output as additional channels, filled in the same pass.
  */
 class LIDARCORE_EXPORT vtkLidarRawSignalImage : public vtkImageAlgorithm
 {
@@ -61,6 +67,30 @@ public:
   vtkSetMacro(Scale, double)
   //! @}
 
+  //! @{
+  //! @copydoc UseStructuredPointID
+  vtkGetMacro(UseStructuredPointID, bool)
+  vtkSetMacro(UseStructuredPointID, bool)
+  //! @}
+
+  //! @{
+  //! @copydoc NumberOfLasers
+  vtkGetMacro(NumberOfLasers, int)
+  vtkSetMacro(NumberOfLasers, int)
+  //! @}
+
+  //! @{
+  //! @copydoc OutputGeometryChannels
+  vtkGetMacro(OutputGeometryChannels, bool)
+  vtkSetMacro(OutputGeometryChannels, bool)
+  //! @}
+
+  //! @{
+  //! @copydoc NumberOfThreads
+  vtkGetMacro(NumberOfThreads, int)
+  vtkSetMacro(NumberOfThreads, int)
+  //! @}
+
 protected:
   vtkLidarRawSignalImage();
   int FillInputPortInformation(int port, vtkInformation *info) override;
@@ -92,6 +122,20 @@ protected:
   ///! Scale of the image
   double Scale = 1.0;
 
+  //! Fill the image from the structured PointID array instead of the azimuth.
+  //! The width of the image is then the number of firings of the frame.
+  bool UseStructuredPointID = false;
+  //! Number of lasers of the structured PointID, 0 to use the calibration size
+  int NumberOfLasers = 0;
+  //! Add the Range and Elevation of the points to the output image
+  bool OutputGeometryChannels = true;
+  //! Number of threads used to fill the image, 0 to use all the cores
+  int NumberOfThreads = 0;
+
+  //! Modification time of the calibration used to sort the lasers
+  vtkMTimeType CalibrationTime = 0;
+  RangeImageBuilder Builder;
+
 private:
   vtkLidarRawSignalImage(const vtkLidarRawSignalImage&) = delete;
   void operator=(const vtkLidarRawSignalImage&) = delete;
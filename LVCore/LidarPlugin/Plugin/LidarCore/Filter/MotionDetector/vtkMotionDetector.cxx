@@ -93,6 +93,38 @@ void vtkMotionDetector::ResetAlgorithm()
   this->GaussianMap.ResetMap();
 }
 
+//----------------------------------------------------------------------------
+void vtkMotionDetector::SetNumberOfThreads(int threads)
+{
+  if (this->GaussianMap.GetNumberOfThreads() != threads)
+  {
+    this->GaussianMap.SetNumberOfThreads(threads);
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkMotionDetector::GetNumberOfThreads()
+{
+  return this->GaussianMap.GetNumberOfThreads();
+}
+
+//----------------------------------------------------------------------------
+void vtkMotionDetector::SetMaximumNumberOfGaussians(int k)
+{
+  if (k > 0 && this->GaussianMap.GetMaximumNumberOfGaussians() != static_cast<unsigned int>(k))
+  {
+    this->GaussianMap.SetMaximumNumberOfGaussians(k);
+    this->Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkMotionDetector::GetMaximumNumberOfGaussians()
+{
+  return this->GaussianMap.GetMaximumNumberOfGaussians();
+}
+
 //-----------------------------------------------------------------------------
 void vtkMotionDetector::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -60,6 +60,15 @@ public:
   // Reset the vtkMotionDetector algorithm
   void ResetAlgorithm();
 
+  // Number of threads used, 0 to use all the cores
+  void SetNumberOfThreads(int threads);
+  int GetNumberOfThreads();
+
+  // Maximum number of gaussians of each pixel of the map,
+  // changing it resets the algorithm
+  void SetMaximumNumberOfGaussians(int k);
+  int GetMaximumNumberOfGaussians();
+
 protected:
   // constructor / destructor
   vtkMotionDetector();
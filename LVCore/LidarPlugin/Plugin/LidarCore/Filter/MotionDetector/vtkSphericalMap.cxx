@@ -20,148 +20,38 @@
 #include <vtkUnsignedShortArray.h>
 #include <vtkPNGWriter.h>
 
-//----------------------------------------------------------------------------
-Gaussian::Gaussian()
-{
-  this->N = 0;
-  this->Sigma = 0.20; // 10 cm accuracy
-  this->MaxTTL = 25;
-  this->TTL = this->MaxTTL;
-}
+// LOCAL
+#include "ParallelTools.h"
 
-//----------------------------------------------------------------------------
-double Gaussian::operator()(double x)
-{
-  return 1.0 / (this->Sigma * sqrt(2 * vtkMath::Pi())) * exp(-std::pow(x - this->Mean, 2) / (2.0 * std::pow(this->Sigma, 2)));
-}
+// STD
+#include <algorithm>
+#include <limits>
 
-//----------------------------------------------------------------------------
-void Gaussian::SetMean(double mean)
+namespace
 {
-  this->Mean = mean;
-  this->N = 1;
-}
+// Minimum number of points handled by each thread
+constexpr vtkIdType MinPointsPerThread = 2048;
 
-//----------------------------------------------------------------------------
-double Gaussian::GetSigma()
-{
-  return this->Sigma;
-}
+// Threshold on the density under which a depth does not
+// belong to a gaussian, ie 3 sigma of a normal distribution
+constexpr double NewGaussianThreshold = 0.00135;
 
 //----------------------------------------------------------------------------
-void Gaussian::UpdateParam(double x)
+inline double Density(double mean, double sigma, double x)
 {
-  // update the mean
-  double oldMean = this->Mean;
-  this->Mean = (static_cast<double>(N) * this->Mean + x) / (static_cast<double>(N) + 1);
-
-  // update the standard deviation
-  this->Sigma = std::sqrt((this->N * std::pow(this->Sigma, 2) + (x - oldMean) * (x - this->Mean)) / (this->N + 1));
-
-  // reset the TTL to its maximum
-  this->TTL = this->MaxTTL;
-
-  // update the number of sample
-  this->N += 1;
+  const double d = x - mean;
+  return 1.0 / (sigma * std::sqrt(2 * vtkMath::Pi())) * std::exp(-(d * d) / (2.0 * sigma * sigma));
 }
 
 //----------------------------------------------------------------------------
-bool Gaussian::UpdateTTL()
+// Spherical coordinates (r, theta, phi) of a point expressed in the map base
+inline void ToSpherical(double x, double y, double z, double& r, double& theta, double& phi)
 {
-  this->TTL -= 1;
-  return (this->TTL >= 0);
+  const double planar = std::sqrt(x * x + y * y);
+  r = std::sqrt(x * x + y * y + z * z);
+  theta = std::atan2(y, x);
+  phi = std::atan2(planar, z);
 }
-
-//----------------------------------------------------------------------------
-GaussianMixture::GaussianMixture()
-{
-
-}
-
-//----------------------------------------------------------------------------
-double GaussianMixture::Evaluate(double x)
-{
-  if (this->Gaussians.size() == 0)
-  {
-    return 0.0;
-  }
-
-  double proba = 0;
-  for (std::list<Gaussian>::iterator it = this->Gaussians.begin(); it != this->Gaussians.end(); ++it)
-  {
-    // divide by the max
-    proba = std::max(proba, (*it)(x));
-  }
-
-  return proba;
-}
-
-//----------------------------------------------------------------------------
-double GaussianMixture::operator()(double x)
-{
-  return 1.0 / (this->sigma * sqrt(2 * vtkMath::Pi())) * exp(-std::pow(x - this->mean, 2) / (2.0 * std::pow(this->sigma, 2)));
-}
-
-//----------------------------------------------------------------------------
-void GaussianMixture::AddPoint(double x)
-{
-  double maxProba = 0.0;
-  std::list<Gaussian>::iterator itMaxProba;
-
-  // add the point to the right gaussian
-  for (std::list<Gaussian>::iterator it = this->Gaussians.begin(); it != this->Gaussians.end(); ++it)
-  {
-    double proba = (*it)(x);
-    if (proba > maxProba)
-    {
-      maxProba = proba;
-      itMaxProba = it;
-    }
-  }
-
-  double threshProb = 0.00135; // 3 sigma
-
-  // Create new gaussian
-  if (maxProba < threshProb)
-  {
-    // Create new gaussian, centered on x and with a starting
-    // sigma of 2cm (specific to the Lidar sensors)
-    Gaussian newGaussian;
-    newGaussian.SetMean(x);
-    this->Gaussians.push_back(newGaussian);
-    return;
-  }
-
-  itMaxProba->UpdateParam(x);
-}
-
-//----------------------------------------------------------------------------
-void GaussianMixture::UpdateTTL()
-{
-  std::list<Gaussian>::iterator it = this->Gaussians.begin();
-  while (it != this->Gaussians.end())
-  {
-    // Get if the gaussian is still alive
-    bool stillAlive = it->UpdateTTL();
-
-    // erase the gaussian
-    if (!stillAlive)
-    {
-      // erase current iterator and get next on
-      it = this->Gaussians.erase(it);
-      // no need to increment iterator here
-    }
-    else
-    {
-      it++; // increment iterator here
-    }
-  }
-}
-
-//----------------------------------------------------------------------------
-unsigned int GaussianMixture::GetNumberOfPoints()
-{
-  return this->Gaussians.size();
 }
 
 //----------------------------------------------------------------------------
@@ -178,6 +68,12 @@ vtkSphericalMap::vtkSphericalMap()
   // Default sensor rpm
   this->SensorRPM = 600.0;
 
+  // Gaussian mixtures parameters
+  this->K = 4;
+  this->InitialSigma = 0.20; // 10 cm accuracy
+  this->MaxTTL = 25;
+  this->NumberOfThreads = 0;
+
   // Default NPhi / NTheta values
   this->NPhi = 180;
   this->NTheta = static_cast<int>(std::floor(60.0 / (this->SensorRPM * 55.296 * 1e-6))); // around 904
@@ -230,6 +126,31 @@ unsigned int vtkSphericalMap::GetNTheta()
   return this->NTheta;
 }
 
+//----------------------------------------------------------------------------
+void vtkSphericalMap::SetMaximumNumberOfGaussians(unsigned int k)
+{
+  this->K = std::max(1u, std::min(k, static_cast<unsigned int>(std::numeric_limits<uint8_t>::max())));
+  this->ResetMap();
+}
+
+//----------------------------------------------------------------------------
+unsigned int vtkSphericalMap::GetMaximumNumberOfGaussians()
+{
+  return this->K;
+}
+
+//----------------------------------------------------------------------------
+void vtkSphericalMap::SetNumberOfThreads(int threads)
+{
+  this->NumberOfThreads = threads;
+}
+
+//----------------------------------------------------------------------------
+int vtkSphericalMap::GetNumberOfThreads()
+{
+  return this->NumberOfThreads;
+}
+
 //----------------------------------------------------------------------------
 void vtkSphericalMap::ResetMap()
 {
@@ -238,11 +159,16 @@ void vtkSphericalMap::ResetMap()
   this->dTheta = (this->ThetaBounds[1] - this->ThetaBounds[0]) / static_cast<double>(this->NTheta);
 
   // reset the map
-  this->Map.clear();
-  this->Map.resize(this->NPhi * this->NTheta);
+  const size_t nbPixels = static_cast<size_t>(this->NPhi) * this->NTheta;
+  this->Mean.assign(nbPixels * this->K, 0.0);
+  this->Sigma.assign(nbPixels * this->K, 0.0);
+  this->N.assign(nbPixels * this->K, 0);
+  this->LastUpdate.assign(nbPixels * this->K, 0);
+  this->NumberOfGaussians.assign(nbPixels, 0);
 
   // reset internal parameters
   this->AddedFrames = 0;
+  this->TTLClock = 0;
 
   // reset export parameters
   this->ShouldExportAsImage = false;
@@ -261,51 +187,137 @@ Eigen::Matrix<double, 3, 1> vtkSphericalMap::GetSphericalCoordinates(const Eigen
        this->ex(2), this->ey(2), this->ez(2);
   Eigen::Matrix<double, 3, 1> CX = R.transpose() * (X - C);
 
-  // compute the vetor length
-  double r = CX.norm();
+  // Phi is the angle between CX and ez, theta the angle
+  // between ex and the projection of CX onto the (ex, ey) plane
+  Eigen::Matrix<double, 3, 1> sphericalCoords;
+  ToSpherical(CX(0), CX(1), CX(2), sphericalCoords(0), sphericalCoords(1), sphericalCoords(2));
+  return sphericalCoords;
+}
 
-  // If the vector is not null
-  // we normalized it
-  if (r > 1e-4)
+//----------------------------------------------------------------------------
+unsigned int vtkSphericalMap::GetNumberOfPoints()
+{
+  unsigned int nbrPoints = 0;
+  for (size_t pixel = 0; pixel < this->NumberOfGaussians.size(); ++pixel)
   {
-    CX.normalize();
+    for (size_t i = pixel * this->K; i < pixel * this->K + this->NumberOfGaussians[pixel]; ++i)
+    {
+      nbrPoints += (this->TTLClock - this->LastUpdate[i] <= this->MaxTTL) ? 1 : 0;
+    }
   }
 
-  // Project CX onto the (ex, ey) plane
-  Eigen::Matrix<double, 3, 1> projCX = CX.dot(this->ex) * this->ex + CX.dot(this->ey) * this->ey;
-  projCX.normalize();
-
-  // Compute Phi angle
-  double cosPhi = CX.dot(this->ez);
-  double sinPhi = CX.cross(this->ez).transpose() * CX.cross(this->ez).normalized();
-  double Phi = std::atan2(sinPhi, cosPhi);
+  return nbrPoints;
+}
 
-  // Compute theta angle
-  double cosTheta = projCX.dot(this->ex);
-  double sinTheta = projCX.cross(this->ex).dot(this->ey.cross(this->ex).normalized());
-  double Theta = std::atan2(sinTheta, cosTheta);
+//----------------------------------------------------------------------------
+void vtkSphericalMap::RemoveDeadGaussians(unsigned int pixel)
+{
+  const size_t first = static_cast<size_t>(pixel) * this->K;
+  const unsigned int count = this->NumberOfGaussians[pixel];
+  unsigned int kept = 0;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    if (this->TTLClock - this->LastUpdate[first + i] > this->MaxTTL)
+    {
+      continue;
+    }
+    // keep the order of the gaussians
+    if (kept != i)
+    {
+      this->Mean[first + kept] = this->Mean[first + i];
+      this->Sigma[first + kept] = this->Sigma[first + i];
+      this->N[first + kept] = this->N[first + i];
+      this->LastUpdate[first + kept] = this->LastUpdate[first + i];
+    }
+    kept++;
+  }
+  this->NumberOfGaussians[pixel] = static_cast<uint8_t>(kept);
+}
 
-  Eigen::Matrix<double, 3, 1> sphericalCoords;
-  sphericalCoords << r, Theta, Phi;
-  return sphericalCoords;
+//----------------------------------------------------------------------------
+double vtkSphericalMap::Evaluate(unsigned int pixel, double x) const
+{
+  const size_t first = static_cast<size_t>(pixel) * this->K;
+  const size_t last = first + this->NumberOfGaussians[pixel];
+  double proba = 0;
+  for (size_t i = first; i < last; ++i)
+  {
+    proba = std::max(proba, Density(this->Mean[i], this->Sigma[i], x));
+  }
+  return proba;
 }
 
 //----------------------------------------------------------------------------
-unsigned int vtkSphericalMap::GetNumberOfPoints()
+void vtkSphericalMap::AddDepth(unsigned int pixel, double x)
 {
-  unsigned int nbrPoints = 0;
-  for (unsigned int k = 0; k < this->Map.size(); ++k)
+  const size_t first = static_cast<size_t>(pixel) * this->K;
+  unsigned int count = this->NumberOfGaussians[pixel];
+
+  // find the most likely gaussian
+  double maxProba = 0.0;
+  size_t best = first;
+  for (size_t i = first; i < first + count; ++i)
   {
-    nbrPoints += this->Map[k].GetNumberOfPoints();
+    double proba = Density(this->Mean[i], this->Sigma[i], x);
+    if (proba > maxProba)
+    {
+      maxProba = proba;
+      best = i;
+    }
   }
 
-  return nbrPoints;
+  // Create new gaussian, centered on x and with
+  // the starting sigma (specific to the Lidar sensors)
+  if (maxProba < NewGaussianThreshold)
+  {
+    // The pixel is full, remove the gaussian updated the least recently
+    if (count == this->K)
+    {
+      size_t oldest = first;
+      for (size_t i = first + 1; i < first + count; ++i)
+      {
+        if (this->TTLClock - this->LastUpdate[i] > this->TTLClock - this->LastUpdate[oldest])
+        {
+          oldest = i;
+        }
+      }
+      for (size_t i = oldest; i + 1 < first + count; ++i)
+      {
+        this->Mean[i] = this->Mean[i + 1];
+        this->Sigma[i] = this->Sigma[i + 1];
+        this->N[i] = this->N[i + 1];
+        this->LastUpdate[i] = this->LastUpdate[i + 1];
+      }
+      count--;
+    }
+
+    const size_t i = first + count;
+    this->Mean[i] = x;
+    this->Sigma[i] = this->InitialSigma;
+    this->N[i] = 1;
+    this->LastUpdate[i] = this->TTLClock;
+    this->NumberOfGaussians[pixel] = static_cast<uint8_t>(count + 1);
+    return;
+  }
+
+  // update the mean
+  const double n = static_cast<double>(this->N[best]);
+  const double oldMean = this->Mean[best];
+  this->Mean[best] = (n * oldMean + x) / (n + 1);
+
+  // update the standard deviation
+  this->Sigma[best] = std::sqrt((n * this->Sigma[best] * this->Sigma[best] +
+    (x - oldMean) * (x - this->Mean[best])) / (n + 1));
+
+  // reset the TTL to its maximum and update the number of sample
+  this->LastUpdate[best] = this->TTLClock;
+  this->N[best] += 1;
 }
 
 //----------------------------------------------------------------------------
 void vtkSphericalMap::AddPoint(unsigned int idxTheta, unsigned int idxPhi, double valueDepth)
 {
-  if (idxTheta > this->NTheta || idxPhi > this->NPhi)
+  if (idxTheta >= this->NTheta || idxPhi >= this->NPhi)
   {
     std::cout << "Error, required values out of bounds" << std::endl;
     std::cout << "[" << idxTheta << "," << idxPhi << "] / [" << this->NTheta << "," << this->NPhi << "]" << std::endl;
@@ -313,72 +325,179 @@ void vtkSphericalMap::AddPoint(unsigned int idxTheta, unsigned int idxPhi, doubl
   }
 
   // fill the mixture gaussian
-  this->Map[idxTheta + this->NTheta * idxPhi].AddPoint(valueDepth);
+  const unsigned int pixel = idxTheta + this->NTheta * idxPhi;
+  this->RemoveDeadGaussians(pixel);
+  this->AddDepth(pixel, valueDepth);
+}
+
+//----------------------------------------------------------------------------
+void vtkSphericalMap::UpdatePixels(size_t begin, size_t end, double* motion)
+{
+  for (size_t j = begin; j < end; ++j)
+  {
+    const size_t firstPoint = this->TouchedPixels[j];
+    const size_t lastPoint = this->TouchedPixels[j + 1];
+    const unsigned int pixel =
+      static_cast<unsigned int>(this->PointPixel[this->SortedPoints[firstPoint]]);
+    this->RemoveDeadGaussians(pixel);
+
+    // The points of a pixel are in the frame order, as when
+    // they are added one by one
+    for (size_t k = firstPoint; k < lastPoint; ++k)
+    {
+      const uint32_t pointId = this->SortedPoints[k];
+      const double depth = this->PointDepth[pointId];
+
+      // Evaluate the mixture model on the current data
+      // it return the "probability" of the point to be
+      // a point in motion
+      motion[pointId] = this->Evaluate(pixel, depth);
+
+      // Add the depth to the correct "pixel"
+      this->AddDepth(pixel, depth);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void vtkSphericalMap::AddFrame(vtkSmartPointer<vtkPolyData> polydata)
+{
+  vtkSmartPointer<vtkDoubleArray> Phi = vtkSmartPointer<vtkDoubleArray>::New();
+  vtkSmartPointer<vtkDoubleArray> Theta = vtkSmartPointer<vtkDoubleArray>::New();
+  vtkSmartPointer<vtkDoubleArray> Motion = vtkSmartPointer<vtkDoubleArray>::New();
+  Phi->SetName("Phi");
+  Theta->SetName("Theta");
+  Motion->SetName("Motion_Probability");
+
+  const size_t nbPoints = static_cast<size_t>(polydata->GetNumberOfPoints());
+  if (nbPoints > std::numeric_limits<uint32_t>::max())
+  {
+    std::cout << "Error, too many points in the frame" << std::endl;
+    return;
+  }
+  Phi->SetNumberOfTuples(nbPoints);
+  Theta->SetNumberOfTuples(nbPoints);
+  Motion->SetNumberOfTuples(nbPoints);
+  double* phiOut = Phi->GetPointer(0);
+  double* thetaOut = Theta->GetPointer(0);
+  double* motionOut = Motion->GetPointer(0);
+
+  // Read the points in place when possible
+  vtkDataArray* points = nbPoints > 0 ? polydata->GetPoints()->GetData() : nullptr;
+  vtkSmartPointer<vtkDoubleArray> convertedPoints;
+  if (points && points->GetDataType() != VTK_FLOAT && points->GetDataType() != VTK_DOUBLE)
+  {
+    convertedPoints = vtkSmartPointer<vtkDoubleArray>::New();
+    convertedPoints->DeepCopy(points);
+    points = convertedPoints;
+  }
+  const float* floatPoints = (points && points->GetDataType() == VTK_FLOAT)
+    ? static_cast<const float*>(points->GetVoidPointer(0)) : nullptr;
+  const double* doublePoints = (points && points->GetDataType() == VTK_DOUBLE)
+    ? static_cast<const double*>(points->GetVoidPointer(0)) : nullptr;
+
+  // Change of base to the local reference frame
+  Eigen::Matrix<double, 3, 3> R;
+  R << this->ex(0), this->ey(0), this->ez(0),
+       this->ex(1), this->ey(1), this->ez(1),
+       this->ex(2), this->ey(2), this->ez(2);
+  const Eigen::Matrix<double, 3, 3> Rt = R.transpose();
+  const Eigen::Matrix<double, 3, 1> center = this->C;
+
+  const int threads =
+    ParallelTools::GetNumberOfThreadsToUse(this->NumberOfThreads, nbPoints, MinPointsPerThread);
+
+  // Compute the spherical coordinates and the pixel of each point
+  this->PointPixel.resize(nbPoints);
+  this->PointDepth.resize(nbPoints);
+  ParallelTools::ParallelFor(nbPoints, 1024, threads, [&](size_t begin, size_t end) {
+    for (size_t k = begin; k < end; ++k)
+    {
+      Eigen::Matrix<double, 3, 1> X;
+      if (floatPoints)
+      {
+        X << floatPoints[3 * k], floatPoints[3 * k + 1], floatPoints[3 * k + 2];
+      }
+      else
+      {
+        X << doublePoints[3 * k], doublePoints[3 * k + 1], doublePoints[3 * k + 2];
+      }
+      const Eigen::Matrix<double, 3, 1> CX = Rt * (X - center);
+      double r, theta, phi;
+      ToSpherical(CX(0), CX(1), CX(2), r, theta, phi);
+
+      thetaOut[k] = theta * 180.0 / vtkMath::Pi();
+      phiOut[k] = phi * 180.0 / vtkMath::Pi();
+      this->PointDepth[k] = r;
+      if (!std::isfinite(r))
+      {
+        // Invalid points (NaN) are not added to the map
+        this->PointPixel[k] = -1;
+        motionOut[k] = std::numeric_limits<double>::quiet_NaN();
+        continue;
+      }
+
+      // Convert spherical coordinates to
+      // spherical map coordinates. theta = pi
+      // is the same direction as -pi and phi = pi
+      // belongs to the last row
+      int64_t idxPhi = static_cast<int64_t>(std::floor((phi - this->PhiBounds[0]) / this->dPhi));
+      int64_t idxTheta = static_cast<int64_t>(std::floor((theta - this->ThetaBounds[0]) / this->dTheta));
+      idxPhi = std::max<int64_t>(0, std::min<int64_t>(idxPhi, this->NPhi - 1));
+      idxTheta = (idxTheta >= this->NTheta || idxTheta < 0) ? 0 : idxTheta;
+      this->PointPixel[k] = idxTheta + static_cast<int64_t>(this->NTheta) * idxPhi;
+    }
+  });
+
+  // Sort the points by pixel, keeping their order inside each pixel
+  const size_t nbPixels = this->NumberOfGaussians.size();
+  this->PixelStart.assign(nbPixels + 1, 0);
+  for (int64_t pixel : this->PointPixel)
+  {
+    if (pixel >= 0)
+    {
+      ++this->PixelStart[pixel + 1];
+    }
+  }
+  this->TouchedPixels.clear();
+  for (size_t pixel = 0; pixel < nbPixels; ++pixel)
+  {
+    if (this->PixelStart[pixel + 1] > 0)
+    {
+      this->TouchedPixels.push_back(this->PixelStart[pixel]);
+    }
+    this->PixelStart[pixel + 1] += this->PixelStart[pixel];
+  }
+  this->TouchedPixels.push_back(this->PixelStart[nbPixels]);
+  this->SortedPoints.resize(this->PixelStart[nbPixels]);
+  for (size_t k = 0; k < nbPoints; ++k)
+  {
+    const int64_t pixel = this->PointPixel[k];
+    if (pixel >= 0)
+    {
+      this->SortedPoints[this->PixelStart[pixel]++] = static_cast<uint32_t>(k);
+    }
+  }
+
+  // Update the pixels in parallel, each one being updated by a single thread
+  ParallelTools::ParallelFor(this->TouchedPixels.size() - 1, 64, threads, [&](size_t begin, size_t end) {
+    this->UpdatePixels(begin, end, motionOut);
+  });
+
+  // Time to live of the gaussians
+  this->UpdateTTL();
+
+  polydata->GetPointData()->AddArray(Phi);
+  polydata->GetPointData()->AddArray(Theta);
+  polydata->GetPointData()->AddArray(Motion);
+
+  this->AddedFrames += 1;
 }
 
 //----------------------------------------------------------------------------
- void vtkSphericalMap::AddFrame(vtkSmartPointer<vtkPolyData> polydata)
- {
-   vtkSmartPointer<vtkDoubleArray> Phi = vtkSmartPointer<vtkDoubleArray>::New();
-   vtkSmartPointer<vtkDoubleArray> Theta = vtkSmartPointer<vtkDoubleArray>::New();
-   vtkSmartPointer<vtkDoubleArray> Motion = vtkSmartPointer<vtkDoubleArray>::New();
-   Phi->SetName("Phi");
-   Theta->SetName("Theta");
-   Motion->SetName("Motion_Probability");
-
-   double point[3];
-   Eigen::Matrix<double, 3, 1> cartesianPoint;
-   Eigen::Matrix<double, 3, 1> sphericalPoint;
-
-   for (unsigned int k = 0; k < polydata->GetNumberOfPoints(); ++k)
-   {
-     // Get point and compute its spherical coordinates
-     polydata->GetPoint(k, point);
-     cartesianPoint << point[0], point[1], point[2];
-     sphericalPoint = this->GetSphericalCoordinates(cartesianPoint);
-
-     // Convert spherical coordinates to
-     // spherical map coordinates
-     unsigned int idxPhi = static_cast<int>(std::floor((sphericalPoint(2) - this->PhiBounds[0]) / this->dPhi));
-     unsigned int idxTheta = static_cast<int>(std::floor((sphericalPoint(1) - this->ThetaBounds[0]) / this->dTheta));
-
-     // Evaluate the mixture model on the current data
-     // it return the "probability" of the point to be
-     // a point in motion
-     double proba = this->Map[idxTheta + this->NTheta * idxPhi].Evaluate(sphericalPoint(0));
-
-     // Add the depth to the correct "pixel"
-     this->AddPoint(idxTheta, idxPhi, sphericalPoint(0));
-
-     double theta = this->ThetaBounds[0] + idxTheta * this->dTheta;
-     double phi = this->PhiBounds[0] + idxPhi * this->dPhi;
-     double r = sphericalPoint(0);
-
-     point[0] = r * std::sin(phi) * std::cos(theta);
-     point[1] = r * std::sin(phi) * std::sin(theta);
-     point[2] = r * std::cos(phi);
-     //polydata->GetPoints()->SetPoint(k, point);
-
-     Theta->InsertNextTuple1(sphericalPoint(1) * 180.0 / vtkMath::Pi());
-     Phi->InsertNextTuple1(sphericalPoint(2) * 180.0 / vtkMath::Pi());
-     Motion->InsertNextTuple1(proba);
-   }
-
-   // Time to live of the gaussians
-   this->UpdateTTL();
-
-   polydata->GetPointData()->AddArray(Phi);
-   polydata->GetPointData()->AddArray(Theta);
-   polydata->GetPointData()->AddArray(Motion);
-
-   this->AddedFrames += 1;
- }
-
- //----------------------------------------------------------------------------
- void vtkSphericalMap::UpdateTTL()
- {
-   for (unsigned int k = 0; k < this->Map.size(); ++k)
-   {
-     this->Map[k].UpdateTTL();
-   }
- }
+void vtkSphericalMap::UpdateTTL()
+{
+  // The gaussians whose time to live is over are
+  // removed when their pixel is visited again
+  this->TTLClock += 1;
+}
@@ -39,84 +39,13 @@
 #include <Eigen/Dense>
 
 // STD
+#include <cstdint>
 #include <vector>
 #include <cmath>
-#include <list>
 
-class Gaussian
-{
-public:
-  Gaussian();
-  double operator()(double x);
-
-  // set the mean
-  void SetMean(double mean);
-
-  // update parameters using new value
-  void UpdateParam(double x);
-
-  // Update the time to live
-  // return false if ttl falls
-  // to zero value
-  bool UpdateTTL();
-
-  // return sigma value
-  double GetSigma();
-
-private:
-  // mean of the gaussian
-  double Mean;
-
-  // standard deviation of the gaussian
-  double Sigma;
-
-  // number of points
-  unsigned int N;
-
-  // Time to live of the gaussian
-  int TTL;
-
-  // Maximum number of the TTL
-  int MaxTTL;
-};
-
-class GaussianMixture
-{
-public:
-  // default constructor
-  GaussianMixture();
-
-  // Evaluation
-  double operator()(double x);
+#include "LidarCoreModule.h"
 
-  // Add a data
-  void AddPoint(double x);
-
-  // return the number of points
-  unsigned int GetNumberOfPoints();
-
-  // Update the time to live
-  // of the gaussians composing
-  // the gaussian mixture model
-  void UpdateTTL();
-
-  // Evaluate the probability
-  // of a point to be in motion
-  double Evaluate(double x);
-
-private:
-  // mean of the gaussian
-  double mean;
-
-  // standard deviation of the gaussian
-  double sigma;
-
-  // points in the distribution
-  std::list<Gaussian> Gaussians;
-};
-
-
-class vtkSphericalMap
+class LIDARCORE_EXPORT vtkSphericalMap
 {
 public:
   // default constructor
@@ -150,7 +79,33 @@ public:
   // Set the sensor RPM
   void SetSensorRPM(double rpm);
 
+  // Getter / Setter of the maximum number of gaussians
+  // of each pixel. When a new mode appears in a full pixel,
+  // it replaces the gaussian updated the least recently
+  void SetMaximumNumberOfGaussians(unsigned int k);
+  unsigned int GetMaximumNumberOfGaussians();
+
+  // Number of threads used, 0 to use all the cores
+  void SetNumberOfThreads(int threads);
+  int GetNumberOfThreads();
+
 private:
+  // Remove the gaussians of a pixel whose time to live is over.
+  // The gaussians are removed lazily, when their pixel is visited,
+  // instead of walking the whole map at each frame
+  void RemoveDeadGaussians(unsigned int pixel);
+
+  // Return the highest density of the gaussians of a pixel at x,
+  // 0 if there is none
+  double Evaluate(unsigned int pixel, double x) const;
+
+  // Add a depth to a pixel: update its most likely gaussian,
+  // or create a new one if x is beyond 3 sigma of all of them
+  void AddDepth(unsigned int pixel, double x);
+
+  // Update the pixels of the points [begin, end) of SortedPoints
+  void UpdatePixels(size_t begin, size_t end, double* motion);
+
   // Number of sample points along
   // Phi parameter (vertical angle
   // between 90 and -90 degrees)
@@ -184,8 +139,34 @@ private:
   // processed by the algorithm
   unsigned int AddedFrames;
 
-  // The spherical map
-  std::vector<GaussianMixture> Map;
+  // The spherical map: a mixture of at most K gaussians per pixel,
+  // stored as flat arrays, the gaussians of pixel p being
+  // at [p * K, p * K + NumberOfGaussians[p])
+  unsigned int K;
+  std::vector<double> Mean;
+  std::vector<double> Sigma;
+  std::vector<uint32_t> N;
+  // Value of TTLClock when the gaussian was last updated
+  std::vector<uint32_t> LastUpdate;
+  std::vector<uint8_t> NumberOfGaussians;
+
+  // Number of UpdateTTL calls, a gaussian dies
+  // MaxTTL + 1 calls after its last update
+  uint32_t TTLClock;
+
+  // Parameters of the new gaussians
+  double InitialSigma;
+  uint32_t MaxTTL;
+
+  int NumberOfThreads;
+
+  // Buffers kept between the frames, the points of the
+  // current frame are sorted by pixel to update the pixels in parallel
+  std::vector<int64_t> PointPixel;    // -1 for the invalid points
+  std::vector<double> PointDepth;
+  std::vector<size_t> PixelStart;     // first point of each pixel in SortedPoints
+  std::vector<uint32_t> SortedPoints;
+  std::vector<size_t> TouchedPixels;  // first point of each non empty pixel in SortedPoints
 
   // Base of R3 used. in some
   // case it can be changed
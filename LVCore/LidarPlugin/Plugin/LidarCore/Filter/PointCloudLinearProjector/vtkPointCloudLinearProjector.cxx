@@ -28,8 +28,11 @@
 #include <vtkImageData.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkDoubleArray.h>
@@ -88,6 +91,51 @@ int vtkPointCloudLinearProjector::RequestInformation(vtkInformation *vtkNotUsed(
   return VTK_OK;
 }
 
+//------------------------------------------------------------------------------
+namespace
+{
+struct LinearProjection
+{
+  double HorizontalResolution; // radians
+  double VerticalResolution;   // radians
+  double MinX;
+  double MinY;
+  double Scale;
+};
+
+template <typename T>
+void MapLinearProjection(RangeImageBuilder& builder, const T* points, vtkIdType numberOfPoints,
+  const LinearProjection& projection)
+{
+  builder.MapPoints(numberOfPoints, [&](vtkIdType indexPoint) {
+    const double x_lidar = points[3 * indexPoint];
+    const double y_lidar = points[3 * indexPoint + 1];
+    const double z_lidar = points[3 * indexPoint + 2];
+    const double d_lidar = std::sqrt(x_lidar * x_lidar + y_lidar * y_lidar + z_lidar * z_lidar);
+    double x_img;
+    if (y_lidar > 0)
+    {
+      x_img = std::atan2(-y_lidar, x_lidar) / projection.HorizontalResolution;
+    }
+    else
+    {
+      x_img = (-std::atan2(y_lidar, x_lidar)) / projection.HorizontalResolution;
+    }
+    double y_img = std::atan2(z_lidar, d_lidar) / projection.VerticalResolution;
+    x_img -= projection.MinX;
+    y_img -= projection.MinY;
+    // Points out of the image, or not finite, are dropped
+    const double x = x_img * projection.Scale;
+    const double y = y_img * projection.Scale + 15;
+    if (!(x > -1. && x < VTK_INT_MAX && y > -1. && y < VTK_INT_MAX))
+    {
+      return std::make_pair(-1, -1);
+    }
+    return std::make_pair(static_cast<int>(x), static_cast<int>(y));
+  });
+}
+}
+
 //------------------------------------------------------------------------------
 int vtkPointCloudLinearProjector::RequestData(vtkInformation* vtkNotUsed(request),
   vtkInformationVector** inputVector,
@@ -97,11 +145,13 @@ int vtkPointCloudLinearProjector::RequestData(vtkInformation* vtkNotUsed(request
     double v_fov = 15;
     double h_res = 0.1;
     double v_res = 0.2;
-    double v_res_rad = v_res * (vtkMath::Pi() / 180);
-    double h_res_rad = h_res * (vtkMath::Pi() / 180);
-    double x_min = -h_fov / h_res / 2;
+    LinearProjection projection;
+    projection.VerticalResolution = v_res * (vtkMath::Pi() / 180);
+    projection.HorizontalResolution = h_res * (vtkMath::Pi() / 180);
+    projection.MinX = -h_fov / h_res / 2;
+    projection.MinY = -v_fov / v_res;
+    projection.Scale = this->Scale;
     double x_max = h_fov / h_res;
-    double y_min = -v_fov / v_res;
     double y_max = v_fov * 2 / v_res - 30;
     this->Width = std::floor(x_max + 1);
     this->Height = std::floor(y_max + 1);
@@ -111,37 +161,46 @@ int vtkPointCloudLinearProjector::RequestData(vtkInformation* vtkNotUsed(request
     outputImage->SetSpacing(this->Spacing);
     outputImage->SetOrigin(this->Origin);
     outputImage->AllocateScalars(VTK_DOUBLE, 1);
-    unsigned char* dataPointer = static_cast<unsigned char*>(outputImage->GetScalarPointer());
-    std::fill(dataPointer, dataPointer + this->Height * this->Width, 0);
     vtkDataArray* arrayToUse = this->GetInputArrayToProcess(0, inputVector);
     if (!arrayToUse)
     {
         vtkErrorMacro("No input array selected!");
         return 0;
     }
-    for (unsigned int indexPoint = 0; indexPoint < input->GetNumberOfPoints(); ++indexPoint)
+
+    // Compute the pixel of each point in parallel, then write the image buffer
+    // directly, the pixels without points are set to 0
+    this->Builder.SetNumberOfThreads(this->NumberOfThreads);
+    this->Builder.SetDimensions(this->Width, this->Height);
+    vtkDataArray* points = input->GetPoints() ? input->GetPoints()->GetData() : nullptr;
+    const vtkIdType numberOfPoints = points ? points->GetNumberOfTuples() : 0;
+    if (points && points->GetDataType() == VTK_FLOAT)
     {
-        double points[3];
-        input->GetPoint(indexPoint, points);
-        double x_lidar = points[0];
-        double y_lidar = points[1];
-        double z_lidar = points[2];
-        double d_lidar = std::sqrt(x_lidar * x_lidar + y_lidar * y_lidar + z_lidar * z_lidar);
-        double x_img;
-        if(y_lidar > 0) {
-            x_img = std::atan2(-y_lidar, x_lidar) / h_res_rad;
-        }
-        else {
-            x_img = (- std::atan2(y_lidar, x_lidar)) / h_res_rad;
+        MapLinearProjection(this->Builder, static_cast<const float*>(points->GetVoidPointer(0)),
+          numberOfPoints, projection);
+    }
+    else if (points && points->GetDataType() == VTK_DOUBLE)
+    {
+        MapLinearProjection(this->Builder, static_cast<const double*>(points->GetVoidPointer(0)),
+          numberOfPoints, projection);
+    }
+    else
+    {
+        // Seldom used point types are converted
+        vtkNew<vtkDoubleArray> converted;
+        if (points)
+        {
+            converted->DeepCopy(points);
         }
-        double y_img = std::atan2(z_lidar, d_lidar) / v_res_rad;
-        x_img -= x_min;
-        y_img -= y_min;
-        int x = x_img * this->Scale;
-        int y = y_img * this->Scale + 15;
-//        outputImage->SetScalarComponentFromDouble(x, y, 0, 0, d_lidar);
-//        outputImage->SetScalarComponentFromDouble(x, y + 50, 0, 0, z_lidar + 100);
-        outputImage->SetScalarComponentFromDouble(x, y, 0, 0, arrayToUse->GetTuple1(indexPoint));
+        MapLinearProjection(this->Builder, converted->GetPointer(0), numberOfPoints, projection);
+    }
+
+    this->Builder.ClearChannels();
+    this->Builder.AddValueChannel(arrayToUse, outputImage->GetPointData()->GetScalars());
+    if (!this->Builder.Fill())
+    {
+        vtkErrorMacro("The selected array must have one value per point!");
+        return 0;
     }
     return VTK_OK;
 }
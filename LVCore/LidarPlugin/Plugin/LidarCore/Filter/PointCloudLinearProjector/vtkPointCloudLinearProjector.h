@@ -26,6 +26,7 @@
 #include <Eigen/Dense>
 
 #include "LidarCoreModule.h"
+#include "RangeImageBuilder.h"
 
 /**
  * @brief vtkPointCloudLinearProjector Projects a 3D point cloud
@@ -60,6 +61,9 @@ public:
   vtkGetMacro(MedianFilterWidth, int)
   vtkSetMacro(MedianFilterWidth, int)
 
+  vtkGetMacro(NumberOfThreads, int)
+  vtkSetMacro(NumberOfThreads, int)
+
   // set the plane normal coordinates on which points are projected
   void SetPlaneNormal(double w0, double w1, double w2);
 
@@ -112,6 +116,10 @@ private:
   double Origin[3] = {-50,-5,0};
   ///! Scale of the image
   double Scale = 0.6;
+
+  // Number of threads used to fill the image, 0 to use all the cores
+  int NumberOfThreads = 0;
+  RangeImageBuilder Builder;
 };
 
 #endif // VTK_POINTCLOUD_LINEAR_PROJECTOR_H
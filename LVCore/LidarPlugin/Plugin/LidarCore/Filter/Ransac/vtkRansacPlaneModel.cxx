@@ -19,8 +19,14 @@
 #include "vtkConversions.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <numeric>
 #include <random>
+#include <thread>
 
 #include <vtkPointData.h>
 #include <vtkInformationVector.h>
@@ -51,57 +57,59 @@ struct RansacSampleInfo
 };
 
 //----------------------------------------------------------------------------
-void RefineRansac(std::vector<Eigen::Vector3d >& Points, vtkPolyData* output,
-                  RansacSampleInfo sampleInfo, double threshold, double PlaneParam[4])
+void RefinePlane(std::vector<Eigen::Vector3d >& Points, vtkPolyData* output,
+                 Eigen::Vector3d pointPlane, Eigen::Vector3d normalPlane, double threshold,
+                 unsigned int iterations, double PlaneParam[4])
 {
   // Create inliers / outliers array information
   vtkNew<vtkUnsignedIntArray> inliersArray;
   inliersArray->SetName("ransac_plane_inliers");
+  inliersArray->SetNumberOfValues(Points.size());
 
-  // compute plane PlaneParameters
-  Eigen::Vector3d pointPlane = Points[sampleInfo.Index1];
-  Eigen::Vector3d normalPlane = (Points[sampleInfo.Index3] - pointPlane).cross(Points[sampleInfo.Index2] - pointPlane);
-  normalPlane.normalize();
-
-  // compute inliers
   std::vector<Eigen::Vector3d > inliersPoints;
-  for (unsigned int k = 0; k < Points.size(); ++k)
+  for (unsigned int iteration = 0; iteration < std::max(1u, iterations); ++iteration)
   {
-    if (std::abs((Points[k] - pointPlane).dot(normalPlane)) < threshold)
+    // compute inliers
+    inliersPoints.clear();
+    for (unsigned int k = 0; k < Points.size(); ++k)
     {
-      inliersPoints.push_back(Points[k]);
-      inliersArray->InsertNextValue(1);
+      const bool isInlier = std::abs((Points[k] - pointPlane).dot(normalPlane)) < threshold;
+      if (isInlier)
+      {
+        inliersPoints.push_back(Points[k]);
+      }
+      inliersArray->SetValue(k, isInlier ? 1 : 0);
     }
-    else
+    if (inliersPoints.empty())
     {
-      inliersArray->InsertNextValue(0);
+      break;
     }
-  }
 
-  // Now, compute the best plane using all inliers
-  Eigen::MatrixXd centeredSamples(3, inliersPoints.size());
-  Eigen::Vector3d center = Eigen::Vector3d::Zero();
-  for (unsigned int k = 0; k < inliersPoints.size(); ++k)
-  {
-    centeredSamples.col(k) = inliersPoints[k];
-    center += inliersPoints[k];
-  }
-  center /= static_cast<double>(inliersPoints.size());
-  for (unsigned int k = 0; k < inliersPoints.size(); ++k)
-  {
-    centeredSamples.col(k) -= center;
-  }
-  Eigen::Matrix3d varianceCovariance = centeredSamples * centeredSamples.transpose();
-  varianceCovariance /= static_cast<double>(inliersPoints.size());
+    // Now, compute the best plane using all inliers
+    Eigen::MatrixXd centeredSamples(3, inliersPoints.size());
+    Eigen::Vector3d center = Eigen::Vector3d::Zero();
+    for (unsigned int k = 0; k < inliersPoints.size(); ++k)
+    {
+      centeredSamples.col(k) = inliersPoints[k];
+      center += inliersPoints[k];
+    }
+    center /= static_cast<double>(inliersPoints.size());
+    for (unsigned int k = 0; k < inliersPoints.size(); ++k)
+    {
+      centeredSamples.col(k) -= center;
+    }
+    Eigen::Matrix3d varianceCovariance = centeredSamples * centeredSamples.transpose();
+    varianceCovariance /= static_cast<double>(inliersPoints.size());
 
-  // since the variance covariance matrix is a real
-  // symmetric matrix it can be diagonalized in a orthonormal
-  // basis. We will use the AutoAdjoint eigen solver
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d > eigenSolver(varianceCovariance);
+    // since the variance covariance matrix is a real
+    // symmetric matrix it can be diagonalized in a orthonormal
+    // basis. We will use the AutoAdjoint eigen solver
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d > eigenSolver(varianceCovariance);
 
-  // PlaneParameters
-  normalPlane = eigenSolver.eigenvectors().col(0);
-  pointPlane = center;
+    // PlaneParameters
+    normalPlane = eigenSolver.eigenvectors().col(0);
+    pointPlane = center;
+  }
   PlaneParam[0] = normalPlane(0);
   PlaneParam[1] = normalPlane(1);
   PlaneParam[2] = normalPlane(2);
@@ -110,6 +118,18 @@ void RefineRansac(std::vector<Eigen::Vector3d >& Points, vtkPolyData* output,
   output->GetPointData()->AddArray(inliersArray.Get());
 }
 
+//----------------------------------------------------------------------------
+void RefineRansac(std::vector<Eigen::Vector3d >& Points, vtkPolyData* output,
+                  RansacSampleInfo sampleInfo, double threshold, unsigned int iterations,
+                  double PlaneParam[4])
+{
+  // compute plane PlaneParameters
+  Eigen::Vector3d pointPlane = Points[sampleInfo.Index1];
+  Eigen::Vector3d normalPlane = (Points[sampleInfo.Index3] - pointPlane).cross(Points[sampleInfo.Index2] - pointPlane);
+  normalPlane.normalize();
+
+  RefinePlane(Points, output, pointPlane, normalPlane, threshold, iterations, PlaneParam);
+}
 
 //----------------------------------------------------------------------------
 unsigned int ComputeNumberOfInlier(std::vector<Eigen::Vector3d >& Points, Eigen::Vector3d planePoint,
@@ -127,6 +147,191 @@ unsigned int ComputeNumberOfInlier(std::vector<Eigen::Vector3d >& Points, Eigen:
   return nInliers;
 }
 
+//----------------------------------------------------------------------------
+// Written on flat arrays so that the compiler can vectorize it
+unsigned int CountInliers(const float* x, const float* y, const float* z, size_t nbPoints,
+                          const float plane[4], float threshold)
+{
+  unsigned int nInliers = 0;
+  for (size_t k = 0; k < nbPoints; ++k)
+  {
+    const float distance = plane[0] * x[k] + plane[1] * y[k] + plane[2] * z[k] + plane[3];
+    nInliers += std::abs(distance) < threshold ? 1 : 0;
+  }
+  return nInliers;
+}
+
+//----------------------------------------------------------------------------
+// Small random generator, so that each plane sample is drawn from its own seed
+uint64_t SplitMix64(uint64_t& state)
+{
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+//----------------------------------------------------------------------------
+struct FastRansacResult
+{
+  RansacSampleInfo BestSample = RansacSampleInfo(0, 0, 0, 0);
+  unsigned int NIterations = 0;
+  bool HasConverged = false;
+};
+
+//----------------------------------------------------------------------------
+/**
+ * Ransac loop where:
+ * - the samples are scored in parallel, on centered float copies of the points
+ * - each sample is first scored on a random subset of the points, and rejected
+ *   if its inlier ratio is more than 3 standard deviations below the best one
+ * - the loop stops once a sample of inliers has been drawn with the required
+ *   confidence, given the best inlier ratio found so far
+ */
+FastRansacResult FastRansac(const std::vector<Eigen::Vector3d>& Points, double threshold,
+                            unsigned int maxIterations, double ratioInliersRequired,
+                            double confidence, unsigned int preemptiveSampleSize,
+                            int numberOfThreads)
+{
+  const size_t nbPoints = Points.size();
+  FastRansacResult result;
+
+  // Centered float copies of the points, as structure of arrays
+  Eigen::Vector3d center = Eigen::Vector3d::Zero();
+  for (const auto& point : Points)
+  {
+    center += point;
+  }
+  center /= static_cast<double>(nbPoints);
+  std::vector<float> x(nbPoints), y(nbPoints), z(nbPoints);
+  for (size_t k = 0; k < nbPoints; ++k)
+  {
+    x[k] = static_cast<float>(Points[k].x() - center.x());
+    y[k] = static_cast<float>(Points[k].y() - center.y());
+    z[k] = static_cast<float>(Points[k].z() - center.z());
+  }
+
+  std::random_device rd;
+  std::mt19937 g(rd());
+  const uint64_t seed = (static_cast<uint64_t>(g()) << 32) | g();
+
+  // Random subset of the points used to reject the bad samples early
+  const size_t subsetSize = preemptiveSampleSize < nbPoints ? preemptiveSampleSize : 0;
+  std::vector<float> subsetX(subsetSize), subsetY(subsetSize), subsetZ(subsetSize);
+  if (subsetSize > 0)
+  {
+    std::vector<unsigned int> indices(nbPoints);
+    std::iota(indices.begin(), indices.end(), 0);
+    for (size_t k = 0; k < subsetSize; ++k)
+    {
+      std::uniform_int_distribution<size_t> draw(k, nbPoints - 1);
+      std::swap(indices[k], indices[draw(g)]);
+      subsetX[k] = x[indices[k]];
+      subsetY[k] = y[indices[k]];
+      subsetZ[k] = z[indices[k]];
+    }
+  }
+
+  std::mutex mutex;
+  std::atomic<unsigned int> nextSample(0);
+  std::atomic<unsigned int> nbSamples(maxIterations);
+  std::atomic<unsigned int> bestInliers(0);
+  std::atomic<unsigned int> iterationsMade(0);
+  std::atomic<bool> stop(false);
+  unsigned int bestSampleIndex = std::numeric_limits<unsigned int>::max();
+
+  auto worker = [&]() {
+    for (unsigned int sample = nextSample++; sample < nbSamples && !stop; sample = nextSample++)
+    {
+      ++iterationsMade;
+
+      // Draw 3 different points
+      uint64_t state = seed + sample * 0xD1B54A32D192ED03ULL;
+      unsigned int index[3];
+      for (int i = 0; i < 3; ++i)
+      {
+        do
+        {
+          index[i] = static_cast<unsigned int>(SplitMix64(state) % nbPoints);
+        } while ((i > 0 && index[i] == index[0]) || (i > 1 && index[i] == index[1]));
+      }
+
+      const Eigen::Vector3d planePoint = Points[index[0]] - center;
+      Eigen::Vector3d planeNormal = (Points[index[2]] - center - planePoint).cross(Points[index[1]] - center - planePoint);
+      if (planeNormal.norm() < std::numeric_limits<double>::epsilon())
+      {
+        continue;
+      }
+      planeNormal.normalize();
+      const float plane[4] = { static_cast<float>(planeNormal.x()), static_cast<float>(planeNormal.y()),
+                               static_cast<float>(planeNormal.z()), static_cast<float>(-planeNormal.dot(planePoint)) };
+
+      if (subsetSize > 0)
+      {
+        const double bestRatio = static_cast<double>(bestInliers) / nbPoints;
+        const double expected = bestRatio * subsetSize;
+        const double margin = 3. * std::sqrt(subsetSize * bestRatio * (1. - bestRatio));
+        const unsigned int subsetInliers = CountInliers(subsetX.data(), subsetY.data(), subsetZ.data(),
+                                                        subsetSize, plane, threshold);
+        if (subsetInliers < expected - margin)
+        {
+          continue;
+        }
+      }
+
+      const unsigned int nInliers = CountInliers(x.data(), y.data(), z.data(), nbPoints, plane, threshold);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (nInliers > result.BestSample.NInliers ||
+          (nInliers == result.BestSample.NInliers && sample < bestSampleIndex))
+      {
+        result.BestSample = RansacSampleInfo(nInliers, index[0], index[1], index[2]);
+        bestSampleIndex = sample;
+        bestInliers = nInliers;
+      }
+
+      // Check that the number of inliers is enought to
+      // break the ransac algorithm loop
+      if (nInliers > nbPoints * ratioInliersRequired)
+      {
+        result.HasConverged = true;
+        stop = true;
+      }
+
+      // Number of samples needed to draw 3 inliers with the required confidence
+      const double inlierRatio = static_cast<double>(result.BestSample.NInliers) / nbPoints;
+      const double outlierSampleProbability = 1. - inlierRatio * inlierRatio * inlierRatio;
+      if (confidence < 1. && inlierRatio > 0.)
+      {
+        const double required = outlierSampleProbability > 0.
+          ? std::ceil(std::log(1. - confidence) / std::log(outlierSampleProbability))
+          : 1.;
+        if (required < nbSamples)
+        {
+          nbSamples = std::max(static_cast<unsigned int>(required), sample + 1);
+        }
+      }
+    }
+  };
+
+  unsigned int nbThreads = numberOfThreads > 0 ? numberOfThreads : std::thread::hardware_concurrency();
+  // Not worth it on small clouds
+  nbThreads = std::max(1u, std::min(nbThreads, static_cast<unsigned int>(nbPoints / 10000) + 1));
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < nbThreads; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  result.NIterations = iterationsMade;
+  return result;
+}
+
 // Implementation of the New function
 vtkStandardNewMacro(vtkRansacPlaneModel)
 
@@ -148,87 +353,115 @@ int vtkRansacPlaneModel::RequestData(vtkInformation *vtkNotUsed(request),
   // Convert the point cloud in Eigen data structure point cloud
   std::vector<Eigen::Vector3d> Points = vtkPointsToEigenVector(input->GetPoints());
 
-  // Create a random order of points index
-  std::vector<double> randomIndex(input->GetNumberOfPoints(), 0);
-  for (unsigned int k = 0; k < randomIndex.size(); ++k)
+  if (Points.size() < 3)
   {
-    randomIndex[k] = k;
+    vtkWarningMacro("At least 3 points are required to fit a plane");
+    return 1;
   }
-  std::random_device rd;
-  std::mt19937 g(rd());
-  std::shuffle(randomIndex.begin(), randomIndex.end(), g);
 
   // information variable about ransac iterations
-  bool shouldStopRansac = false;
   unsigned int iterationMade = 0;
-  unsigned int iterationPointer = 0;
-
-  // keep information of iterations
-  std::vector<RansacSampleInfo> samplesInfo;
   unsigned int maxInliers = 0;
-  unsigned int indexMaxInliers = 0;
-
-  // Affine plane PlaneParameters
-  Eigen::Vector3d planeNormal, planePoint;
+  RansacSampleInfo bestSample(0, 0, 0, 0);
 
   // indicate if ransac has "converged"
   bool hasConverged = false;
 
-  // Ransac loop
-  while (!shouldStopRansac)
+  if (this->FastRansac)
   {
-    // if we went throught the all random index we need
-    // to random shuffle again
-    if ((iterationPointer + 2) >= randomIndex.size())
+    FastRansacResult result = FastRansac(Points, this->Threshold, this->MaxRansacIteration,
+                                         this->RatioInliersRequired, this->Confidence,
+                                         this->PreemptiveSampleSize, this->NumberOfThreads);
+    iterationMade = result.NIterations;
+    bestSample = result.BestSample;
+    maxInliers = bestSample.NInliers;
+    hasConverged = result.HasConverged;
+    if (maxInliers == 0)
     {
-      std::shuffle(randomIndex.begin(), randomIndex.end(),g);
-      iterationPointer = 0;
+      vtkWarningMacro("No plane could be fitted, the points may be aligned");
+      return 1;
     }
-
-    // Compute current sample plane PlaneParameters
-    planePoint = Points[randomIndex[iterationPointer]];
-    planeNormal = (Points[randomIndex[iterationPointer + 2]] - planePoint).cross(Points[randomIndex[iterationPointer + 1]] - planePoint);
-    planeNormal.normalize();
-
-    // Compute the number of inliers / outliers
-    unsigned int nInliers = ComputeNumberOfInlier(Points, planePoint, planeNormal, this->Threshold);
-
-    // keep info
-    RansacSampleInfo info(nInliers, randomIndex[iterationPointer], randomIndex[iterationPointer + 1], randomIndex[iterationPointer + 2]);
-    samplesInfo.push_back(info);
-
-    if (nInliers > maxInliers)
+  }
+  else
+  {
+    // Create a random order of points index
+    std::vector<double> randomIndex(input->GetNumberOfPoints(), 0);
+    for (unsigned int k = 0; k < randomIndex.size(); ++k)
     {
-      maxInliers = nInliers;
-      indexMaxInliers = iterationMade;
+      randomIndex[k] = k;
     }
+    std::random_device rd;
+    std::mt19937 g(rd());
+    std::shuffle(randomIndex.begin(), randomIndex.end(), g);
 
-    // Check that the number of inliers is enought to
-    // break the ransac algorithm loop
-    if (nInliers > input->GetNumberOfPoints() * this->RatioInliersRequired)
-    {
-      shouldStopRansac = true;
-      hasConverged = true;
-    }
+    // information variable about ransac iterations
+    bool shouldStopRansac = false;
+    unsigned int iterationPointer = 0;
+
+    // keep information of iterations
+    std::vector<RansacSampleInfo> samplesInfo;
+    unsigned int indexMaxInliers = 0;
 
-    // check if the maximum iteration has been reached
-    if (iterationMade > this->MaxRansacIteration)
+    // Affine plane PlaneParameters
+    Eigen::Vector3d planeNormal, planePoint;
+
+    // Ransac loop
+    while (!shouldStopRansac)
     {
-      shouldStopRansac = true;
+      // if we went throught the all random index we need
+      // to random shuffle again
+      if ((iterationPointer + 2) >= randomIndex.size())
+      {
+        std::shuffle(randomIndex.begin(), randomIndex.end(),g);
+        iterationPointer = 0;
+      }
+
+      // Compute current sample plane PlaneParameters
+      planePoint = Points[randomIndex[iterationPointer]];
+      planeNormal = (Points[randomIndex[iterationPointer + 2]] - planePoint).cross(Points[randomIndex[iterationPointer + 1]] - planePoint);
+      planeNormal.normalize();
+
+      // Compute the number of inliers / outliers
+      unsigned int nInliers = ComputeNumberOfInlier(Points, planePoint, planeNormal, this->Threshold);
+
+      // keep info
+      RansacSampleInfo info(nInliers, randomIndex[iterationPointer], randomIndex[iterationPointer + 1], randomIndex[iterationPointer + 2]);
+      samplesInfo.push_back(info);
+
+      if (nInliers > maxInliers)
+      {
+        maxInliers = nInliers;
+        indexMaxInliers = iterationMade;
+      }
+
+      // Check that the number of inliers is enought to
+      // break the ransac algorithm loop
+      if (nInliers > input->GetNumberOfPoints() * this->RatioInliersRequired)
+      {
+        shouldStopRansac = true;
+        hasConverged = true;
+      }
+
+      // check if the maximum iteration has been reached
+      if (iterationMade > this->MaxRansacIteration)
+      {
+        shouldStopRansac = true;
+      }
+
+      // Updates iterations index
+      iterationMade++;
+      iterationPointer += 3;
     }
-
-    // Updates iterations index
-    iterationMade++;
-    iterationPointer += 3;
+    bestSample = samplesInfo[indexMaxInliers];
   }
 
   // Now refine using all inliers
-  RefineRansac(Points, output, samplesInfo[indexMaxInliers], this->Threshold, this->PlaneParam);
+  RefineRansac(Points, output, bestSample, this->Threshold, this->RefineIterations, this->PlaneParam);
 
   // output info
   std::cout << "ransac algorithm has converged: " << hasConverged << std::endl;
   std::cout << "number of iteration made: " << iterationMade << std::endl;
-  std::cout << "number of inliers: " << maxInliers << ", " << samplesInfo[indexMaxInliers].NInliers << std::endl;
+  std::cout << "number of inliers: " << maxInliers << ", " << bestSample.NInliers << std::endl;
   std::cout << "plane PlaneParams: [" << this->PlaneParam[0] << "," << this->PlaneParam[1] << "," << this->PlaneParam[2] << "," << this->PlaneParam[3] << "]" << std::endl;
 
   // flip normal if needed
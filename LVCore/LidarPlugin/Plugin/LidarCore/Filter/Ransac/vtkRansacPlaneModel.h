@@ -59,6 +59,26 @@ public:
   vtkGetMacro(PreviousEstimationWeight, double)
   vtkSetMacro(PreviousEstimationWeight, double)
 
+  /// Get/Set the use of the fast ransac engine
+  vtkGetMacro(FastRansac, bool)
+  vtkSetMacro(FastRansac, bool)
+
+  /// Get/Set the number of threads of the fast engine, 0 to use all the cores
+  vtkGetMacro(NumberOfThreads, int)
+  vtkSetMacro(NumberOfThreads, int)
+
+  /// Get/Set the confidence used by the fast engine to stop adaptively
+  vtkGetMacro(Confidence, double)
+  vtkSetMacro(Confidence, double)
+
+  /// Get/Set the number of points on which the fast engine first evaluates each plane
+  vtkGetMacro(PreemptiveSampleSize, unsigned int)
+  vtkSetMacro(PreemptiveSampleSize, unsigned int)
+
+  /// Get/Set the number of least squares refinements of the best plane
+  vtkGetMacro(RefineIterations, unsigned int)
+  vtkSetMacro(RefineIterations, unsigned int)
+
 protected:
   vtkRansacPlaneModel() = default;
 
@@ -91,6 +111,27 @@ private:
 
   /// how much the previous estimation is used in temporal averaging
   double PreviousEstimationWeight = 0.9;
+
+  /// use the fast ransac engine: the planes are scored in parallel, first on a
+  /// random subset of the points, and the loop stops once the best plane has
+  /// been found with the required confidence
+  bool FastRansac = false;
+
+  /// number of threads of the fast engine, 0 to use all the cores
+  int NumberOfThreads = 0;
+
+  /// probability that the fast engine draws at least one sample of inliers
+  /// before stopping, given the best inlier ratio found so far
+  double Confidence = 0.99;
+
+  /// number of random points on which the fast engine first evaluates each plane,
+  /// planes clearly worse than the best one are rejected without scoring all the points.
+  /// 0 to disable.
+  unsigned int PreemptiveSampleSize = 1000;
+
+  /// number of least squares refinements of the best plane, each one fitting the
+  /// inliers of the previous plane
+  unsigned int RefineIterations = 1;
 };
 
 #endif // VTK_RANSAC_PLANE_MODEL_H
@@ -22,10 +22,70 @@
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
-#include <vtkTransform.h>
 
+#include "ParallelTools.h"
 #include "vtkTemporalTransforms.h"
 
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Minimum number of points handled by each thread
+constexpr vtkIdType MinPointsPerThread = 4096;
+
+// Rigid transform (with scale) applied as p' = A.leftCols<3>() * p + A.col(3)
+using Affine = Eigen::Matrix<double, 3, 4, Eigen::DontAlign>;
+
+//-----------------------------------------------------------------------------
+// Transforms of the interpolator at the given times
+std::vector<Affine> InterpolateAffines(vtkCustomTransformInterpolator* interpolator,
+  const std::vector<double>& times)
+{
+  std::vector<double> matrices(16 * times.size());
+  interpolator->InterpolateMany(static_cast<vtkIdType>(times.size()), times.data(), matrices.data());
+  std::vector<Affine> affines(times.size());
+  for (size_t k = 0; k < times.size(); ++k)
+  {
+    affines[k] = Eigen::Map<const Eigen::Matrix<double, 4, 4, Eigen::RowMajor>>(
+      &matrices[16 * k]).topRows<3>();
+  }
+  return affines;
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void ReadTimes(const T* data, vtkIdType numberOfTuples, int numberOfComponents, double factor,
+  std::vector<double>& times)
+{
+  times.resize(numberOfTuples);
+  for (vtkIdType i = 0; i < numberOfTuples; ++i)
+  {
+    times[i] = static_cast<double>(data[i * numberOfComponents]) * factor;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Write to output the input points moved by the transform returned by affineOfPoint(pointId)
+template <typename T, typename F>
+void TransformPoints(const T* input, T* output, vtkIdType numberOfPoints, int numberOfThreads,
+  F affineOfPoint)
+{
+  ParallelTools::ParallelFor(numberOfPoints, 1024, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType i = begin; i < end; ++i)
+    {
+      const Eigen::Vector3d point(input[3 * i], input[3 * i + 1], input[3 * i + 2]);
+      const Eigen::Vector3d moved = affineOfPoint(i) * point.homogeneous();
+      output[3 * i] = static_cast<T>(moved(0));
+      output[3 * i + 1] = static_cast<T>(moved(1));
+      output[3 * i + 2] = static_cast<T>(moved(2));
+    }
+  });
+}
+}
+
 //-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkTemporalTransformsApplier)
 
@@ -68,10 +128,33 @@ int vtkTemporalTransformsApplier::RequestData(vtkInformation* vtkNotUsed(request
   // Copy the input and create some new points
   vtkPolyData* output = vtkPolyData::GetData(outputVector);
   output->ShallowCopy(pointcloud);
+  vtkPoints* inputPoints = pointcloud->GetPoints();
+  if (!inputPoints || inputPoints->GetNumberOfPoints() == 0)
+  {
+    return 1;
+  }
+  const vtkIdType nbPoints = inputPoints->GetNumberOfPoints();
   auto points = vtkSmartPointer<vtkPoints>::New();
-  points->SetNumberOfPoints(pointcloud->GetNumberOfPoints());
+  points->SetDataType(inputPoints->GetDataType());
+  points->SetNumberOfPoints(nbPoints);
   output->SetPoints(points);
 
+  const int threads =
+    ParallelTools::GetNumberOfThreadsToUse(this->NumberOfThreads, nbPoints, MinPointsPerThread);
+
+  // Move the points in parallel, with the transform returned by affineOfPoint(pointId)
+  auto apply = [&](auto affineOfPoint) {
+    switch (inputPoints->GetDataType())
+    {
+      vtkTemplateMacro(TransformPoints(static_cast<const VTK_TT*>(inputPoints->GetVoidPointer(0)),
+        static_cast<VTK_TT*>(points->GetVoidPointer(0)), nbPoints, threads, affineOfPoint));
+      default:
+        vtkErrorMacro(<< "Unsupported points type.");
+    }
+  };
+
+  // The interpolator is not thread safe, all the transforms are interpolated beforehand
+
   // Apply the same transform to all points. The transform is determined by the
   // pipeline time
   if (!this->InterpolateEachPoint)
@@ -80,20 +163,8 @@ int vtkTemporalTransformsApplier::RequestData(vtkInformation* vtkNotUsed(request
     vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
     double currentTimestamp = inInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
 
-    // get the right transform
-    auto transform = vtkSmartPointer<vtkTransform>::New();
-    this->Interpolator->InterpolateTransform(currentTimestamp,transform);
-    transform->Update();
-
-    // apply the transform
-    for (vtkIdType i = 0; i < pointcloud->GetNumberOfPoints(); i++)
-    {
-      float* inputPoint = reinterpret_cast<float*>
-          (pointcloud->GetPoints()->GetData()->WriteVoidPointer(3*i,1));
-      float* outputPoint = reinterpret_cast<float*>
-          (output->GetPoints()->GetData()->WriteVoidPointer(3*i,1));
-      transform->InternalTransformPoint(inputPoint, outputPoint);
-    }
+    const Affine affine = InterpolateAffines(this->Interpolator, { currentTimestamp })[0];
+    apply([&](vtkIdType) { return affine; });
   }
   // Apply an individual transform to each points. The transform is determined by
   // a time array.
@@ -105,22 +176,70 @@ int vtkTemporalTransformsApplier::RequestData(vtkInformation* vtkNotUsed(request
       vtkErrorMacro(<<"No TimeStamp array selected.");
       return 1;
     }
-    for (vtkIdType i = 0; i < pointcloud->GetNumberOfPoints(); i++)
+    if (timestamp->GetNumberOfTuples() < nbPoints)
+    {
+      vtkErrorMacro(<< "The TimeStamp array has less values than the number of points.");
+      return 1;
+    }
+
+    // get timestamps in seconds
+    std::vector<double> times;
+    switch (timestamp->GetDataType())
+    {
+      vtkTemplateMacro(ReadTimes(static_cast<const VTK_TT*>(timestamp->GetVoidPointer(0)),
+        nbPoints, timestamp->GetNumberOfComponents(), this->ConversionFactorToSecond, times));
+      default:
+        vtkErrorMacro(<< "Unsupported TimeStamp array type.");
+        return 1;
+    }
+
+    const auto range = std::minmax_element(times.begin(), times.end());
+    const double minTime = *range.first;
+    const double duration = *range.second - minTime;
+    const int slots = this->NumberOfTimeSlots;
+
+    // The nearest transform of a point can not be deduced from the transforms at the
+    // bounds of its slot, those are the nearest ones to the bounds
+    const int type = this->Interpolator->GetInterpolationType();
+    const bool nearest = type == vtkCustomTransformInterpolator::INTERPOLATION_TYPE_NEAREST ||
+      type == vtkCustomTransformInterpolator::INTERPOLATION_TYPE_NEAREST_LOW_BOUNDED;
+
+    if (slots == 0 || nearest)
+    {
+      // One transform per point
+      const std::vector<Affine> affines = InterpolateAffines(this->Interpolator, times);
+      apply([&](vtkIdType i) { return affines[i]; });
+    }
+    else if (duration > 0)
+    {
+      // Transforms at the bounds of the slots, followed by the difference between
+      // consecutive bounds to blend them
+      std::vector<double> boundTimes(slots + 1);
+      for (int k = 0; k <= slots; ++k)
+      {
+        boundTimes[k] = minTime + duration * k / slots;
+      }
+      std::vector<Affine> affines = InterpolateAffines(this->Interpolator, boundTimes);
+      affines.resize(2 * slots + 1);
+      for (int k = 0; k < slots; ++k)
+      {
+        affines[slots + 1 + k] = affines[k + 1] - affines[k];
+      }
+
+      // Linear blend of the bound transforms. Over a slot, the rotation is small enough
+      // for the blended matrix to stay a rotation up to a negligible error.
+      const double scale = slots / duration;
+      apply([&](vtkIdType i) {
+        const double u = (times[i] - minTime) * scale;
+        const int k = std::min(static_cast<int>(u), slots - 1);
+        return Affine(affines[k] + (u - k) * affines[slots + 1 + k]);
+      });
+    }
+    else
     {
-      // get timestamp in seconds
-      double currentTimestamp = timestamp->GetTuple1(i) * this->ConversionFactorToSecond;
-
-      // get the right transform
-      auto transform = vtkSmartPointer<vtkTransform>::New();
-      this->Interpolator->InterpolateTransform(currentTimestamp,transform);
-      transform->Update();
-
-      // apply the transform
-      float* inputPoint = reinterpret_cast<float*>
-          (pointcloud->GetPoints()->GetData()->WriteVoidPointer(3*i,1));
-      float* outputPoint = reinterpret_cast<float*>
-          (output->GetPoints()->GetData()->WriteVoidPointer(3*i,1));
-      transform->InternalTransformPoint(inputPoint, outputPoint);
+      // All the points share the same time
+      const Affine affine = InterpolateAffines(this->Interpolator, { minTime })[0];
+      apply([&](vtkIdType) { return affine; });
     }
   }
 
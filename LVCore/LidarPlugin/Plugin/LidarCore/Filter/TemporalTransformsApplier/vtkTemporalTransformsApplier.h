@@ -59,6 +59,22 @@ public:
   vtkGetMacro(ConversionFactorToSecond, double)
   vtkSetMacro(ConversionFactorToSecond, double)
 
+  //@{
+  /**
+   * @copydoc vtkTemporalTransformsApplier::NumberOfTimeSlots
+   */
+  vtkGetMacro(NumberOfTimeSlots, int)
+  vtkSetClampMacro(NumberOfTimeSlots, int, 0, VTK_INT_MAX)
+  //@}
+
+  //@{
+  /**
+   * @copydoc vtkTemporalTransformsApplier::NumberOfThreads
+   */
+  vtkGetMacro(NumberOfThreads, int)
+  vtkSetClampMacro(NumberOfThreads, int, 0, VTK_INT_MAX)
+  //@}
+
 protected:
   vtkTemporalTransformsApplier();
 
@@ -84,6 +100,15 @@ private:
   //! default is for data in microsecond
   double ConversionFactorToSecond = 1e-6;
 
+  //! With InterpolateEachPoint, the time range of the point cloud is split in
+  //! NumberOfTimeSlots slots and the transform is only interpolated at their bounds.
+  //! Each point then blends the transforms of the bounds of its slot. 0 interpolates the
+  //! transform of each point, which is always done with a nearest interpolation type.
+  int NumberOfTimeSlots = 1024;
+
+  //! Number of threads used to transform the points, 0 to use all the cores
+  int NumberOfThreads = 0;
+
   vtkTemporalTransformsApplier(const vtkTemporalTransformsApplier&) /*= delete*/;
   void operator =(const vtkTemporalTransformsApplier&) /*= delete*/;
 };
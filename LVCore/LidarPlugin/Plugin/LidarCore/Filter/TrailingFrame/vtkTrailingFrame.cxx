@@ -1,8 +1,16 @@
 #include "vtkTrailingFrame.h"
 
+#include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtkInformationVector.h>
 #include <vtkInformation.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkTrailingFrame)
@@ -19,6 +27,23 @@ void vtkTrailingFrame::SetNumberOfTrailingFrames(const unsigned int value)
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkTrailingFrame::SetIncremental(const bool value)
+{
+  if (this->Incremental != value)
+  {
+    this->Incremental = value;
+    // Each mode starts from scratch, as the frames of the other one may be outdated
+    this->Ring.clear();
+    this->RingSize = 0;
+    this->MergedFrames->Initialize();
+    this->CacheTimeRange[0] = -1;
+    this->CacheTimeRange[1] = -1;
+    this->Cache->Initialize();
+    this->Modified();
+  }
+}
+
 //----------------------------------------------------------------------------
 int vtkTrailingFrame::FillOutputPortInformation(int port, vtkInformation *info)
 {
@@ -36,6 +61,12 @@ int vtkTrailingFrame::RequestUpdateExtent(vtkInformation* vtkNotUsed(request),
                                       vtkInformationVector** inputVector,
                                       vtkInformationVector* vtkNotUsed(outputVector))
 {
+  // The input is only updated at the pipeline time
+  if (this->Incremental)
+  {
+    return 1;
+  }
+
   vtkInformation *inInfo = inputVector[0]->GetInformationObject(0);
   // get the available time steps from source
   // This is done every time the number of timesteps is changed in the UI
@@ -156,6 +187,29 @@ int vtkTrailingFrame::RequestData(vtkInformation* request,
   // The filter made the assumption that each RequestUpdateExtent is follow by a RequestData
   LastCallWasRequestUpdateExtentCall = false;
 
+  if (this->Incremental)
+  {
+    this->AppendFrame(input);
+    if (this->MergeFrames)
+    {
+      this->MergeRing();
+      vtkNew<vtkPolyData> merged;
+      merged->ShallowCopy(this->MergedFrames);
+      output->SetNumberOfBlocks(1);
+      output->SetBlock(0, merged);
+    }
+    else
+    {
+      // same block order as the other mode, the current frame first
+      output->SetNumberOfBlocks(this->NumberOfTrailingFrames + 1);
+      for (unsigned int i = 0; i < this->NumberOfTrailingFrames + 1; ++i)
+      {
+        output->SetBlock(i, this->GetRingFrame(i));
+      }
+    }
+    return 1;
+  }
+
   // If the TimeSteps size is still zero, it means
   // that no time_steps has been filled by the reader /
   // stream. Hence, either no lidar data was stored in the
@@ -221,3 +275,181 @@ int vtkTrailingFrame::RequestData(vtkInformation* request,
   }
   return 1;
 }
+
+//----------------------------------------------------------------------------
+void vtkTrailingFrame::ResizeRing(unsigned int capacity)
+{
+  const unsigned int size = std::min(this->RingSize, capacity);
+  std::vector<vtkSmartPointer<vtkPolyData>> ring(capacity);
+  for (unsigned int i = 0; i < size; ++i)
+  {
+    ring[size - 1 - i] = this->GetRingFrame(i);
+  }
+  this->Ring.swap(ring);
+  this->RingSize = size;
+  this->RingHead = (size + capacity - 1) % capacity;
+}
+
+//----------------------------------------------------------------------------
+vtkPolyData* vtkTrailingFrame::GetRingFrame(unsigned int i) const
+{
+  if (i >= this->RingSize)
+  {
+    return nullptr;
+  }
+  const unsigned int capacity = static_cast<unsigned int>(this->Ring.size());
+  return this->Ring[(this->RingHead + capacity - i) % capacity];
+}
+
+//----------------------------------------------------------------------------
+void vtkTrailingFrame::AppendFrame(vtkPolyData* input)
+{
+  const unsigned int capacity = this->NumberOfTrailingFrames + 1;
+  if (this->Ring.size() != capacity)
+  {
+    this->ResizeRing(capacity);
+  }
+
+  vtkInformation* info = input->GetInformation();
+  const bool hasTime = info->Has(vtkDataObject::DATA_TIME_STEP());
+  const double time = hasTime ? info->Get(vtkDataObject::DATA_TIME_STEP()) : 0.;
+  const vtkMTimeType mtime = input->GetMTime();
+
+  bool sameFrame = false;
+  if (this->RingSize > 0 && hasTime == this->RingHeadHasTime)
+  {
+    sameFrame = hasTime ? time == this->RingHeadTime : mtime == this->RingHeadMTime;
+    // jumping backward, the frames in the ring are not the previous ones anymore
+    if (hasTime && time < this->RingHeadTime)
+    {
+      std::fill(this->Ring.begin(), this->Ring.end(), nullptr);
+      this->RingSize = 0;
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> frame = vtkSmartPointer<vtkPolyData>::New();
+  frame->ShallowCopy(input);
+  if (!sameFrame)
+  {
+    this->RingHead = (this->RingHead + 1) % capacity;
+    this->RingSize = std::min(this->RingSize + 1, capacity);
+  }
+  this->Ring[this->RingHead] = frame;
+  this->RingHeadHasTime = hasTime;
+  this->RingHeadTime = time;
+  this->RingHeadMTime = mtime;
+}
+
+//----------------------------------------------------------------------------
+void vtkTrailingFrame::MergeRing()
+{
+  // The newest frame gives the points type and the arrays to keep
+  vtkPolyData* reference = nullptr;
+  vtkIdType nbPoints = 0;
+  for (unsigned int i = 0; i < this->RingSize; ++i)
+  {
+    vtkPolyData* frame = this->GetRingFrame(i);
+    if (frame->GetPoints())
+    {
+      reference = reference ? reference : frame;
+      nbPoints += frame->GetNumberOfPoints();
+    }
+  }
+  if (!reference)
+  {
+    this->MergedFrames->Initialize();
+    return;
+  }
+
+  // Reset the arrays without releasing their memory, so that they are only
+  // reallocated when the trail grows bigger than it ever was
+  auto merge = [this](vtkAbstractArray* merged, auto getArray) {
+    merged->Reset();
+    vtkIdType offset = 0;
+    for (unsigned int i = 0; i < this->RingSize; ++i)
+    {
+      vtkPolyData* frame = this->GetRingFrame(i);
+      if (frame->GetPoints())
+      {
+        merged->InsertTuples(offset, frame->GetNumberOfPoints(), 0, getArray(frame));
+        offset += frame->GetNumberOfPoints();
+      }
+    }
+    merged->Modified();
+  };
+
+  vtkPoints* points = this->MergedFrames->GetPoints();
+  if (!points || points->GetDataType() != reference->GetPoints()->GetDataType())
+  {
+    vtkNew<vtkPoints> newPoints;
+    newPoints->SetDataType(reference->GetPoints()->GetDataType());
+    this->MergedFrames->SetPoints(newPoints);
+    points = newPoints;
+  }
+  merge(points->GetData(), [](vtkPolyData* frame) { return frame->GetPoints()->GetData(); });
+  points->Modified();
+
+  // Only the arrays present in all the frames, with the same type, can be merged
+  vtkPointData* referencePD = reference->GetPointData();
+  vtkPointData* mergedPD = this->MergedFrames->GetPointData();
+  std::vector<std::string> kept;
+  for (int arrayIdx = 0; arrayIdx < referencePD->GetNumberOfArrays(); ++arrayIdx)
+  {
+    vtkAbstractArray* array = referencePD->GetAbstractArray(arrayIdx);
+    if (!array->GetName())
+    {
+      continue;
+    }
+    bool mergeable = true;
+    for (unsigned int i = 0; i < this->RingSize && mergeable; ++i)
+    {
+      vtkPolyData* frame = this->GetRingFrame(i);
+      vtkAbstractArray* other = frame->GetPointData()->GetAbstractArray(array->GetName());
+      mergeable = !frame->GetPoints() ||
+        (other && other->GetDataType() == array->GetDataType() &&
+          other->GetNumberOfComponents() == array->GetNumberOfComponents() &&
+          other->GetNumberOfTuples() == frame->GetNumberOfPoints());
+    }
+    if (!mergeable)
+    {
+      continue;
+    }
+
+    vtkAbstractArray* merged = mergedPD->GetAbstractArray(array->GetName());
+    if (!merged || merged->GetDataType() != array->GetDataType() ||
+      merged->GetNumberOfComponents() != array->GetNumberOfComponents())
+    {
+      vtkSmartPointer<vtkAbstractArray> newArray;
+      newArray.TakeReference(array->NewInstance());
+      newArray->SetName(array->GetName());
+      newArray->SetNumberOfComponents(array->GetNumberOfComponents());
+      mergedPD->AddArray(newArray);
+      merged = newArray;
+    }
+    const std::string name = array->GetName();
+    merge(merged, [&name](vtkPolyData* frame) {
+      return frame->GetPointData()->GetAbstractArray(name.c_str());
+    });
+    kept.push_back(name);
+  }
+  for (int arrayIdx = mergedPD->GetNumberOfArrays() - 1; arrayIdx >= 0; --arrayIdx)
+  {
+    const char* name = mergedPD->GetAbstractArray(arrayIdx)->GetName();
+    if (!name || std::find(kept.begin(), kept.end(), name) == kept.end())
+    {
+      mergedPD->RemoveArray(arrayIdx);
+    }
+  }
+
+  // One vertex per point
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(nbPoints + 1);
+  std::iota(offsets->GetPointer(0), offsets->GetPointer(0) + nbPoints + 1, 0);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(nbPoints);
+  std::iota(connectivity->GetPointer(0), connectivity->GetPointer(0) + nbPoints, 0);
+  vtkNew<vtkCellArray> verts;
+  verts->SetData(offsets, connectivity);
+  this->MergedFrames->SetVerts(verts);
+  this->MergedFrames->Modified();
+}
@@ -2,10 +2,12 @@
 #define VTKTRAILINGFRAME_H
 
 #include <queue>
+#include <vector>
 
 #include "vtkPolyDataAlgorithm.h"
 #include <vtkNew.h>
 #include <vtkMultiBlockDataSet.h>
+#include <vtkSmartPointer.h>
 
 #include "LidarCoreModule.h"
 
@@ -13,6 +15,10 @@
  * @brief The vtkTrailingFrame class is a filter that combine consecutive timestep
  * of its input to produce a multiblock.
  * The input of this filter must produce only consecutive interger timestep.
+ *
+ * In incremental mode, the filter does not request the previous timesteps but keeps
+ * the last frames it received in a ring buffer. This works with inputs that can not
+ * provide past frames, such as a live stream.
  */
 class LIDARCORE_EXPORT vtkTrailingFrame : public vtkPolyDataAlgorithm
 {
@@ -32,6 +38,18 @@ public:
   vtkSetMacro(UseCache, bool)
   //! @}
 
+  //! @{
+  //! @copydoc Incremental
+  vtkGetMacro(Incremental, bool)
+  void SetIncremental(const bool value);
+  //! @}
+
+  //! @{
+  //! @copydoc MergeFrames
+  vtkGetMacro(MergeFrames, bool)
+  vtkSetMacro(MergeFrames, bool)
+  //! @}
+
 protected:
   vtkTrailingFrame() = default;
 
@@ -44,10 +62,23 @@ protected:
                   vtkInformationVector* outputVector) override;
 
 private:
+  //! Add the input to the ring buffer, or replace the newest frame if it is the same timestep
+  void AppendFrame(vtkPolyData* input);
+  //! Change the capacity of the ring buffer, keeping the newest frames
+  void ResizeRing(unsigned int capacity);
+  //! i-th newest frame of the ring buffer, 0 being the last received
+  vtkPolyData* GetRingFrame(unsigned int i) const;
+  //! Fill MergedFrames with the frames of the ring buffer
+  void MergeRing();
+
   //! Number of previous timestep to display
   unsigned int NumberOfTrailingFrames = 0;
   //! Should the internal cache be used for speed
   bool UseCache = true;
+  //! Keep the last frames received instead of requesting the previous timesteps
+  bool Incremental = false;
+  //! In incremental mode, output a single polydata containing all the frames
+  bool MergeFrames = false;
 
   //! Original pipeline time which must be restored after modifying the input filter time
   double PipelineTime = 0;
@@ -64,6 +95,19 @@ private:
   //! List of available time steps from the source
   std::vector<double> TimeSteps;
 
+  //! Last frames received in incremental mode, with a capacity of NumberOfTrailingFrames + 1
+  std::vector<vtkSmartPointer<vtkPolyData>> Ring;
+  //! Index of the newest frame in Ring
+  unsigned int RingHead = 0;
+  //! Number of frames in Ring
+  unsigned int RingSize = 0;
+  //! Timestep of the newest frame in Ring, or its modification time if it has no timestep
+  bool RingHeadHasTime = false;
+  double RingHeadTime = 0;
+  vtkMTimeType RingHeadMTime = 0;
+  //! Frames of Ring merged in a single polydata, whose arrays are reused between the updates
+  vtkNew<vtkPolyData> MergedFrames;
+
   //! Help variable
   bool FirstFilterIteration = true;
 
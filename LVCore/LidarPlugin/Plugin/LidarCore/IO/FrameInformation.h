@@ -15,7 +15,9 @@
 #ifndef FRAMEINFORMATION_H
 #define FRAMEINFORMATION_H
 
+#include <cstddef>
 #include <memory>
+#include <string>
 
 /**
  * @brief SpecificFrameInformation placeholder for
@@ -24,6 +26,19 @@
 struct SpecificFrameInformation {
   virtual void reset() = 0;
   virtual std::unique_ptr<SpecificFrameInformation> clone() = 0;
+
+  /**
+   * @brief serialize append a binary representation of the information to buffer.
+   *        Used to persist the frame index on disk, see FrameCatalogIndex.
+   * @return false if the sensor does not support persisting its information
+   */
+  virtual bool serialize(std::string& /*buffer*/) const { return false; }
+
+  /**
+   * @brief deserialize restore the information written by serialize
+   * @return false if the data could not be interpreted
+   */
+  virtual bool deserialize(const char* /*data*/, size_t /*size*/) { return false; }
 };
 
 /**
@@ -14,9 +14,16 @@
 
 #include "LASFileWriter.h"
 
+#include <vtkDataArray.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 namespace
 {
 
@@ -62,20 +69,28 @@ projPJ ProjFromEPSG(int epsg)
   return pj_init_plus(ss.str().c_str());
 }
 
+// Number of points read, projected and written at once
+constexpr vtkIdType ChunkSize = 4096;
+
+// Offsets of the fields of the LAS public header block updated by Close(),
+// identical in all the LAS versions
+constexpr std::streamoff PointCountOffset = 107;
+constexpr std::streamoff BoundsOffset = 179;
+
 //-----------------------------------------------------------------------------
-Eigen::Vector3d ConvertGcs(Eigen::Vector3d p, projPJ inProj, projPJ outProj)
+// Convert count positions in place, with a single call to proj
+void ConvertGcs(double* x, double* y, double* z, vtkIdType count, projPJ inProj, projPJ outProj)
 {
   if (pj_is_latlong(inProj))
   {
-    p[0] *= DEG_TO_RAD;
-    p[1] *= DEG_TO_RAD;
+    for (vtkIdType i = 0; i < count; ++i)
+    {
+      x[i] *= DEG_TO_RAD;
+      y[i] *= DEG_TO_RAD;
+    }
   }
 
-  double* const data = p.data();
-  //std::cout << "position in : [" << p[0] << ";" << p[1] << ";" << p[2] << "]" << std::endl;
-  int last_errno = pj_transform(inProj, outProj, 1, 1, data + 0, data + 1, data + 2);
-  //std::cout << "position out : [" << p[0] << ";" << p[1] << ";" << p[2] << "]" << std::endl << std::endl;
-
+  int last_errno = pj_transform(inProj, outProj, count, 1, x, y, z);
   if (last_errno != 0)
   {
     vtkGenericWarningMacro("Error : CRS conversion failed with error: " << last_errno);
@@ -83,12 +98,69 @@ Eigen::Vector3d ConvertGcs(Eigen::Vector3d p, projPJ inProj, projPJ outProj)
 
   if (pj_is_latlong(outProj))
   {
-    p[0] *= RAD_TO_DEG;
-    p[1] *= RAD_TO_DEG;
+    for (vtkIdType i = 0; i < count; ++i)
+    {
+      x[i] *= RAD_TO_DEG;
+      y[i] *= RAD_TO_DEG;
+    }
   }
+}
 
+//-----------------------------------------------------------------------------
+Eigen::Vector3d ConvertGcs(Eigen::Vector3d p, projPJ inProj, projPJ outProj)
+{
+  ConvertGcs(p.data() + 0, p.data() + 1, p.data() + 2, 1, inProj, outProj);
   return p;
 }
+
+//-----------------------------------------------------------------------------
+// Read a component of the tuples [start, start + count) of an array, with typed
+// access to the memory when possible
+void ReadComponent(vtkDataArray* array, int component, vtkIdType start, vtkIdType count,
+  double* out)
+{
+  if (array->HasStandardMemoryLayout())
+  {
+    const int nbComponents = array->GetNumberOfComponents();
+    switch (array->GetDataType())
+    {
+      vtkTemplateMacro(
+        const VTK_TT* data = static_cast<const VTK_TT*>(array->GetVoidPointer(0)) +
+          start * nbComponents + component;
+        for (vtkIdType i = 0; i < count; ++i)
+        {
+          out[i] = static_cast<double>(data[i * nbComponents]);
+        }
+        return;
+      );
+    }
+  }
+  for (vtkIdType i = 0; i < count; ++i)
+  {
+    out[i] = array->GetComponent(start + i, component);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Read a component of a chunk of tuples, or fill it with a default value if there is no array
+void ReadComponentOrDefault(vtkDataArray* array, int component, vtkIdType start, vtkIdType count,
+  double defaultValue, double* out)
+{
+  if (array == nullptr)
+  {
+    std::fill(out, out + count, defaultValue);
+    return;
+  }
+  ReadComponent(array, component, start, count, out);
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void WriteLittleEndian(std::ostream& stream, const T* values, int count)
+{
+  // LAS files are little endian, as all the platforms supported
+  stream.write(reinterpret_cast<const char*>(values), sizeof(T) * count);
+}
 }
 
 //-----------------------------------------------------------------------------
@@ -102,6 +174,7 @@ LASFileWriter::LASFileWriter()
   this->MaxTime = +std::numeric_limits<double>::infinity();
 
   this->Writer = nullptr;
+  this->WrittenPoints = 0;
 }
 
 int LASFileWriter::Open(const char* filename)
@@ -110,10 +183,13 @@ int LASFileWriter::Open(const char* filename)
   // writer another file
   this->npoints = 0;
 
+  this->WrittenPoints = 0;
   for (int i = 0; i < 3; ++i)
   {
     this->MaxPt[i] = -std::numeric_limits<double>::max();
     this->MinPt[i] = std::numeric_limits<double>::max();
+    this->WrittenMaxPt[i] = -std::numeric_limits<double>::max();
+    this->WrittenMinPt[i] = std::numeric_limits<double>::max();
   }
 
   this->Stream.open(filename, std::ios::out | std::ios::trunc | std::ios::binary);
@@ -132,20 +208,39 @@ int LASFileWriter::Open(const char* filename)
     this->header.SetDataFormatId(liblas::ePointFormat1);
   }
   this->header.SetScale(1e-3, 1e-3, 1e-3);
+  this->header.SetCompressed(this->Compressed);
 
   return 1;
 }
 
 void LASFileWriter::Close()
 {
+  const bool wrotePoints = this->Writer != nullptr && this->WrittenPoints > 0;
   if (this->Writer != nullptr)
   {
+    // Completes the file, including the compressed chunks of a LAZ
     delete this->Writer;
     this->Writer = nullptr;
   }
 
   if (this->Stream.is_open())
   {
+    // The header has been written before the points, update the metadata
+    // computed while writing them. This part of the header is never compressed.
+    if (wrotePoints)
+    {
+      const uint32_t count = static_cast<uint32_t>(
+        std::min<size_t>(this->WrittenPoints, std::numeric_limits<uint32_t>::max()));
+      // total, then by return: all the points are first returns
+      const uint32_t counts[6] = { count, count, 0, 0, 0, 0 };
+      this->Stream.seekp(PointCountOffset);
+      WriteLittleEndian(this->Stream, counts, 6);
+
+      const double bounds[6] = { this->WrittenMaxPt[0], this->WrittenMinPt[0],
+        this->WrittenMaxPt[1], this->WrittenMinPt[1], this->WrittenMaxPt[2], this->WrittenMinPt[2] };
+      this->Stream.seekp(BoundsOffset);
+      WriteLittleEndian(this->Stream, bounds, 6);
+    }
     this->Stream.close();
   }
 
@@ -313,14 +408,35 @@ void LASFileWriter::SetPrecision(double neTol, double hTol)
 }
 
 //-----------------------------------------------------------------------------
-void LASFileWriter::WriteFrame(vtkPolyData* data)
+bool LASFileWriter::CreateWriter()
 {
-  if (!this->Writer)
+  try
   {
     this->Writer = new liblas::Writer(this->Stream, this->header);
   }
+  catch (std::exception& e)
+  {
+    // e.g. LAZ requested but libLAS built without LASzip
+    vtkGenericWarningMacro("Error : failed to create the LAS writer: " << e.what());
+    this->Writer = nullptr;
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void LASFileWriter::WriteFrame(vtkPolyData* data)
+{
+  if (!this->Writer && !this->CreateWriter())
+  {
+    return;
+  }
 
-  vtkPoints* const points = data->GetPoints();
+  vtkDataArray* const pointsData = data->GetPoints() ? data->GetPoints()->GetData() : nullptr;
+  if (pointsData == nullptr)
+  {
+    return;
+  }
   vtkDataArray* intensityData = data->GetPointData()->GetArray("intensity");
   vtkDataArray* laserIdData = data->GetPointData()->GetArray("laser_id");
   vtkDataArray* timestampData = data->GetPointData()->GetArray("adjustedtime");
@@ -340,43 +456,93 @@ void LASFileWriter::WriteFrame(vtkPolyData* data)
     laserIdData = data->GetPointData()->GetArray("Channel");
   }
 
-  vtkDataArray* const colorData = data->GetPointData()->GetArray("camera_color");
+  vtkDataArray* colorData = data->GetPointData()->GetArray("camera_color");
+  if (!this->WriteColor || (colorData && colorData->GetNumberOfComponents() < 3))
+  {
+    colorData = nullptr;
+  }
+
+  // Only the coordinates, the time and the color change from one point to the other
+  liblas::Point p(&this->Writer->GetHeader());
+  p.SetReturnNumber(1);
+  p.SetNumberOfReturns(1);
 
-  const vtkIdType numPoints = points->GetNumberOfPoints();
-  for (vtkIdType n = 0; n < numPoints; ++n)
+  std::vector<double> x(ChunkSize), y(ChunkSize), z(ChunkSize), time(ChunkSize);
+  std::vector<double> intensity(ChunkSize), laserId(ChunkSize);
+  std::vector<double> red, green, blue;
+  if (colorData)
   {
-    const double time = timestampData == nullptr ? 0.0 : timestampData->GetComponent(n, 0) * timeToSec;
-    // This test implements the time-clamping feature
-    if (time >= this->MinTime && time <= this->MaxTime)
+    red.resize(ChunkSize);
+    green.resize(ChunkSize);
+    blue.resize(ChunkSize);
+  }
+
+  const vtkIdType numPoints = pointsData->GetNumberOfTuples();
+  for (vtkIdType start = 0; start < numPoints; start += ChunkSize)
+  {
+    const vtkIdType count = std::min(ChunkSize, numPoints - start);
+    ReadComponent(pointsData, 0, start, count, x.data());
+    ReadComponent(pointsData, 1, start, count, y.data());
+    ReadComponent(pointsData, 2, start, count, z.data());
+    ReadComponentOrDefault(timestampData, 0, start, count, 0.0, time.data());
+    ReadComponentOrDefault(intensityData, 0, start, count, 0.0, intensity.data());
+    ReadComponentOrDefault(laserIdData, 0, start, count, 0.0, laserId.data());
+    if (colorData)
     {
-      Eigen::Vector3d pos;
-      points->GetPoint(n, pos.data());
-      pos += this->Origin;
+      ReadComponent(colorData, 0, start, count, red.data());
+      ReadComponent(colorData, 1, start, count, green.data());
+      ReadComponent(colorData, 2, start, count, blue.data());
+    }
 
-      if (this->OutProj)
+    // Keep the points in the time range (time-clamping feature), in place
+    vtkIdType kept = 0;
+    for (vtkIdType n = 0; n < count; ++n)
+    {
+      const double pointTime = timestampData == nullptr ? 0.0 : time[n] * timeToSec;
+      if (pointTime >= this->MinTime && pointTime <= this->MaxTime)
       {
-        pos = ConvertGcs(pos, this->InProj, this->OutProj);
+        x[kept] = x[n] + this->Origin[0];
+        y[kept] = y[n] + this->Origin[1];
+        z[kept] = z[n] + this->Origin[2];
+        time[kept] = pointTime;
+        intensity[kept] = intensity[n];
+        laserId[kept] = laserId[n];
+        if (colorData)
+        {
+          red[kept] = red[n];
+          green[kept] = green[n];
+          blue[kept] = blue[n];
+        }
+        ++kept;
       }
+    }
 
-      liblas::Point p(&this->Writer->GetHeader());
-      p.SetCoordinates(pos[0], pos[1], pos[2]);
-      p.SetIntensity(static_cast<uint16_t>(intensityData == nullptr ? 0.0 : intensityData->GetComponent(n, 0)));
-      p.SetReturnNumber(1);
-      p.SetNumberOfReturns(1);
-      p.SetUserData(static_cast<uint8_t>(laserIdData == nullptr ? 0.0 : laserIdData->GetComponent(n, 0)));
-      if (this->WriteColor && colorData != nullptr)
+    if (this->OutProj && kept > 0)
+    {
+      ConvertGcs(x.data(), y.data(), z.data(), kept, this->InProj, this->OutProj);
+    }
+
+    for (vtkIdType n = 0; n < kept; ++n)
+    {
+      p.SetCoordinates(x[n], y[n], z[n]);
+      p.SetIntensity(static_cast<uint16_t>(intensity[n]));
+      p.SetUserData(static_cast<uint8_t>(laserId[n]));
+      if (colorData)
       {
-        liblas::Color color = liblas::Color(
-              static_cast<uint32_t>(colorData->GetComponent(n, 0)),
-              static_cast<uint32_t>(colorData->GetComponent(n, 1)),
-              static_cast<uint32_t>(colorData->GetComponent(n, 2))
-              );
-        p.SetColor(color);
+        p.SetColor(liblas::Color(static_cast<uint32_t>(red[n]),
+          static_cast<uint32_t>(green[n]), static_cast<uint32_t>(blue[n])));
       }
-      p.SetTime(time);
-
+      p.SetTime(time[n]);
       this->Writer->WritePoint(p);
+
+      const double pos[3] = { x[n], y[n], z[n] };
+      for (int i = 0; i < 3; ++i)
+      {
+        this->WrittenMaxPt[i] = std::max(this->WrittenMaxPt[i], pos[i]);
+        this->WrittenMinPt[i] = std::min(this->WrittenMinPt[i], pos[i]);
+      }
     }
+    this->WrittenPoints += kept;
   }
 }
 
@@ -391,7 +557,11 @@ void LASFileWriter::FlushMetaData()
 //-----------------------------------------------------------------------------
 void LASFileWriter::UpdateMetaData(vtkPolyData* data)
 {
-  vtkPoints* const points = data->GetPoints();
+  vtkDataArray* const pointsData = data->GetPoints() ? data->GetPoints()->GetData() : nullptr;
+  if (pointsData == nullptr)
+  {
+    return;
+  }
   vtkDataArray* timestampData = data->GetPointData()->GetArray("timestamp");
   double timeToSec = 1e-6;
   if(timestampData == nullptr)
@@ -400,33 +570,42 @@ void LASFileWriter::UpdateMetaData(vtkPolyData* data)
     timeToSec = 1e-9;
   }
 
-  const vtkIdType numPoints = points->GetNumberOfPoints();
-  for (vtkIdType n = 0; n < numPoints; ++n)
+  std::vector<double> x(ChunkSize), y(ChunkSize), z(ChunkSize), time(ChunkSize);
+  const vtkIdType numPoints = pointsData->GetNumberOfTuples();
+  for (vtkIdType start = 0; start < numPoints; start += ChunkSize)
   {
-    const double time = timestampData == nullptr ? 0.0 : timestampData->GetComponent(n, 0) * timeToSec;
-    if (time >= this->MinTime && time <= this->MaxTime)
-    {
-      Eigen::Vector3d pos;
-      points->GetPoint(n, pos.data());
-      pos += this->Origin;
+    const vtkIdType count = std::min(ChunkSize, numPoints - start);
+    ReadComponent(pointsData, 0, start, count, x.data());
+    ReadComponent(pointsData, 1, start, count, y.data());
+    ReadComponent(pointsData, 2, start, count, z.data());
+    ReadComponentOrDefault(timestampData, 0, start, count, 0.0, time.data());
 
-      if (this->OutProj)
+    vtkIdType kept = 0;
+    for (vtkIdType n = 0; n < count; ++n)
+    {
+      const double pointTime = timestampData == nullptr ? 0.0 : time[n] * timeToSec;
+      if (pointTime >= this->MinTime && pointTime <= this->MaxTime)
       {
-        pos = ConvertGcs(pos, this->InProj, this->OutProj);
+        x[kept] = x[n] + this->Origin[0];
+        y[kept] = y[n] + this->Origin[1];
+        z[kept] = z[n] + this->Origin[2];
+        ++kept;
       }
+    }
 
-      this->npoints++;
+    if (this->OutProj && kept > 0)
+    {
+      ConvertGcs(x.data(), y.data(), z.data(), kept, this->InProj, this->OutProj);
+    }
 
+    this->npoints += kept;
+    for (vtkIdType n = 0; n < kept; ++n)
+    {
+      const double pos[3] = { x[n], y[n], z[n] };
       for (int i = 0; i < 3; ++i)
       {
-        if (pos[i] > this->MaxPt[i])
-        {
-          this->MaxPt[i] = pos[i];
-        }
-        if (pos[i] < this->MinPt[i])
-        {
-          this->MinPt[i] = pos[i];
-        }
+        this->MaxPt[i] = std::max(this->MaxPt[i], pos[i]);
+        this->MinPt[i] = std::min(this->MinPt[i], pos[i]);
       }
     }
   }
@@ -454,3 +633,18 @@ void LASFileWriter::SetWriteColor(bool shouldWrite)
 {
   this->WriteColor = shouldWrite;
 }
+
+void LASFileWriter::SetCompressed(bool compressed)
+{
+  this->Compressed = compressed;
+  this->header.SetCompressed(compressed);
+}
+
+bool LASFileWriter::CanWriteCompressed()
+{
+#ifdef LIDARVIEW_LIBLAS_WITH_LASZIP
+  return true;
+#else
+  return false;
+#endif
+}
@@ -80,11 +80,19 @@ public:
   void SetWriteSRS(bool shouldWrite);
   void SetWriteColor(bool shouldWrite);
 
+  // Write a LAZ (compressed) file instead of a LAS one. Requires a libLAS built
+  // with LASzip, otherwise nothing is written. Must be called before WriteFrame()
+  void SetCompressed(bool compressed);
+
+  // True if LAZ files can be written, i.e. libLAS was built with LASzip
+  static bool CanWriteCompressed();
+
   // Sets the metadata into the LAS header
   void FlushMetaData();
 
-  // UpdateMetaData() and FlushMetaData() must have been called before the
-  // first call to WriteFrame()
+  // The points are projected by chunks, and the bounding box and the number of
+  // points written are stored in the header by Close(). UpdateMetaData() and
+  // FlushMetaData() are not needed anymore, a single pass is enough.
   // Will use arrays:
   // - intensity
   // - laser_id (has user data field)
@@ -97,6 +105,9 @@ public:
   void WriteFrame(vtkPolyData* data);
 
 private:
+  // Create the liblas writer with the current header, false on error
+  bool CreateWriter();
+
   std::ofstream Stream;
   liblas::Writer* Writer;
 
@@ -108,6 +119,11 @@ private:
   double MinPt[3];
   double MaxPt[3];
 
+  // Metadata of the points written by WriteFrame(), stored in the header by Close()
+  size_t WrittenPoints;
+  double WrittenMinPt[3];
+  double WrittenMaxPt[3];
+
   liblas::Header header;
 
   projPJ InProj; // used to intepret the polyDatas points
@@ -123,6 +139,8 @@ private:
   // library (in which case setting SRS fails), or to use the default
   // interpretation of the software that will use the LAS file.
   bool WriteSRS = true;
+
+  bool Compressed = false;
 };
 
 #endif
@@ -0,0 +1,200 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#include "LZFCompression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+constexpr int HashLog = 14;
+constexpr size_t MaxLiteral = 32;
+constexpr size_t MaxOffset = 1 << 13;
+constexpr size_t MaxMatch = 7 + 255 + 2;
+
+//-----------------------------------------------------------------------------
+inline uint32_t Hash(const uint8_t* p)
+{
+  const uint32_t v = (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+  return ((v * 2654435761u) >> (32 - HashLog)) & ((1 << HashLog) - 1);
+}
+}
+
+//-----------------------------------------------------------------------------
+size_t LZFMaxCompressedSize(size_t inSize)
+{
+  // One control byte every MaxLiteral literals in the worst case, plus the room
+  // needed by the capacity checks of LZFCompress
+  return inSize + inSize / MaxLiteral + 16;
+}
+
+//-----------------------------------------------------------------------------
+size_t LZFCompress(const void* input, size_t inSize, void* output, size_t outCapacity)
+{
+  const uint8_t* in = static_cast<const uint8_t*>(input);
+  uint8_t* out = static_cast<uint8_t*>(output);
+  if (inSize == 0 || outCapacity == 0)
+  {
+    return 0;
+  }
+
+  // Last position + 1 of each hashed triplet, 0 if none
+  std::vector<size_t> table(1 << HashLog, 0);
+
+  size_t ip = 0;
+  size_t op = 1; // room for the control byte of the first literal run
+  size_t literalStart = 0;
+  size_t literals = 0;
+
+  while (ip < inSize)
+  {
+    size_t length = 0;
+    size_t offset = 0;
+    if (ip + 2 < inSize)
+    {
+      const uint32_t h = Hash(in + ip);
+      const size_t candidate = table[h];
+      table[h] = ip + 1;
+      if (candidate != 0 && ip - (candidate - 1) <= MaxOffset)
+      {
+        const size_t ref = candidate - 1;
+        const size_t maxLength = std::min(MaxMatch, inSize - ip);
+        while (length < maxLength && in[ref + length] == in[ip + length])
+        {
+          ++length;
+        }
+        offset = ip - ref - 1;
+      }
+    }
+
+    if (length >= 3)
+    {
+      // Close the current literal run, or reuse its control byte if it is empty
+      if (literals > 0)
+      {
+        out[literalStart] = static_cast<uint8_t>(literals - 1);
+      }
+      else
+      {
+        --op;
+      }
+      if (op + 4 > outCapacity)
+      {
+        return 0;
+      }
+      const size_t encodedLength = length - 2;
+      if (encodedLength < 7)
+      {
+        out[op++] = static_cast<uint8_t>((offset >> 8) + (encodedLength << 5));
+      }
+      else
+      {
+        out[op++] = static_cast<uint8_t>((offset >> 8) + (7 << 5));
+        out[op++] = static_cast<uint8_t>(encodedLength - 7);
+      }
+      out[op++] = static_cast<uint8_t>(offset & 0xff);
+
+      // Hash the positions inside the match, so that they can be referenced later
+      for (size_t i = ip + 1; i < ip + length && i + 2 < inSize; ++i)
+      {
+        table[Hash(in + i)] = i + 1;
+      }
+      ip += length;
+
+      literalStart = op++;
+      literals = 0;
+      continue;
+    }
+
+    if (op + 2 > outCapacity)
+    {
+      return 0;
+    }
+    out[op++] = in[ip++];
+    if (++literals == MaxLiteral)
+    {
+      out[literalStart] = static_cast<uint8_t>(MaxLiteral - 1);
+      literalStart = op++;
+      literals = 0;
+    }
+  }
+
+  if (literals > 0)
+  {
+    out[literalStart] = static_cast<uint8_t>(literals - 1);
+  }
+  else
+  {
+    --op;
+  }
+  return op;
+}
+
+//-----------------------------------------------------------------------------
+size_t LZFDecompress(const void* input, size_t inSize, void* output, size_t outCapacity)
+{
+  const uint8_t* in = static_cast<const uint8_t*>(input);
+  uint8_t* out = static_cast<uint8_t*>(output);
+
+  size_t ip = 0;
+  size_t op = 0;
+  while (ip < inSize)
+  {
+    const size_t control = in[ip++];
+    if (control < MaxLiteral)
+    {
+      const size_t length = control + 1;
+      if (ip + length > inSize || op + length > outCapacity)
+      {
+        return 0;
+      }
+      std::memcpy(out + op, in + ip, length);
+      ip += length;
+      op += length;
+      continue;
+    }
+
+    size_t length = control >> 5;
+    if (length == 7)
+    {
+      if (ip >= inSize)
+      {
+        return 0;
+      }
+      length += in[ip++];
+    }
+    if (ip >= inSize)
+    {
+      return 0;
+    }
+    const size_t offset = ((control & 0x1f) << 8) + in[ip++] + 1;
+    length += 2;
+    if (offset > op || op + length > outCapacity)
+    {
+      return 0;
+    }
+    // The reference may overlap the output, copy byte by byte
+    for (size_t i = 0; i < length; ++i, ++op)
+    {
+      out[op] = out[op - offset];
+    }
+  }
+  return op;
+}
@@ -0,0 +1,52 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef LZFCOMPRESSION_H
+#define LZFCOMPRESSION_H
+
+#include "LidarCoreModule.h"
+
+#include <cstddef>
+
+/**
+ * LZF compression, as used by the binary_compressed PCD files.
+ *
+ * The stream is a sequence of chunks, each starting with a control byte:
+ * - 000LLLLL: a run of L + 1 literal bytes follows
+ * - LLLooooo oooooooo: back reference of L + 2 bytes, at offset o + 1
+ * - 111ooooo LLLLLLLL oooooooo: same with a length of L + 9 bytes
+ */
+
+/**
+ * @brief LZFMaxCompressedSize size of the output buffer needed to compress inSize bytes,
+ * even if the data can not be compressed at all
+ */
+size_t LIDARCORE_EXPORT LZFMaxCompressedSize(size_t inSize);
+
+/**
+ * @brief LZFCompress compress inSize bytes from in to out
+ * @return the size of the compressed data, 0 if out is too small
+ */
+size_t LIDARCORE_EXPORT LZFCompress(const void* in, size_t inSize, void* out, size_t outCapacity);
+
+/**
+ * @brief LZFDecompress decompress inSize bytes from in to out
+ * @return the size of the decompressed data, 0 if out is too small or the data is corrupted
+ */
+size_t LIDARCORE_EXPORT LZFDecompress(const void* in, size_t inSize, void* out, size_t outCapacity);
+
+#endif // LZFCOMPRESSION_H
@@ -0,0 +1,260 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#include "FrameCatalogIndex.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <vtksys/SystemTools.hxx>
+
+const char* FrameCatalogIndex::Extension = ".lvindex";
+
+namespace
+{
+const char Magic[8] = { 'L', 'V', 'F', 'R', 'I', 'D', 'X', '\0' };
+
+//-----------------------------------------------------------------------------
+// 64 bits FNV-1a, stable across platforms and runs contrary to std::hash
+uint64_t HashBytes(const char* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void Append(std::string& buffer, const T& value)
+{
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//-----------------------------------------------------------------------------
+// Bounds checked sequential reader over the mapped index
+class BufferCursor
+{
+public:
+  BufferCursor(const char* data, size_t size) : Data(data), Size(size) {}
+
+  template <typename T>
+  bool Read(T& value)
+  {
+    return this->Read(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+
+  bool Read(char* out, size_t size)
+  {
+    if (!this->Skip(size))
+    {
+      return false;
+    }
+    std::memcpy(out, this->Data + this->Position - size, size);
+    return true;
+  }
+
+  bool Skip(size_t size)
+  {
+    if (size > this->Size - this->Position)
+    {
+      return false;
+    }
+    this->Position += size;
+    return true;
+  }
+
+  const char* Current() const { return this->Data + this->Position; }
+
+private:
+  const char* Data;
+  size_t Size;
+  size_t Position = 0;
+};
+}
+
+//-----------------------------------------------------------------------------
+bool FrameCatalogIndex::Initialize(const std::string& pcapFileName,
+                                   const std::string& interpreterClassName,
+                                   const std::string& calibrationFileName,
+                                   const std::string& parsingOptions)
+{
+  if (!vtksys::SystemTools::FileExists(pcapFileName, true))
+  {
+    return false;
+  }
+
+  this->IndexFileName = pcapFileName + FrameCatalogIndex::Extension;
+  this->FileSize = vtksys::SystemTools::FileLength(pcapFileName);
+  this->FileModificationTime = vtksys::SystemTools::ModifiedTime(pcapFileName);
+  this->InterpreterClassName = interpreterClassName;
+
+  this->CalibrationHash = 0;
+  if (!calibrationFileName.empty())
+  {
+    std::ifstream calibration(calibrationFileName, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(calibration)), std::istreambuf_iterator<char>());
+    this->CalibrationHash = HashBytes(content.data(), content.size());
+  }
+  this->ParsingOptionsHash = HashBytes(parsingOptions.data(), parsingOptions.size());
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool FrameCatalogIndex::Load(const FrameInformation& prototype,
+                             std::vector<FrameInformation>& catalog) const
+{
+  if (this->IndexFileName.empty() || !vtksys::SystemTools::FileExists(this->IndexFileName, true))
+  {
+    return false;
+  }
+
+  boost::iostreams::mapped_file_source file;
+  try
+  {
+    file.open(this->IndexFileName);
+  }
+  catch (const std::exception&)
+  {
+    return false;
+  }
+  if (!file.is_open())
+  {
+    return false;
+  }
+
+  BufferCursor cursor(file.data(), file.size());
+
+  // Header, every field must match the key of the current capture
+  char magic[sizeof(Magic)];
+  uint32_t version = 0, fposSize = 0, classNameSize = 0;
+  uint64_t fileSize = 0, calibrationHash = 0, parsingOptionsHash = 0, numberOfFrames = 0;
+  int64_t modificationTime = 0;
+  if (!cursor.Read(magic, sizeof(Magic)) || std::memcmp(magic, Magic, sizeof(Magic)) != 0 ||
+      !cursor.Read(version) || version != FrameCatalogIndex::Version ||
+      !cursor.Read(fposSize) || fposSize != sizeof(fpos_t) ||
+      !cursor.Read(fileSize) || fileSize != this->FileSize ||
+      !cursor.Read(modificationTime) || modificationTime != this->FileModificationTime ||
+      !cursor.Read(calibrationHash) || calibrationHash != this->CalibrationHash ||
+      !cursor.Read(parsingOptionsHash) || parsingOptionsHash != this->ParsingOptionsHash ||
+      !cursor.Read(classNameSize) || classNameSize != this->InterpreterClassName.size() ||
+      !cursor.Skip(classNameSize) ||
+      std::memcmp(cursor.Current() - classNameSize, this->InterpreterClassName.data(), classNameSize) != 0 ||
+      !cursor.Read(numberOfFrames))
+  {
+    return false;
+  }
+
+  // Reject corrupted counts before allocating anything
+  const size_t minimumFrameRecordSize = sizeof(fpos_t) + 2 * sizeof(double) + sizeof(uint32_t);
+  if (numberOfFrames > file.size() / minimumFrameRecordSize)
+  {
+    return false;
+  }
+
+  std::vector<FrameInformation> frames(numberOfFrames);
+  for (FrameInformation& frame : frames)
+  {
+    uint32_t specificSize = 0;
+    if (!cursor.Read(frame.FilePosition) ||
+        !cursor.Read(frame.FirstPacketNetworkTime) ||
+        !cursor.Read(frame.FirstPacketDataTime) ||
+        !cursor.Read(specificSize))
+    {
+      return false;
+    }
+
+    if (prototype.SpecificInformation)
+    {
+      frame.SpecificInformation = prototype.SpecificInformation->clone();
+      if (!frame.SpecificInformation->deserialize(cursor.Current(), specificSize))
+      {
+        return false;
+      }
+    }
+    if (!cursor.Skip(specificSize))
+    {
+      return false;
+    }
+  }
+
+  catalog.swap(frames);
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool FrameCatalogIndex::Save(const std::vector<FrameInformation>& catalog) const
+{
+  if (this->IndexFileName.empty())
+  {
+    return false;
+  }
+
+  std::string buffer;
+  buffer.append(Magic, sizeof(Magic));
+  Append(buffer, static_cast<uint32_t>(FrameCatalogIndex::Version));
+  Append(buffer, static_cast<uint32_t>(sizeof(fpos_t)));
+  Append(buffer, this->FileSize);
+  Append(buffer, this->FileModificationTime);
+  Append(buffer, this->CalibrationHash);
+  Append(buffer, this->ParsingOptionsHash);
+  Append(buffer, static_cast<uint32_t>(this->InterpreterClassName.size()));
+  buffer.append(this->InterpreterClassName);
+  Append(buffer, static_cast<uint64_t>(catalog.size()));
+
+  std::string specific;
+  for (const FrameInformation& frame : catalog)
+  {
+    specific.clear();
+    if (frame.SpecificInformation && !frame.SpecificInformation->serialize(specific))
+    {
+      // The sensor cannot persist its parser state, the index would be useless
+      return false;
+    }
+    Append(buffer, frame.FilePosition);
+    Append(buffer, frame.FirstPacketNetworkTime);
+    Append(buffer, frame.FirstPacketDataTime);
+    Append(buffer, static_cast<uint32_t>(specific.size()));
+    buffer.append(specific);
+  }
+
+  // Write to a temporary file first so that a concurrent reader
+  // never sees a partially written index
+  const std::string temporaryFileName = this->IndexFileName + ".tmp";
+  {
+    std::ofstream file(temporaryFileName, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+      return false;
+    }
+    file.write(buffer.data(), buffer.size());
+    if (!file.good())
+    {
+      file.close();
+      vtksys::SystemTools::RemoveFile(temporaryFileName);
+      return false;
+    }
+  }
+
+  vtksys::SystemTools::RemoveFile(this->IndexFileName);
+  return static_cast<bool>(vtksys::SystemTools::RenameFile(temporaryFileName, this->IndexFileName));
+}
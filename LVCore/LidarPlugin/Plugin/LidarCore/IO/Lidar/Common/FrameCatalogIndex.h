@@ -0,0 +1,91 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef FRAME_CATALOG_INDEX_H
+#define FRAME_CATALOG_INDEX_H
+
+//Compliance with vtk's fpos_t policy, needs to be included before any libc header
+#include <vtkSystemIncludes.h>
+
+#include "IO/FrameInformation.h"
+
+#include "LidarCoreModule.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * \class FrameCatalogIndex
+ * \brief Persist the frame catalog built by vtkLidarReader in a sidecar file
+ *        next to the pcap, so that the whole capture does not need to be
+ *        scanned again the next time it is opened.
+ *
+ * The index is only reused if it has been generated from the same capture
+ * (size and modification time), with the same interpreter class, the same
+ * calibration file content and the same parsing options.
+ */
+class LIDARCORE_EXPORT FrameCatalogIndex
+{
+public:
+  //! Bump this each time the on-disk layout changes
+  static const uint32_t Version = 1;
+
+  //! Extension appended to the pcap file name to get the index file name
+  static const char* Extension;
+
+  /**
+   * @brief Initialize compute the key identifying the capture and its parsing parameters
+   * @param pcapFileName capture to index
+   * @param interpreterClassName name of the interpreter class used to build the catalog
+   * @param calibrationFileName calibration file, its content is hashed
+   * @param parsingOptions any other option that changes the catalog (port filter, framing, ...)
+   * @return false if the capture could not be found
+   */
+  bool Initialize(const std::string& pcapFileName,
+                  const std::string& interpreterClassName,
+                  const std::string& calibrationFileName,
+                  const std::string& parsingOptions);
+
+  /**
+   * @brief Load memory-map the index file and fill the catalog if it matches the key
+   * @param prototype frame information of the interpreter, used to instanciate
+   *        the sensor specific information of each frame
+   * @param catalog[out] the frame catalog, only modified on success
+   */
+  bool Load(const FrameInformation& prototype, std::vector<FrameInformation>& catalog) const;
+
+  /**
+   * @brief Save write the catalog to the index file
+   * @return false if the catalog could not be saved, for example because the sensor
+   *         specific information does not support serialization or because the
+   *         capture folder is read-only
+   */
+  bool Save(const std::vector<FrameInformation>& catalog) const;
+
+  const std::string& GetIndexFileName() const { return this->IndexFileName; }
+
+private:
+  std::string IndexFileName;
+  uint64_t FileSize = 0;
+  int64_t FileModificationTime = 0;
+  std::string InterpreterClassName;
+  uint64_t CalibrationHash = 0;
+  uint64_t ParsingOptionsHash = 0;
+};
+
+#endif // FRAME_CATALOG_INDEX_H
@@ -0,0 +1,149 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef LIDAR_FRAME_CACHE_H
+#define LIDAR_FRAME_CACHE_H
+
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <list>
+#include <unordered_map>
+
+/**
+ * \class LidarFrameCache
+ * \brief Least recently used cache of decoded frames, indexed by frame number.
+ *        The cache is bounded by the memory used by the frames, not by their count,
+ *        as the size of a frame depends on the sensor and on the enabled arrays.
+ */
+class LidarFrameCache
+{
+public:
+  /**
+   * @brief Get return the cached frame and mark it as the most recently used one
+   * @return nullptr if the frame is not cached
+   */
+  vtkSmartPointer<vtkPolyData> Get(int frameNumber)
+  {
+    auto it = this->Frames.find(frameNumber);
+    if (it == this->Frames.end())
+    {
+      this->Misses++;
+      return nullptr;
+    }
+    this->Hits++;
+    this->Usage.splice(this->Usage.begin(), this->Usage, it->second.UsageIterator);
+    return it->second.Frame;
+  }
+
+  /**
+   * @brief Contains check if a frame is cached, without updating the usage nor the counters
+   */
+  bool Contains(int frameNumber) const { return this->Frames.count(frameNumber) != 0; }
+
+  /**
+   * @brief Put add a frame to the cache, evicting the least recently used frames
+   *        until the memory limit is respected. Frames larger than the limit are not cached.
+   */
+  void Put(int frameNumber, vtkPolyData* frame)
+  {
+    if (!frame)
+    {
+      return;
+    }
+    this->Remove(frameNumber);
+
+    const unsigned long long frameSize = frame->GetActualMemorySize() * 1024ull;
+    if (frameSize > this->MemoryLimit)
+    {
+      return;
+    }
+
+    this->Usage.push_front(frameNumber);
+    this->Frames[frameNumber] = { frame, frameSize, this->Usage.begin() };
+    this->MemoryUsed += frameSize;
+    this->Shrink();
+  }
+
+  /**
+   * @brief Clear remove all frames, the counters are kept
+   */
+  void Clear()
+  {
+    this->Frames.clear();
+    this->Usage.clear();
+    this->MemoryUsed = 0;
+  }
+
+  void ResetCounters()
+  {
+    this->Hits = 0;
+    this->Misses = 0;
+  }
+
+  void SetMemoryLimit(unsigned long long bytes)
+  {
+    this->MemoryLimit = bytes;
+    this->Shrink();
+  }
+  unsigned long long GetMemoryLimit() const { return this->MemoryLimit; }
+  unsigned long long GetMemoryUsed() const { return this->MemoryUsed; }
+  size_t GetNumberOfFrames() const { return this->Frames.size(); }
+
+  unsigned long long GetHits() const { return this->Hits.load(std::memory_order_relaxed); }
+  unsigned long long GetMisses() const { return this->Misses.load(std::memory_order_relaxed); }
+
+private:
+  struct Entry
+  {
+    vtkSmartPointer<vtkPolyData> Frame;
+    unsigned long long Size;
+    std::list<int>::iterator UsageIterator;
+  };
+
+  void Remove(int frameNumber)
+  {
+    auto it = this->Frames.find(frameNumber);
+    if (it != this->Frames.end())
+    {
+      this->MemoryUsed -= it->second.Size;
+      this->Usage.erase(it->second.UsageIterator);
+      this->Frames.erase(it);
+    }
+  }
+
+  void Shrink()
+  {
+    while (this->MemoryUsed > this->MemoryLimit && !this->Usage.empty())
+    {
+      this->Remove(this->Usage.back());
+    }
+  }
+
+  //! Frames number ordered from the most recently used to the least recently used
+  std::list<int> Usage;
+  std::unordered_map<int, Entry> Frames;
+
+  unsigned long long MemoryLimit = 0;
+  unsigned long long MemoryUsed = 0;
+  //! Read without the lock of the owner of the cache, to display the statistics
+  std::atomic<unsigned long long> Hits{ 0 };
+  std::atomic<unsigned long long> Misses{ 0 };
+};
+
+#endif // LIDAR_FRAME_CACHE_H
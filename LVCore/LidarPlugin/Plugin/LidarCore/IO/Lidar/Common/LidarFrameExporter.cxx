@@ -0,0 +1,301 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#include "LidarFrameExporter.h"
+
+#include "vtkLidarReader.h"
+
+#include <vtkPolyData.h>
+
+//-----------------------------------------------------------------------------
+LidarFrameExporter::LidarFrameExporter(vtkLidarReader* reader)
+  : Reader(reader)
+{
+  const int cores = std::max(1u, std::thread::hardware_concurrency());
+  this->NumberOfDecodingThreads = std::max(1, cores / 2);
+  this->NumberOfEncodingThreads = std::max(1, cores - this->NumberOfDecodingThreads);
+}
+
+//-----------------------------------------------------------------------------
+LidarFrameExporter::~LidarFrameExporter()
+{
+  this->Abort();
+  this->Join();
+}
+
+//-----------------------------------------------------------------------------
+bool LidarFrameExporter::Start(int firstFrame, int lastFrame, EncodeFunction encode)
+{
+  if (!this->Threads.empty() || !this->Reader || !encode || firstFrame < 0 ||
+    firstFrame > lastFrame)
+  {
+    return false;
+  }
+
+  this->EncodeFrame = std::move(encode);
+  this->FirstFrame = firstFrame;
+  this->LastFrame = lastFrame;
+  this->FramesDone = 0;
+  this->Aborted = false;
+  this->Failed = false;
+
+  // Without a clone of the interpreter, the reader decodes under lock: one chunk only
+  const int numberOfFrames = lastFrame - firstFrame + 1;
+  int numberOfChunks = 1;
+  if (this->NumberOfDecodingThreads > 1 && this->Reader->SupportsConcurrentDecoding())
+  {
+    numberOfChunks = std::min(this->NumberOfDecodingThreads, numberOfFrames);
+  }
+  this->MaximumPendingFramesPerChunk = std::max(1, this->MaximumPendingFrames / numberOfChunks);
+
+  this->Chunks.clear();
+  this->Chunks.resize(numberOfChunks);
+  for (int i = 0; i < numberOfChunks; ++i)
+  {
+    this->Chunks[i].First = firstFrame + (numberOfFrames * i) / numberOfChunks;
+    this->Chunks[i].Last = firstFrame + (numberOfFrames * (i + 1)) / numberOfChunks - 1;
+  }
+
+  this->RunningThreads = numberOfChunks + this->NumberOfEncodingThreads;
+  for (Chunk& chunk : this->Chunks)
+  {
+    this->Threads.emplace_back(&LidarFrameExporter::Decode, this, std::ref(chunk));
+  }
+  for (int i = 0; i < this->NumberOfEncodingThreads; ++i)
+  {
+    this->Threads.emplace_back(&LidarFrameExporter::Encode, this);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void LidarFrameExporter::Decode(Chunk& chunk)
+{
+  const bool success = this->Reader->DecodeFrames(chunk.First, chunk.Last,
+    [this, &chunk](int frameIndex, vtkSmartPointer<vtkPolyData> frame) {
+      std::unique_lock<std::mutex> lock(this->Mutex);
+      this->FrameConsumed.wait(lock, [this, &chunk]() {
+        return this->Aborted ||
+          static_cast<int>(chunk.Queue.size()) < this->MaximumPendingFramesPerChunk;
+      });
+      if (this->Aborted)
+      {
+        return false;
+      }
+      chunk.Queue.emplace_back(frameIndex, frame);
+      ++chunk.Decoded;
+      this->StateChanged.notify_all();
+      return true;
+    });
+
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  chunk.DecodingDone = true;
+  if (!this->Aborted && (!success || chunk.Decoded != chunk.Last - chunk.First + 1))
+  {
+    this->Failed = true;
+    this->Aborted = true;
+    this->FrameConsumed.notify_all();
+  }
+  --this->RunningThreads;
+  this->StateChanged.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+void LidarFrameExporter::Encode()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  std::pair<int, vtkSmartPointer<vtkPolyData>> frame;
+  while (!this->Aborted)
+  {
+    if (this->PopFrame(false, frame))
+    {
+      lock.unlock();
+      const bool success = this->EncodeFrame(frame.first, frame.second);
+      // Release the frame outside of the lock
+      frame.second = nullptr;
+      lock.lock();
+      this->FrameEncoded(success);
+      continue;
+    }
+
+    const bool decodingDone = std::all_of(this->Chunks.begin(), this->Chunks.end(),
+      [](const Chunk& chunk) { return chunk.DecodingDone && chunk.Queue.empty(); });
+    if (decodingDone)
+    {
+      break;
+    }
+    this->StateChanged.wait(lock);
+  }
+  --this->RunningThreads;
+  this->StateChanged.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+LidarFrameExporter::Chunk* LidarFrameExporter::GetNextChunk()
+{
+  const int nextFrame = this->FirstFrame + this->FramesDone;
+  for (Chunk& chunk : this->Chunks)
+  {
+    if (nextFrame >= chunk.First && nextFrame <= chunk.Last)
+    {
+      return &chunk;
+    }
+  }
+  return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+bool LidarFrameExporter::PopFrame(bool ordered, std::pair<int, vtkSmartPointer<vtkPolyData>>& frame)
+{
+  Chunk* source = nullptr;
+  if (ordered)
+  {
+    source = this->GetNextChunk();
+  }
+  else
+  {
+    // The earliest frames first, so that the files appear roughly in order
+    for (Chunk& chunk : this->Chunks)
+    {
+      if (!chunk.Queue.empty())
+      {
+        source = &chunk;
+        break;
+      }
+    }
+  }
+  if (!source || source->Queue.empty())
+  {
+    return false;
+  }
+
+  frame = std::move(source->Queue.front());
+  source->Queue.pop_front();
+  this->FrameConsumed.notify_all();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void LidarFrameExporter::FrameEncoded(bool success)
+{
+  ++this->FramesDone;
+  if (!success && !this->Aborted)
+  {
+    this->Failed = true;
+    this->Aborted = true;
+    this->FrameConsumed.notify_all();
+  }
+  this->StateChanged.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+void LidarFrameExporter::Poll()
+{
+  if (this->NumberOfEncodingThreads > 0)
+  {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  std::pair<int, vtkSmartPointer<vtkPolyData>> frame;
+  if (this->Aborted || !this->PopFrame(true, frame))
+  {
+    return;
+  }
+  lock.unlock();
+  const bool success = this->EncodeFrame(frame.first, frame.second);
+  frame.second = nullptr;
+  lock.lock();
+  this->FrameEncoded(success);
+}
+
+//-----------------------------------------------------------------------------
+int LidarFrameExporter::GetNumberOfFramesDone() const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->FramesDone;
+}
+
+//-----------------------------------------------------------------------------
+bool LidarFrameExporter::IsFinishedLocked() const
+{
+  if (this->RunningThreads > 0)
+  {
+    return false;
+  }
+  // In ordered mode, decoded frames may still wait for Poll
+  return this->Aborted ||
+    std::all_of(this->Chunks.begin(), this->Chunks.end(),
+      [](const Chunk& chunk) { return chunk.Queue.empty(); });
+}
+
+//-----------------------------------------------------------------------------
+bool LidarFrameExporter::IsFinished() const
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->IsFinishedLocked();
+}
+
+//-----------------------------------------------------------------------------
+void LidarFrameExporter::Abort()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  this->Aborted = true;
+  this->FrameConsumed.notify_all();
+  this->StateChanged.notify_all();
+}
+
+//-----------------------------------------------------------------------------
+bool LidarFrameExporter::Wait()
+{
+  const bool ordered = this->NumberOfEncodingThreads == 0;
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (!this->IsFinishedLocked())
+    {
+      if (ordered)
+      {
+        Chunk* next = this->GetNextChunk();
+        if (!this->Aborted && next && !next->Queue.empty())
+        {
+          lock.unlock();
+          this->Poll();
+          lock.lock();
+          continue;
+        }
+      }
+      this->StateChanged.wait(lock);
+    }
+  }
+  this->Join();
+
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return !this->Failed && !this->Aborted && this->FramesDone == this->GetNumberOfFrames();
+}
+
+//-----------------------------------------------------------------------------
+void LidarFrameExporter::Join()
+{
+  for (std::thread& thread : this->Threads)
+  {
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+  this->Threads.clear();
+}
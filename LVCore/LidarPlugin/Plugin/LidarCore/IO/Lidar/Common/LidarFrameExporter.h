@@ -0,0 +1,148 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef LIDAR_FRAME_EXPORTER_H
+#define LIDAR_FRAME_EXPORTER_H
+
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "LidarCoreModule.h"
+
+class vtkLidarReader;
+class vtkPolyData;
+
+/**
+ * \class LidarFrameExporter
+ * \brief Decode a range of frames of a vtkLidarReader in the background and
+ *        pass each of them to an encode function, to save them to disk.
+ *
+ * The range is split in contiguous chunks, each decoded by its own thread which
+ * reads its part of the capture only once, in order (see vtkLidarReader::DecodeFrames).
+ * A single chunk is used if the interpreter can not be cloned.
+ * The decoded frames are then encoded either:
+ * - by a pool of encoding threads, the encode function must then be thread safe
+ * - in frame order, on the thread calling Poll(), when there is no encoding thread.
+ *   This is meant for encoders which must run on the main thread, such as proxies.
+ *
+ * The number of decoded frames waiting to be encoded is bounded, so that the
+ * memory used does not depend on the size of the range.
+ */
+class LIDARCORE_EXPORT LidarFrameExporter
+{
+public:
+  //! Save a frame, return false to stop the export
+  using EncodeFunction = std::function<bool(int frameIndex, vtkPolyData* frame)>;
+
+  explicit LidarFrameExporter(vtkLidarReader* reader);
+  ~LidarFrameExporter();
+
+  LidarFrameExporter(const LidarFrameExporter&) = delete;
+  LidarFrameExporter& operator=(const LidarFrameExporter&) = delete;
+
+  //! Number of threads decoding the capture, at least 1
+  void SetNumberOfDecodingThreads(int count) { this->NumberOfDecodingThreads = std::max(1, count); }
+  int GetNumberOfDecodingThreads() const { return this->NumberOfDecodingThreads; }
+
+  //! Number of threads encoding the frames, 0 to encode them in order from Poll()
+  void SetNumberOfEncodingThreads(int count) { this->NumberOfEncodingThreads = std::max(0, count); }
+  int GetNumberOfEncodingThreads() const { return this->NumberOfEncodingThreads; }
+
+  //! Maximum number of decoded frames waiting to be encoded
+  void SetMaximumPendingFrames(int count) { this->MaximumPendingFrames = std::max(1, count); }
+  int GetMaximumPendingFrames() const { return this->MaximumPendingFrames; }
+
+  /**
+   * @brief Start the export of the frames [firstFrame, lastFrame] of the reader catalog
+   * @return false if the range is invalid or an export is already running
+   */
+  bool Start(int firstFrame, int lastFrame, EncodeFunction encode);
+
+  /**
+   * @brief Poll encode the next frame if it is ready, when there is no encoding thread.
+   *        Does not wait for it, and does nothing if there are encoding threads.
+   */
+  void Poll();
+
+  //! Number of frames encoded so far
+  int GetNumberOfFramesDone() const;
+
+  //! Total number of frames to export
+  int GetNumberOfFrames() const { return this->LastFrame - this->FirstFrame + 1; }
+
+  //! True once all frames are encoded, or the export has been stopped
+  bool IsFinished() const;
+
+  //! Stop the export as soon as possible, the frames being encoded are completed
+  void Abort();
+
+  /**
+   * @brief Wait for the end of the export, polling the frames if there is no encoding thread
+   * @return true if all frames have been decoded and encoded
+   */
+  bool Wait();
+
+private:
+  struct Chunk
+  {
+    int First = 0;
+    int Last = 0;
+    int Decoded = 0;
+    bool DecodingDone = false;
+    std::deque<std::pair<int, vtkSmartPointer<vtkPolyData>>> Queue;
+  };
+
+  void Decode(Chunk& chunk);
+  void Encode();
+  //! Chunk holding the next frame to encode in order, null if done. Lock must be held.
+  Chunk* GetNextChunk();
+  //! Pop the next frame to encode, from the earliest chunk if not ordered. Lock must be held.
+  bool PopFrame(bool ordered, std::pair<int, vtkSmartPointer<vtkPolyData>>& frame);
+  void FrameEncoded(bool success);
+  bool IsFinishedLocked() const;
+  void Join();
+
+  vtkLidarReader* Reader = nullptr;
+  EncodeFunction EncodeFrame;
+  int NumberOfDecodingThreads = 1;
+  int NumberOfEncodingThreads = 1;
+  int MaximumPendingFrames = 16;
+  int MaximumPendingFramesPerChunk = 16;
+
+  int FirstFrame = 0;
+  int LastFrame = -1;
+  int FramesDone = 0;
+  int RunningThreads = 0;
+  bool Aborted = false;
+  bool Failed = false;
+
+  std::vector<Chunk> Chunks;
+  std::vector<std::thread> Threads;
+  mutable std::mutex Mutex;
+  std::condition_variable StateChanged;  /*!< frame decoded or encoded, thread finished */
+  std::condition_variable FrameConsumed; /*!< room available in a chunk queue */
+};
+
+#endif // LIDAR_FRAME_EXPORTER_H
@@ -0,0 +1,234 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef LIDAR_FRAME_POOL_H
+#define LIDAR_FRAME_POOL_H
+
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+/**
+ * \class LidarFramePool
+ * \brief Recycle the points and arrays of the frames built by an interpreter.
+ *
+ * Each new frame is a new vtkPolyData, but its points and arrays are taken from
+ * a previous frame once nothing references them anymore: a buffer held by the pool
+ * only (reference count of 1) can not be reached by anyone else, it is overwritten
+ * without any allocation. The frames still used (by the interpreter, the reader cache,
+ * a filter output sharing the arrays, ...) are never recycled.
+ *
+ * The arrays are matched by name and type, so that the layout of the frames can change
+ * (advanced arrays, schema, ...) without clearing the pool. Frames requested while all
+ * the pooled buffers are in use are allocated outside of the pool.
+ *
+ * Not thread safe, except the occupancy getters which can be called from any thread.
+ */
+class LidarFramePool
+{
+public:
+  /**
+   * @brief NewFrame start a frame of numberOfPoints points, reusing the points of
+   *        a released frame when possible. Recycled points are filled with 0.
+   */
+  vtkSmartPointer<vtkPolyData> NewFrame(vtkIdType numberOfPoints, int pointsDataType = VTK_FLOAT)
+  {
+    this->Spare.clear();
+    this->CurrentEntry = -1;
+    this->NumberOfPoints = numberOfPoints;
+
+    // Look at all the entries, to report how many frames are still in use
+    size_t inUse = 0;
+    for (size_t index = 0; index < this->Entries.size(); ++index)
+    {
+      const Entry& entry = this->Entries[index];
+      if (!IsReleased(entry))
+      {
+        inUse++;
+      }
+      else if (this->CurrentEntry < 0 && entry.Points->GetDataType() == pointsDataType)
+      {
+        this->CurrentEntry = static_cast<int>(index);
+      }
+    }
+    this->NumberOfFramesInUse = inUse;
+
+    vtkSmartPointer<vtkPoints> points;
+    if (this->CurrentEntry >= 0)
+    {
+      Entry& entry = this->Entries[this->CurrentEntry];
+      this->Spare.swap(entry.Arrays);
+      points = entry.Points;
+      points->SetNumberOfPoints(numberOfPoints);
+      FillWithZeros(points->GetData());
+      points->Modified();
+      this->NumberOfRecycledFrames++;
+    }
+    else
+    {
+      points = vtkSmartPointer<vtkPoints>::New();
+      points->SetDataType(pointsDataType);
+      points->SetNumberOfPoints(numberOfPoints);
+      if (this->Entries.size() < this->MaximumNumberOfFrames)
+      {
+        this->CurrentEntry = static_cast<int>(this->Entries.size());
+        this->Entries.push_back({ points, {} });
+        this->NumberOfFrames = this->Entries.size();
+      }
+      else
+      {
+        this->NumberOfUnpooledFrames++;
+      }
+    }
+
+    vtkSmartPointer<vtkPolyData> frame = vtkSmartPointer<vtkPolyData>::New();
+    frame->SetPoints(points);
+    return frame;
+  }
+
+  /**
+   * @brief AddArray add an array of one value per point, filled with 0, to the frame
+   *        started by the last NewFrame. The array of the recycled frame with the same
+   *        name and type is reused if any.
+   */
+  template <typename T>
+  vtkSmartPointer<T> AddArray(vtkPolyData* frame, const char* name)
+  {
+    vtkSmartPointer<T> array;
+    for (size_t index = 0; index < this->Spare.size(); ++index)
+    {
+      T* candidate = T::SafeDownCast(this->Spare[index]);
+      if (candidate && candidate->GetName() && std::strcmp(candidate->GetName(), name) == 0)
+      {
+        array = candidate;
+        this->Spare[index] = this->Spare.back();
+        this->Spare.pop_back();
+        break;
+      }
+    }
+    if (!array)
+    {
+      array = vtkSmartPointer<T>::New();
+      array->SetName(name);
+    }
+    array->SetNumberOfValues(this->NumberOfPoints);
+    FillWithZeros(array);
+    array->Modified();
+
+    if (this->CurrentEntry >= 0)
+    {
+      this->Entries[this->CurrentEntry].Arrays.push_back(array);
+    }
+    frame->GetPointData()->AddArray(array);
+    return array;
+  }
+
+  /**
+   * @brief SetMaximumNumberOfFrames number of frames whose buffers are kept.
+   *        It should cover the frames held at the same time by the consumers.
+   */
+  void SetMaximumNumberOfFrames(size_t value)
+  {
+    this->MaximumNumberOfFrames = value;
+    if (this->Entries.size() > value)
+    {
+      // The arrays of the frame under construction are owned by the frame, only forget them
+      this->Entries.resize(value);
+      this->NumberOfFrames = value;
+      if (this->CurrentEntry >= static_cast<int>(value))
+      {
+        this->CurrentEntry = -1;
+      }
+    }
+  }
+  size_t GetMaximumNumberOfFrames() const { return this->MaximumNumberOfFrames; }
+
+  //! Forget all the buffers, the frames still in use keep theirs
+  void Clear()
+  {
+    this->Entries.clear();
+    this->Spare.clear();
+    this->CurrentEntry = -1;
+    this->NumberOfFrames = 0;
+    this->NumberOfFramesInUse = 0;
+  }
+
+  //! Number of frames whose buffers are kept by the pool
+  size_t GetNumberOfFrames() const { return this->NumberOfFrames; }
+  //! Number of pooled frames which were still in use when the last frame was started
+  size_t GetNumberOfFramesInUse() const { return this->NumberOfFramesInUse; }
+  //! Number of frames built from the buffers of a released frame
+  unsigned long long GetNumberOfRecycledFrames() const { return this->NumberOfRecycledFrames; }
+  //! Number of frames allocated outside of the pool as it was full, the pool is too small if this grows
+  unsigned long long GetNumberOfUnpooledFrames() const { return this->NumberOfUnpooledFrames; }
+
+private:
+  struct Entry
+  {
+    vtkSmartPointer<vtkPoints> Points;
+    std::vector<vtkSmartPointer<vtkDataArray>> Arrays;
+  };
+
+  //! True if only the pool references the buffers of the entry
+  static bool IsReleased(const Entry& entry)
+  {
+    if (entry.Points->GetReferenceCount() != 1 || entry.Points->GetData()->GetReferenceCount() != 1)
+    {
+      return false;
+    }
+    for (const auto& array : entry.Arrays)
+    {
+      if (array->GetReferenceCount() != 1)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void FillWithZeros(vtkDataArray* array)
+  {
+    const vtkIdType size = array->GetNumberOfValues() * array->GetDataTypeSize();
+    if (size > 0)
+    {
+      std::memset(array->GetVoidPointer(0), 0, static_cast<size_t>(size));
+    }
+  }
+
+  std::vector<Entry> Entries;
+  size_t MaximumNumberOfFrames = 8;
+
+  //! Entry of the frame under construction, -1 if it is not pooled
+  int CurrentEntry = -1;
+  vtkIdType NumberOfPoints = 0;
+  //! Arrays of the recycled entry not claimed yet by AddArray
+  std::vector<vtkSmartPointer<vtkDataArray>> Spare;
+
+  // Occupancy, updated by the thread building the frames and read by any other
+  std::atomic<size_t> NumberOfFrames{ 0 };
+  std::atomic<size_t> NumberOfFramesInUse{ 0 };
+  std::atomic<unsigned long long> NumberOfRecycledFrames{ 0 };
+  std::atomic<unsigned long long> NumberOfUnpooledFrames{ 0 };
+};
+
+#endif // LIDAR_FRAME_POOL_H
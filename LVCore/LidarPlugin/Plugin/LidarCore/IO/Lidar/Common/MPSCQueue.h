@@ -0,0 +1,257 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @brief The MPSCQueue class is a bounded lock-free FIFO, filled by any number of threads
+ * and emptied by a single one. It is the counterpart of SPSCQueue for the consumers shared
+ * by several producers, such as a recording shared by several streams.
+ *
+ * Each slot carries a sequence number telling whether it is free, being written or ready,
+ * so that the producers only compete on the tail, with a compare and swap, and the elements
+ * are dequeued in the order the producers reserved their slot. When the queue is full the
+ * new element is refused and passed to the discard function: the oldest ones can not be
+ * taken back from the consumer without a lock.
+ *
+ * The queue can be finished and restarted, so that the producers can keep a plain reference
+ * to it across several runs of the consumer. The elements must be trivially copyable,
+ * typically pointers.
+ */
+template<typename T>
+class MPSCQueue
+{
+  static_assert(std::is_trivially_copyable<T>::value, "MPSCQueue elements must be trivially copyable");
+
+public:
+  /**
+   * @param capacity maximum number of elements, rounded up to a power of 2
+   * @param discard called with each refused element, and with the elements
+   *        still queued when the queue is destroyed, to release them
+   */
+  MPSCQueue(size_t capacity, std::function<void(T)> discard = nullptr)
+    : Discard(discard)
+  {
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity)
+    {
+      roundedCapacity <<= 1;
+    }
+    this->Mask = roundedCapacity - 1;
+    this->Slots.reset(new Slot[roundedCapacity]);
+    for (size_t i = 0; i < roundedCapacity; ++i)
+    {
+      this->Slots[i].Sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  ~MPSCQueue()
+  {
+    T element;
+    while (this->tryDequeue(element))
+    {
+      this->DiscardElement(element);
+    }
+  }
+
+  /**
+   * @brief enqueue add an element, can be called from any thread
+   * @return false if the element has been refused, because the queue is full or finished
+   */
+  bool enqueue(const T& data)
+  {
+    // Announce the producer before looking at the state, see dequeueBatch
+    this->ActiveProducers.fetch_add(1, std::memory_order_seq_cst);
+    const bool accepted = !this->FinishRequested.load(std::memory_order_seq_cst) && this->Push(data);
+    this->ActiveProducers.fetch_sub(1, std::memory_order_release);
+    if (!accepted)
+    {
+      this->DiscardElement(data);
+    }
+    return accepted;
+  }
+
+  /**
+   * @brief dequeueBatch wait for at least one element and move up to maxCount of them
+   * to result, only call it from the consumer thread
+   * @return the number of elements moved, 0 once the queue is finished and empty
+   */
+  size_t dequeueBatch(T* result, size_t maxCount)
+  {
+    int idleLoops = 0;
+    while (true)
+    {
+      // Once the queue is finished and no producer is running, nothing can be added anymore.
+      // Read before the queue, so that the elements of the last producers are seen.
+      const bool finished = this->FinishRequested.load(std::memory_order_seq_cst) &&
+        this->ActiveProducers.load(std::memory_order_seq_cst) == 0;
+
+      size_t count = 0;
+      while (count < maxCount && this->tryDequeue(result[count]))
+      {
+        ++count;
+      }
+      if (count > 0)
+      {
+        return count;
+      }
+      if (finished)
+      {
+        return 0;
+      }
+      this->Wait(idleLoops++);
+    }
+  }
+
+  /**
+   * @brief finishQueue refuse the new elements, the consumer stops dequeuing
+   * once it has dequeued all the elements already queued.
+   * Can be called while the producers are enqueuing.
+   */
+  void finishQueue()
+  {
+    this->FinishRequested.store(true, std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief restartQueue accept new elements again after finishQueue(),
+   * and reset the number of dropped elements. The previous consumer must be done.
+   */
+  void restartQueue()
+  {
+    this->Dropped.store(0, std::memory_order_relaxed);
+    this->FinishRequested.store(false, std::memory_order_seq_cst);
+  }
+
+  //! Approximate number of queued elements
+  size_t size() const
+  {
+    const uint64_t head = this->Head.load(std::memory_order_acquire);
+    const uint64_t tail = this->Tail.load(std::memory_order_acquire);
+    return static_cast<size_t>(tail > head ? tail - head : 0);
+  }
+
+  bool isEmpty() const { return this->size() == 0; }
+
+  size_t capacity() const { return this->Mask + 1; }
+
+  //! Number of elements refused because the queue was full, since the last restart
+  uint64_t droppedCount() const { return this->Dropped.load(std::memory_order_relaxed); }
+
+private:
+  struct Slot
+  {
+    //! index of the element the slot is ready for, +1 once it holds it
+    std::atomic<uint64_t> Sequence;
+    T Data;
+  };
+
+  bool Push(const T& data)
+  {
+    uint64_t tail = this->Tail.load(std::memory_order_relaxed);
+    while (true)
+    {
+      Slot& slot = this->Slots[tail & this->Mask];
+      const int64_t difference = static_cast<int64_t>(slot.Sequence.load(std::memory_order_acquire)) -
+        static_cast<int64_t>(tail);
+      if (difference == 0)
+      {
+        // The slot is free, reserve it unless another producer did
+        if (this->Tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+        {
+          slot.Data = data;
+          slot.Sequence.store(tail + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0)
+      {
+        // The slot still holds the element of the previous turn
+        this->Dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      else
+      {
+        tail = this->Tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool tryDequeue(T& result)
+  {
+    const uint64_t head = this->Head.load(std::memory_order_relaxed);
+    Slot& slot = this->Slots[head & this->Mask];
+    if (slot.Sequence.load(std::memory_order_acquire) != head + 1)
+    {
+      // Empty, or the producer of the next element is still writing it
+      return false;
+    }
+    result = slot.Data;
+    slot.Sequence.store(head + this->Mask + 1, std::memory_order_release);
+    this->Head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  void DiscardElement(T data)
+  {
+    if (this->Discard)
+    {
+      this->Discard(data);
+    }
+  }
+
+  // Spin a little to catch bursts with a low latency,
+  // then sleep to avoid burning a core while the sensors are idle
+  static void Wait(int idleLoops)
+  {
+    if (idleLoops < 64)
+    {
+      std::this_thread::yield();
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+  std::unique_ptr<Slot[]> Slots;
+  uint64_t Mask = 0;
+  std::function<void(T)> Discard;
+
+  // Head and Tail are written by different threads, keep them on separate cache lines.
+  // Padding is used instead of alignas, as C++14 operator new ignores over-alignment.
+  char HeadPadding[64];
+  std::atomic<uint64_t> Head{ 0 };
+  char TailPadding[64];
+  std::atomic<uint64_t> Tail{ 0 };
+  std::atomic<int> ActiveProducers{ 0 };
+  std::atomic<uint64_t> Dropped{ 0 };
+  std::atomic<bool> FinishRequested{ false };
+  char EndPadding[64];
+};
+
+#endif // MPSCQUEUE_H
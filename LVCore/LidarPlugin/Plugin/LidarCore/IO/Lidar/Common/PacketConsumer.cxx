@@ -4,7 +4,7 @@
 #include <cassert>
 
 #include "NetworkPacket.h"
-#include "SynchronizedQueue.h"
+#include "SPSCQueue.h"
 #include "IO/vtkInterpreter.h"
 #include "IO/vtkStream.h"
 #include "Common/LVTime.h"
@@ -48,12 +48,15 @@ void PacketConsumer::HandleSensorData(NetworkPacket* packet)
 //----------------------------------------------------------------------------
 void PacketConsumer::ThreadLoop()
 {
-  NetworkPacket* packet = nullptr;
+  NetworkPacket* packets[BatchSize];
   this->Stream->GetInterpreter()->ResetCurrentData();
-  while (this->Packets->dequeue(packet))
+  while (size_t count = this->Packets->dequeueBatch(packets, BatchSize))
   {
-    this->HandleSensorData(packet);
-    delete packet;
+    for (size_t i = 0; i < count; ++i)
+    {
+      this->HandleSensorData(packets[i]);
+      packets[i]->Release();
+    }
   }
 }
 
@@ -62,7 +65,10 @@ void PacketConsumer::Start()
 {
   this->Stop();;
   this->Stream->GetInterpreter()->ResetCurrentData();
-  this->Packets = std::make_unique<SynchronizedQueue<NetworkPacket*>>();
+  this->DroppedPackets = 0;
+  this->Packets = std::make_unique<SPSCQueue<NetworkPacket*>>(this->PacketCacheSize,
+    SPSCQueue<NetworkPacket*>::OverflowPolicy::DropOldest,
+    [](NetworkPacket* packet) { packet->Release(); });
   this->Thread = std::make_unique<std::thread>(std::bind(&
                                                          PacketConsumer::ThreadLoop, this));
 }
@@ -75,6 +81,7 @@ void PacketConsumer::Stop()
     this->Packets->stopQueue();
     this->Thread->join();
     this->Thread.reset();
+    this->DroppedPackets = this->Packets->droppedCount();
     this->Packets.reset();
   }
 }
@@ -83,17 +90,16 @@ void PacketConsumer::Stop()
 void PacketConsumer::Enqueue(NetworkPacket* packet)
 {
   assert(this->Packets && "The consumer need to be started before enqueueing");
-  this->Packets->enqueue(packet);
-
   // In order to prevent memory usage to grow unbounded, we limit the growth of
   // the packet cache. Above an arbitrary limit it seems safe to assume that
   // the lateness of the consuming (decoding) thread has zero chance of being
-  // catched up and that packets can be dropped.
+  // catched up and that the oldest packets can be dropped by the queue.
   // To test: look at memory usage while running PacketFileSender --speed 100
-  if (this->Packets->size() > this->PacketCacheSize)
-  {
-      NetworkPacket* packetToDiscard = nullptr;
-      this->Packets->dequeue(packetToDiscard);
-      delete packetToDiscard;
-  }
+  this->Packets->enqueue(packet);
+}
+
+//----------------------------------------------------------------------------
+uint64_t PacketConsumer::GetNumberOfDroppedPackets() const
+{
+  return this->Packets ? this->Packets->droppedCount() : this->DroppedPackets;
 }
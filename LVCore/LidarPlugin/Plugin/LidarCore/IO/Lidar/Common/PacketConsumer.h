@@ -15,12 +15,13 @@
 #ifndef PACKETCONSUMER_H
 #define PACKETCONSUMER_H
 
+#include <cstdint>
 #include <memory>
 #include <thread>
 #include <mutex>
 
 template<typename T>
-class SynchronizedQueue;
+class SPSCQueue;
 class NetworkPacket;
 class vtkStream;
 
@@ -38,14 +39,21 @@ public:
 
   void Enqueue(NetworkPacket* packet);
 
+  //! Number of packets dropped since the last Start() because the decoding was too slow
+  uint64_t GetNumberOfDroppedPackets() const;
+
 protected:
   void ThreadLoop();
 
   vtkStream * Stream;
 
-  std::unique_ptr<SynchronizedQueue<NetworkPacket*>> Packets;
+  std::unique_ptr<SPSCQueue<NetworkPacket*>> Packets;
   /*!< Number of packets to cache, above: drop oldest packets */
-  size_t PacketCacheSize = 100000;
+  size_t PacketCacheSize = 131072;
+  /*!< Number of packets decoded between two checks of the queue */
+  static constexpr size_t BatchSize = 64;
+  /*!< Packets dropped by the last queue, kept once the consumer is stopped */
+  uint64_t DroppedPackets = 0;
 
   std::unique_ptr<std::thread> Thread;
 };
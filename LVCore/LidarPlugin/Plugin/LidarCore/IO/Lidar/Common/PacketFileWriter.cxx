@@ -3,20 +3,42 @@
 //! @todo this include is only for vtkGenericWarningMacro which is strange
 #include <vtkMath.h>
 
+//-----------------------------------------------------------------------------
+PacketFileWriter::~PacketFileWriter()
+{
+  this->Stop();
+  delete this->Packets.load();
+}
+
 //-----------------------------------------------------------------------------
 void PacketFileWriter::ThreadLoop()
 {
-  NetworkPacket* packet = nullptr;
-  while (this->Packets->dequeue(packet))
+  MPSCQueue<NetworkPacket*>* queue = this->Packets.load();
+  NetworkPacket* packets[BatchSize];
+  while (size_t count = queue->dequeueBatch(packets, BatchSize))
   {
-    this->PacketWriter.WritePacket(*packet);
-    delete packet;
+    // The dequeued packets were still in the queue a moment ago
+    const size_t depth = count + queue->size();
+    if (depth > this->MaximumQueueDepth.load(std::memory_order_relaxed))
+    {
+      this->MaximumQueueDepth.store(depth, std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      this->PacketWriter.WritePacket(*packets[i]);
+      packets[i]->Release();
+    }
+    this->PacketsWritten.fetch_add(count, std::memory_order_relaxed);
+    this->BytesWritten.store(this->PacketWriter.GetNumberOfBytesWritten(), std::memory_order_relaxed);
   }
+  this->PacketWriter.Flush();
 }
 
 //-----------------------------------------------------------------------------
 void PacketFileWriter::Start(const std::string &filename)
 {
+  std::lock_guard<std::mutex> lock(this->ControlMutex);
   if (this->Thread)
   {
     return;
@@ -29,6 +51,8 @@ void PacketFileWriter::Start(const std::string &filename)
 
   if (!this->PacketWriter.IsOpen())
   {
+    this->PacketWriter.SetBufferSize(this->BufferSize);
+    this->PacketWriter.SetPreallocationSize(this->PreallocationSize);
     if (!this->PacketWriter.Open(filename))
     {
       vtkGenericWarningMacro("Failed to open packet file: " << filename);
@@ -36,37 +60,72 @@ void PacketFileWriter::Start(const std::string &filename)
     }
   }
 
-  this->Packets.reset(new SynchronizedQueue<NetworkPacket*>);
-  this->Thread = std::make_unique<std::thread>(
-    std::mem_fn(&PacketFileWriter::ThreadLoop),
-    this
-  );
+  this->MaximumQueueDepth = 0;
+  this->PacketsWritten = 0;
+  this->BytesWritten = this->PacketWriter.GetNumberOfBytesWritten();
+
+  // Dropping the newest packets keeps the beginning of the recording contiguous
+  MPSCQueue<NetworkPacket*>* queue = this->Packets.load();
+  if (!queue)
+  {
+    queue = new MPSCQueue<NetworkPacket*>(this->PacketCacheSize,
+      [](NetworkPacket* packet) { packet->Release(); });
+    this->Packets.store(queue);
+  }
+  queue->restartQueue();
+  this->Thread = std::make_unique<std::thread>(&PacketFileWriter::ThreadLoop, this);
 }
 
 //-----------------------------------------------------------------------------
 void PacketFileWriter::Stop()
 {
-  if (this->Thread)
+  std::lock_guard<std::mutex> lock(this->ControlMutex);
+  if (!this->Thread)
   {
-    this->Packets->stopQueue();
-    this->Thread->join();
-    this->Thread.reset();
-    this->Packets.reset();
+    return;
+  }
+
+  // The packets enqueued from now on are released right away,
+  // the thread writes all the ones already queued before exiting
+  MPSCQueue<NetworkPacket*>* queue = this->Packets.load();
+  queue->finishQueue();
+  this->Thread->join();
+  this->Thread.reset();
+
+  const uint64_t dropped = queue->droppedCount();
+  if (dropped > 0)
+  {
+    vtkGenericWarningMacro("The recording missed " << dropped
+                           << " packets, the disk could not keep up with the sensor");
   }
 }
 
 //-----------------------------------------------------------------------------
 void PacketFileWriter::Enqueue(NetworkPacket* packet)
 {
-  // TODO
-  // After capturing a stream and stoping the recording, Packets is NULL
-  // and this loop continues until a new reader or stream is selected.
-  if (this->Packets != NULL)
+  // After stopping the recording, the streams keep sending their packets
+  // until they are told to stop recording too
+  MPSCQueue<NetworkPacket*>* queue = this->Packets.load(std::memory_order_acquire);
+  if (queue)
   {
-    this->Packets->enqueue(packet);
+    queue->enqueue(packet);
   }
   else
   {
-    this->Stop();
+    packet->Release();
   }
 }
+
+//-----------------------------------------------------------------------------
+size_t PacketFileWriter::GetQueueDepth() const
+{
+  MPSCQueue<NetworkPacket*>* queue = this->Packets.load(std::memory_order_acquire);
+  return queue ? queue->size() : 0;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t PacketFileWriter::GetNumberOfDroppedPackets() const
+{
+  MPSCQueue<NetworkPacket*>* queue = this->Packets.load(std::memory_order_acquire);
+  return queue ? queue->droppedCount() : 0;
+}
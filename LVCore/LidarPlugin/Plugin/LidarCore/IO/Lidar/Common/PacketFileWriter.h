@@ -15,32 +15,75 @@
 #ifndef PACKETWRITER_H
 #define PACKETWRITER_H
 
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <queue>
 #include <boost/asio.hpp>
 
 #include "vtkPacketFileWriter.h"
-#include "SynchronizedQueue.h"
+#include "MPSCQueue.h"
 
 class PacketFileWriter
 {
 public:
+  ~PacketFileWriter();
+
+  //! Write the packets of the queue until it is finished
   void ThreadLoop();
 
   void Start(const std::string& filename);
 
+  //! Write all the packets still queued, then stop the writing thread
   void Stop();
 
+  //! Thread safe and lock-free, several streams can record into the same writer
   void Enqueue(NetworkPacket* packet);
 
   bool IsOpen() { return this->PacketWriter.IsOpen(); }
 
+  //! Size of the write buffer of the file, used by the next Start(). See vtkPacketFileWriter.
+  void SetBufferSize(size_t bytes) { this->BufferSize = bytes; }
+  size_t GetBufferSize() const { return this->BufferSize; }
+
+  //! Disk space reserved when opening the file, used by the next Start(). See vtkPacketFileWriter.
+  void SetPreallocationSize(uint64_t bytes) { this->PreallocationSize = bytes; }
+  uint64_t GetPreallocationSize() const { return this->PreallocationSize; }
+
+  //! Number of packets waiting to be written
+  size_t GetQueueDepth() const;
+
+  //! Highest number of packets waiting to be written since the last Start()
+  size_t GetMaximumQueueDepth() const { return this->MaximumQueueDepth; }
+
+  //! Number of packets written since the last Start()
+  uint64_t GetNumberOfPacketsWritten() const { return this->PacketsWritten; }
+
+  //! Size of the file written since the last Start(), including the pcap headers
+  uint64_t GetNumberOfBytesWritten() const { return this->BytesWritten; }
+
+  //! Number of packets not recorded since the last Start() because the disk was too slow
+  uint64_t GetNumberOfDroppedPackets() const;
+
   void Close() { this->PacketWriter.Close(); }
 
 private:
   vtkPacketFileWriter PacketWriter;
   std::unique_ptr<std::thread> Thread;
-  std::shared_ptr<SynchronizedQueue<NetworkPacket*>> Packets;
+  /*!< Created by the first Start() and kept afterward, so that the producers never see it change.
+       It refuses the packets while the writer is stopped. */
+  std::atomic<MPSCQueue<NetworkPacket*>*> Packets{ nullptr };
+  /*!< Serializes Start() and Stop(), the producers never take it */
+  std::mutex ControlMutex;
+  size_t BufferSize = 4 << 20;
+  uint64_t PreallocationSize = 0;
+  std::atomic<size_t> MaximumQueueDepth{ 0 };
+  std::atomic<uint64_t> PacketsWritten{ 0 };
+  std::atomic<uint64_t> BytesWritten{ 0 };
+  /*!< Number of packets waiting to be written, above: drop the newest packets */
+  size_t PacketCacheSize = 262144;
+  /*!< Number of packets written between two checks of the queue */
+  static constexpr size_t BatchSize = 64;
 };
 
 
@@ -19,13 +19,65 @@
 #include "PacketReceiver.h"
 
 #include "NetworkPacket.h"
-#include "SynchronizedQueue.h"
 
 #include <vtkMath.h>
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 
-#define DEBUG_BUFFER_SIZE 1
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <ctime>
+#endif
+
+
+#ifdef __linux__
+//-----------------------------------------------------------------------------
+struct PacketReceiver::BatchReception
+{
+  BatchReception(unsigned int batchSize)
+    : Messages(batchSize)
+    , IOVectors(batchSize)
+    , Addresses(batchSize)
+    , Buffers(static_cast<std::size_t>(batchSize) * BUFFER_SIZE)
+    , Controls(batchSize * ControlSize)
+  {
+  }
+
+  //! Prepare the headers before each recvmmsg call, as the kernel overwrites some fields
+  void Reset()
+  {
+    for (std::size_t i = 0; i < this->Messages.size(); ++i)
+    {
+      this->IOVectors[i].iov_base = this->Buffers.data() + i * BUFFER_SIZE;
+      this->IOVectors[i].iov_len = BUFFER_SIZE;
+      msghdr& header = this->Messages[i].msg_hdr;
+      header = msghdr();
+      header.msg_name = &this->Addresses[i];
+      header.msg_namelen = sizeof(sockaddr_storage);
+      header.msg_iov = &this->IOVectors[i];
+      header.msg_iovlen = 1;
+      header.msg_control = this->Controls.data() + i * ControlSize;
+      header.msg_controllen = ControlSize;
+      this->Messages[i].msg_len = 0;
+    }
+  }
+
+  static constexpr std::size_t ControlSize = CMSG_SPACE(sizeof(struct timespec));
+
+  std::vector<mmsghdr> Messages;
+  std::vector<iovec> IOVectors;
+  std::vector<sockaddr_storage> Addresses;
+  std::vector<unsigned char> Buffers;
+  std::vector<unsigned char> Controls;
+};
+#else
+struct PacketReceiver::BatchReception
+{
+};
+#endif
 
 //-----------------------------------------------------------------------------
 PacketReceiver::PacketReceiver(int port,
@@ -38,6 +90,7 @@ PacketReceiver::PacketReceiver(int port,
   , PacketCounter(0)
   , Socket(IOService)
   , ForwardedSocket(IOService)
+  , PacketPool(std::make_shared<NetworkPacketPool>(PACKET_POOL_SIZE))
   , ReceiverCallback(callback)
 {
   // Check that the provided multicast ipadress is valid
@@ -64,15 +117,6 @@ PacketReceiver::PacketReceiver(int port,
       // Tell the OS we accept to re-use the port address for an other app
       this->Socket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
 
-#if DEBUG_BUFFER_SIZE
-      // default 106496 (linux) to 4194304 (4MB)
-      this->Socket.set_option(boost::asio::socket_base::receive_buffer_size(4194304));
-
-      boost::asio::socket_base::receive_buffer_size size_option;
-      this->Socket.get_option(size_option);
-      std::cout << "[PacketReceiver] (Multicast) Set receive buffer size = " << size_option.value() << std::endl;
-#endif
-
       // Connect to multicast
       boost::system::error_code errCode;
       boost::asio::ip::address multicast_address = boost::asio::ip::address::from_string(multicastAddress, errCode);
@@ -138,15 +182,6 @@ PacketReceiver::PacketReceiver(int port,
     // Tell the OS we accept to re-use the port address for an other app
     this->Socket.set_option(boost::asio::ip::udp::socket::reuse_address(true));
 
-#if DEBUG_BUFFER_SIZE
-      // default 106496 (linux) to 4194304 (4MB)
-      this->Socket.set_option(boost::asio::socket_base::receive_buffer_size(4194304));
-
-      boost::asio::socket_base::receive_buffer_size size_option;
-      this->Socket.get_option(size_option);
-      std::cout << "[PacketReceiver] Set receive buffer size = " << size_option.value() << std::endl;
-#endif
-
     try
       {
         // If no multicast address specified (Listen on broadcast and unicast)
@@ -208,7 +243,14 @@ void PacketReceiver::EnableForwarding(int forwardport, const std::string& forwar
 void PacketReceiver::Start()
 {
   std::cout << "Start" << std::endl;
-  this->WaitForNextPacket();
+  if (this->Batch)
+  {
+    this->WaitForNextBatch();
+  }
+  else
+  {
+    this->WaitForNextPacket();
+  }
   // Make the callback run in otherthread
   this->Thread = std::make_unique<std::thread>([&]{ this->IOService.run(); });
 }
@@ -251,6 +293,52 @@ void PacketReceiver::SetFakeManufacturerMACAddress(uint64_t value)
   this->FakeManufacturerMACAddress = value;
 }
 
+//-----------------------------------------------------------------------------
+void PacketReceiver::SetReceiveBufferSize(int bytes)
+{
+  boost::system::error_code errCode;
+  this->Socket.set_option(boost::asio::socket_base::receive_buffer_size(bytes), errCode);
+  if (errCode)
+  {
+    vtkGenericWarningMacro("Could not set the socket receive buffer size: " << errCode.message());
+    return;
+  }
+
+  boost::asio::socket_base::receive_buffer_size sizeOption;
+  this->Socket.get_option(sizeOption, errCode);
+  // Linux doubles the requested value to account for its bookkeeping overhead
+  if (!errCode && sizeOption.value() < bytes)
+  {
+    vtkGenericWarningMacro("The socket receive buffer is limited to " << sizeOption.value()
+      << " bytes instead of " << bytes << ", increase the system limit (net.core.rmem_max on Linux)");
+  }
+}
+
+//-----------------------------------------------------------------------------
+void PacketReceiver::EnableBatchedReception(unsigned int batchSize)
+{
+  assert(!this->Thread && "You cannot call this function while running, please call it just after constructing the object");
+#ifdef __linux__
+  if (batchSize <= 1)
+  {
+    this->Batch.reset();
+    return;
+  }
+
+  int enable = 1;
+  if (setsockopt(this->Socket.native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) != 0)
+  {
+    vtkGenericWarningMacro("Could not enable the kernel reception timestamps, using the batch reception time");
+  }
+  this->Batch = std::make_unique<BatchReception>(batchSize);
+#else
+  if (batchSize > 1)
+  {
+    vtkGenericWarningMacro("Batched reception is only supported on Linux");
+  }
+#endif
+}
+
 //-----------------------------------------------------------------------------
 void PacketReceiver::SocketCallback(
   const boost::system::error_code& error, std::size_t numberOfBytes)
@@ -259,26 +347,43 @@ void PacketReceiver::SocketCallback(
   {
     return;
   }
+
+  this->HandleDatagram(this->RXBuffer, numberOfBytes, this->SenderEndpoint, nullptr);
+
+  this->WaitForNextPacket();
+}
+
+//-----------------------------------------------------------------------------
+void PacketReceiver::HandleDatagram(const unsigned char* data,
+                                    std::size_t numberOfBytes,
+                                    const boost::asio::ip::udp::endpoint& sender,
+                                    const struct timeval* receptionTime)
+{
   unsigned short ourPort = static_cast<unsigned short>(this->Port);
   // endpoint::port() is in host byte order
-  unsigned short sourcePort = this->SenderEndpoint.port();
+  unsigned short sourcePort = sender.port();
   // sourceIP has network endianess (so big endian).
   std::array<unsigned char, 4> sourceIP = {192, 168, 0, 200};
-  if (this->SenderEndpoint.address().is_v4())
+  if (sender.address().is_v4())
   {
     for (int i = 0; i < 4; i++)
     {
       // the array types are differents and to_bytes() handles endianess
-      sourceIP[i] = this->SenderEndpoint.address().to_v4().to_bytes()[i];
+      sourceIP[i] = sender.address().to_v4().to_bytes()[i];
     }
   }
   // TODO: IPV6 is recorded as fake ipv4 packet -> create BuildEthernetIP6UDP
-  NetworkPacket* packet = NetworkPacket::BuildEthernetIP4UDP(this->RXBuffer,
+  NetworkPacket* packet = NetworkPacket::BuildEthernetIP4UDP(data,
                                                        numberOfBytes,
                                                        sourceIP,
                                                        sourcePort,
                                                        ourPort,
-                                                       this->FakeManufacturerMACAddress);
+                                                       this->FakeManufacturerMACAddress,
+                                                       this->PacketPool);
+  if (receptionTime)
+  {
+    packet->ReceptionTime = *receptionTime;
+  }
 
   if (this->isForwarding)
   {
@@ -292,14 +397,11 @@ void PacketReceiver::SocketCallback(
 
   this->ReceiverCallback(packet);
 
-  this->WaitForNextPacket();
-
   if ((++this->PacketCounter % 10000) == 0)
   {
     //std::cout << "RECV packets: " << this->PacketCounter << " on " << this->Port << std::endl;
 //    vtkDebugMacro(<< "RECV packets: " << this->PacketCounter << " on " << this->Port);
   }
-
 }
 
 //-----------------------------------------------------------------------------
@@ -311,3 +413,63 @@ void PacketReceiver::WaitForNextPacket()
                                               std::placeholders::_2));
 }
 
+//-----------------------------------------------------------------------------
+void PacketReceiver::WaitForNextBatch()
+{
+  this->Socket.async_wait(boost::asio::ip::udp::socket::wait_read,
+                          std::bind(&PacketReceiver::BatchCallback, this, std::placeholders::_1));
+}
+
+//-----------------------------------------------------------------------------
+void PacketReceiver::BatchCallback(const boost::system::error_code& error)
+{
+  if (error) // in case the Socket cancel == boost::asio::error::operation_aborted)
+  {
+    return;
+  }
+
+#ifdef __linux__
+  BatchReception& batch = *this->Batch;
+  const unsigned int batchSize = static_cast<unsigned int>(batch.Messages.size());
+  int received = 0;
+  // A full batch means that more datagrams may be pending, drain them
+  // before waiting again, to save the asio dispatch
+  do
+  {
+    batch.Reset();
+    received = recvmmsg(this->Socket.native_handle(), batch.Messages.data(), batchSize, MSG_DONTWAIT, nullptr);
+    if (received <= 0)
+    {
+      break;
+    }
+
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    for (int i = 0; i < received; ++i)
+    {
+      msghdr& header = batch.Messages[i].msg_hdr;
+
+      struct timeval receptionTime = now;
+      for (cmsghdr* control = CMSG_FIRSTHDR(&header); control; control = CMSG_NXTHDR(&header, control))
+      {
+        if (control->cmsg_level == SOL_SOCKET && control->cmsg_type == SCM_TIMESTAMPNS)
+        {
+          struct timespec kernelTime;
+          std::memcpy(&kernelTime, CMSG_DATA(control), sizeof(kernelTime));
+          receptionTime.tv_sec = kernelTime.tv_sec;
+          receptionTime.tv_usec = kernelTime.tv_nsec / 1000;
+        }
+      }
+
+      boost::asio::ip::udp::endpoint sender;
+      std::memcpy(sender.data(), header.msg_name, std::min<std::size_t>(header.msg_namelen, sender.capacity()));
+      sender.resize(std::min<std::size_t>(header.msg_namelen, sender.capacity()));
+
+      this->HandleDatagram(static_cast<const unsigned char*>(batch.IOVectors[i].iov_base),
+                           batch.Messages[i].msg_len, sender, &receptionTime);
+    }
+  } while (received == static_cast<int>(batchSize));
+#endif
+
+  this->WaitForNextBatch();
+}
@@ -21,12 +21,12 @@
 // BOOST
 #include <boost/asio.hpp>
 
-#include <thread>
 #include <functional>
+#include <memory>
+#include <thread>
 
 class NetworkSource;
-template<typename T>
-class SynchronizedQueue;
+class NetworkPacketPool;
 
 /*!< Size of the buffer used to store the data received */
 #define BUFFER_SIZE 34000
@@ -34,6 +34,9 @@ class SynchronizedQueue;
 /*!< Number of packed save when the option CrashAnalysing is set */
 #define NBR_PACKETS_SAVED  1500
 
+/*!< Number of packets preallocated to hold the received data, see NetworkPacketPool */
+#define PACKET_POOL_SIZE 16384
+
 /**
  * \class PacketReceiver
  * \brief This classs is reponsbale for listening on a socket and each time a packet is received,
@@ -78,6 +81,20 @@ public:
 
   void SetFakeManufacturerMACAddress(uint64_t);
 
+  /**
+   * @brief SetReceiveBufferSize set the size of the socket receive buffer (SO_RCVBUF), in bytes.
+   * A larger buffer absorbs the bursts of several sensors while the receiver thread is busy.
+   * The system may clamp it (net.core.rmem_max on Linux), a warning is displayed in that case.
+   */
+  void SetReceiveBufferSize(int bytes);
+
+  /**
+   * @brief EnableBatchedReception receive up to batchSize datagrams per system call with
+   * recvmmsg, and use the kernel reception time (SO_TIMESTAMPNS) of each datagram.
+   * Only supported on Linux, ignored elsewhere. Must be called before Start().
+   */
+  void EnableBatchedReception(unsigned int batchSize);
+
 private:
   //!
   //! \brief Callback call when a new packet is receive
@@ -92,6 +109,20 @@ private:
    */
   void WaitForNextPacket();
 
+  /**
+   * @brief Build the NetworkPacket of a received datagram, forward it, log it and pass it to the callback
+   * @param receptionTime kernel reception time, nullptr to use the current time
+   */
+  void HandleDatagram(const unsigned char* data, std::size_t numberOfBytes,
+                      const boost::asio::ip::udp::endpoint& sender,
+                      const struct timeval* receptionTime);
+
+  //!
+  //! \brief Wait for the socket to be readable, then receive all the pending datagrams with recvmmsg
+  //!
+  void WaitForNextBatch();
+  void BatchCallback(const boost::system::error_code& error);
+
   std::unique_ptr<std::thread> Thread;
   boost::asio::io_service IOService;
 
@@ -134,6 +165,13 @@ private:
   /*!< Manufacturer MAC address to fake in the constructed NetworkPacket, as this information is lost by using boost::asio */
   uint64_t FakeManufacturerMACAddress = 0;
 
+  /*!< Buffers used by the batched reception, null if it is disabled, see EnableBatchedReception */
+  struct BatchReception;
+  std::unique_ptr<BatchReception> Batch;
+
+  /*!< Slots reused for the received packets, to avoid allocating memory for each of them */
+  std::shared_ptr<NetworkPacketPool> PacketPool;
+
   std::function<void(NetworkPacket*)> ReceiverCallback;
 };
 
@@ -0,0 +1,223 @@
+//=========================================================================
+//
+// Copyright 2023 Kitware, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//=========================================================================
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+/**
+ * @brief The SPSCQueue class is a bounded lock-free FIFO, to be filled by one thread
+ * and emptied by another one. The producer never blocks: when the queue is full, an element
+ * is dropped according to the OverflowPolicy and passed to the discard function.
+ * The consumer polls the queue, sleeping a little while it is empty, so that neither
+ * of the threads takes a lock or signals the other one at each element.
+ *
+ * Only one thread may enqueue, see MPSCQueue when several ones share the consumer.
+ * The elements must be trivially copyable, typically pointers.
+ */
+template<typename T>
+class SPSCQueue
+{
+  static_assert(std::is_trivially_copyable<T>::value, "SPSCQueue elements must be trivially copyable");
+
+public:
+  enum class OverflowPolicy
+  {
+    DropOldest, //!< Remove the oldest element to make room for the new one
+    DropNewest  //!< Refuse the new element
+  };
+
+  /**
+   * @param capacity maximum number of elements, rounded up to a power of 2
+   * @param policy which element to drop when the queue is full
+   * @param discard called with each dropped element, and with the elements
+   *        still queued when the queue is destroyed, to release them
+   */
+  SPSCQueue(size_t capacity, OverflowPolicy policy, std::function<void(T)> discard = nullptr)
+    : Policy(policy)
+    , Discard(discard)
+  {
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity)
+    {
+      roundedCapacity <<= 1;
+    }
+    this->Mask = roundedCapacity - 1;
+    this->Slots.reset(new std::atomic<T>[roundedCapacity]);
+  }
+
+  ~SPSCQueue()
+  {
+    const uint64_t tail = this->Tail.load(std::memory_order_acquire);
+    for (uint64_t i = this->Head.load(std::memory_order_acquire); i < tail; ++i)
+    {
+      this->DiscardElement(this->Slots[i & this->Mask].load(std::memory_order_relaxed));
+    }
+  }
+
+  /**
+   * @brief enqueue add an element, only call it from the producer thread
+   * @return false if the element has been dropped, see OverflowPolicy
+   */
+  bool enqueue(const T& data)
+  {
+    if (this->StopRequested.load(std::memory_order_relaxed))
+    {
+      this->DiscardElement(data);
+      return false;
+    }
+
+    const uint64_t tail = this->Tail.load(std::memory_order_relaxed);
+    uint64_t head = this->Head.load(std::memory_order_acquire);
+    if (tail - head > this->Mask)
+    {
+      if (this->Policy == OverflowPolicy::DropNewest)
+      {
+        this->Dropped.fetch_add(1, std::memory_order_relaxed);
+        this->DiscardElement(data);
+        return false;
+      }
+
+      // Steal the oldest element. If the consumer moved the head in the meantime,
+      // there is now some room and nothing needs to be dropped.
+      if (this->Head.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel))
+      {
+        this->Dropped.fetch_add(1, std::memory_order_relaxed);
+        this->DiscardElement(this->Slots[head & this->Mask].load(std::memory_order_relaxed));
+      }
+    }
+
+    this->Slots[tail & this->Mask].store(data, std::memory_order_relaxed);
+    this->Tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief dequeueBatch wait for at least one element and move up to maxCount of them
+   * to result, only call it from the consumer thread
+   * @return the number of elements moved, 0 once stopQueue() has been called
+   */
+  size_t dequeueBatch(T* result, size_t maxCount)
+  {
+    int idleLoops = 0;
+    while (!this->StopRequested.load(std::memory_order_acquire))
+    {
+      uint64_t head = this->Head.load(std::memory_order_acquire);
+      const uint64_t tail = this->Tail.load(std::memory_order_acquire);
+      const size_t count = static_cast<size_t>(std::min<uint64_t>(tail - head, maxCount));
+      if (count == 0)
+      {
+        this->Wait(idleLoops++);
+        continue;
+      }
+
+      for (size_t i = 0; i < count; ++i)
+      {
+        result[i] = this->Slots[(head + i) & this->Mask].load(std::memory_order_relaxed);
+      }
+      // Fails if the producer dropped the oldest element while we were reading,
+      // in which case the copied elements may be outdated
+      if (this->Head.compare_exchange_strong(head, head + count, std::memory_order_acq_rel))
+      {
+        return count;
+      }
+      idleLoops = 0;
+    }
+    return 0;
+  }
+
+  /**
+   * @brief dequeue wait for one element, only call it from the consumer thread
+   * @return false once stopQueue() has been called
+   */
+  bool dequeue(T& result)
+  {
+    return this->dequeueBatch(&result, 1) == 1;
+  }
+
+  /**
+   * @brief stopQueue wake up the consumer, which stops dequeuing.
+   * The elements still queued are discarded when the queue is destroyed.
+   */
+  void stopQueue()
+  {
+    this->StopRequested.store(true, std::memory_order_release);
+  }
+
+  //! Approximate number of queued elements
+  size_t size() const
+  {
+    const uint64_t head = this->Head.load(std::memory_order_acquire);
+    const uint64_t tail = this->Tail.load(std::memory_order_acquire);
+    return static_cast<size_t>(tail > head ? tail - head : 0);
+  }
+
+  bool isEmpty() const { return this->size() == 0; }
+
+  size_t capacity() const { return this->Mask + 1; }
+
+  //! Number of elements dropped because the queue was full
+  uint64_t droppedCount() const { return this->Dropped.load(std::memory_order_relaxed); }
+
+private:
+  void DiscardElement(T data)
+  {
+    if (this->Discard)
+    {
+      this->Discard(data);
+    }
+  }
+
+  // Spin a little to catch bursts with a low latency,
+  // then sleep to avoid burning a core while the sensor is idle
+  static void Wait(int idleLoops)
+  {
+    if (idleLoops < 64)
+    {
+      std::this_thread::yield();
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+
+  std::unique_ptr<std::atomic<T>[]> Slots;
+  uint64_t Mask = 0;
+  const OverflowPolicy Policy;
+  std::function<void(T)> Discard;
+
+  // Head and Tail are written by different threads, keep them on separate cache lines.
+  // Padding is used instead of alignas, as C++14 operator new ignores over-alignment.
+  char HeadPadding[64];
+  std::atomic<uint64_t> Head{ 0 };
+  char TailPadding[64];
+  std::atomic<uint64_t> Tail{ 0 };
+  std::atomic<uint64_t> Dropped{ 0 };
+  std::atomic<bool> StopRequested{ false };
+  char EndPadding[64];
+};
+
+#endif // SPSCQUEUE_H
@@ -1,5 +1,8 @@
 #include "vtkLidarPacketInterpreter.h"
 
+#include <vtkTransform.h>
+
+#include <algorithm>
 #include <ctime>
 #include <sstream>
 
@@ -66,11 +69,17 @@ bool vtkLidarPacketInterpreter::SplitFrame(bool force, FramingMethod_t framingMe
       return false;
     }
 
-    // add vertex to the polydata
-    this->CurrentFrame->SetVerts(NewVertexCells(this->CurrentFrame->GetNumberOfPoints()));
+    // add vertex to the polydata, the cells only depend on the number of points
+    // and are never modified, so the frames of the same size share them
+    if (!this->VertexCells || this->VertexCells->GetNumberOfCells() != nPtsOfCurrentDataset)
+    {
+      this->VertexCells = NewVertexCells(nPtsOfCurrentDataset);
+    }
+    this->CurrentFrame->SetVerts(this->VertexCells);
     // split the frame
     this->Frames.push_back(this->CurrentFrame);
     // create a new frame
+    this->ApplyFramePoolSize();
     this->CurrentFrame = this->CreateNewEmptyFrame(0, nPtsOfCurrentDataset);
 
     return true;
@@ -78,6 +87,16 @@ bool vtkLidarPacketInterpreter::SplitFrame(bool force, FramingMethod_t framingMe
   return false;
 }
 
+//-----------------------------------------------------------------------------
+void vtkLidarPacketInterpreter::ApplyFramePoolSize()
+{
+  const size_t size = static_cast<size_t>(this->FramePoolSize);
+  if (size != this->FramePool.GetMaximumNumberOfFrames())
+  {
+    this->FramePool.SetMaximumNumberOfFrames(size);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void vtkLidarPacketInterpreter::SetLaserSelection(int index, int value)
 {
@@ -134,6 +153,31 @@ bool vtkLidarPacketInterpreter::shouldBeCroppedOut(double pos[3])
   return !((pointInside && !this->CropOutside) || (!pointInside && this->CropOutside));
 }
 
+//-----------------------------------------------------------------------------
+void vtkLidarPacketInterpreter::CopyDecodingParameters(vtkLidarPacketInterpreter* clone)
+{
+  clone->ApplyTransform = this->ApplyTransform;
+  if (this->SensorTransform)
+  {
+    // vtkTransform updates itself lazily, it can not be shared between threads
+    vtkNew<vtkTransform> transform;
+    transform->DeepCopy(this->SensorTransform);
+    clone->SetSensorTransform(transform);
+  }
+  clone->CalibrationFileName = this->CalibrationFileName;
+  clone->TimeOffset = this->TimeOffset;
+  clone->LaserSelection->DeepCopy(this->LaserSelection);
+  clone->IgnoreZeroDistances = this->IgnoreZeroDistances;
+  clone->IgnoreEmptyFrames = this->IgnoreEmptyFrames;
+  clone->CropMode = this->CropMode;
+  clone->CropOutside = this->CropOutside;
+  std::copy(this->CropRegion, this->CropRegion + 6, clone->CropRegion);
+  clone->EnableAdvancedArrays = this->EnableAdvancedArrays;
+  clone->FramingMethod = this->FramingMethod;
+  clone->FrameDuration_s = this->FrameDuration_s;
+  clone->FramePoolSize = this->FramePoolSize.load();
+}
+
 //-----------------------------------------------------------------------------
 bool vtkLidarPacketInterpreter::IsNewData()
 {
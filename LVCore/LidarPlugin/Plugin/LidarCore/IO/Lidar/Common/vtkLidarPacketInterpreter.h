@@ -21,9 +21,14 @@
 #include <vtkSmartPointer.h>
 #include <vtkTable.h>
 #include <vtkPolyData.h>
+#include <vtkCellArray.h>
+
+#include <algorithm>
+#include <atomic>
 
 #include "IO/vtkInterpreter.h"
 #include "IO/FrameInformation.h"
+#include "IO/Lidar/Common/LidarFramePool.h"
 
 #include "LidarCoreModule.h"
 
@@ -104,11 +109,38 @@ public:
    */
   virtual bool IsLidarPacket(unsigned char const * data, unsigned int dataLength) = 0;
 
+  /**
+   * @brief CreateIndexingClone create a new interpreter able to build the frame catalog
+   *        of a part of a capture concurrently with this one, see vtkLidarReader::SetIndexingThreads.
+   *        The clone must only depend on the parameters of this interpreter, and the state of its
+   *        parser meta data must only depend on the last lidar packets it preprocessed.
+   * @return nullptr if the interpreter does not support concurrent indexing (default)
+   */
+  virtual vtkSmartPointer<vtkLidarPacketInterpreter> CreateIndexingClone() { return nullptr; }
+
+  /**
+   * @brief CreateDecodingClone create a new interpreter producing the same frames as this one,
+   *        so that several parts of a capture can be decoded concurrently, see vtkLidarReader::DecodeFrames.
+   *        The clone is calibrated and must not share any mutable state with this interpreter.
+   * @return nullptr if the interpreter does not support concurrent decoding (default)
+   */
+  virtual vtkSmartPointer<vtkLidarPacketInterpreter> CreateDecodingClone() { return nullptr; }
+
+  /**
+   * @brief CanCreateDecodingClone return true if CreateDecodingClone is implemented, without
+   *        building a clone. Must be overridden along with CreateDecodingClone.
+   */
+  virtual bool CanCreateDecodingClone() { return false; }
+
   /**
    * @brief ResetCurrentFrame reset all information to handle some new frame. This reset the
    * frame container, some information about the current frame, guesses about the sensor type, etc
    */
-  virtual void ResetCurrentFrame() { this->CurrentFrame = this->CreateNewEmptyFrame(0); }
+  virtual void ResetCurrentFrame()
+  {
+    this->ApplyFramePoolSize();
+    this->CurrentFrame = this->CreateNewEmptyFrame(0);
+  }
 
   /**
    * @brief isNewFrameReady check if a new frame is ready
@@ -219,14 +251,49 @@ public:
   vtkSetMacro(FrameDuration_s, double)
   vtkGetMacro(FrameDuration_s, double)
 
+  /**
+   * @brief SetFramePoolSize number of frames whose points and arrays are kept to build
+   * the next frames once released, see LidarFramePool. It should cover the frames held
+   * at the same time downstream (stream queue, trailing frames, ...), 0 allocates each frame.
+   * Applied when the next frame is created.
+   */
+  void SetFramePoolSize(int size) { this->FramePoolSize = std::max(size, 0); }
+  int GetFramePoolSize() { return this->FramePoolSize; }
+
+  //! @brief Occupancy of the frame pool, to tune its size. Can be called from any thread.
+  int GetNumberOfPooledFrames() { return static_cast<int>(this->FramePool.GetNumberOfFrames()); }
+  int GetNumberOfPooledFramesInUse() { return static_cast<int>(this->FramePool.GetNumberOfFramesInUse()); }
+  vtkIdType GetNumberOfRecycledFrames() { return static_cast<vtkIdType>(this->FramePool.GetNumberOfRecycledFrames()); }
+  vtkIdType GetNumberOfUnpooledFrames() { return static_cast<vtkIdType>(this->FramePool.GetNumberOfUnpooledFrames()); }
+
 protected:
   /**
    * @brief CreateNewEmptyFrame construct a empty polyData with the right DataArray and allocate some
    * space. No CellArray should be created as it can be create once the frame is ready.
+   * The points and arrays should come from FramePool (FramePool.NewFrame, CreateDataArray),
+   * so that the buffers of the released frames are reused.
    * @param numberOfPoints indicate the space to allocate @todo change the meaning
    */
   virtual vtkSmartPointer<vtkPolyData> CreateNewEmptyFrame(vtkIdType numberOfPoints, vtkIdType prereservedNumberOfPoints = 0) = 0;
 
+  /**
+   * @brief CreateDataArray add an array of one value per point, filled with 0, to a frame
+   * started by FramePool.NewFrame.
+   * @return nullptr if the array is advanced and the advanced arrays are disabled
+   */
+  template <typename T>
+  vtkSmartPointer<T> CreateDataArray(bool isAdvanced, const char* name, vtkPolyData* frame)
+  {
+    if (isAdvanced && !this->EnableAdvancedArrays)
+    {
+      return nullptr;
+    }
+    return this->FramePool.AddArray<T>(frame, name);
+  }
+
+  //! @brief ApplyFramePoolSize resize the frame pool if FramePoolSize was changed
+  void ApplyFramePoolSize();
+
   /**
    * @brief shouldBeCroppedOut Returns true if a point should be removed,
    * i.e. if it lays *outside* the cropping volume.
@@ -242,12 +309,26 @@ protected:
    */
   bool shouldBeCroppedOut(double pos[3]);
 
+  /**
+   * @brief CopyDecodingParameters copy the parameters shared by all the interpreters which
+   * modify the decoded frames (cropping, laser selection, framing, ...) to a decoding clone.
+   * The calibration is not copied.
+   */
+  void CopyDecodingParameters(vtkLidarPacketInterpreter* clone);
+
   //! Buffer to store the frame once they are ready
   std::vector<vtkSmartPointer<vtkPolyData> > Frames;
 
   //! Frame under construction
   vtkSmartPointer<vtkPolyData> CurrentFrame;
 
+  //! Points and arrays of the released frames, reused by the next ones
+  LidarFramePool FramePool;
+  std::atomic<int> FramePoolSize{ 8 };
+
+  //! Vertices of the last split frame, shared by the next frames with as many points
+  vtkSmartPointer<vtkCellArray> VertexCells;
+
   //! File containing all calibration information
   std::string CalibrationFileName = "";
 
@@ -1,21 +1,75 @@
 #include "vtkLidarReader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iterator>
 #include <sstream>
 
 #include "Common/Network/vtkPacketFileWriter.h"
 #include "Common/Network/vtkPacketFileReader.h"
 #include "Common/statistics.h"
+#include "FrameCatalogIndex.h"
 
 #include <vtkInformationVector.h>
 #include <vtkInformation.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 #include <vtksys/SystemTools.hxx>
 
+namespace
+{
+//-----------------------------------------------------------------------------
+// Decode the frame starting at info, with the state of the interpreter reset
+vtkSmartPointer<vtkPolyData> DecodeFrame(vtkLidarPacketInterpreter* interpreter,
+                                         vtkPacketFileReader* reader, const FrameInformation& info)
+{
+  interpreter->ResetCurrentFrame();
+  interpreter->ClearAllFramesAvailable();
+  interpreter->SetParserMetaData(info);
+  fpos_t position = info.FilePosition;
+  reader->SetFilePosition(&position);
+
+  const unsigned char* data = 0;
+  unsigned int dataLength = 0;
+  double timeSinceStart = 0;
+  while (reader->NextPacket(data, dataLength, timeSinceStart))
+  {
+    // If the current packet is not a lidar packet,
+    // skip it and update the file position
+    if (!interpreter->IsLidarPacket(data, dataLength))
+    {
+      continue;
+    }
+
+    // Process the lidar packet and check
+    // if the required frame is ready
+    interpreter->ProcessPacketWrapped(data, dataLength, timeSinceStart);
+    if (interpreter->IsNewFrameReady())
+    {
+      return interpreter->GetLastFrameAvailable();
+    }
+  }
+
+  interpreter->SplitFrame(true);
+  return interpreter->GetLastFrameAvailable();
+}
+}
+
 //-----------------------------------------------------------------------------
 vtkLidarReader::vtkLidarReader()
 {
   this->SetNumberOfInputPorts(0);
   this->SetNumberOfOutputPorts(2);
+  this->SetFrameCacheMemoryLimit(512);
+}
+
+//-----------------------------------------------------------------------------
+vtkLidarReader::~vtkLidarReader()
+{
+  this->StopPrefetchThread();
+  this->Close();
 }
 
 //-----------------------------------------------------------------------------
@@ -58,6 +112,54 @@ vtkMTimeType vtkLidarReader::GetMTime()
 
 //-----------------------------------------------------------------------------
 int vtkLidarReader::ReadFrameInformation()
+{
+  // Try to reuse the index saved the last time the capture was opened.
+  // Interpreters which get their calibration from the data need the full scan.
+  this->FrameCache.Clear();
+
+  FrameCatalogIndex index;
+  bool indexAvailable = this->UseFrameIndexCache && this->Interpreter->GetIsCalibrated() &&
+    index.Initialize(this->FileName, this->Interpreter->GetClassName(),
+                     this->CalibrationFileName, this->GetFrameIndexParsingOptions());
+  if (indexAvailable)
+  {
+    this->Interpreter->ResetParserMetaData();
+    if (index.Load(this->Interpreter->GetParserMetaData(), this->FrameCatalog))
+    {
+      this->ComputeNetworkTimeToDataTime();
+      return this->GetNumberOfFrames();
+    }
+  }
+
+  int numberOfThreads = this->IndexingThreads;
+  if (numberOfThreads <= 0)
+  {
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (numberOfThreads == 1 || !this->BuildFrameCatalogParallel(numberOfThreads))
+  {
+    if (!this->BuildFrameCatalogSerial())
+    {
+      return 0;
+    }
+  }
+
+  this->ComputeNetworkTimeToDataTime();
+
+  if (this->FrameCatalog.size() == 1)
+  {
+    vtkErrorMacro("The reader could not parse the pcap file");
+  }
+  else if (indexAvailable && !index.Save(this->FrameCatalog))
+  {
+    vtkDebugMacro("Could not write the frame index " << index.GetIndexFileName());
+  }
+
+  return this->GetNumberOfFrames();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarReader::BuildFrameCatalogSerial()
 {
   this->Open();
   const unsigned char* data = 0;
@@ -73,7 +175,7 @@ int vtkLidarReader::ReadFrameInformation()
   if (!this->Reader)
   {
     vtkErrorMacro("Could not open the pcap file");
-    return 0;
+    return false;
   }
 
   // keep track of the file position
@@ -117,12 +219,182 @@ int vtkLidarReader::ReadFrameInformation()
 
     this->Reader->GetFilePosition(&lastFilePosition);
   }
+  return true;
+}
 
-  if (this->FrameCatalog.size() == 1)
+namespace
+{
+//! Size of the capture scanned before a chunk to bring a cloned interpreter
+//! in the same state as the one scanning the previous chunk
+const int64_t IndexingWarmUpSize = 4 * 1024 * 1024;
+
+struct IndexingChunk
+{
+  int64_t WarmUpOffset = 0;
+  int64_t StartOffset = 0;
+  //! -1 for the last chunk
+  int64_t EndOffset = -1;
+  vtkLidarPacketInterpreter* Interpreter = nullptr;
+  bool IsFirst = false;
+  bool Success = false;
+  std::vector<FrameInformation> Catalog;
+};
+
+//-----------------------------------------------------------------------------
+// Same loop as vtkLidarReader::BuildFrameCatalogSerial, except that the frames
+// detected by the packets located before StartOffset are discarded, and that
+// the scan stops at the first packet located after EndOffset. A packet is located
+// at the position of the reader before reading it, exactly as in the serial scan,
+// so that each frame belongs to exactly one chunk.
+void ScanChunk(const std::string& fileName, const std::string& filter, IndexingChunk& chunk)
+{
+  vtkPacketFileReader reader;
+  if (!reader.Open(fileName, filter) ||
+      (!chunk.IsFirst && !reader.SetFileOffset(chunk.WarmUpOffset)))
   {
-    vtkErrorMacro("The reader could not parse the pcap file");
+    return;
   }
 
+  vtkLidarPacketInterpreter* interpreter = chunk.Interpreter;
+  interpreter->ResetParserMetaData();
+
+  const unsigned char* data = 0;
+  unsigned int dataLength = 0;
+  double lastPacketNetworkTime = 0;
+  bool firstIteration = chunk.IsFirst;
+  bool warmedUp = chunk.IsFirst;
+  std::vector<FrameInformation> warmUpCatalog;
+
+  fpos_t lastFilePosition;
+  reader.GetFilePosition(&lastFilePosition);
+  int64_t lastFileOffset = reader.GetFileOffset();
+
+  while ((chunk.EndOffset < 0 || lastFileOffset < chunk.EndOffset) &&
+         reader.NextPacket(data, dataLength, lastPacketNetworkTime))
+  {
+    if (interpreter->IsLidarPacket(data, dataLength))
+    {
+      const bool isWarmUp = lastFileOffset < chunk.StartOffset;
+      if (firstIteration && interpreter->GetFramingMethod() == INTERPRETER_FRAMING)
+      {
+        chunk.Catalog.push_back(interpreter->GetParserMetaData());
+        chunk.Catalog.back().FilePosition = lastFilePosition;
+        firstIteration = false;
+      }
+
+      interpreter->PreProcessPacketWrapped(data, dataLength, lastFilePosition,
+        lastPacketNetworkTime, isWarmUp ? &warmUpCatalog : &chunk.Catalog);
+
+      if (isWarmUp)
+      {
+        warmUpCatalog.clear();
+        warmedUp = true;
+      }
+    }
+    reader.GetFilePosition(&lastFilePosition);
+    lastFileOffset = reader.GetFileOffset();
+  }
+
+  // Without any lidar packet in the warm up area, the state of the interpreter
+  // at the start of the chunk is unknown
+  chunk.Success = warmedUp;
+}
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarReader::BuildFrameCatalogParallel(int numberOfThreads)
+{
+  const int64_t fileSize = static_cast<int64_t>(vtksys::SystemTools::FileLength(this->FileName));
+  const int numberOfChunks = static_cast<int>(
+    std::min<int64_t>(numberOfThreads, fileSize / std::max<int64_t>(1, this->IndexingMinimumChunkSize)));
+  if (numberOfChunks < 2)
+  {
+    return false;
+  }
+
+  std::vector<IndexingChunk> chunks(numberOfChunks);
+  std::vector<vtkSmartPointer<vtkLidarPacketInterpreter>> clones;
+  for (int i = 0; i < numberOfChunks; ++i)
+  {
+    IndexingChunk& chunk = chunks[i];
+    if (i == 0)
+    {
+      // The first chunk is scanned by the reader interpreter,
+      // so that it ends up in the same state as after a serial scan start
+      chunk.IsFirst = true;
+      chunk.Interpreter = this->Interpreter;
+      continue;
+    }
+
+    vtkSmartPointer<vtkLidarPacketInterpreter> clone = this->Interpreter->CreateIndexingClone();
+    if (!clone)
+    {
+      return false;
+    }
+    clones.push_back(clone);
+    chunk.Interpreter = clone;
+
+    const int64_t target = fileSize / numberOfChunks * i;
+    chunk.StartOffset = vtkPacketFileReader::FindNextRecordOffset(this->FileName, target);
+    chunk.WarmUpOffset = vtkPacketFileReader::FindNextRecordOffset(
+      this->FileName, std::max<int64_t>(0, target - IndexingWarmUpSize));
+    if (chunk.StartOffset < 0 || chunk.WarmUpOffset < 0 || chunk.WarmUpOffset >= chunk.StartOffset)
+    {
+      return false;
+    }
+    chunks[i - 1].EndOffset = chunk.StartOffset;
+  }
+
+  std::string filterPCAP = "udp";
+  if (this->LidarPort != -1)
+  {
+    filterPCAP += " port " + std::to_string(this->LidarPort);
+  }
+
+  std::atomic<int> finishedChunks(0);
+  std::vector<std::thread> threads;
+  for (IndexingChunk& chunk : chunks)
+  {
+    threads.emplace_back([this, &filterPCAP, &chunk, &finishedChunks]() {
+      ScanChunk(this->FileName, filterPCAP, chunk);
+      finishedChunks++;
+    });
+  }
+
+  // Keep the progress dialog alive, only the main thread can emit the event
+  while (finishedChunks < numberOfChunks)
+  {
+    this->UpdateProgress(0.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  for (const IndexingChunk& chunk : chunks)
+  {
+    if (!chunk.Success)
+    {
+      vtkDebugMacro("Parallel indexing failed, scanning the capture sequentially");
+      return false;
+    }
+  }
+
+  this->FrameCatalog.clear();
+  for (IndexingChunk& chunk : chunks)
+  {
+    std::move(chunk.Catalog.begin(), chunk.Catalog.end(), std::back_inserter(this->FrameCatalog));
+  }
+
+  // Leave the reader open as after a serial scan
+  this->Open();
+  return this->Reader != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarReader::ComputeNetworkTimeToDataTime()
+{
   this->NetworkTimeToDataTime = 0.0; // default value if no frames seen
   if (this->FrameCatalog.size() > 0)
   {
@@ -133,13 +405,17 @@ int vtkLidarReader::ReadFrameInformation()
       }
       this->NetworkTimeToDataTime = ComputeMedian(diffs);
   }
+}
 
-  if (this->FrameCatalog.size() == 1)
-  {
-    vtkErrorMacro("The reader could not parse the pcap file");
-  }
-
-  return this->GetNumberOfFrames();
+//-----------------------------------------------------------------------------
+std::string vtkLidarReader::GetFrameIndexParsingOptions()
+{
+  std::ostringstream options;
+  options << std::setprecision(17)
+          << "port=" << this->LidarPort
+          << ";framing=" << this->Interpreter->GetFramingMethod()
+          << ";frameDuration=" << this->Interpreter->GetFrameDuration_s();
+  return options.str();
 }
 
 //-----------------------------------------------------------------------------
@@ -200,17 +476,18 @@ void vtkLidarReader::SetFileName(const std::string &filename)
     return;
   }
 
+  std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
   this->FileName = filename;
   this->FrameCatalog.clear();
+  this->FrameCache.Clear();
+  this->Close();
   this->Modified();
 }
 
 //-----------------------------------------------------------------------------
 vtkSmartPointer<vtkPolyData> vtkLidarReader::GetFrame(int frameNumber)
 {
-  this->Interpreter->ResetCurrentFrame();
-  this->Interpreter->ClearAllFramesAvailable();
-
+  std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
   if (!this->Reader)
   {
     vtkErrorMacro("GetFrame() called but packet file reader is not open.");
@@ -222,35 +499,7 @@ vtkSmartPointer<vtkPolyData> vtkLidarReader::GetFrame(int frameNumber)
     return 0;
   }
 
-  const unsigned char* data = 0;
-  unsigned int dataLength = 0;
-  double timeSinceStart = 0;
-
-  // Update the interpreter meta data according to the requested frame
-  FrameInformation currInfo= this->FrameCatalog[frameNumber];
-  this->Interpreter->SetParserMetaData(this->FrameCatalog[frameNumber]);
-  this->Reader->SetFilePosition(&currInfo.FilePosition);
-
-  while (this->Reader->NextPacket(data, dataLength, timeSinceStart))
-  {
-    // If the current packet is not a lidar packet,
-    // skip it and update the file position
-    if (!this->Interpreter->IsLidarPacket(data, dataLength))
-    {
-      continue;
-    }
-
-    // Process the lidar packet and check
-    // if the required frame is ready
-    this->Interpreter->ProcessPacketWrapped(data, dataLength, timeSinceStart);
-    if (this->Interpreter->IsNewFrameReady())
-    {
-      return this->Interpreter->GetLastFrameAvailable();
-    }
-  }
-
-  this->Interpreter->SplitFrame(true);
-  return this->Interpreter->GetLastFrameAvailable();
+  return DecodeFrame(this->Interpreter, this->Reader, this->FrameCatalog[frameNumber]);
 }
 
 //-----------------------------------------------------------------------------
@@ -305,28 +554,146 @@ int vtkLidarReader::GetFrameIndexForDataTime(double dataTime)
   return static_cast<int>(frameRequested);
 }
 
+//-----------------------------------------------------------------------------
+int vtkLidarReader::GetFrameIndexForTimestep(double timestep)
+{
+  if (this->UsePacketTimeForDisplayTime)
+  {
+    return this->GetFrameIndexForDataTime(timestep);
+  }
+  return this->GetFrameIndexForPacketTime(timestep);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarReader::SupportsConcurrentDecoding()
+{
+  std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
+  return this->Interpreter && this->Interpreter->CanCreateDecodingClone();
+}
+
+//-----------------------------------------------------------------------------
+bool vtkLidarReader::DecodeFrames(int firstFrame, int lastFrame,
+  const std::function<bool(int, vtkSmartPointer<vtkPolyData>)>& callback)
+{
+  std::unique_lock<std::recursive_mutex> lock(this->DecodeMutex);
+  if (!this->Interpreter || !this->Interpreter->GetIsCalibrated())
+  {
+    vtkErrorMacro("Calibration data has not been loaded.");
+    return false;
+  }
+  if (firstFrame < 0 || firstFrame > lastFrame ||
+      lastFrame >= static_cast<int>(this->FrameCatalog.size()))
+  {
+    vtkErrorMacro("Incorrect frame interval requested: [" << firstFrame << ", " << lastFrame << "]");
+    return false;
+  }
+  const FrameInformation firstFrameInfo = this->FrameCatalog[firstFrame];
+
+  // With a clone, everything past this point is independent from the reader state,
+  // otherwise the reader interpreter and packet file reader are used under lock
+  vtkSmartPointer<vtkLidarPacketInterpreter> interpreter = this->Interpreter->CreateDecodingClone();
+  std::unique_ptr<vtkPacketFileReader> ownReader;
+  vtkPacketFileReader* reader = nullptr;
+  if (interpreter)
+  {
+    ownReader.reset(new vtkPacketFileReader);
+    if (!ownReader->Open(this->FileName, this->GetPacketFilter()))
+    {
+      vtkErrorMacro("Failed to open packet file: " << this->FileName);
+      return false;
+    }
+    reader = ownReader.get();
+    lock.unlock();
+  }
+  else
+  {
+    interpreter = this->Interpreter;
+    if (!this->Reader)
+    {
+      this->Open();
+    }
+    reader = this->Reader;
+    if (!reader)
+    {
+      return false;
+    }
+  }
+
+  // Same start as GetFrame, then keep on reading the following frames
+  interpreter->ResetCurrentFrame();
+  interpreter->ClearAllFramesAvailable();
+  interpreter->SetParserMetaData(firstFrameInfo);
+  fpos_t position = firstFrameInfo.FilePosition;
+  reader->SetFilePosition(&position);
+
+  const unsigned char* data = 0;
+  unsigned int dataLength = 0;
+  double timeSinceStart = 0;
+  int frameNumber = firstFrame;
+  while (frameNumber <= lastFrame && reader->NextPacket(data, dataLength, timeSinceStart))
+  {
+    if (!interpreter->IsLidarPacket(data, dataLength))
+    {
+      continue;
+    }
+
+    interpreter->ProcessPacketWrapped(data, dataLength, timeSinceStart);
+    if (interpreter->IsNewFrameReady())
+    {
+      // A packet may complete several frames
+      for (const auto& frame : interpreter->GetAllFramesAvailable())
+      {
+        if (frameNumber <= lastFrame && !callback(frameNumber++, frame))
+        {
+          return false;
+        }
+      }
+      interpreter->ClearAllFramesAvailable();
+    }
+  }
+
+  // The last frame of the capture is never split by a following packet
+  if (frameNumber <= lastFrame)
+  {
+    interpreter->SplitFrame(true);
+    if (!callback(frameNumber, interpreter->GetLastFrameAvailable()))
+    {
+      return false;
+    }
+    interpreter->ClearAllFramesAvailable();
+  }
+  return true;
+}
+
 //-----------------------------------------------------------------------------
 void vtkLidarReader::Open(bool reassemble)
 {
+  std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
   this->Close();
   this->Reader = new vtkPacketFileReader;
+  if (!this->Reader->Open(this->FileName, this->GetPacketFilter(), reassemble))
+  {
+    vtkErrorMacro(<< "Failed to open packet file: " << this->FileName << "!\n"
+                                                 << this->Reader->GetLastError());
+    this->Close();
+  }
+}
 
+//-----------------------------------------------------------------------------
+std::string vtkLidarReader::GetPacketFilter()
+{
   std::string filterPCAP = "udp";
   if (this->LidarPort != -1)
   {
     filterPCAP += " port " + std::to_string(this->LidarPort);
   }
-  if (!this->Reader->Open(this->FileName, filterPCAP.c_str(), reassemble))
-  {
-    vtkErrorMacro(<< "Failed to open packet file: " << this->FileName << "!\n"
-                                                 << this->Reader->GetLastError());
-    this->Close();
-  }
+  return filterPCAP;
 }
 
 //-----------------------------------------------------------------------------
 void vtkLidarReader::Close()
 {
+  std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
   delete this->Reader;
   this->Reader = 0;
 }
@@ -334,6 +701,7 @@ void vtkLidarReader::Close()
 //-----------------------------------------------------------------------------
 void vtkLidarReader::SaveFrame(int startFrame, int endFrame, const std::string &filename)
 {
+  std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
   if (!this->Reader)
   {
     vtkErrorMacro("SaveFrame() called but packet file reader is not open.");
@@ -429,8 +797,11 @@ void vtkLidarReader::SetLidarPort(int _arg)
 {
   if (this->LidarPort != _arg)
   {
+    std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
     this->LidarPort = _arg;
     this->FrameCatalog.clear();
+    this->FrameCache.Clear();
+    this->Close();
     this->Modified();
   }
 }
@@ -475,20 +846,13 @@ int vtkLidarReader::RequestData(vtkInformation *vtkNotUsed(request),
     timestep = info->Get(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP());
   }
 
-  int frameRequested = 0;
-  if(this->UsePacketTimeForDisplayTime)
-  {
-    frameRequested = GetFrameIndexForDataTime(timestep);
-  }
-  else
-  {
-    frameRequested = GetFrameIndexForPacketTime(timestep);
-  }
+  int frameRequested = this->GetFrameIndexForTimestep(timestep);
+
+  int step = frameRequested - this->LastFrameProcessed;
 
   // detect frame dropping
   if (this->DetectFrameDropping)
   {
-    int step = frameRequested - this->LastFrameProcessed;
     if (step > 1)
     {
       std::stringstream text;
@@ -499,14 +863,202 @@ int vtkLidarReader::RequestData(vtkInformation *vtkNotUsed(request),
   }
   this->LastFrameProcessed = frameRequested;
 
-  //! @todo we should no open the pcap file everytime a frame is requested !!!
-  this->Open();
-  output->ShallowCopy(this->GetFrame(frameRequested));
-  this->Close();
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
+
+    // Any change of the reader or interpreter parameters invalidates the decoded frames
+    if (this->FrameCacheMTime != this->GetMTime())
+    {
+      this->FrameCache.Clear();
+      this->FrameCacheMTime = this->GetMTime();
+    }
+
+    output->ShallowCopy(this->GetFrameFromCache(frameRequested));
+  }
+
+  // Small steps are considered as a playback, in any direction and at any speed,
+  // larger ones as a seek which only restarts the prefetching from the new position
+  if (this->PrefetchFrames > 0)
+  {
+    int stride = (step != 0 && std::abs(step) <= this->PrefetchFrames) ? step : 1;
+    this->SchedulePrefetch(frameRequested, stride);
+  }
 
   return 1;
 }
 
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> vtkLidarReader::GetFrameFromCache(int frameNumber)
+{
+  vtkSmartPointer<vtkPolyData> frame = this->FrameCache.Get(frameNumber);
+  if (!frame)
+  {
+    // The pcap is kept open between requests, it is only closed
+    // when the file changes or when the reader is destroyed
+    if (!this->Reader)
+    {
+      this->Open();
+    }
+    frame = this->GetFrame(frameNumber);
+    this->FrameCache.Put(frameNumber, frame);
+  }
+  return frame;
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarReader::SetFrameCacheMemoryLimit(int megabytes)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
+  this->FrameCache.SetMemoryLimit(static_cast<unsigned long long>(std::max(megabytes, 0)) << 20);
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarReader::SetPrefetchFrames(int numberOfFrames)
+{
+  numberOfFrames = std::max(numberOfFrames, 0);
+  if (numberOfFrames == this->PrefetchFrames)
+  {
+    return;
+  }
+  // As for the cache size, this does not change the output so Modified() is not called
+  this->StopPrefetchThread();
+  this->PrefetchFrames = numberOfFrames;
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarReader::SchedulePrefetch(int lastFrame, int stride)
+{
+  // The prefetch thread decodes with its own interpreter and packet file reader: the
+  // properties of the reader interpreter are set from the GUI thread without any lock
+  std::lock_guard<std::mutex> lock(this->PrefetchMutex);
+  if (!this->PrefetchInterpreter || this->PrefetchMTime != this->FrameCacheMTime)
+  {
+    this->PrefetchInterpreter = this->Interpreter->CanCreateDecodingClone()
+      ? this->Interpreter->CreateDecodingClone() : nullptr;
+    this->PrefetchMTime = this->FrameCacheMTime;
+    this->PrefetchFileName = this->FileName;
+    this->PrefetchFilter = this->GetPacketFilter();
+  }
+  if (!this->PrefetchInterpreter)
+  {
+    return;
+  }
+  this->PrefetchLastFrame = lastFrame;
+  this->PrefetchStride = stride;
+  this->PrefetchGeneration++;
+  if (!this->PrefetchThread)
+  {
+    this->PrefetchStopRequested = false;
+    this->PrefetchThread.reset(new std::thread(&vtkLidarReader::PrefetchThreadLoop, this));
+  }
+  this->PrefetchCondition.notify_one();
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarReader::StopPrefetchThread()
+{
+  if (!this->PrefetchThread)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(this->PrefetchMutex);
+    this->PrefetchStopRequested = true;
+  }
+  this->PrefetchCondition.notify_one();
+  this->PrefetchThread->join();
+  this->PrefetchThread.reset();
+}
+
+//-----------------------------------------------------------------------------
+void vtkLidarReader::PrefetchThreadLoop()
+{
+  unsigned long processedGeneration = 0;
+  std::unique_ptr<vtkPacketFileReader> reader;
+  std::string readerFile;
+  while (true)
+  {
+    int lastFrame, stride;
+    unsigned long generation;
+    vtkMTimeType mtime;
+    vtkSmartPointer<vtkLidarPacketInterpreter> interpreter;
+    std::string fileName, filter;
+    {
+      std::unique_lock<std::mutex> lock(this->PrefetchMutex);
+      this->PrefetchCondition.wait(lock, [&] {
+        return this->PrefetchStopRequested || this->PrefetchGeneration != processedGeneration;
+      });
+      if (this->PrefetchStopRequested)
+      {
+        return;
+      }
+      lastFrame = this->PrefetchLastFrame;
+      stride = this->PrefetchStride;
+      generation = processedGeneration = this->PrefetchGeneration;
+      mtime = this->PrefetchMTime;
+      interpreter = this->PrefetchInterpreter;
+      fileName = this->PrefetchFileName;
+      filter = this->PrefetchFilter;
+    }
+
+    // The errors are not reported from this thread, the frame
+    // is decoded again, with its errors, when it is requested
+    if (!reader || readerFile != fileName + '\n' + filter)
+    {
+      reader.reset(new vtkPacketFileReader);
+      readerFile = fileName + '\n' + filter;
+      if (!reader->Open(fileName, filter))
+      {
+        reader.reset();
+        continue;
+      }
+    }
+
+    for (int i = 1; i <= this->PrefetchFrames; ++i)
+    {
+      {
+        // a new request (seek, stop, ...) cancels the remaining frames
+        std::lock_guard<std::mutex> lock(this->PrefetchMutex);
+        if (this->PrefetchStopRequested || this->PrefetchGeneration != generation)
+        {
+          break;
+        }
+      }
+
+      // The lock is only held to access the catalog and the cache,
+      // the frame is decoded without blocking RequestData
+      int frameNumber = lastFrame + i * stride;
+      FrameInformation info;
+      {
+        std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
+        if (frameNumber < 0 || frameNumber >= static_cast<int>(this->FrameCatalog.size()) ||
+            this->FrameCacheMTime != mtime)
+        {
+          break;
+        }
+        if (this->FrameCache.Contains(frameNumber))
+        {
+          continue;
+        }
+        info = this->FrameCatalog[frameNumber];
+      }
+
+      vtkSmartPointer<vtkPolyData> frame = DecodeFrame(interpreter, reader.get(), info);
+
+      // The frames decoded with outdated parameters are dropped
+      std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
+      if (this->FrameCacheMTime != mtime)
+      {
+        break;
+      }
+      if (frame)
+      {
+        this->FrameCache.Put(frameNumber, frame);
+      }
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 int vtkLidarReader::RequestInformation(vtkInformation *vtkNotUsed(request),
                                        vtkInformationVector **vtkNotUsed(inputVector),
@@ -520,12 +1072,14 @@ int vtkLidarReader::RequestInformation(vtkInformation *vtkNotUsed(request),
   // load the calibration file only now to allow to set it before the interpreter.
   if (this->Interpreter->GetCalibrationFileName() != this->CalibrationFileName)
   {
+    std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
     this->Interpreter->SetCalibrationFileName(this->CalibrationFileName);
     this->Interpreter->LoadCalibration(this->CalibrationFileName);
   }
 
   if (this->Interpreter && !this->FileName.empty())
   {
+    std::lock_guard<std::recursive_mutex> lock(this->DecodeMutex);
     this->ReadFrameInformation();
   }
   vtkInformation* info = outputVector->GetInformationObject(0);
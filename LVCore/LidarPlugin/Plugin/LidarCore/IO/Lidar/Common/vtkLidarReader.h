@@ -17,8 +17,15 @@
 #define VTKLIDARREADER_H
 
 #include "vtkLidarPacketInterpreter.h"
+#include "LidarFrameCache.h"
 #include <vtkPolyDataAlgorithm.h>
 
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include "LidarCoreModule.h"
 
 class vtkPacketFileReader;
@@ -42,6 +49,49 @@ public:
   vtkGetMacro(DetectFrameDropping, bool)
   vtkSetMacro(DetectFrameDropping, bool)
 
+  /**
+   * @copydoc UseFrameIndexCache
+   */
+  vtkGetMacro(UseFrameIndexCache, bool)
+  vtkSetMacro(UseFrameIndexCache, bool)
+
+  /**
+   * @brief SetFrameCacheMemoryLimit set the memory budget, in MiB, of the decoded frames cache.
+   * 0 disables the cache. This does not modify the output, so Modified() is not called.
+   */
+  void SetFrameCacheMemoryLimit(int megabytes);
+  int GetFrameCacheMemoryLimit() { return static_cast<int>(this->FrameCache.GetMemoryLimit() >> 20); }
+
+  /**
+   * @brief GetFrameCacheHits number of frame requests served by the decoded frames cache
+   */
+  vtkIdType GetFrameCacheHits() { return static_cast<vtkIdType>(this->FrameCache.GetHits()); }
+
+  /**
+   * @brief GetFrameCacheMisses number of frame requests which required to decode the pcap
+   */
+  vtkIdType GetFrameCacheMisses() { return static_cast<vtkIdType>(this->FrameCache.GetMisses()); }
+
+  /**
+   * @brief SetPrefetchFrames set the number of frames decoded in advance by a background
+   * thread, in the current playback direction. 0 disables the prefetching.
+   * Prefetched frames are stored in the frame cache, which must be large enough to hold them.
+   * The thread decodes with its own interpreter, so only the interpreters implementing
+   * vtkLidarPacketInterpreter::CreateDecodingClone are prefetched.
+   */
+  void SetPrefetchFrames(int numberOfFrames);
+  vtkGetMacro(PrefetchFrames, int)
+
+  /**
+   * @brief SetIndexingThreads set the number of threads used to build the frame catalog.
+   * 0 uses all the available cores, 1 (the default) scans the capture sequentially.
+   * Each thread starts at the next record found after an offset of the capture,
+   * so only enable it with captures whose records can be resynchronized reliably.
+   * The catalog does not depend on the number of threads, so this does not modify the reader.
+   */
+  void SetIndexingThreads(int numberOfThreads) { this->IndexingThreads = numberOfThreads; }
+  vtkGetMacro(IndexingThreads, int)
+
   vtkMTimeType GetMTime() override;
 
   /**
@@ -105,6 +155,32 @@ public:
    */
   virtual int GetFrameIndexForDataTime(double dataTime);
 
+  /**
+   * @brief GetFrameIndexForTimestep returns the frame index corresponding to
+   *        a timestep of the pipeline, as used by RequestData
+   * @param timestep packet time or data time depending on UsePacketTimeForDisplayTime
+   */
+  virtual int GetFrameIndexForTimestep(double timestep);
+
+  /**
+   * @brief SupportsConcurrentDecoding return true if DecodeFrames can decode several
+   *        parts of the capture at the same time, see vtkLidarPacketInterpreter::CreateDecodingClone
+   */
+  bool SupportsConcurrentDecoding();
+
+  /**
+   * @brief DecodeFrames decode the frames [firstFrame, lastFrame] reading the capture
+   *        only once, in order, and pass each of them to callback with its index.
+   *        When the interpreter supports it, each call uses its own packet file reader
+   *        and interpreter, so that it can be called from several threads at once
+   *        and does not block the pipeline. Otherwise the reader interpreter is locked
+   *        during the whole call.
+   * @param callback return false to stop decoding
+   * @return false if the frames could not be decoded or callback stopped the decoding
+   */
+  bool DecodeFrames(int firstFrame, int lastFrame,
+    const std::function<bool(int, vtkSmartPointer<vtkPolyData>)>& callback);
+
   /**
    * @brief Open open the pcap file
    * @todo a decition should be made if the opening/closing of the pcap should be handle by
@@ -140,7 +216,7 @@ public:
 
 protected:
   vtkLidarReader();
-  ~vtkLidarReader() = default;
+  ~vtkLidarReader();
 
   int RequestData(vtkInformation* request,
                   vtkInformationVector** inputVector,
@@ -177,29 +253,118 @@ protected:
   //! libpcap wrapped reader which enable to get the raw pcap packet from the pcap file
   vtkPacketFileReader* Reader = nullptr;
 
+  //! Decoded frames kept in memory, indexed by their position in the FrameCatalog
+  LidarFrameCache FrameCache;
+
+  //! MTime of the reader when the FrameCache has been filled,
+  //! any modification of the reader or the interpreter invalidates the cache
+  vtkMTimeType FrameCacheMTime = 0;
+
+  //! Number of frames to decode in advance, see SetPrefetchFrames
+  int PrefetchFrames = 0;
+
+  //! Number of threads used to build the frame catalog, see SetIndexingThreads
+  int IndexingThreads = 1;
+
   //! Filter the packet to only read the packet received on a specify port
   //! To read all packet use -1
   int LidarPort = -1;
 
+  //! Reuse (and create) an index file next to the pcap to avoid
+  //! scanning the whole capture each time it is opened, see FrameCatalogIndex
+  bool UseFrameIndexCache = true;
+
   //! True to display the packet time in the UI pipeline
   //! False to display the network time in the UI pipeline
   bool UsePacketTimeForDisplayTime = false;
 
+  //! Smallest part of the capture scanned by each indexing thread, smaller captures
+  //! are scanned sequentially. Lowered by the tests to split their small captures.
+  int64_t IndexingMinimumChunkSize = 64 * 1024 * 1024;
+
+  /**
+   * @brief BuildFrameCatalogSerial scan the whole capture with the reader interpreter
+   * @return false if the capture could not be opened
+   */
+  bool BuildFrameCatalogSerial();
+
+  /**
+   * @brief BuildFrameCatalogParallel split the capture into chunks starting at packet
+   * record boundaries and scan them concurrently, each with its own clone of the interpreter.
+   * The result is identical to BuildFrameCatalogSerial.
+   * @return false if the capture cannot be split, the caller must then use the serial scan
+   */
+  bool BuildFrameCatalogParallel(int numberOfThreads);
+
 private:
   /**
    * @brief ReadFrameInformation read the whole pcap and create a frame index.
    * In case the calibration is contained in the pcap file, this will also read it
    */
   int ReadFrameInformation();
+
+  /**
+   * @brief ComputeNetworkTimeToDataTime update NetworkTimeToDataTime from the frame catalog
+   */
+  void ComputeNetworkTimeToDataTime();
+
+  /**
+   * @brief GetFrameIndexParsingOptions return a string describing all the reader and
+   * interpreter options that change the content of the frame catalog
+   */
+  std::string GetFrameIndexParsingOptions();
   /**
    * @brief SetTimestepInformation Set the timestep available
    * @param info
    */
   void SetTimestepInformation(vtkInformation *info);
 
+  /**
+   * @brief GetFrameFromCache return the requested frame from the frame cache,
+   * decoding and caching it if needed. DecodeMutex must be locked.
+   */
+  vtkSmartPointer<vtkPolyData> GetFrameFromCache(int frameNumber);
+
+  /**
+   * @brief SchedulePrefetch wake up the prefetch thread so that it decodes the frames
+   * following lastFrame, every stride frames. It cancels the frames which have been
+   * scheduled previously.
+   */
+  void SchedulePrefetch(int lastFrame, int stride);
+
+  void StopPrefetchThread();
+
+  /**
+   * @brief GetPacketFilter return the pcap filter selecting the packets read
+   */
+  std::string GetPacketFilter();
+
+  void PrefetchThreadLoop();
+
   vtkLidarReader(const vtkLidarReader&) = delete;
   void operator=(const vtkLidarReader&) = delete;
 
+  //! Protect the Interpreter, the packet file Reader, the FrameCatalog and
+  //! the FrameCache which are shared with the prefetch thread.
+  //! Recursive as the public methods (GetFrame, Open, ...) lock it too.
+  std::recursive_mutex DecodeMutex;
+
+  //! Background thread decoding the next frames, see SetPrefetchFrames
+  std::unique_ptr<std::thread> PrefetchThread;
+  std::mutex PrefetchMutex;
+  std::condition_variable PrefetchCondition;
+  bool PrefetchStopRequested = false;
+  //! Incremented at each request so that the thread abandons outdated work
+  unsigned long PrefetchGeneration = 0;
+  int PrefetchLastFrame = 0;
+  int PrefetchStride = 1;
+  //! Clone of the interpreter used by the prefetch thread, and the FrameCacheMTime,
+  //! capture and packet filter it has been created for
+  vtkSmartPointer<vtkLidarPacketInterpreter> PrefetchInterpreter;
+  vtkMTimeType PrefetchMTime = 0;
+  std::string PrefetchFileName;
+  std::string PrefetchFilter;
+
   /**
    * @brief The timeshift between these two times.
    * When added to "network time" it gives "data time".
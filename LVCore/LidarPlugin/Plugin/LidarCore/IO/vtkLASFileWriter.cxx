@@ -7,6 +7,9 @@
 #include "vtkInformationVector.h"
 #include "vtkInformation.h"
 #include <iostream>
+#include <string>
+
+#include <vtksys/SystemTools.hxx>
 
 #include "vtkConversions.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
@@ -88,6 +91,16 @@ int vtkLASFileWriter::Write()
 
   this->LASWriter.SetWriteSRS(this->WriteSRS);
   this->LASWriter.SetWriteColor(this->WriteColor);
+  // .laz files are always compressed
+  const std::string fileName = this->FileName ? this->FileName : "";
+  const bool lazExtension = fileName.size() >= 4 &&
+    vtksys::SystemTools::LowerCase(fileName.substr(fileName.size() - 4)) == ".laz";
+  if ((this->Compressed || lazExtension) && !LASFileWriter::CanWriteCompressed())
+  {
+    vtkErrorMacro("Can not write " << fileName << " compressed, libLAS was built without LASzip");
+    return 0;
+  }
+  this->LASWriter.SetCompressed(this->Compressed || lazExtension);
   this->LASWriter.Open(this->FileName);
 
   bool useLatLonForOut = this->ExportType == EXPORT_LATLONG;
@@ -118,6 +131,8 @@ int vtkLASFileWriter::Write()
   // the call to Update() is required, this is what triggers the writting
   // by way of running the pipeline
   this->Update();
+  // stores the bounding box and the number of points computed while writing
+  this->LASWriter.Close();
 
   return 1;
 }
@@ -64,6 +64,9 @@ public:
   vtkSetMacro(WriteColor, bool)
   vtkGetMacro(WriteColor, bool)
 
+  vtkSetMacro(Compressed, bool)
+  vtkGetMacro(Compressed, bool)
+
   vtkSetMacro(LastFrame, int)
   vtkGetMacro(LastFrame, int)
 
@@ -142,7 +145,9 @@ private:
   int CurrentFrame = 0;
   int ExportType = EXPORT_UTM;
   int InOutSignedUTMZone = 0;
-  bool SkipMetaDataPass = false;
+  bool Compressed = false; // write LAZ, requires libLAS built with LASzip
+  // The metadata are computed while writing, the first pass is only kept for compatibility
+  bool SkipMetaDataPass = true;
   int CurrentPass = 0; // pass 0 is to compute the header, pass 1 is to write
   static const int PassCount = 2;
   // This Offset must be applied to the coordinates of the points inside the
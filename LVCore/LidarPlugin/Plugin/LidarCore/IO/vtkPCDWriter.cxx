@@ -1,13 +1,19 @@
 #include "vtkPCDWriter.h"
 
+#include "LZFCompression.h"
+
 #include <vtkInformation.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkTemplateAliasMacro.h>
 
+#include <cstring>
+#include <limits>
 #include <unordered_set>
 #include <sstream>
+#include <vector>
 
 using namespace std;
 
@@ -23,6 +29,125 @@ bool is_big_endian(void)
     return bint.c[0] == 1;
 }
 
+//-----------------------------------------------------------------------------
+// PCD TYPE of a vtk data type, 0 if the arrays of this type are not written
+char GetPCDType(int dataType)
+{
+  switch (dataType)
+  {
+    case VTK_SIGNED_CHAR:
+    case VTK_SHORT:
+    case VTK_INT:
+    case VTK_LONG:
+    case VTK_LONG_LONG:
+      return 'I';
+    case VTK_UNSIGNED_CHAR:
+    case VTK_UNSIGNED_SHORT:
+    case VTK_UNSIGNED_INT:
+    case VTK_UNSIGNED_LONG:
+    case VTK_UNSIGNED_LONG_LONG:
+      return 'U';
+    case VTK_TYPE_FLOAT32:
+    case VTK_TYPE_FLOAT64:
+      return 'F';
+    default:
+      return 0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <size_t Size>
+void CopyStrided(const unsigned char* src, vtkIdType nbTuples, unsigned char* dst, size_t stride)
+{
+  for (vtkIdType i = 0; i < nbTuples; ++i)
+  {
+    std::memcpy(dst + i * stride, src + i * Size, Size);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Copy the tuples of an array, as stored, to dst with stride bytes between two tuples
+void CopyArray(vtkDataArray* array, vtkIdType nbTuples, unsigned char* dst, size_t stride)
+{
+  const int nbComponents = array->GetNumberOfComponents();
+  const size_t tupleSize = array->GetDataTypeSize() * nbComponents;
+  if (!array->HasStandardMemoryLayout())
+  {
+    // Generic path for the implicit and the structure of arrays layouts
+    switch (array->GetDataType())
+    {
+      vtkTemplateAliasMacro(
+        for (vtkIdType i = 0; i < nbTuples; ++i)
+        {
+          for (int k = 0; k < nbComponents; ++k)
+          {
+            VTK_TT data = static_cast<VTK_TT>(array->GetComponent(i, k));
+            std::memcpy(dst + i * stride + k * sizeof(VTK_TT), &data, sizeof(VTK_TT));
+          }
+        }
+      );
+    }
+    return;
+  }
+
+  const unsigned char* src = static_cast<const unsigned char*>(array->GetVoidPointer(0));
+  if (stride == tupleSize)
+  {
+    std::memcpy(dst, src, nbTuples * tupleSize);
+    return;
+  }
+  switch (tupleSize)
+  {
+    case 1: CopyStrided<1>(src, nbTuples, dst, stride); break;
+    case 2: CopyStrided<2>(src, nbTuples, dst, stride); break;
+    case 4: CopyStrided<4>(src, nbTuples, dst, stride); break;
+    case 8: CopyStrided<8>(src, nbTuples, dst, stride); break;
+    default:
+      for (vtkIdType i = 0; i < nbTuples; ++i)
+      {
+        std::memcpy(dst + i * stride, src + i * tupleSize, tupleSize);
+      }
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void CopyCoordinates(const T* src, vtkIdType nbPoints, unsigned char* dst, size_t stride, size_t componentStride)
+{
+  for (vtkIdType i = 0; i < nbPoints; ++i)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      const float value = static_cast<float>(src[3 * i + c]);
+      std::memcpy(dst + i * stride + c * componentStride, &value, sizeof(float));
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Copy the point coordinates as float, x at dst, y at dst + componentStride, z at dst + 2 * componentStride
+void CopyPoints(vtkPoints* points, vtkIdType nbPoints, unsigned char* dst, size_t stride, size_t componentStride)
+{
+  vtkDataArray* data = points->GetData();
+  if (data->HasStandardMemoryLayout() && data->GetDataType() == VTK_FLOAT)
+  {
+    CopyCoordinates(static_cast<const float*>(data->GetVoidPointer(0)), nbPoints, dst, stride, componentStride);
+  }
+  else if (data->HasStandardMemoryLayout() && data->GetDataType() == VTK_DOUBLE)
+  {
+    CopyCoordinates(static_cast<const double*>(data->GetVoidPointer(0)), nbPoints, dst, stride, componentStride);
+  }
+  else
+  {
+    for (vtkIdType i = 0; i < nbPoints; ++i)
+    {
+      double pt[3];
+      points->GetPoint(i, pt);
+      CopyCoordinates(pt, 1, dst + i * stride, stride, componentStride);
+    }
+  }
+}
+
 }
 //-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkPCDWriter)
@@ -38,7 +163,7 @@ void vtkPCDWriter::WriteData()
 {
   auto* polyData = vtkPolyData::SafeDownCast(this->Superclass::GetInput());
 
-  if (!polyData && polyData->GetNumberOfPoints() == 0)
+  if (!polyData || polyData->GetNumberOfPoints() == 0)
   {
     vtkErrorMacro("No points to save");
     return;
@@ -59,7 +184,7 @@ void vtkPCDWriter::WriteData()
     return;
   }
 
-  ofstream file(this->FileName);
+  ofstream file(this->FileName, this->Binary ? ios::out | ios::binary : ios::out);
   if (!file.is_open())
   {
     vtkErrorMacro("Could not open file: " << this->FileName);
@@ -102,24 +227,9 @@ void vtkPCDWriter::WriteHeader(vtkPolyData* polydata, ofstream& file)
     auto* array = pd->GetArray(i);
 
     // determine TYPE
-    char type;
-    switch (array->GetDataType()) {
-      case VTK_SIGNED_CHAR:
-      case VTK_SHORT:
-      case VTK_INT:
-      case VTK_LONG:
-      case VTK_LONG_LONG: type = 'I';
-                          break;
-      case VTK_UNSIGNED_CHAR:
-      case VTK_UNSIGNED_SHORT:
-      case VTK_UNSIGNED_INT:
-      case VTK_UNSIGNED_LONG:
-      case VTK_UNSIGNED_LONG_LONG: type = 'U';
-                                   break;
-      case VTK_TYPE_FLOAT32:
-      case VTK_TYPE_FLOAT64: type = 'F';
-                             break;
-    default:
+    char type = GetPCDType(array->GetDataType());
+    if (!type)
+    {
       vtkWarningMacro("Unsupported type for array " << array->GetName());
       continue;
     }
@@ -146,54 +256,72 @@ void vtkPCDWriter::WriteHeader(vtkPolyData* polydata, ofstream& file)
   file << "\nTYPE " << types.str();
   file << "\nCOUNT " << counts.str();
 
-  file << "\nWIDTH " << pd->GetNumberOfTuples();
+  file << "\nWIDTH " << polydata->GetNumberOfPoints();
   file << "\nHEIGHT " << 1;
   file << "\nVIEWPOINT " << "0 0 0 1 0 0 0";
-  file << "\nPOINTS " << pd->GetNumberOfTuples();
+  file << "\nPOINTS " << polydata->GetNumberOfPoints();
 
-  string mode = this->Binary ? "binary" : "ascii";
+  string mode = this->Binary ? (this->Compressed ? "binary_compressed" : "binary") : "ascii";
   file << "\nDATA " << mode << "\n";
 }
 
 //-----------------------------------------------------------------------------
 void vtkPCDWriter::WriteBody(vtkPolyData* polydata, ofstream& file)
 {
-  // If speed up is needed, and you can make the assumption the array are AOS
-  // do not hesite to grap directly the data in memory using using GetVoidPointer()
   vtkPointData* pd = polydata->GetPointData();
   if (this->Binary)
   {
-    for (int i = 0; i < polydata->GetNumberOfPoints(); i++)
+    // Pack the whole body from the raw memory of the arrays, then write it at once
+    const vtkIdType nbPoints = polydata->GetNumberOfPoints();
+    std::vector<vtkDataArray*> arrays;
+    size_t pointSize = 3 * sizeof(float);
+    for (int j = 0; j < pd->GetNumberOfArrays(); ++j)
     {
-      // Write x y z
-      double pt[3];
-      polydata->GetPoint(i, pt);
-      float x = static_cast<float>(pt[0]);
-      float y = static_cast<float>(pt[1]);
-      float z = static_cast<float>(pt[2]);
-      file.write(reinterpret_cast<const char *>(&x), sizeof(float));
-      file.write(reinterpret_cast<const char *>(&y), sizeof(float));
-      file.write(reinterpret_cast<const char *>(&z), sizeof(float));
+      auto* array = pd->GetArray(j);
+      if (GetPCDType(array->GetDataType()))
+      {
+        arrays.push_back(array);
+        pointSize += array->GetDataTypeSize() * array->GetNumberOfComponents();
+      }
+    }
+    if (this->Compressed && pointSize * nbPoints > std::numeric_limits<uint32_t>::max())
+    {
+      vtkErrorMacro("Too many points to write a binary_compressed file");
+      return;
+    }
+    std::vector<unsigned char> body(pointSize * nbPoints);
+    unsigned char* dst = body.data();
 
-      // Write other array
-      for (int j = 0; j < pd->GetNumberOfArrays(); ++j)
+    if (!this->Compressed)
+    {
+      // One point after the other: x y z and the arrays
+      CopyPoints(polydata->GetPoints(), nbPoints, dst, pointSize, sizeof(float));
+      size_t offset = 3 * sizeof(float);
+      for (auto* array : arrays)
       {
-        auto* array = pd->GetArray(j);
-        int dataType = array->GetDataType();
-        for (int k = 0; k < array->GetNumberOfComponents(); ++k)
-        {
-          switch (dataType)
-          {
-            vtkTemplateAliasMacro(
-              VTK_TT data = static_cast<VTK_TT>(array->GetComponent(i,k));
-              file.write(reinterpret_cast<const char *>(&data), sizeof(VTK_TT));
-            );
-            default:
-              vtkErrorMacro("unknow vtk type encountered in array " << array->GetName());
-          }
-        }
+        CopyArray(array, nbPoints, dst + offset, pointSize);
+        offset += array->GetDataTypeSize() * array->GetNumberOfComponents();
       }
+      file.write(reinterpret_cast<const char*>(body.data()), body.size());
+      return;
+    }
+
+    // binary_compressed stores one field after the other: all the x, all the y...
+    // then compresses everything with LZF, preceded by the compressed and uncompressed sizes
+    CopyPoints(polydata->GetPoints(), nbPoints, dst, sizeof(float), nbPoints * sizeof(float));
+    size_t offset = 3 * sizeof(float) * nbPoints;
+    for (auto* array : arrays)
+    {
+      const size_t tupleSize = array->GetDataTypeSize() * array->GetNumberOfComponents();
+      CopyArray(array, nbPoints, dst + offset, tupleSize);
+      offset += tupleSize * nbPoints;
     }
+
+    std::vector<unsigned char> compressed(LZFMaxCompressedSize(body.size()));
+    const uint32_t sizes[2] = { static_cast<uint32_t>(LZFCompress(body.data(), body.size(), compressed.data(), compressed.size())),
+                                static_cast<uint32_t>(body.size()) };
+    file.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    file.write(reinterpret_cast<const char*>(compressed.data()), sizes[0]);
   }
   else
   {
@@ -215,6 +343,11 @@ void vtkPCDWriter::WriteBody(vtkPolyData* polydata, ofstream& file)
       {
         auto* array = pd->GetArray(j);
         int dataType = array->GetDataType();
+        // skipped by the header
+        if (!GetPCDType(dataType))
+        {
+          continue;
+        }
         for (int k = 0; k < array->GetNumberOfComponents(); ++k)
         {
           if(dataType == VTK_UNSIGNED_CHAR)
@@ -27,6 +27,13 @@ public:
   vtkGetMacro(Binary, bool)
   vtkSetMacro(Binary, bool)
 
+  /**
+   * @brief Compressed compress the binary data with LZF (DATA binary_compressed),
+   * only used in Binary mode
+   */
+  vtkGetMacro(Compressed, bool)
+  vtkSetMacro(Compressed, bool)
+
   vtkGetMacro(FloatPointPrecision, int)
   vtkSetMacro(FloatPointPrecision, int)
 
@@ -46,6 +53,7 @@ private:
 
   char* FileName = nullptr;
   bool Binary = false;
+  bool Compressed = false;
   int FloatPointPrecision = 8;
 };
 #endif // VTKPCDWRITER_H
@@ -102,6 +102,18 @@ void vtkStream::SetIsCrashAnalysing(bool value)
   SetAttributeAndRestartIfRunning(this->IsCrashAnalysing, value);
 }
 
+//-----------------------------------------------------------------------------
+void vtkStream::SetReceiveBufferSize(int value)
+{
+  SetAttributeAndRestartIfRunning(this->ReceiveBufferSize, value);
+}
+
+//-----------------------------------------------------------------------------
+void vtkStream::SetReceptionBatchSize(int value)
+{
+  SetAttributeAndRestartIfRunning(this->ReceptionBatchSize, value);
+}
+
 //-----------------------------------------------------------------------------
 bool vtkStream::GetNeedsUpdate()
 {
@@ -136,6 +148,11 @@ void vtkStream::Start()
                                                         std::bind(&vtkStream::EnqueuePacket, this, std::placeholders::_1),
                                                         this->MulticastAddress,
                                                         this->LocalListeningAddress);
+  this->ReceiverThread->SetReceiveBufferSize(this->ReceiveBufferSize);
+  if (this->ReceptionBatchSize > 1)
+  {
+    this->ReceiverThread->EnableBatchedReception(this->ReceptionBatchSize);
+  }
   if (this->IsForwarding)
   {
     this->ReceiverThread->EnableForwarding(this->ForwardedPort, this->ForwardedIpAddress);
@@ -169,6 +186,11 @@ void vtkStream::Stop()
   if (this->ConsumerThread)
   {
     this->ConsumerThread->Stop();
+    if (this->ConsumerThread->GetNumberOfDroppedPackets() > 0)
+    {
+      vtkWarningMacro(<< this->ConsumerThread->GetNumberOfDroppedPackets()
+                      << " packets were dropped because the decoding could not keep up with the sensor");
+    }
     this->ConsumerThread.reset();
   }
 }
@@ -201,6 +223,30 @@ bool vtkStream::IsRecording()
   return this->WriterThread ? true : false;
 }
 
+//-----------------------------------------------------------------------------
+uint64_t vtkStream::GetNumberOfDroppedPackets()
+{
+  return this->ConsumerThread ? this->ConsumerThread->GetNumberOfDroppedPackets() : 0;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t vtkStream::GetNumberOfDroppedRecordedPackets()
+{
+  return this->WriterThread ? this->WriterThread->GetNumberOfDroppedPackets() : 0;
+}
+
+//-----------------------------------------------------------------------------
+size_t vtkStream::GetRecordingQueueDepth()
+{
+  return this->WriterThread ? this->WriterThread->GetQueueDepth() : 0;
+}
+
+//-----------------------------------------------------------------------------
+uint64_t vtkStream::GetNumberOfRecordedBytes()
+{
+  return this->WriterThread ? this->WriterThread->GetNumberOfBytesWritten() : 0;
+}
+
 //-----------------------------------------------------------------------------
 void vtkStream::EnqueuePacket(NetworkPacket* packet)
 {
@@ -221,11 +267,11 @@ void vtkStream::EnqueuePacket(NetworkPacket* packet)
   //std::cout << "seq : " << ap->header.GetSeqNum() << std::endl;
 #endif
 
-  NetworkPacket* packet2 = nullptr;
+  // The writer and the consumer share the packet, each of them releases it once done
   if (this->WriterThread)
   {
-    packet2 = new NetworkPacket(*packet);
-    this->WriterThread->Enqueue(packet2);
+    packet->AddReference();
+    this->WriterThread->Enqueue(packet);
   }
   assert(this->ConsumerThread && "The receiver thread should be started before the consumer one");
   this->ConsumerThread->Enqueue(packet);
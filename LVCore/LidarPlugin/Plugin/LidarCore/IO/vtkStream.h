@@ -16,6 +16,7 @@
 #ifndef VTKSTREAM_H
 #define VTKSTREAM_H
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -46,6 +47,30 @@ public:
   void StopRecording();
   bool IsRecording();
 
+  /**
+   * @brief GetNumberOfDroppedPackets number of received packets which could not be decoded
+   * since the last Start(), because the decoding thread was too slow.
+   */
+  uint64_t GetNumberOfDroppedPackets();
+
+  /**
+   * @brief GetNumberOfDroppedRecordedPackets number of received packets which could not be
+   * recorded since the last StartRecording(), because the disk was too slow.
+   */
+  uint64_t GetNumberOfDroppedRecordedPackets();
+
+  /**
+   * @brief GetRecordingQueueDepth number of received packets waiting to be recorded,
+   * a depth growing toward the queue size means that the disk is too slow.
+   */
+  size_t GetRecordingQueueDepth();
+
+  /**
+   * @brief GetNumberOfRecordedBytes size of the file recorded since the last StartRecording().
+   * The writer may be shared with other streams, in which case their packets are counted too.
+   */
+  uint64_t GetNumberOfRecordedBytes();
+
   vtkGetMacro(ListeningPort, int)
   void SetListeningPort(int);
 
@@ -67,6 +92,12 @@ public:
   vtkGetMacro(IsCrashAnalysing, bool)
   void SetIsCrashAnalysing(bool value);
 
+  vtkGetMacro(ReceiveBufferSize, int)
+  void SetReceiveBufferSize(int bytes);
+
+  vtkGetMacro(ReceptionBatchSize, int)
+  void SetReceptionBatchSize(int numberOfPackets);
+
   vtkGetObjectMacro(Interpreter, vtkInterpreter)
   [[deprecated("Please use specific setter : setLidarInterpreter() or SetPosOrInterpreter()")]]
   vtkSetObjectMacro(Interpreter, vtkInterpreter)
@@ -148,6 +179,11 @@ private:
 
   bool IsCrashAnalysing = false;
 
+  /*!< Size of the socket receive buffer (SO_RCVBUF), in bytes*/
+  int ReceiveBufferSize = 4194304;
+  /*!< Maximum number of packets received per system call, 1 to disable the batched reception (Linux only)*/
+  int ReceptionBatchSize = 1;
+
   //! Thread that will listen on the network to get the packets
   std::unique_ptr<PacketReceiver> ReceiverThread;
   //! Thread that will consume the packets
@@ -0,0 +1,188 @@
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtksys/SystemTools.hxx>
+
+#include "IO/Lidar/Common/FrameCatalogIndex.h"
+#include "IO/Lidar/Common/vtkLidarReader.h"
+#include "TestPacketInterpreter.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+
+// Gives access to the frame catalog of the reader
+class TestIndexReader : public vtkLidarReader
+{
+public:
+    static TestIndexReader* New() { VTK_STANDARD_NEW_BODY(TestIndexReader); }
+    vtkTypeMacro(TestIndexReader, vtkLidarReader)
+
+    const std::vector<FrameInformation>& GetFrameCatalog() { return this->FrameCatalog; }
+};
+
+
+struct Capture
+{
+    std::string FileName;
+    std::string CalibrationFileName;
+    double FrameDuration = 0;
+};
+
+
+// Open the capture with a new reader, as when the capture is opened again.
+// preProcessedPackets is 0 when the catalog has been loaded from the index.
+void open_capture(const Capture& capture, bool useIndex,
+                  std::vector<FrameInformation>& catalog, int& preProcessedPackets)
+{
+    vtkNew<TestPacketInterpreter> interpreter;
+    interpreter->SetFrameDuration_s(capture.FrameDuration);
+    vtkNew<TestIndexReader> reader;
+    reader->SetInterpreter(interpreter);
+    reader->SetFileName(capture.FileName);
+    reader->SetCalibrationFileName(capture.CalibrationFileName);
+    reader->SetIndexingThreads(1);
+    reader->SetUseFrameIndexCache(useIndex);
+    reader->UpdateInformation();
+    catalog = reader->GetFrameCatalog();
+    preProcessedPackets = interpreter->NumberOfPreProcessedPackets;
+}
+
+
+bool check_catalog(const std::vector<FrameInformation>& expected,
+                   const std::vector<FrameInformation>& catalog, const char* name)
+{
+    if (catalog.size() != expected.size())
+    {
+        std::cerr << name << ": " << catalog.size() << " frames instead of " << expected.size() << "\n";
+        return false;
+    }
+    bool res = true;
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        res = check_frame(expected[i], catalog[i], i) && res;
+    }
+    if (!res)
+    {
+        std::cerr << name << ": the catalog differs from the one built from the capture\n";
+    }
+    return res;
+}
+
+
+// Open the capture twice: the first time the catalog must be built
+// (and saved), the second time it must come from the index
+bool check_rebuilt(const Capture& capture, const std::vector<FrameInformation>& expected, const char* name)
+{
+    std::vector<FrameInformation> catalog;
+    int preProcessedPackets = 0;
+    open_capture(capture, true, catalog, preProcessedPackets);
+    bool res = check_catalog(expected, catalog, name);
+    if (preProcessedPackets == 0)
+    {
+        std::cerr << name << ": the stale index has been used\n";
+        res = false;
+    }
+
+    open_capture(capture, true, catalog, preProcessedPackets);
+    res = check_catalog(expected, catalog, name) && res;
+    if (preProcessedPackets != 0)
+    {
+        std::cerr << name << ": the index has not been saved again\n";
+        res = false;
+    }
+    return res;
+}
+
+
+void write_file(const std::string& fileName, const std::string& content)
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <pcap file> <temporary pcap file>\n";
+        return 1;
+    }
+
+    // The index is written next to the capture, work on a copy
+    Capture capture;
+    capture.FileName = argv[2];
+    capture.CalibrationFileName = capture.FileName + ".calib";
+    const std::string indexFileName = capture.FileName + FrameCatalogIndex::Extension;
+    vtksys::SystemTools::RemoveFile(indexFileName);
+    if (!vtksys::SystemTools::CopyFileAlways(argv[1], capture.FileName))
+    {
+        std::cerr << "Could not copy " << argv[1] << " to " << capture.FileName << "\n";
+        return 1;
+    }
+    write_file(capture.CalibrationFileName, "First calibration");
+
+    // Reference catalog, built without the index
+    std::vector<FrameInformation> expected;
+    int preProcessedPackets = 0;
+    open_capture(capture, false, expected, preProcessedPackets);
+    if (expected.size() < 2)
+    {
+        std::cerr << "Could not index " << argv[1] << "\n";
+        return 1;
+    }
+    if (vtksys::SystemTools::FileExists(indexFileName))
+    {
+        std::cerr << "The index has been written while it is disabled\n";
+        return 1;
+    }
+
+    int errors = 0;
+
+    // Write then reload the index
+    errors += !check_rebuilt(capture, expected, "New index");
+    if (!vtksys::SystemTools::FileExists(indexFileName))
+    {
+        std::cerr << "The index has not been written\n";
+        errors++;
+    }
+
+    // The calibration content is part of the key, not only its file name
+    write_file(capture.CalibrationFileName, "Second calibration");
+    errors += !check_rebuilt(capture, expected, "Calibration modified");
+
+    // So are the parsing options
+    capture.FrameDuration = 0.05;
+    errors += !check_rebuilt(capture, expected, "Frame duration modified");
+    capture.FrameDuration = 0;
+    errors += !check_rebuilt(capture, expected, "Frame duration restored");
+
+    // And the modification time of the capture
+    const long int modificationTime = vtksys::SystemTools::ModifiedTime(capture.FileName);
+    for (int i = 0; i < 30 && vtksys::SystemTools::ModifiedTime(capture.FileName) == modificationTime; ++i)
+    {
+        vtksys::SystemTools::Delay(100);
+        vtksys::SystemTools::Touch(capture.FileName, false);
+    }
+    errors += !check_rebuilt(capture, expected, "Capture modified");
+
+    // A truncated index is ignored
+    std::ifstream index(indexFileName, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(index)), std::istreambuf_iterator<char>());
+    index.close();
+    write_file(indexFileName, content.substr(0, content.size() / 2));
+    errors += !check_rebuilt(capture, expected, "Truncated index");
+
+    vtksys::SystemTools::RemoveFile(indexFileName);
+    vtksys::SystemTools::RemoveFile(capture.CalibrationFileName);
+    vtksys::SystemTools::RemoveFile(capture.FileName);
+
+    if (errors == 0)
+    {
+        std::cout << "The index of the " << expected.size() << " frames is reused and rebuilt when stale" << std::endl;
+    }
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtksys/SystemTools.hxx>
+
+#include "IO/Lidar/Common/vtkLidarReader.h"
+#include "TestPacketInterpreter.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+// Gives access to the two ways of building the frame catalog
+class TestCatalogReader : public vtkLidarReader
+{
+public:
+    static TestCatalogReader* New() { VTK_STANDARD_NEW_BODY(TestCatalogReader); }
+    vtkTypeMacro(TestCatalogReader, vtkLidarReader)
+
+    bool BuildSerial(std::vector<FrameInformation>& catalog)
+    {
+        if (!this->BuildFrameCatalogSerial())
+        {
+            return false;
+        }
+        catalog = this->FrameCatalog;
+        return true;
+    }
+
+    // Split the capture into numberOfThreads chunks, whatever its size
+    bool BuildParallel(int numberOfThreads, std::vector<FrameInformation>& catalog)
+    {
+        const int64_t fileSize = static_cast<int64_t>(vtksys::SystemTools::FileLength(this->FileName));
+        this->IndexingMinimumChunkSize = fileSize / numberOfThreads;
+        if (!this->BuildFrameCatalogParallel(numberOfThreads))
+        {
+            return false;
+        }
+        catalog = this->FrameCatalog;
+        return true;
+    }
+};
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <pcap file>\n";
+        return 1;
+    }
+
+    vtkNew<TestPacketInterpreter> interpreter;
+    vtkNew<TestCatalogReader> reader;
+    reader->SetInterpreter(interpreter);
+    reader->SetFileName(argv[1]);
+
+    std::vector<FrameInformation> serialCatalog;
+    if (!reader->BuildSerial(serialCatalog) || serialCatalog.size() < 2)
+    {
+        std::cerr << "Could not index " << argv[1] << "\n";
+        return 1;
+    }
+
+    int errors = 0;
+    for (int numberOfThreads : { 2, 3, 4 })
+    {
+        std::vector<FrameInformation> parallelCatalog;
+        if (!reader->BuildParallel(numberOfThreads, parallelCatalog))
+        {
+            std::cerr << "The capture was not indexed with " << numberOfThreads << " threads\n";
+            errors++;
+            continue;
+        }
+
+        if (parallelCatalog.size() != serialCatalog.size())
+        {
+            std::cerr << numberOfThreads << " threads: " << parallelCatalog.size()
+                      << " frames instead of " << serialCatalog.size() << "\n";
+            errors++;
+            continue;
+        }
+
+        for (size_t i = 0; i < serialCatalog.size(); ++i)
+        {
+            if (!check_frame(serialCatalog[i], parallelCatalog[i], i))
+            {
+                errors++;
+            }
+        }
+    }
+
+    if (errors == 0)
+    {
+        std::cout << "The " << serialCatalog.size() << " frames are identical" << std::endl;
+    }
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include "IO/LZFCompression.h"
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// Compress then decompress the buffer, and check the sizes on the way
+bool check_round_trip(const std::vector<unsigned char>& data, const std::string& name)
+{
+    std::vector<unsigned char> compressed(LZFMaxCompressedSize(data.size()));
+    const size_t compressedSize = LZFCompress(data.data(), data.size(), compressed.data(), compressed.size());
+    if (data.empty())
+    {
+        return compressedSize == 0;
+    }
+    if (compressedSize == 0 || compressedSize > compressed.size())
+    {
+        std::cerr << name << ": could not compress " << data.size() << " bytes\n";
+        return false;
+    }
+
+    // One byte more than needed, to detect a too long output
+    std::vector<unsigned char> decompressed(data.size() + 1);
+    const size_t size = LZFDecompress(compressed.data(), compressedSize, decompressed.data(), decompressed.size());
+    if (size != data.size() || std::memcmp(data.data(), decompressed.data(), size) != 0)
+    {
+        std::cerr << name << ": " << data.size() << " bytes are not restored\n";
+        return false;
+    }
+
+    // The decompression stops instead of writing out of the output
+    if (LZFDecompress(compressed.data(), compressedSize, decompressed.data(), data.size() - 1) != 0)
+    {
+        std::cerr << name << ": decompressed in a too small buffer\n";
+        return false;
+    }
+    return true;
+}
+
+
+// Decompress a hand-written stream, following the format described in LZFCompression.h
+bool check_stream(const std::vector<unsigned char>& stream, const std::string& expected, const std::string& name)
+{
+    std::vector<char> out(expected.size() + 16);
+    const size_t size = LZFDecompress(stream.data(), stream.size(), out.data(), out.size());
+    if (std::string(out.data(), size) != expected)
+    {
+        std::cerr << name << ": decompressed \"" << std::string(out.data(), size) << "\" instead of \"" << expected << "\"\n";
+        return false;
+    }
+    return true;
+}
+
+
+int main()
+{
+    int errors = 0;
+
+    errors += !check_stream({ 2, 'a', 'b', 'c' }, "abc", "Literals");
+    // a back reference of 3 bytes at an offset of 3, then one of 5 overlapping bytes at an offset of 1
+    errors += !check_stream({ 2, 'a', 'b', 'c', 1 << 5, 2, 3 << 5, 0 }, "abcabcccccc", "Short back references");
+    // a back reference of 7 + 3 + 2 bytes at an offset of 2
+    errors += !check_stream({ 1, 'a', 'b', 7 << 5, 3, 1 }, "ababababababab", "Long back reference");
+    // references before the start of the output are corrupted data
+    errors += !check_stream({ 1, 'a', 'b', 1 << 5, 5 }, "", "Corrupted reference");
+    errors += !check_stream({ 5, 'a', 'b' }, "", "Truncated literals");
+
+    std::mt19937 generator(42);
+    for (size_t size : { 0, 1, 2, 3, 4, 31, 32, 33, 1000, 8192, 8193, 100000, 1 << 20 })
+    {
+        std::vector<unsigned char> data(size);
+        const std::string suffix = " (" + std::to_string(size) + " bytes)";
+
+        // Incompressible
+        for (auto& byte : data)
+        {
+            byte = static_cast<unsigned char>(generator());
+        }
+        errors += !check_round_trip(data, "Random bytes" + suffix);
+
+        // Short and overlapping matches
+        for (auto& byte : data)
+        {
+            byte = static_cast<unsigned char>(generator() % 3);
+        }
+        errors += !check_round_trip(data, "Three symbols" + suffix);
+
+        // Matches longer than the longest back reference
+        for (size_t i = 0; i < size; ++i)
+        {
+            data[i] = static_cast<unsigned char>(i / 1000);
+        }
+        errors += !check_round_trip(data, "Long runs" + suffix);
+
+        // Copies of older data, up to the farthest back reference and beyond
+        for (size_t i = 0; i < size; ++i)
+        {
+            const size_t distance = 8190 + generator() % 5;
+            data[i] = i >= distance && generator() % 16 != 0 ? data[i - distance]
+                                                              : static_cast<unsigned char>(generator());
+        }
+        errors += !check_round_trip(data, "Distant matches" + suffix);
+    }
+
+    // Compressible data is actually compressed
+    std::vector<unsigned char> zeros(100000, 0);
+    std::vector<unsigned char> compressed(LZFMaxCompressedSize(zeros.size()));
+    const size_t compressedSize = LZFCompress(zeros.data(), zeros.size(), compressed.data(), compressed.size());
+    if (compressedSize == 0 || compressedSize > zeros.size() / 50)
+    {
+        std::cerr << zeros.size() << " zeros compressed to " << compressedSize << " bytes\n";
+        errors++;
+    }
+
+    // The compression stops instead of writing out of the output
+    if (LZFCompress(zeros.data(), zeros.size(), compressed.data(), compressedSize - 1) != 0)
+    {
+        std::cerr << "Compressed in a too small buffer\n";
+        errors++;
+    }
+
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include <vtkDoubleArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+#include "IO/Lidar/Common/LidarFramePool.h"
+
+#include <iostream>
+
+
+const vtkIdType numberOfPoints = 1000;
+
+
+vtkSmartPointer<vtkPolyData> new_frame(LidarFramePool& pool)
+{
+    auto frame = pool.NewFrame(numberOfPoints);
+    pool.AddArray<vtkDoubleArray>(frame, "Distance");
+    pool.AddArray<vtkUnsignedCharArray>(frame, "Intensity");
+    frame->GetPoints()->SetPoint(10, 1.0, 2.0, 3.0);
+    vtkDoubleArray::SafeDownCast(frame->GetPointData()->GetArray("Distance"))->SetValue(10, 4.0);
+    return frame;
+}
+
+
+bool check(bool condition, const char* message)
+{
+    if (!condition)
+    {
+        std::cerr << "Frame pool test failed: " << message << "\n";
+    }
+    return condition;
+}
+
+
+int main()
+{
+    LidarFramePool pool;
+    pool.SetMaximumNumberOfFrames(2);
+    bool res = true;
+
+    // A released frame gives its buffers to the next one, cleared
+    auto frame = new_frame(pool);
+    vtkPoints* points = frame->GetPoints();
+    vtkDataArray* distance = frame->GetPointData()->GetArray("Distance");
+    frame = nullptr;
+    frame = new_frame(pool);
+    res = res && check(frame->GetPoints() == points, "points of a released frame not recycled");
+    res = res && check(frame->GetPointData()->GetArray("Distance") == distance, "array of a released frame not recycled");
+    res = res && check(pool.GetNumberOfRecycledFrames() == 1, "wrong number of recycled frames");
+    vtkSmartPointer<vtkPolyData> held = frame;
+    frame = nullptr;
+
+    // Frames still referenced, or sharing their arrays, are never recycled
+    vtkSmartPointer<vtkDataArray> shared = held->GetPointData()->GetArray("Intensity");
+    held = nullptr;
+    frame = pool.NewFrame(numberOfPoints);
+    res = res && check(frame->GetPoints() != points, "frame whose array is shared recycled");
+    auto next = pool.NewFrame(numberOfPoints);
+    res = res && check(next->GetPoints() != points && next->GetPoints() != frame->GetPoints(),
+      "frame in use recycled");
+    res = res && check(pool.GetNumberOfFrames() == 2 && pool.GetNumberOfUnpooledFrames() == 1,
+      "wrong pool occupancy");
+
+    // Once the shared array is released the frame can be reused, with its arrays cleared
+    shared = nullptr;
+    frame = nullptr;
+    next = nullptr;
+    frame = pool.NewFrame(numberOfPoints);
+    res = res && check(frame->GetPoints() == points, "released frame not recycled");
+    auto recycled = pool.AddArray<vtkDoubleArray>(frame, "Distance");
+    double point[3];
+    frame->GetPoints()->GetPoint(10, point);
+    res = res && check(recycled == distance && recycled->GetValue(10) == 0.0 && point[0] == 0.0,
+      "recycled frame not cleared");
+
+    // An array requested with another type is a new array
+    auto other = pool.AddArray<vtkUnsignedCharArray>(frame, "Distance");
+    res = res && check(other.GetPointer() != distance && other->GetNumberOfTuples() == numberOfPoints,
+      "array of the wrong type recycled");
+
+    if (!res)
+    {
+        return 1;
+    }
+    std::cout << "Frame pool test passed\n";
+    return 0;
+}
@@ -0,0 +1,261 @@
+#include <vtkCharArray.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkShortArray.h>
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+
+#include "IO/LZFCompression.h"
+#include "IO/vtkPCDWriter.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+const vtkIdType numberOfPoints = 5000;
+
+
+vtkSmartPointer<vtkPolyData> make_cloud()
+{
+    vtkNew<vtkPoints> points;
+    points->SetNumberOfPoints(numberOfPoints);
+    vtkNew<vtkUnsignedCharArray> intensity;
+    intensity->SetName("intensity");
+    intensity->SetNumberOfTuples(numberOfPoints);
+    vtkNew<vtkShortArray> ring;
+    ring->SetName("ring");
+    ring->SetNumberOfTuples(numberOfPoints);
+    vtkNew<vtkDoubleArray> timestamp;
+    timestamp->SetName("timestamp");
+    timestamp->SetNumberOfTuples(numberOfPoints);
+    vtkNew<vtkFloatArray> normal;
+    normal->SetName("normal");
+    normal->SetNumberOfComponents(3);
+    normal->SetNumberOfTuples(numberOfPoints);
+    // Not supported by the PCD format, so not written
+    vtkNew<vtkCharArray> label;
+    label->SetName("label");
+    label->SetNumberOfTuples(numberOfPoints);
+
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+        points->SetPoint(i, 0.01 * i, -0.5 * (i % 16), 100.0 / (i + 1));
+        intensity->SetValue(i, static_cast<unsigned char>(i * 7));
+        ring->SetValue(i, static_cast<short>(i % 16 - 8));
+        timestamp->SetValue(i, 1.5e9 + 1e-5 * i);
+        normal->SetTuple3(i, 0, (i % 2) ? 1 : -1, 0.25 * (i % 5));
+        label->SetValue(i, static_cast<char>('a' + i % 26));
+    }
+
+    vtkSmartPointer<vtkPolyData> cloud = vtkSmartPointer<vtkPolyData>::New();
+    cloud->SetPoints(points);
+    cloud->GetPointData()->AddArray(intensity);
+    cloud->GetPointData()->AddArray(ring);
+    cloud->GetPointData()->AddArray(timestamp);
+    cloud->GetPointData()->AddArray(normal);
+    cloud->GetPointData()->AddArray(label);
+    return cloud;
+}
+
+
+void read_header(std::ifstream& file, std::map<std::string, std::string>& header)
+{
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        const size_t space = line.find(' ');
+        header[line.substr(0, space)] = line.substr(space + 1);
+        if (line.compare(0, 5, "DATA ") == 0)
+        {
+            break;
+        }
+    }
+}
+
+
+// Read the header and the decompressed body of a binary_compressed PCD file
+bool read_pcd(const std::string& fileName, std::map<std::string, std::string>& header, std::vector<char>& body)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    read_header(file, header);
+    if (header["DATA"] != "binary_compressed")
+    {
+        std::cerr << "DATA " << header["DATA"] << " instead of binary_compressed\n";
+        return false;
+    }
+
+    uint32_t sizes[2];
+    if (!file.read(reinterpret_cast<char*>(sizes), sizeof(sizes)))
+    {
+        std::cerr << "No compressed data\n";
+        return false;
+    }
+    std::vector<char> compressed(sizes[0]);
+    if (!file.read(compressed.data(), compressed.size()) || file.peek() != std::ifstream::traits_type::eof())
+    {
+        std::cerr << "The compressed data does not have " << sizes[0] << " bytes\n";
+        return false;
+    }
+    body.resize(sizes[1]);
+    if (LZFDecompress(compressed.data(), compressed.size(), body.data(), body.size()) != sizes[1])
+    {
+        std::cerr << "Could not decompress the " << sizes[1] << " bytes of data\n";
+        return false;
+    }
+    return true;
+}
+
+
+// binary_compressed stores the fields one after the other
+template <typename T>
+bool check_field(const std::vector<char>& body, size_t& offset, int numberOfComponents,
+                 vtkDataArray* expected, const char* name)
+{
+    bool res = true;
+    for (vtkIdType i = 0; i < numberOfPoints && res; ++i)
+    {
+        for (int k = 0; k < numberOfComponents; ++k)
+        {
+            T value;
+            std::memcpy(&value, body.data() + offset + (i * numberOfComponents + k) * sizeof(T), sizeof(T));
+            if (value != static_cast<T>(expected->GetComponent(i, k)))
+            {
+                std::cerr << "Field " << name << ", point " << i << ": " << +value << " instead of "
+                          << +static_cast<T>(expected->GetComponent(i, k)) << "\n";
+                res = false;
+            }
+        }
+    }
+    offset += numberOfPoints * numberOfComponents * sizeof(T);
+    return res;
+}
+
+
+// The ascii lines must have the values of the fields of the header only
+bool check_ascii(const std::string& fileName, size_t numberOfValues)
+{
+    std::ifstream file(fileName);
+    std::map<std::string, std::string> header;
+    read_header(file, header);
+    if (header["DATA"] != "ascii")
+    {
+        std::cerr << "DATA " << header["DATA"] << " instead of ascii\n";
+        return false;
+    }
+
+    std::string line;
+    vtkIdType lines = 0;
+    while (std::getline(file, line))
+    {
+        std::istringstream values(line);
+        size_t count = 0;
+        for (std::string value; values >> value;)
+        {
+            count++;
+        }
+        if (count != numberOfValues)
+        {
+            std::cerr << "Ascii line " << lines << ": " << count << " values instead of " << numberOfValues << "\n";
+            return false;
+        }
+        lines++;
+    }
+    if (lines != numberOfPoints)
+    {
+        std::cerr << lines << " ascii lines instead of " << numberOfPoints << "\n";
+        return false;
+    }
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <temporary pcd file>\n";
+        return 1;
+    }
+
+    vtkSmartPointer<vtkPolyData> cloud = make_cloud();
+    vtkNew<vtkPCDWriter> writer;
+    writer->SetInputData(cloud);
+    writer->SetFileName(argv[1]);
+    writer->SetBinary(true);
+    writer->SetCompressed(true);
+    writer->Write();
+
+    std::map<std::string, std::string> header;
+    std::vector<char> body;
+    if (!read_pcd(argv[1], header, body))
+    {
+        return 1;
+    }
+
+    int errors = 0;
+    const std::map<std::string, std::string> expectedHeader = {
+        { "FIELDS", "x y z intensity ring timestamp normal" },
+        { "SIZE", "4 4 4 1 2 8 4" },
+        { "TYPE", "F F F U I F F" },
+        { "COUNT", "1 1 1 1 1 1 3" },
+        { "WIDTH", std::to_string(numberOfPoints) },
+        { "HEIGHT", "1" },
+        { "POINTS", std::to_string(numberOfPoints) },
+    };
+    for (const auto& entry : expectedHeader)
+    {
+        if (header[entry.first] != entry.second)
+        {
+            std::cerr << entry.first << " " << header[entry.first] << " instead of " << entry.second << "\n";
+            errors++;
+        }
+    }
+
+    const size_t pointSize = 3 * 4 + 1 + 2 + 8 + 3 * 4;
+    if (body.size() != pointSize * numberOfPoints)
+    {
+        std::cerr << body.size() << " bytes of data instead of " << pointSize * numberOfPoints << "\n";
+        return 1;
+    }
+
+    // The coordinates are written as float
+    vtkNew<vtkFloatArray> coordinates[3];
+    for (int c = 0; c < 3; ++c)
+    {
+        coordinates[c]->SetNumberOfTuples(numberOfPoints);
+        for (vtkIdType i = 0; i < numberOfPoints; ++i)
+        {
+            coordinates[c]->SetValue(i, static_cast<float>(cloud->GetPoint(i)[c]));
+        }
+    }
+
+    vtkPointData* pointData = cloud->GetPointData();
+    size_t offset = 0;
+    errors += !check_field<float>(body, offset, 1, coordinates[0], "x");
+    errors += !check_field<float>(body, offset, 1, coordinates[1], "y");
+    errors += !check_field<float>(body, offset, 1, coordinates[2], "z");
+    errors += !check_field<uint8_t>(body, offset, 1, pointData->GetArray("intensity"), "intensity");
+    errors += !check_field<int16_t>(body, offset, 1, pointData->GetArray("ring"), "ring");
+    errors += !check_field<double>(body, offset, 1, pointData->GetArray("timestamp"), "timestamp");
+    errors += !check_field<float>(body, offset, 3, pointData->GetArray("normal"), "normal");
+
+    writer->SetBinary(false);
+    writer->Write();
+    errors += !check_ascii(argv[1], 3 + 1 + 1 + 1 + 3);
+
+    return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+#ifndef TEST_PACKET_INTERPRETER_H
+#define TEST_PACKET_INTERPRETER_H
+
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include "IO/Lidar/Common/vtkLidarPacketInterpreter.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+
+
+/**
+ * Sensor specific information of TestPacketInterpreter: the period of the last
+ * preprocessed packet and a checksum of the payload of the packet starting the frame.
+ */
+struct TestFrameInformation : public SpecificFrameInformation
+{
+    int64_t LastPeriod = -1;
+    uint32_t Checksum = 0;
+
+    void reset() override { *this = TestFrameInformation(); }
+
+    std::unique_ptr<SpecificFrameInformation> clone() override
+    {
+        return std::unique_ptr<SpecificFrameInformation>(new TestFrameInformation(*this));
+    }
+
+    bool serialize(std::string& buffer) const override
+    {
+        buffer.append(reinterpret_cast<const char*>(&this->LastPeriod), sizeof(this->LastPeriod));
+        buffer.append(reinterpret_cast<const char*>(&this->Checksum), sizeof(this->Checksum));
+        return true;
+    }
+
+    bool deserialize(const char* data, size_t size) override
+    {
+        if (size != sizeof(this->LastPeriod) + sizeof(this->Checksum))
+        {
+            return false;
+        }
+        std::memcpy(&this->LastPeriod, data, sizeof(this->LastPeriod));
+        std::memcpy(&this->Checksum, data + sizeof(this->LastPeriod), sizeof(this->Checksum));
+        return true;
+    }
+};
+
+
+/**
+ * Interpreter of any UDP capture, for the reader tests that do not depend on a sensor:
+ * every packet is a lidar packet and a new frame starts every FramePeriod seconds of
+ * network time. The frames are empty, only the frame catalog is meaningful.
+ */
+class TestPacketInterpreter : public vtkLidarPacketInterpreter
+{
+public:
+    static TestPacketInterpreter* New() { VTK_STANDARD_NEW_BODY(TestPacketInterpreter); }
+    vtkTypeMacro(TestPacketInterpreter, vtkLidarPacketInterpreter)
+
+    double FramePeriod = 0.1;
+
+    // Number of calls to PreProcessPacket, 0 when the catalog comes from its index
+    int NumberOfPreProcessedPackets = 0;
+
+    void LoadCalibration(const std::string& vtkNotUsed(filename)) override { this->IsCalibrated = true; }
+
+    bool IsLidarPacket(unsigned char const* vtkNotUsed(data), unsigned int dataLength) override
+    {
+        return dataLength > 0;
+    }
+
+    bool PreProcessPacket(unsigned char const* data, unsigned int dataLength,
+                          fpos_t filePosition, double packetNetworkTime,
+                          std::vector<FrameInformation>* frameCatalog) override
+    {
+        this->NumberOfPreProcessedPackets++;
+        auto* info = static_cast<TestFrameInformation*>(this->ParserMetaData.SpecificInformation.get());
+        const int64_t period = static_cast<int64_t>(std::floor(packetNetworkTime / this->FramePeriod));
+        const bool isNewFrame = info->LastPeriod != -1 && period != info->LastPeriod;
+        info->LastPeriod = period;
+        if (!isNewFrame)
+        {
+            return false;
+        }
+
+        // FNV-1a, stands for the content a real sensor would read in the packet
+        uint32_t checksum = 2166136261u;
+        for (unsigned int i = 0; i < dataLength; ++i)
+        {
+            checksum = (checksum ^ data[i]) * 16777619u;
+        }
+        info->Checksum = checksum;
+        this->ParserMetaData.FilePosition = filePosition;
+        this->ParserMetaData.FirstPacketNetworkTime = packetNetworkTime;
+        this->ParserMetaData.FirstPacketDataTime = period * this->FramePeriod;
+        if (frameCatalog)
+        {
+            frameCatalog->push_back(this->ParserMetaData);
+        }
+        return true;
+    }
+
+    vtkSmartPointer<vtkLidarPacketInterpreter> CreateIndexingClone() override
+    {
+        vtkSmartPointer<TestPacketInterpreter> clone = vtkSmartPointer<TestPacketInterpreter>::New();
+        clone->FramePeriod = this->FramePeriod;
+        clone->SetFramingMethod(this->FramingMethod);
+        return clone;
+    }
+
+    void ProcessPacket(unsigned char const* vtkNotUsed(data), unsigned int vtkNotUsed(dataLength)) override {}
+
+    std::string GetSensorInformation(bool vtkNotUsed(shortVersion) = false) override { return "Test sensor"; }
+
+protected:
+    TestPacketInterpreter()
+    {
+        this->ParserMetaData.SpecificInformation = std::make_shared<TestFrameInformation>();
+    }
+
+    vtkSmartPointer<vtkPolyData> CreateNewEmptyFrame(vtkIdType vtkNotUsed(numberOfPoints),
+                                                     vtkIdType vtkNotUsed(prereservedNumberOfPoints)) override
+    {
+        vtkSmartPointer<vtkPolyData> frame = vtkSmartPointer<vtkPolyData>::New();
+        frame->SetPoints(vtkSmartPointer<vtkPoints>::New());
+        return frame;
+    }
+};
+
+
+// Compare two frames of the catalogs of a capture read with TestPacketInterpreter
+inline bool check_frame(const FrameInformation& expected, const FrameInformation& actual, size_t index)
+{
+    bool res = true;
+    // fpos_t is opaque, but both positions come from fgetpos on the same file
+    if (std::memcmp(&expected.FilePosition, &actual.FilePosition, sizeof(fpos_t)) != 0)
+    {
+        std::cerr << "Frame " << index << ": different file positions\n";
+        res = false;
+    }
+    if (expected.FirstPacketNetworkTime != actual.FirstPacketNetworkTime)
+    {
+        std::cerr << "Frame " << index << ": network time " << actual.FirstPacketNetworkTime
+                  << " instead of " << expected.FirstPacketNetworkTime << "\n";
+        res = false;
+    }
+    if (expected.FirstPacketDataTime != actual.FirstPacketDataTime)
+    {
+        std::cerr << "Frame " << index << ": data time " << actual.FirstPacketDataTime
+                  << " instead of " << expected.FirstPacketDataTime << "\n";
+        res = false;
+    }
+
+    // The sensor specific information is compared through its binary representation
+    std::string expectedInformation, actualInformation;
+    if (!expected.SpecificInformation || !actual.SpecificInformation ||
+        !expected.SpecificInformation->serialize(expectedInformation) ||
+        !actual.SpecificInformation->serialize(actualInformation) ||
+        expectedInformation != actualInformation)
+    {
+        std::cerr << "Frame " << index << ": different sensor specific information\n";
+        res = false;
+    }
+    return res;
+}
+
+#endif // TEST_PACKET_INTERPRETER_H
@@ -0,0 +1,136 @@
+#include "Common/ML/DBSCAN.h"
+#include "Common/ML/ParallelDBSCAN.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+
+// Squared distance threshold, as in DBSCAN<T>
+const double epsilon = 1.0;
+const double minPts = 3;
+
+
+std::vector<double> make_cloud()
+{
+    std::vector<double> points;
+    auto add = [&points](double x, double y, double z) {
+        points.push_back(x);
+        points.push_back(y);
+        points.push_back(z);
+    };
+
+    // Dense blobs, with some duplicated points
+    std::mt19937 generator(7);
+    std::normal_distribution<double> spread(0.0, 0.6);
+    const double centers[4][3] = { { 0, 0, 0 }, { 8, 0, 0 }, { 0, 8, 2 }, { -8, -8, -1 } };
+    for (const auto& center : centers)
+    {
+        for (int i = 0; i < 150; ++i)
+        {
+            add(center[0] + spread(generator), center[1] + spread(generator), center[2] + spread(generator));
+            if (i % 40 == 0)
+            {
+                add(points[points.size() - 3], points[points.size() - 2], points[points.size() - 1]);
+            }
+        }
+    }
+
+    // Sparse points all around, mostly noise, some on the border of the blobs
+    std::uniform_real_distribution<double> uniform(-15.0, 15.0);
+    for (int i = 0; i < 200; ++i)
+    {
+        add(uniform(generator), uniform(generator), uniform(generator));
+    }
+
+    // A chain whose inner points have exactly minPts neighbors (themselves included):
+    // DBSCAN<T> starts clusters from them but does not expand a cluster through them,
+    // so the chain is split in several clusters. Its ends are border points.
+    for (int i = 0; i < 9; ++i)
+    {
+        add(40.0 + 0.6 * i, 40.0, 40.0);
+    }
+
+    // Isolated points
+    add(-40, 40, 0);
+    add(40, -40, 0);
+    return points;
+}
+
+
+// Classify the points of the cloud by brute force, to check that the test covers all the cases
+void count_cases(const std::vector<double>& points, const std::vector<int>& labels,
+                 int& noise, int& border, int& coreWithMinPts)
+{
+    noise = border = coreWithMinPts = 0;
+    const size_t numberOfPoints = labels.size();
+    for (size_t i = 0; i < numberOfPoints; ++i)
+    {
+        unsigned int neighbors = 0;
+        for (size_t j = 0; j < numberOfPoints; ++j)
+        {
+            double squaredDistance = 0;
+            for (int k = 0; k < 3; ++k)
+            {
+                const double delta = points[3 * i + k] - points[3 * j + k];
+                squaredDistance += delta * delta;
+            }
+            neighbors += squaredDistance < epsilon;
+        }
+        noise += labels[i] == 0;
+        border += labels[i] != 0 && neighbors < minPts;
+        coreWithMinPts += labels[i] != 0 && neighbors == minPts;
+    }
+}
+
+
+int main()
+{
+    const std::vector<double> points = make_cloud();
+    const size_t numberOfPoints = points.size() / 3;
+
+    std::vector<std::vector<double>> pointsVector(numberOfPoints);
+    for (size_t i = 0; i < numberOfPoints; ++i)
+    {
+        pointsVector[i] = { points[3 * i], points[3 * i + 1], points[3 * i + 2] };
+    }
+    DBSCAN<double> reference(epsilon, minPts);
+    const std::vector<int> expected = reference.fit(pointsVector);
+
+    int noise, border, coreWithMinPts;
+    count_cases(points, expected, noise, border, coreWithMinPts);
+    std::cout << numberOfPoints << " points, " << reference.getNbCluster() << " clusters, "
+              << noise << " noise points, " << border << " border points, "
+              << coreWithMinPts << " core points with minPts neighbors" << std::endl;
+    if (noise == 0 || border == 0 || coreWithMinPts == 0)
+    {
+        std::cerr << "The cloud does not cover all the cases\n";
+        return 1;
+    }
+
+    int errors = 0;
+    for (auto search : { ParallelDBSCAN::NeighborSearch::KDTree, ParallelDBSCAN::NeighborSearch::VoxelGrid })
+    {
+        for (int numberOfThreads : { 1, 4 })
+        {
+            ParallelDBSCAN parallel(epsilon, minPts);
+            parallel.SetNeighborSearch(search);
+            parallel.SetNumberOfThreads(numberOfThreads);
+            const std::vector<int>& labels = parallel.Fit(points.data(), numberOfPoints);
+
+            int differences = 0;
+            for (size_t i = 0; i < numberOfPoints; ++i)
+            {
+                differences += labels[i] != expected[i];
+            }
+            if (differences != 0 || parallel.GetNbCluster() != reference.getNbCluster())
+            {
+                std::cerr << (search == ParallelDBSCAN::NeighborSearch::VoxelGrid ? "Voxel grid" : "KD-tree")
+                          << ", " << numberOfThreads << " threads: " << differences << " different labels, "
+                          << parallel.GetNbCluster() << " clusters instead of " << reference.getNbCluster() << "\n";
+                errors++;
+            }
+        }
+    }
+    return errors == 0 ? 0 : 1;
+}
@@ -14,6 +14,46 @@
 #include <Eigen/Dense>
 
 
+int check_ransac(vtkPolyData* polydata, bool fast_ransac, int N, int N_OUTLIERS)
+{
+    // apply filter ransac plane model
+    auto filter = vtkSmartPointer<vtkRansacPlaneModel>::New();
+    filter->SetAlignOutput(1);
+    filter->SetFastRansac(fast_ransac);
+    filter->SetInputData(polydata);
+    filter->Update();
+    auto output = filter->GetOutput();
+
+    // check that the points are correctly aligned to XY
+    double temp_d[3];
+    double max_z_threshold = 1.0;       // threshold on z for points with small noise
+    for (int i = 0; i < N - N_OUTLIERS; ++i)
+    {
+        output->GetPoint(i, temp_d);
+        if (std::abs(temp_d[2]) > max_z_threshold)
+        {
+            std::cout << "Error: point " << i << " has z = " << temp_d[2] << std::endl;
+            return -1;
+        }
+
+    }
+
+    // check that outliers are detected as outliers
+    vtkSmartPointer<vtkUnsignedIntArray> inliers_array = 
+    vtkUnsignedIntArray::SafeDownCast(output->GetPointData()->GetArray("ransac_plane_inliers"));
+    for (int i =  N - N_OUTLIERS; i < N; ++i)
+    {
+        if (inliers_array->GetValue(i) == 1)
+        {
+            std::cout << "Error: Point " << i << " should be classified as outliers" << std::endl;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
 int main(int argc, char* argv[])
 {
     static_cast<void>(argc);
@@ -72,38 +112,10 @@ int main(int argc, char* argv[])
     new_points->SetData(array);
     polydata->SetPoints(new_points);
 
-    // apply filter ransac plane model
-    auto filter = vtkSmartPointer<vtkRansacPlaneModel>::New();
-    filter->SetAlignOutput(1);
-    filter->SetInputData(polydata);
-    filter->Update();
-    auto output = filter->GetOutput();
-
-    // check that the points are correctly aligned to XY
-    double temp_d[3];
-    double max_z_threshold = 1.0;       // threshold on z for points with small noise
-    for (int i = 0; i < N - N_OUTLIERS; ++i)
+    // check both ransac engines
+    if (check_ransac(polydata, false, N, N_OUTLIERS) != 0)
     {
-        output->GetPoint(i, temp_d);
-        if (std::abs(temp_d[2]) > max_z_threshold)
-        {
-            std::cout << "Error: point " << i << " has z = " << temp_d[2] << std::endl;
-            return -1;
-        }
-
+        return -1;
     }
-
-    // check that outliers are detected as outliers
-    vtkSmartPointer<vtkUnsignedIntArray> inliers_array = 
-    vtkUnsignedIntArray::SafeDownCast(output->GetPointData()->GetArray("ransac_plane_inliers"));
-    for (int i =  N - N_OUTLIERS; i < N; ++i)
-    {
-        if (inliers_array->GetValue(i) == 1)
-        {
-            std::cout << "Error: Point " << i << " should be classified as outliers" << std::endl;
-            return -1;
-        }
-    }
-
-    return 0;
+    return check_ransac(polydata, true, N, N_OUTLIERS);
 }
@@ -0,0 +1,139 @@
+#include <vtkDoubleArray.h>
+#include <vtkMath.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
+
+#include "Filter/MotionDetector/vtkSphericalMap.h"
+
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <limits>
+
+
+// Density at the mean of a gaussian created from a single depth
+const double initialDensity = 1.0 / (0.2 * std::sqrt(2 * vtkMath::Pi()));
+
+// Densities under this value mean that the depth matches no gaussian
+const double noMatch = 0.00135;
+
+const double invalid = std::numeric_limits<double>::quiet_NaN();
+
+
+struct Point
+{
+    float x, y, z;
+};
+
+
+vtkSmartPointer<vtkPolyData> make_frame(std::initializer_list<Point> points)
+{
+    vtkSmartPointer<vtkPoints> framePoints = vtkSmartPointer<vtkPoints>::New();
+    for (const Point& point : points)
+    {
+        framePoints->InsertNextPoint(point.x, point.y, point.z);
+    }
+    vtkSmartPointer<vtkPolyData> frame = vtkSmartPointer<vtkPolyData>::New();
+    frame->SetPoints(framePoints);
+    return frame;
+}
+
+
+// Check the motion of the points of a frame: invalid stands for NaN,
+// noMatch for any density under noMatch, and the other values are exact
+bool check_motion(vtkPolyData* frame, std::initializer_list<double> expected, const char* name)
+{
+    vtkDoubleArray* motion = vtkDoubleArray::SafeDownCast(frame->GetPointData()->GetArray("Motion_Probability"));
+    if (!motion || motion->GetNumberOfTuples() != static_cast<vtkIdType>(expected.size()))
+    {
+        std::cerr << name << ": no motion probability for each point\n";
+        return false;
+    }
+
+    bool res = true;
+    vtkIdType i = 0;
+    for (double value : expected)
+    {
+        const double actual = motion->GetValue(i);
+        const bool ok = std::isnan(value) ? std::isnan(actual)
+                      : value == noMatch  ? actual >= 0 && actual < noMatch
+                                          : std::abs(actual - value) < 1e-9;
+        if (!ok)
+        {
+            std::cerr << name << ", point " << i << ": motion probability " << actual << " instead of " << value << "\n";
+            res = false;
+        }
+        ++i;
+    }
+    return res;
+}
+
+
+bool check_count(vtkSphericalMap& map, unsigned int expected, const char* name)
+{
+    if (map.GetNumberOfPoints() != expected)
+    {
+        std::cerr << name << ": " << map.GetNumberOfPoints() << " gaussians instead of " << expected << "\n";
+        return false;
+    }
+    return true;
+}
+
+
+int main()
+{
+    vtkSphericalMap map;
+    map.SetNTheta(36);
+    map.SetNPhi(18);
+    map.SetMaximumNumberOfGaussians(2);
+    map.SetNumberOfThreads(2);
+
+    int errors = 0;
+
+    // A static point, a NaN point, a point at theta = pi, and
+    // three depths in the same pixel, one more than its gaussians
+    vtkSmartPointer<vtkPolyData> frame1 = make_frame({ { 1, 0, 0 }, { NAN, NAN, NAN }, { -2, 0.f, 0 },
+                                                       { 0, 5, 0 }, { 0, 10, 0 }, { 0, 15, 0 } });
+    map.AddFrame(frame1);
+    errors += !check_motion(frame1, { 0, invalid, 0, 0, noMatch, noMatch }, "Frame 1");
+    errors += !check_count(map, 4, "Frame 1");
+
+    vtkDoubleArray* theta = vtkDoubleArray::SafeDownCast(frame1->GetPointData()->GetArray("Theta"));
+    if (!theta || theta->GetValue(2) != 180.0)
+    {
+        std::cerr << "Frame 1: the point at theta = pi does not have a theta of 180 degrees\n";
+        errors++;
+    }
+
+    // The point just above theta = -pi is in the pixel of the point at theta = pi.
+    // The depth 5 was replaced by the depth 15, the oldest being the first
+    // created, and now replaces the depth 15 since the depth 10 was updated
+    vtkSmartPointer<vtkPolyData> frame2 = make_frame({ { 1, 0, 0 }, { NAN, NAN, NAN }, { -2, -1e-6f, 0 },
+                                                       { 0, 10, 0 }, { 0, 5, 0 } });
+    map.AddFrame(frame2);
+    errors += !check_motion(frame2, { initialDensity, invalid, initialDensity, initialDensity, noMatch }, "Frame 2");
+    errors += !check_count(map, 4, "Frame 2");
+
+    // The depth 5 is still in its pixel, while the depth 15 replaces
+    // the depth 10, now the gaussian updated the least recently
+    vtkSmartPointer<vtkPolyData> frame3 = make_frame({ { 0, 5, 0 }, { 0, 15, 0 } });
+    map.AddFrame(frame3);
+    errors += !check_motion(frame3, { initialDensity, noMatch }, "Frame 3");
+    errors += !check_count(map, 4, "Frame 3");
+
+    // A gaussian lives 25 frames after its last update: the gaussians
+    // of the frame 3 outlive those updated in the frame 2
+    for (int i = 0; i < 23; ++i)
+    {
+        map.UpdateTTL();
+    }
+    errors += !check_count(map, 4, "25 frames after the frame 2");
+    map.UpdateTTL();
+    errors += !check_count(map, 2, "26 frames after the frame 2");
+    map.UpdateTTL();
+    errors += !check_count(map, 0, "26 frames after the frame 3");
+
+    return errors == 0 ? 0 : 1;
+}
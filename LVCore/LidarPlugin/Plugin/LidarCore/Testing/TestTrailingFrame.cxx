@@ -91,6 +91,60 @@ bool check_trailing_frames(vtkTrailingFrame* tf, vtkInformation* info, double *t
 }
 
 
+bool check_incremental_frames(vtkTrailingFrame* tf, vtkInformation* info, double *time_steps,
+                               int time_index, std::vector<int> const& expected_indices)
+{
+    // in incremental mode, the trailing frames are the last frames the filter received
+    info->Set(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP(), time_steps[time_index]);
+    tf->Update();
+    auto tf_out = vtkMultiBlockDataSet::SafeDownCast(tf->GetOutputDataObject(0));
+    std::vector<double> sub_time_steps(tf->GetNumberOfTrailingFrames() + 1, -1.0);
+    for (size_t i = 0; i < expected_indices.size(); ++i)
+    {
+        sub_time_steps[i] = time_steps[expected_indices[i]];
+    }
+    return check_multi_block_frames(tf_out, sub_time_steps);
+}
+
+
+bool check_merged_frames(vtkTrailingFrame* tf, vtkInformation* info, double *time_steps,
+                         int time_index, std::vector<int> const& expected_indices)
+{
+    // the merged polydata contains the points of the frames, the newest first
+    info->Set(vtkStreamingDemandDrivenPipeline::UPDATE_TIME_STEP(), time_steps[time_index]);
+    tf->Update();
+    auto tf_out = vtkMultiBlockDataSet::SafeDownCast(tf->GetOutputDataObject(0));
+    vtkPolyData* merged = tf_out->GetNumberOfBlocks() == 1 ? vtkPolyData::SafeDownCast(tf_out->GetBlock(0)) : nullptr;
+    if (!merged)
+    {
+        std::cerr << "Trailing frame test failed: \n";
+        std::cerr << "Expected a single merged frame\n";
+        return false;
+    }
+    auto array = vtkDoubleArray::SafeDownCast(merged->GetPointData()->GetArray("Point Value"));
+    vtkIdType nb_points_per_frame = merged->GetNumberOfPoints() / static_cast<vtkIdType>(expected_indices.size());
+    if (!array || merged->GetNumberOfVerts() != merged->GetNumberOfPoints() ||
+        nb_points_per_frame * static_cast<vtkIdType>(expected_indices.size()) != merged->GetNumberOfPoints())
+    {
+        std::cerr << "Trailing frame test failed: \n";
+        std::cerr << "Invalid merged frame with " << merged->GetNumberOfPoints() << " points\n";
+        return false;
+    }
+    for (size_t i = 0; i < expected_indices.size(); ++i)
+    {
+        double merged_value = array->GetValue(i * nb_points_per_frame);
+        double expected_value = value_fonction(time_steps[expected_indices[i]]);
+        if (std::abs(merged_value - expected_value) > epsilon)
+        {
+            std::cerr << "Trailing frame test failed: \n";
+            std::cerr << "Expected merged value " << expected_value << " found " << merged_value << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
 int main(int argc, char* argv[])
 {
     static_cast<void>(argc);
@@ -145,5 +199,30 @@ int main(int argc, char* argv[])
     // go to 7 and check
     res = res && check_trailing_frames(tf, outInfo, time_steps, 7);
 
+    // incremental mode: play the frames one after the other
+    tf->SetIncremental(true);
+    tf->SetNumberOfTrailingFrames(N1);
+    tf->UpdateInformation();
+    outInfo = tf->GetOutputInformation(0);
+    time_steps = outInfo->Get(vtkStreamingDemandDrivenPipeline::TIME_STEPS());
+
+    res = res && check_incremental_frames(tf, outInfo, time_steps, 0, {0});
+    res = res && check_incremental_frames(tf, outInfo, time_steps, 1, {1, 0});
+    res = res && check_incremental_frames(tf, outInfo, time_steps, 2, {2, 1, 0});
+    res = res && check_incremental_frames(tf, outInfo, time_steps, 3, {3, 2, 1});
+    // same timestep again, the newest frame is replaced
+    res = res && check_incremental_frames(tf, outInfo, time_steps, 3, {3, 2, 1});
+    // jumping backward restarts the trail
+    res = res && check_incremental_frames(tf, outInfo, time_steps, 1, {1});
+    res = res && check_incremental_frames(tf, outInfo, time_steps, 2, {2, 1});
+    // growing the ring keeps the frames
+    tf->SetNumberOfTrailingFrames(N2);
+    res = res && check_incremental_frames(tf, outInfo, time_steps, 3, {3, 2, 1});
+    // merge the frames in a single polydata
+    tf->SetMergeFrames(true);
+    res = res && check_merged_frames(tf, outInfo, time_steps, 4, {4, 3, 2, 1});
+    res = res && check_merged_frames(tf, outInfo, time_steps, 5, {5, 4, 3, 2, 1});
+    res = res && check_merged_frames(tf, outInfo, time_steps, 6, {6, 5, 4, 3, 2});
+
     return res ? 0 : -1;
 }
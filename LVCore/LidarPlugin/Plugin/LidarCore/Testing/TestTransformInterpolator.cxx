@@ -0,0 +1,146 @@
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+#include <vtkTransform.h>
+
+#include "Common/vtkCustomTransformInterpolator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+
+const double epsilon = 1e-9;
+
+
+vtkSmartPointer<vtkTransform> pose(double t)
+{
+    // pose of a sensor moving along x while turning around z, known at integer times
+    auto transform = vtkSmartPointer<vtkTransform>::New();
+    transform->Translate(2.0 * t, 0.5 * t, 0.0);
+    transform->RotateZ(10.0 * t);
+    return transform;
+}
+
+
+bool check_matrix(vtkMatrix4x4* matrix, const double* expected, double t)
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        if (std::abs(matrix->GetElement(i / 4, i % 4) - expected[i]) > epsilon)
+        {
+            std::cerr << "Transform interpolator test failed at t = " << t << ": \n";
+            std::cerr << "element " << i << " is " << matrix->GetElement(i / 4, i % 4)
+                      << " instead of " << expected[i] << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool check_interpolation(vtkCustomTransformInterpolator* interpolator,
+                         std::vector<double> const& times,
+                         double (*expected_time)(double))
+{
+    // the interpolated transforms must be the transforms at expected_time(t),
+    // both with InterpolateTransform and InterpolateMany
+    std::vector<double> matrices(16 * times.size());
+    interpolator->InterpolateMany(times.size(), times.data(), matrices.data());
+
+    auto transform = vtkSmartPointer<vtkTransform>::New();
+    for (size_t k = 0; k < times.size(); ++k)
+    {
+        double expected[16];
+        vtkMatrix4x4::DeepCopy(expected, pose(expected_time(times[k]))->GetMatrix());
+
+        interpolator->InterpolateTransform(times[k], transform);
+        if (!check_matrix(transform->GetMatrix(), expected, times[k]))
+        {
+            return false;
+        }
+
+        auto batched = vtkSmartPointer<vtkMatrix4x4>::New();
+        batched->DeepCopy(&matrices[16 * k]);
+        if (!check_matrix(batched, expected, times[k]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+double linear_time(double t)
+{
+    // constant speeds: the linear interpolation is exact in the range [0, 9]
+    return std::max(0.0, std::min(9.0, t));
+}
+
+
+double nearest_time(double t)
+{
+    // the closest pose, the previous one in case of tie
+    return std::ceil(linear_time(t) - 0.5);
+}
+
+
+double nearest_low_bounded_time(double t)
+{
+    // the previous pose, strictly before t unless t is the first time
+    t = linear_time(t);
+    return std::max(0.0, std::ceil(t) - 1.0);
+}
+
+
+int main(int argc, char* argv[])
+{
+    static_cast<void>(argc);
+    static_cast<void>(argv);
+
+    // Add the poses out of order, with a duplicate, to check the sorted storage
+    auto interpolator = vtkSmartPointer<vtkCustomTransformInterpolator>::New();
+    for (int t : {0, 1, 2, 3, 4, 9, 5, 6, 8, 7, 3})
+    {
+        interpolator->AddTransform(t, pose(t));
+    }
+    if (interpolator->GetNumberOfTransforms() != 10
+        || interpolator->GetMinimumT() != 0.0 || interpolator->GetMaximumT() != 9.0)
+    {
+        std::cerr << "Transform interpolator test failed: wrong stored transforms\n";
+        return 1;
+    }
+
+    // Increasing times use the cursor, random ones the search
+    std::vector<double> increasing, shuffled = {7.25, 0.5, 8.75, 3.0, -2.0, 12.0, 4.4, 1.6, 9.0, 0.0};
+    for (int k = -10; k <= 100; ++k)
+    {
+        increasing.push_back(0.1 * k);
+    }
+
+    bool res = true;
+    interpolator->SetInterpolationTypeToLinear();
+    res = res && check_interpolation(interpolator, increasing, linear_time);
+    res = res && check_interpolation(interpolator, shuffled, linear_time);
+
+    interpolator->SetInterpolationTypeToNearest();
+    res = res && check_interpolation(interpolator, increasing, nearest_time);
+    res = res && check_interpolation(interpolator, shuffled, nearest_time);
+
+    interpolator->SetInterpolationTypeToNearestLowBounded();
+    res = res && check_interpolation(interpolator, increasing, nearest_low_bounded_time);
+    res = res && check_interpolation(interpolator, shuffled, nearest_low_bounded_time);
+
+    // The spline goes through the poses
+    interpolator->SetInterpolationTypeToSpline();
+    std::vector<double> samples = {0.0, 1.0, 4.0, 8.0, 9.0};
+    res = res && check_interpolation(interpolator, samples, linear_time);
+
+    // Removing a pose makes the interpolation skip it
+    interpolator->SetInterpolationTypeToLinear();
+    interpolator->RemoveTransform(9.0);
+    res = res && check_interpolation(interpolator, {8.5, 10.0}, [](double) { return 8.0; });
+
+    return res ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#ifndef AsensingFrameSchema_h
+#define AsensingFrameSchema_h
+
+#include "LidarFramePool.h"
+
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkShortArray.h>
+#include <vtkUnsignedShortArray.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+/**
+ * @brief Layout of the arrays of the frames built by the Asensing interpreters.
+ *
+ * The sensors give integers in hundredths of degree and of meter, and the points are
+ * computed in single precision, so the double arrays of the Full schema store nothing
+ * more than the float ones of the Compact schema. The Quantized schema stores the
+ * angles and the distance as 16 bits integers, in hundredths of degree ("_cdeg" arrays)
+ * and centimeters ("_cm" arrays). The timestamps are always double, as they are seconds
+ * since epoch.
+ */
+enum class AsensingFrameSchema
+{
+  Full = 0,      //!< double attributes, as the other interpreters
+  Compact = 1,   //!< float attributes
+  Quantized = 2  //!< 16 bits integer angles and distance, float coordinates
+};
+
+//! @brief What an attribute holds, which gives its type in each schema
+enum class AsensingAttributeKind
+{
+  Coordinate, //!< meters, never quantized
+  Angle,      //!< degrees
+  Distance    //!< meters
+};
+
+//! Quantum of the Quantized schema, hundredths of degree and of meter
+static constexpr double AsensingQuantizationScale = 100.0;
+
+/**
+ * @brief Raw pointer to an attribute array of the current frame, converting the values
+ * to the type of the array. Quantized values are rounded and clamped, NaN is stored as 0.
+ */
+struct AsensingAttribute
+{
+  enum class Type : uint8_t
+  {
+    None,
+    Double,
+    Float,
+    Short,
+    UnsignedShort
+  };
+
+  void* Data = nullptr;
+  Type ValueType = Type::None;
+
+  void Set(uint32_t pos, double value) const
+  {
+    switch (this->ValueType)
+    {
+      case Type::Double:
+        static_cast<double*>(this->Data)[pos] = value;
+        break;
+      case Type::Float:
+        static_cast<float*>(this->Data)[pos] = static_cast<float>(value);
+        break;
+      case Type::Short:
+        static_cast<int16_t*>(this->Data)[pos] = Quantize<int16_t>(value);
+        break;
+      case Type::UnsignedShort:
+        static_cast<uint16_t*>(this->Data)[pos] = Quantize<uint16_t>(value);
+        break;
+      case Type::None:
+        break;
+    }
+  }
+
+  template <typename T>
+  static T Quantize(double value)
+  {
+    if (std::isnan(value))
+    {
+      return 0;
+    }
+    const double quantized = std::round(value * AsensingQuantizationScale);
+    if (quantized <= std::numeric_limits<T>::min())
+    {
+      return std::numeric_limits<T>::min();
+    }
+    if (quantized >= std::numeric_limits<T>::max())
+    {
+      return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(quantized);
+  }
+};
+
+/**
+ * @brief AddAttributeArray add the array of an attribute to the frame started by the
+ * last pool.NewFrame, typed and named after the schema, and point attribute to it.
+ */
+inline vtkSmartPointer<vtkDataArray> AddAttributeArray(LidarFramePool& pool, vtkPolyData* frame,
+  AsensingFrameSchema schema, AsensingAttributeKind kind, const char* name, AsensingAttribute& attribute)
+{
+  vtkSmartPointer<vtkDataArray> array;
+  if (schema == AsensingFrameSchema::Full)
+  {
+    array = pool.AddArray<vtkDoubleArray>(frame, name);
+    attribute.ValueType = AsensingAttribute::Type::Double;
+  }
+  else if (schema == AsensingFrameSchema::Compact || kind == AsensingAttributeKind::Coordinate)
+  {
+    array = pool.AddArray<vtkFloatArray>(frame, name);
+    attribute.ValueType = AsensingAttribute::Type::Float;
+  }
+  else if (kind == AsensingAttributeKind::Angle)
+  {
+    array = pool.AddArray<vtkShortArray>(frame, (std::string(name) + "_cdeg").c_str());
+    attribute.ValueType = AsensingAttribute::Type::Short;
+  }
+  else
+  {
+    array = pool.AddArray<vtkUnsignedShortArray>(frame, (std::string(name) + "_cm").c_str());
+    attribute.ValueType = AsensingAttribute::Type::UnsignedShort;
+  }
+  attribute.Data = array->GetVoidPointer(0);
+  return array;
+}
+
+/**
+ * @brief FillCoordinateArray copy a coordinate of the points to its array, once the frame
+ * is complete, instead of writing it along with each point. Only float and double arrays.
+ */
+inline void FillCoordinateArray(vtkPoints* points, int component, vtkDataArray* array)
+{
+  if (!points || !array || points->GetDataType() != VTK_FLOAT)
+  {
+    return;
+  }
+  const float* coordinates = static_cast<const float*>(points->GetVoidPointer(0)) + component;
+  const vtkIdType numberOfPoints = std::min(points->GetNumberOfPoints(), array->GetNumberOfTuples());
+  if (array->GetDataType() == VTK_DOUBLE)
+  {
+    double* values = static_cast<double*>(array->GetVoidPointer(0));
+    for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      values[pointId] = coordinates[3 * pointId];
+    }
+  }
+  else if (array->GetDataType() == VTK_FLOAT)
+  {
+    float* values = static_cast<float*>(array->GetVoidPointer(0));
+    for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      values[pointId] = coordinates[3 * pointId];
+    }
+  }
+  array->Modified();
+}
+
+#endif // AsensingFrameSchema_h
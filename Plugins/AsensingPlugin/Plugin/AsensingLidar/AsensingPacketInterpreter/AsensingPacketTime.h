@@ -0,0 +1,133 @@
+#ifndef AsensingPacketTime_h
+#define AsensingPacketTime_h
+
+#include <cstdint>
+#include <ctime>
+
+// Set by the ASENSING_PACKET_PROFILING CMake option, measures the time spent in ProcessPacket
+#ifndef ASENSING_PACKET_PROFILING
+#define ASENSING_PACKET_PROFILING 0
+#endif
+
+#if ASENSING_PACKET_PROFILING
+#include <chrono>
+#include <iostream>
+#endif
+
+/**
+ * @brief Convert the UTC fields of the packet headers to seconds since epoch.
+ *
+ * mktime takes the timezone lock and reads the TZ state at each call, although
+ * consecutive packets share the same date and time down to the second. The result
+ * is computed once per minute, the seconds are then added to it. Gives exactly the
+ * same values as calling mktime on each packet.
+ * Not thread safe, each interpreter owns its cache.
+ */
+class AsensingHeaderTimeCache
+{
+public:
+  /**
+   * @brief Get the seconds since epoch of the header fields, as mktime with tm_isdst = 0
+   * @param year years since 1900
+   * @param month 1 to 12
+   */
+  time_t Get(uint8_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+  {
+    const uint64_t key = (static_cast<uint64_t>(year) << 32) | (static_cast<uint64_t>(month) << 24) |
+      (static_cast<uint64_t>(day) << 16) | (static_cast<uint64_t>(hour) << 8) | minute;
+    if (key != this->Key)
+    {
+      struct tm t;
+      t.tm_year = year;
+      t.tm_mon = month - 1;
+      t.tm_mday = day;
+      t.tm_hour = hour;
+      t.tm_min = minute;
+      t.tm_sec = 0;
+      t.tm_isdst = 0;
+      const time_t minuteStart = mktime(&t);
+      if (minuteStart == static_cast<time_t>(-1))
+      {
+        // Invalid header, keep the former behavior and do not cache it
+        this->Key = InvalidKey;
+        t.tm_year = year;
+        t.tm_mon = month - 1;
+        t.tm_mday = day;
+        t.tm_hour = hour;
+        t.tm_min = minute;
+        t.tm_sec = second;
+        t.tm_isdst = 0;
+        return mktime(&t);
+      }
+      this->Key = key;
+      this->MinuteStart = minuteStart;
+    }
+    return this->MinuteStart + second;
+  }
+
+private:
+  static constexpr uint64_t InvalidKey = ~static_cast<uint64_t>(0);
+
+  uint64_t Key = InvalidKey;   /*!< packed date, hour and minute of MinuteStart */
+  time_t MinuteStart = 0;
+};
+
+#if ASENSING_PACKET_PROFILING
+/**
+ * @brief Accumulate the duration of the processed packets and print
+ * the average and maximum every ReportInterval packets.
+ */
+class AsensingPacketProfiler
+{
+public:
+  static constexpr int ReportInterval = 10000;
+
+  explicit AsensingPacketProfiler(const char* name)
+    : Name(name)
+  {
+  }
+
+  //! Measure the duration of the enclosing scope
+  class Scope
+  {
+  public:
+    explicit Scope(AsensingPacketProfiler& profiler)
+      : Profiler(profiler)
+      , Start(std::chrono::steady_clock::now())
+    {
+    }
+    ~Scope() { this->Profiler.Add(std::chrono::steady_clock::now() - this->Start); }
+
+  private:
+    AsensingPacketProfiler& Profiler;
+    const std::chrono::steady_clock::time_point Start;
+  };
+
+  void Add(std::chrono::steady_clock::duration elapsed)
+  {
+    const double microseconds = std::chrono::duration<double, std::micro>(elapsed).count();
+    this->Total += microseconds;
+    this->Max = microseconds > this->Max ? microseconds : this->Max;
+    if (++this->Count == ReportInterval)
+    {
+      std::cout << this->Name << " ProcessPacket: " << this->Total / this->Count << " us average, "
+                << this->Max << " us max over " << this->Count << " packets" << std::endl;
+      this->Count = 0;
+      this->Total = 0;
+      this->Max = 0;
+    }
+  }
+
+private:
+  const char* Name;
+  int Count = 0;
+  double Total = 0;
+  double Max = 0;
+};
+
+#define ASENSING_PROFILE_PACKET(profiler) AsensingPacketProfiler::Scope packetProfilerScope(profiler)
+#else
+#define ASENSING_PROFILE_PACKET(profiler)
+#endif
+
+#endif // AsensingPacketTime_h
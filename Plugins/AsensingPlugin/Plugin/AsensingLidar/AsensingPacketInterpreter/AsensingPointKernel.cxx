@@ -0,0 +1,209 @@
+#include "AsensingPointKernelImpl.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace
+{
+//-----------------------------------------------------------------------------
+// One unit at a time, used on CPUs without SIMD support and for the tail of the batches
+struct ScalarOps
+{
+  using F = float;
+  using I = int32_t;
+  using M = bool;
+  using MI = int32_t;
+  static constexpr int Width = 1;
+
+  static F Load(const float* p) { return *p; }
+  static I Loadi(const int32_t* p) { return *p; }
+  static F LoadDistance(const uint16_t* p) { return static_cast<float>(*p); }
+  static void Store(float* p, F v) { *p = v; }
+  static F Set1(float v) { return v; }
+  static I Set1i(int32_t v) { return v; }
+  static F Add(F a, F b) { return a + b; }
+  static F Sub(F a, F b) { return a - b; }
+  static F Mul(F a, F b) { return a * b; }
+  static M CmpGt(F a, F b) { return a > b; }
+  static M CmpGe(F a, F b) { return a >= b; }
+  static F Select(M mask, F a, F b) { return mask ? a : b; }
+  static MI ToIntMask(M mask) { return mask ? -1 : 0; }
+  static I Addi(I a, I b) { return a + b; }
+  static I Subi(I a, I b) { return a - b; }
+  static I Andi(I a, I b) { return a & b; }
+  static MI CmpGti(I a, I b) { return a > b ? -1 : 0; }
+  static I Srli1(I a) { return a >> 1; }
+  static I Truncate(F a) { return static_cast<int32_t>(a); }
+  static F Gather(const float* table, I index) { return table[index]; }
+  static I Gatheri(const int32_t* table, I index) { return table[index]; }
+};
+
+//-----------------------------------------------------------------------------
+double DegreeToRadian(double degree)
+{
+  return degree * 3.14159265358979323846 / 180.0;
+}
+
+//-----------------------------------------------------------------------------
+bool CpuSupports(AsensingPointKernel::InstructionSet instructions)
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  switch (instructions)
+  {
+    case AsensingPointKernel::InstructionSet::AVX2:
+      return __builtin_cpu_supports("avx2");
+    case AsensingPointKernel::InstructionSet::SSE41:
+      return __builtin_cpu_supports("sse4.1");
+    default:
+      return true;
+  }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int info[4];
+  __cpuid(info, 1);
+  const bool sse41 = (info[2] & (1 << 19)) != 0;
+  // AVX2 also requires the OS to save the ymm registers
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  bool avx2 = false;
+  if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+  {
+    __cpuidex(info, 7, 0);
+    avx2 = (info[1] & (1 << 5)) != 0;
+  }
+  switch (instructions)
+  {
+    case AsensingPointKernel::InstructionSet::AVX2:
+      return avx2;
+    case AsensingPointKernel::InstructionSet::SSE41:
+      return sse41;
+    default:
+      return true;
+  }
+#else
+  return instructions == AsensingPointKernel::InstructionSet::Scalar;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// The SIMD translation units only contain code when they were compiled with the
+// matching instruction set. Never call their entry points to find out, they may
+// start with instructions the CPU does not have.
+bool BuildSupports(AsensingPointKernel::InstructionSet instructions)
+{
+  switch (instructions)
+  {
+    case AsensingPointKernel::InstructionSet::AVX2:
+      return AsensingHasAVX2Units();
+    case AsensingPointKernel::InstructionSet::SSE41:
+      return AsensingHasSSE41Units();
+    default:
+      return true;
+  }
+}
+}
+
+//-----------------------------------------------------------------------------
+AsensingPointKernel::AsensingPointKernel()
+{
+  this->Cos.resize(TableSize);
+  this->Sin.resize(TableSize);
+  for (int j = 0; j < TableSize; j++)
+  {
+    const double angle = DegreeToRadian(j / 100.0);
+    this->Cos[j] = static_cast<float>(std::cos(angle));
+    this->Sin[j] = static_cast<float>(std::sin(angle));
+  }
+  this->Instructions = AsensingPointKernel::GetSupportedInstructionSet();
+}
+
+//-----------------------------------------------------------------------------
+void AsensingPointKernel::SetMirrorAngles(const float* moduleAngles, int numberOfModules, float mirrorAngle)
+{
+  // Same single precision computation as the A0 interpreter
+  const float gamma0 = DegreeToRadian(mirrorAngle);
+  const float sinGamma0 = std::sin(gamma0);
+  const float cosGamma0 = std::cos(gamma0);
+  this->SinMirror = sinGamma0;
+  this->CosMirror = cosGamma0;
+
+  numberOfModules = std::min(numberOfModules, static_cast<int>(MaxModules));
+  for (int module = 0; module < numberOfModules; module++)
+  {
+    const float theta = DegreeToRadian(moduleAngles[module]);
+    const float cosTheta = std::cos(theta);
+    this->IncidentX[module] = cosTheta - 2.0 * cosTheta * cosGamma0 * cosGamma0;
+    this->IncidentY[module] = std::sin(theta);
+    this->IncidentZ[module] = 2.0 * cosTheta * sinGamma0 * cosGamma0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void AsensingPointKernel::Convert(Model model, const UnitBatch& units, float distanceUnit, PointBatch& points) const
+{
+  Tables tables;
+  tables.Cos = this->Cos.data();
+  tables.Sin = this->Sin.data();
+  tables.IncidentX = this->IncidentX;
+  tables.IncidentY = this->IncidentY;
+  tables.IncidentZ = this->IncidentZ;
+  tables.Tilt = model == Model::TiltedMirror ? this->Tilt : this->NoTilt;
+  tables.CosMirror = this->CosMirror;
+  tables.SinMirror = this->SinMirror;
+  tables.DistanceUnit = distanceUnit;
+
+  int converted = 0;
+  switch (this->Instructions)
+  {
+    case InstructionSet::AVX2:
+      converted = AsensingConvertUnitsAVX2(model, tables, units, points);
+      break;
+    case InstructionSet::SSE41:
+      converted = AsensingConvertUnitsSSE41(model, tables, units, points);
+      break;
+    default:
+      break;
+  }
+  ConvertUnits<ScalarOps>(model, tables, units, points, std::max(converted, 0));
+
+  std::copy(units.Intensity, units.Intensity + units.Size, points.Intensity);
+}
+
+//-----------------------------------------------------------------------------
+void AsensingPointKernel::SetInstructionSet(InstructionSet instructions)
+{
+  this->Instructions = std::min(instructions, AsensingPointKernel::GetSupportedInstructionSet());
+}
+
+//-----------------------------------------------------------------------------
+AsensingPointKernel::InstructionSet AsensingPointKernel::GetSupportedInstructionSet()
+{
+  static const InstructionSet supported = []() {
+    for (InstructionSet instructions : { InstructionSet::AVX2, InstructionSet::SSE41 })
+    {
+      if (CpuSupports(instructions) && BuildSupports(instructions))
+      {
+        return instructions;
+      }
+    }
+    return InstructionSet::Scalar;
+  }();
+  return supported;
+}
+
+//-----------------------------------------------------------------------------
+const char* AsensingPointKernel::GetInstructionSetName(InstructionSet instructions)
+{
+  switch (instructions)
+  {
+    case InstructionSet::AVX2:
+      return "AVX2";
+    case InstructionSet::SSE41:
+      return "SSE4.1";
+    default:
+      return "Scalar";
+  }
+}
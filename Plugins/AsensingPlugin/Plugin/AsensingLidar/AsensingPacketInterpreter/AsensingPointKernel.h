@@ -0,0 +1,122 @@
+#ifndef AsensingPointKernel_h
+#define AsensingPointKernel_h
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Convert the units of an Asensing packet to cartesian points, several units at once.
+ *
+ * The fields of the units are first gathered in structure of arrays layout (UnitBatch), then
+ * converted in one pass with AVX2 or SSE4.1 instructions when the CPU supports them, with a
+ * scalar fallback otherwise. Everything is computed in single precision, so the points only
+ * differ from the former unit by unit conversion by float rounding.
+ *
+ * The per point corrections of the A0 calibration file are not handled: one product per
+ * coordinate costs less than gathering the units, so the interpreter applies them itself.
+ */
+class AsensingPointKernel
+{
+public:
+  enum class InstructionSet
+  {
+    Scalar = 0,
+    SSE41 = 1,
+    AVX2 = 2
+  };
+
+  enum class Model
+  {
+    Spherical,    //!< Azimuth and elevation looked up in the trigonometric tables
+    Mirror,       //!< A0 angle model, beam of the module reflected by the MEMS mirror (type 0x02)
+    TiltedMirror  //!< Same with the modules tilted by 25 degrees steps (type 0x03)
+  };
+
+  //! Maximum number of units converted at once, enough for a whole A0 packet or an A2 block
+  static constexpr int MaxUnits = 256;
+
+  //! Number of entries of the trigonometric tables, one per hundredth of degree
+  static constexpr int TableSize = 36000;
+
+  //! Maximum number of modules of the mirror model
+  static constexpr int MaxModules = 8;
+
+  //! @brief Raw fields of the units to convert
+  struct UnitBatch
+  {
+    int Size = 0;
+    uint16_t Distance[MaxUnits];   /*!< raw distance, in distance units */
+    float Azimuth[MaxUnits];       /*!< degrees */
+    float Elevation[MaxUnits];     /*!< degrees */
+    uint8_t Intensity[MaxUnits];
+    int32_t Laser[MaxUnits];       /*!< laser id, only used by the mirror models */
+  };
+
+  //! @brief Converted points, in the same order as the units
+  struct PointBatch
+  {
+    float X[MaxUnits];
+    float Y[MaxUnits];
+    float Z[MaxUnits];
+    float Distance[MaxUnits];      /*!< meters */
+    uint8_t Intensity[MaxUnits];
+  };
+
+  //! Context handed to the instruction set specific implementations
+  struct Tables
+  {
+    const float* Cos;
+    const float* Sin;
+    const float* IncidentX;        /*!< incident vector of each module, MaxModules entries */
+    const float* IncidentY;
+    const float* IncidentZ;
+    const int32_t* Tilt;           /*!< azimuth offset of each module, hundredths of degree */
+    float CosMirror;
+    float SinMirror;
+    float DistanceUnit;
+  };
+
+  AsensingPointKernel();
+
+  /**
+   * @brief SetMirrorAngles set the angles of the mirror model, for the Mirror models
+   * @param moduleAngles horizontal angle of each module, degrees
+   * @param numberOfModules at most MaxModules, the module of a laser is laser / 2
+   * @param mirrorAngle angle of the mirror, degrees
+   */
+  void SetMirrorAngles(const float* moduleAngles, int numberOfModules, float mirrorAngle);
+
+  /**
+   * @brief Convert compute the points of all the units of the batch
+   * @param distanceUnit meters per raw distance unit
+   */
+  void Convert(Model model, const UnitBatch& units, float distanceUnit, PointBatch& points) const;
+
+  /**
+   * @brief SetInstructionSet force the instructions used, mostly for benchmarking.
+   * Falls back to the best instruction set supported by the CPU.
+   */
+  void SetInstructionSet(InstructionSet instructions);
+  InstructionSet GetInstructionSet() const { return this->Instructions; }
+
+  //! Best instruction set supported by both the build and the CPU
+  static InstructionSet GetSupportedInstructionSet();
+
+  static const char* GetInstructionSetName(InstructionSet instructions);
+
+private:
+  std::vector<float> Cos;
+  std::vector<float> Sin;
+
+  float IncidentX[MaxModules] = { 0 };
+  float IncidentY[MaxModules] = { 0 };
+  float IncidentZ[MaxModules] = { 0 };
+  int32_t NoTilt[MaxModules] = { 0 };
+  int32_t Tilt[MaxModules] = { 5000, 2500, 0, -2500, -5000, 0, 0, 0 };
+  float CosMirror = 1.f;
+  float SinMirror = 0.f;
+
+  InstructionSet Instructions = InstructionSet::Scalar;
+};
+
+#endif // AsensingPointKernel_h
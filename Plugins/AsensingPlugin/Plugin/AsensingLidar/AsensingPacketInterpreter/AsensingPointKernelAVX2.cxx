@@ -0,0 +1,78 @@
+// Compiled with AVX2 enabled, only called once the CPU support has been checked.
+// Nothing from the standard library must be used here, as the inline functions it
+// would instantiate with AVX2 instructions could be picked by the linker for the other callers.
+#include "AsensingPointKernelImpl.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+struct AVX2Ops
+{
+  using F = __m256;
+  using I = __m256i;
+  using M = __m256;
+  using MI = __m256i;
+  static constexpr int Width = 8;
+
+  static F Load(const float* p) { return _mm256_loadu_ps(p); }
+  static I Loadi(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+  static F LoadDistance(const uint16_t* p)
+  {
+    return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))));
+  }
+  static void Store(float* p, F v) { _mm256_storeu_ps(p, v); }
+  static F Set1(float v) { return _mm256_set1_ps(v); }
+  static I Set1i(int32_t v) { return _mm256_set1_epi32(v); }
+  static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+  static F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+  static F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+  static M CmpGt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+  static M CmpGe(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+  static F Select(M mask, F a, F b) { return _mm256_blendv_ps(b, a, mask); }
+  static MI ToIntMask(M mask) { return _mm256_castps_si256(mask); }
+  static I Addi(I a, I b) { return _mm256_add_epi32(a, b); }
+  static I Subi(I a, I b) { return _mm256_sub_epi32(a, b); }
+  static I Andi(I a, I b) { return _mm256_and_si256(a, b); }
+  static MI CmpGti(I a, I b) { return _mm256_cmpgt_epi32(a, b); }
+  static I Srli1(I a) { return _mm256_srli_epi32(a, 1); }
+  static I Truncate(F a) { return _mm256_cvttps_epi32(a); }
+  static F Gather(const float* table, I index) { return _mm256_i32gather_ps(table, index, 4); }
+  static I Gatheri(const int32_t* table, I index)
+  {
+    return _mm256_i32gather_epi32(reinterpret_cast<const int*>(table), index, 4);
+  }
+};
+}
+
+//-----------------------------------------------------------------------------
+int AsensingConvertUnitsAVX2(AsensingPointKernel::Model model, const AsensingPointKernel::Tables& tables,
+  const AsensingPointKernel::UnitBatch& units, AsensingPointKernel::PointBatch& points)
+{
+  return ConvertUnits<AVX2Ops>(model, tables, units, points, 0);
+}
+
+//-----------------------------------------------------------------------------
+bool AsensingHasAVX2Units()
+{
+  return true;
+}
+
+#else
+
+//-----------------------------------------------------------------------------
+int AsensingConvertUnitsAVX2(AsensingPointKernel::Model, const AsensingPointKernel::Tables&,
+  const AsensingPointKernel::UnitBatch&, AsensingPointKernel::PointBatch&)
+{
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+bool AsensingHasAVX2Units()
+{
+  return false;
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef AsensingPointKernelImpl_h
+#define AsensingPointKernelImpl_h
+
+// Conversion algorithms shared by the instruction set specific translation units.
+// Each of them includes this file after defining its own Ops (vector types and operations),
+// everything is kept in an anonymous namespace so that code compiled with different
+// instruction sets never gets merged by the linker.
+
+#include "AsensingPointKernel.h"
+
+// Instruction set specific entry points, they convert as many units as possible
+// with full vectors and return the number of converted units
+int AsensingConvertUnitsSSE41(AsensingPointKernel::Model model, const AsensingPointKernel::Tables& tables,
+  const AsensingPointKernel::UnitBatch& units, AsensingPointKernel::PointBatch& points);
+int AsensingConvertUnitsAVX2(AsensingPointKernel::Model model, const AsensingPointKernel::Tables& tables,
+  const AsensingPointKernel::UnitBatch& units, AsensingPointKernel::PointBatch& points);
+
+// True if the matching entry point above was compiled with its instruction set. They only
+// return a constant, so that they can be called on any CPU, unlike the entry points.
+bool AsensingHasSSE41Units();
+bool AsensingHasAVX2Units();
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Wrap an index of the trigonometric tables once, as the angles can be slightly out of [0, 360[
+template <typename Ops>
+inline typename Ops::I WrapIndex(typename Ops::I index)
+{
+  const typename Ops::I circle = Ops::Set1i(AsensingPointKernel::TableSize);
+  index = Ops::Subi(index, Ops::Andi(Ops::CmpGti(index, Ops::Set1i(AsensingPointKernel::TableSize - 1)), circle));
+  index = Ops::Addi(index, Ops::Andi(Ops::CmpGti(Ops::Set1i(0), index), circle));
+  return index;
+}
+
+//-----------------------------------------------------------------------------
+// Same rounding as static_cast<int>(angle * 100 + 0.5)
+template <typename Ops>
+inline typename Ops::I AngleToIndex(typename Ops::F angle)
+{
+  return Ops::Truncate(Ops::Add(Ops::Mul(angle, Ops::Set1(100.f)), Ops::Set1(0.5f)));
+}
+
+//-----------------------------------------------------------------------------
+template <typename Ops>
+int ConvertSpherical(const AsensingPointKernel::Tables& tables,
+  const AsensingPointKernel::UnitBatch& units, AsensingPointKernel::PointBatch& points, int first)
+{
+  using F = typename Ops::F;
+  const F unit = Ops::Set1(tables.DistanceUnit);
+  const F zero = Ops::Set1(0.f);
+  const F fullTurn = Ops::Set1(360.f);
+
+  int i = first;
+  for (; i + Ops::Width <= units.Size; i += Ops::Width)
+  {
+    const F distance = Ops::Mul(Ops::LoadDistance(units.Distance + i), unit);
+
+    F pitch = Ops::Load(units.Elevation + i);
+    pitch = Ops::Select(Ops::CmpGt(zero, pitch), Ops::Add(pitch, fullTurn), pitch);
+    pitch = Ops::Select(Ops::CmpGe(pitch, fullTurn), Ops::Sub(pitch, fullTurn), pitch);
+    const typename Ops::I pitchIndex = WrapIndex<Ops>(AngleToIndex<Ops>(pitch));
+    const typename Ops::I azimuthIndex = WrapIndex<Ops>(AngleToIndex<Ops>(Ops::Load(units.Azimuth + i)));
+
+    const F xyDistance = Ops::Mul(distance, Ops::Gather(tables.Cos, pitchIndex));
+    Ops::Store(points.X + i, Ops::Mul(xyDistance, Ops::Gather(tables.Cos, azimuthIndex)));
+    Ops::Store(points.Y + i, Ops::Mul(xyDistance, Ops::Gather(tables.Sin, azimuthIndex)));
+    Ops::Store(points.Z + i, Ops::Mul(distance, Ops::Gather(tables.Sin, pitchIndex)));
+    Ops::Store(points.Distance + i, distance);
+  }
+  return i;
+}
+
+//-----------------------------------------------------------------------------
+// The angles of the units are whole hundredths of degree, so the trigonometric tables
+// give the same values as computing the sines and cosines of each unit
+template <typename Ops>
+int ConvertMirror(const AsensingPointKernel::Tables& tables,
+  const AsensingPointKernel::UnitBatch& units, AsensingPointKernel::PointBatch& points, int first)
+{
+  using F = typename Ops::F;
+  using I = typename Ops::I;
+  const F unit = Ops::Set1(tables.DistanceUnit);
+  const F limit = Ops::Set1(120.f);
+  const I fullTurn = Ops::Set1i(AsensingPointKernel::TableSize);
+  const F cosMirror = Ops::Set1(tables.CosMirror);
+  const F sinMirror = Ops::Set1(tables.SinMirror);
+  const F minusCosMirror = Ops::Set1(-tables.CosMirror);
+  const F two = Ops::Set1(2.f);
+
+  int i = first;
+  for (; i + Ops::Width <= units.Size; i += Ops::Width)
+  {
+    const F distance = Ops::Mul(Ops::LoadDistance(units.Distance + i), unit);
+    const I module = Ops::Srli1(Ops::Loadi(units.Laser + i));
+
+    // Angles above 120 degrees are negative ones
+    const F azimuth = Ops::Load(units.Azimuth + i);
+    I azimuthIndex = AngleToIndex<Ops>(azimuth);
+    azimuthIndex = Ops::Subi(azimuthIndex, Ops::Andi(Ops::ToIntMask(Ops::CmpGt(azimuth, limit)), fullTurn));
+    azimuthIndex = WrapIndex<Ops>(Ops::Addi(azimuthIndex, Ops::Gatheri(tables.Tilt, module)));
+    const F elevation = Ops::Load(units.Elevation + i);
+    I elevationIndex = AngleToIndex<Ops>(elevation);
+    elevationIndex = Ops::Subi(elevationIndex, Ops::Andi(Ops::ToIntMask(Ops::CmpGt(elevation, limit)), fullTurn));
+    elevationIndex = WrapIndex<Ops>(elevationIndex);
+
+    // gamma = -azimuth, beta = -elevation
+    const F sinGamma = Ops::Sub(Ops::Set1(0.f), Ops::Gather(tables.Sin, azimuthIndex));
+    const F cosGamma = Ops::Gather(tables.Cos, azimuthIndex);
+    const F sinBeta = Ops::Sub(Ops::Set1(0.f), Ops::Gather(tables.Sin, elevationIndex));
+    const F cosBeta = Ops::Gather(tables.Cos, elevationIndex);
+
+    // Normal of the mirror
+    const F normalX = Ops::Sub(Ops::Mul(Ops::Mul(cosBeta, cosGamma), cosMirror), Ops::Mul(sinBeta, sinMirror));
+    const F normalY = Ops::Mul(sinGamma, cosMirror);
+    const F normalZ = Ops::Sub(Ops::Mul(Ops::Mul(minusCosMirror, sinBeta), cosGamma), Ops::Mul(cosBeta, sinMirror));
+
+    // Reflection of the incident vector of the module
+    const F incidentX = Ops::Gather(tables.IncidentX, module);
+    const F incidentY = Ops::Gather(tables.IncidentY, module);
+    const F incidentZ = Ops::Gather(tables.IncidentZ, module);
+    const F k = Ops::Add(Ops::Add(Ops::Mul(incidentX, normalX), Ops::Mul(incidentY, normalY)), Ops::Mul(incidentZ, normalZ));
+    const F twoK = Ops::Mul(two, k);
+    Ops::Store(points.X + i, Ops::Mul(distance, Ops::Sub(incidentX, Ops::Mul(twoK, normalX))));
+    Ops::Store(points.Y + i, Ops::Mul(distance, Ops::Sub(incidentY, Ops::Mul(twoK, normalY))));
+    Ops::Store(points.Z + i, Ops::Mul(distance, Ops::Sub(incidentZ, Ops::Mul(twoK, normalZ))));
+    Ops::Store(points.Distance + i, distance);
+  }
+  return i;
+}
+
+//-----------------------------------------------------------------------------
+template <typename Ops>
+int ConvertUnits(AsensingPointKernel::Model model, const AsensingPointKernel::Tables& tables,
+  const AsensingPointKernel::UnitBatch& units, AsensingPointKernel::PointBatch& points, int first)
+{
+  switch (model)
+  {
+    case AsensingPointKernel::Model::Mirror:
+    case AsensingPointKernel::Model::TiltedMirror:
+      return ConvertMirror<Ops>(tables, units, points, first);
+    case AsensingPointKernel::Model::Spherical:
+    default:
+      return ConvertSpherical<Ops>(tables, units, points, first);
+  }
+}
+}
+
+#endif // AsensingPointKernelImpl_h
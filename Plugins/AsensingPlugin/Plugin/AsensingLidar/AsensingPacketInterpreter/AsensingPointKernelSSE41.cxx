@@ -0,0 +1,82 @@
+// Compiled with SSE4.1 enabled, only called once the CPU support has been checked
+#include "AsensingPointKernelImpl.h"
+
+#if defined(__SSE4_1__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86)))
+#include <smmintrin.h>
+
+namespace
+{
+//-----------------------------------------------------------------------------
+struct SSE41Ops
+{
+  using F = __m128;
+  using I = __m128i;
+  using M = __m128;
+  using MI = __m128i;
+  static constexpr int Width = 4;
+
+  static F Load(const float* p) { return _mm_loadu_ps(p); }
+  static I Loadi(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  static F LoadDistance(const uint16_t* p)
+  {
+    return _mm_cvtepi32_ps(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))));
+  }
+  static void Store(float* p, F v) { _mm_storeu_ps(p, v); }
+  static F Set1(float v) { return _mm_set1_ps(v); }
+  static I Set1i(int32_t v) { return _mm_set1_epi32(v); }
+  static F Add(F a, F b) { return _mm_add_ps(a, b); }
+  static F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+  static F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+  static M CmpGt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+  static M CmpGe(F a, F b) { return _mm_cmpge_ps(a, b); }
+  static F Select(M mask, F a, F b) { return _mm_blendv_ps(b, a, mask); }
+  static MI ToIntMask(M mask) { return _mm_castps_si128(mask); }
+  static I Addi(I a, I b) { return _mm_add_epi32(a, b); }
+  static I Subi(I a, I b) { return _mm_sub_epi32(a, b); }
+  static I Andi(I a, I b) { return _mm_and_si128(a, b); }
+  static MI CmpGti(I a, I b) { return _mm_cmpgt_epi32(a, b); }
+  static I Srli1(I a) { return _mm_srli_epi32(a, 1); }
+  static I Truncate(F a) { return _mm_cvttps_epi32(a); }
+  static F Gather(const float* table, I index)
+  {
+    // No gather instruction before AVX2
+    return _mm_setr_ps(table[_mm_extract_epi32(index, 0)], table[_mm_extract_epi32(index, 1)],
+      table[_mm_extract_epi32(index, 2)], table[_mm_extract_epi32(index, 3)]);
+  }
+  static I Gatheri(const int32_t* table, I index)
+  {
+    return _mm_setr_epi32(table[_mm_extract_epi32(index, 0)], table[_mm_extract_epi32(index, 1)],
+      table[_mm_extract_epi32(index, 2)], table[_mm_extract_epi32(index, 3)]);
+  }
+};
+}
+
+//-----------------------------------------------------------------------------
+int AsensingConvertUnitsSSE41(AsensingPointKernel::Model model, const AsensingPointKernel::Tables& tables,
+  const AsensingPointKernel::UnitBatch& units, AsensingPointKernel::PointBatch& points)
+{
+  return ConvertUnits<SSE41Ops>(model, tables, units, points, 0);
+}
+
+//-----------------------------------------------------------------------------
+bool AsensingHasSSE41Units()
+{
+  return true;
+}
+
+#else
+
+//-----------------------------------------------------------------------------
+int AsensingConvertUnitsSSE41(AsensingPointKernel::Model, const AsensingPointKernel::Tables&,
+  const AsensingPointKernel::UnitBatch&, AsensingPointKernel::PointBatch&)
+{
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+bool AsensingHasSSE41Units()
+{
+  return false;
+}
+
+#endif
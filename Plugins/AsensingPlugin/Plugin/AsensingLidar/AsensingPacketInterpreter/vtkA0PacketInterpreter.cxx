@@ -6,6 +6,7 @@
 #include <vtkPoints.h>
 #include <vtkTransform.h>
 
+#include <algorithm>
 #include <bitset>
 #include <boost/foreach.hpp>
 #include <boost/property_tree/ptree.hpp>
@@ -14,56 +15,162 @@
 #include <fenv.h>
 #include <math.h>
 
-#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vtkDelimitedTextReader.h>
 
 #define TEST_LASER_NUM (128) /* Just for testing */
 
-using std::chrono::duration;
-using std::chrono::duration_cast;
-using std::chrono::high_resolution_clock;
-using std::chrono::milliseconds;
-
 namespace
 {
 
-double degreeToRadian(double degree)
+//-----------------------------------------------------------------------------
+bool IsInvalidUnit(const AsensingUnit& unit)
 {
-  return degree * vtkMath::Pi() / 180.0;
-}
+  return 0 == unit.GetAzimuth() &&
+         0 == unit.GetElevation() &&
+         0 == unit.GetDistance() &&
+         0 == unit.GetIntensity();
 }
 
-//! @todo this method are actually usefull for every Interpreter and should go to the top
+//-----------------------------------------------------------------------------
 template<typename T>
-vtkSmartPointer<T> vtkA0PacketInterpreter::CreateDataArray(bool isAdvanced, const char* name,
-  vtkIdType vtkNotUsed(np), vtkIdType prereserved_np, vtkPolyData* pd)
+auto GetRawPointer(const vtkSmartPointer<T>& array) -> decltype(array->GetPointer(0))
 {
+  return array != nullptr ? array->GetPointer(0) : nullptr;
+}
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkDataArray> vtkA0PacketInterpreter::CreateAttributeArray(bool isAdvanced,
+  AsensingAttributeKind kind, const char* name, vtkPolyData* pd, AsensingAttribute& attribute)
+{
+  attribute = AsensingAttribute();
   if (isAdvanced && !this->EnableAdvancedArrays)
   {
     return nullptr;
   }
-  vtkSmartPointer<T> array = vtkSmartPointer<T>::New();
-  array->SetNumberOfValues(prereserved_np);
-  array->SetName(name);
-  if (pd)
-  {
-    pd->GetPointData()->AddArray(array);
-  }
-
-  array->FillValue(0);
-
-  return array;
+  return AddAttributeArray(this->FramePool, pd, static_cast<AsensingFrameSchema>(this->FrameSchema),
+    kind, name, attribute);
 }
 
 template<typename T, typename U>
-void TrySetValue(T& array, int pos, U value)
+void TrySetValue(T* array, uint32_t pos, U value)
 {
   if (array != nullptr)
   {
-    array->SetValue(pos, value);
+    array[pos] = static_cast<T>(value);
   }
 }
 
+inline void SetPoint(float* points, uint32_t pos, double x, double y, double z)
+{
+  points[3 * pos] = static_cast<float>(x);
+  points[3 * pos + 1] = static_cast<float>(y);
+  points[3 * pos + 2] = static_cast<float>(z);
+}
+
+//-----------------------------------------------------------------------------
+class vtkA0PacketInterpreter::DecodeWorkers
+{
+public:
+  DecodeWorkers(const vtkA0PacketInterpreter* interpreter, int numberOfThreads)
+    : Interpreter(interpreter)
+    , Jobs(QueueSize)
+  {
+    for (int i = 0; i < numberOfThreads; ++i)
+    {
+      this->Threads.emplace_back(&DecodeWorkers::ThreadLoop, this);
+    }
+  }
+
+  //! Decode the remaining jobs, then stop the threads
+  ~DecodeWorkers()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->StopRequested = true;
+    }
+    this->JobAvailable.notify_all();
+    for (std::thread& thread : this->Threads)
+    {
+      thread.join();
+    }
+  }
+
+  int GetNumberOfThreads() const { return static_cast<int>(this->Threads.size()); }
+
+  //! Copy the packet, as it is released once processed, and wait if too many jobs are queued
+  void Push(const AsensingPacket& packet, const DecodeRange& range)
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->SlotAvailable.wait(lock, [this] { return this->Tail - this->Head < this->Jobs.size(); });
+    Job& job = this->Jobs[this->Tail % this->Jobs.size()];
+    job.Packet = packet;
+    job.Range = range;
+    this->Tail++;
+    this->Pending++;
+    lock.unlock();
+    this->JobAvailable.notify_one();
+  }
+
+  void Wait()
+  {
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    this->AllDecoded.wait(lock, [this] { return this->Pending == 0; });
+  }
+
+private:
+  struct Job
+  {
+    AsensingPacket Packet;
+    DecodeRange Range;
+  };
+
+  void ThreadLoop()
+  {
+    Job job;
+    std::unique_lock<std::mutex> lock(this->Mutex);
+    while (true)
+    {
+      this->JobAvailable.wait(lock, [this] { return this->StopRequested || this->Head != this->Tail; });
+      if (this->Head == this->Tail)
+      {
+        return;
+      }
+      job = this->Jobs[this->Head % this->Jobs.size()];
+      this->Head++;
+      lock.unlock();
+      this->SlotAvailable.notify_one();
+
+      this->Interpreter->DecodeUnits(job.Packet, job.Range);
+
+      lock.lock();
+      if (--this->Pending == 0)
+      {
+        this->AllDecoded.notify_all();
+      }
+    }
+  }
+
+  //! Enough packets for a few frames
+  static constexpr size_t QueueSize = 1024;
+
+  const vtkA0PacketInterpreter* Interpreter;
+  std::vector<std::thread> Threads;
+
+  std::mutex Mutex;
+  std::condition_variable JobAvailable;
+  std::condition_variable SlotAvailable;
+  std::condition_variable AllDecoded;
+  std::vector<Job> Jobs;
+  size_t Head = 0;
+  size_t Tail = 0;
+  size_t Pending = 0; /*!< pushed jobs not decoded yet */
+  bool StopRequested = false;
+};
+
 //-----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkA0PacketInterpreter)
 
@@ -89,21 +196,23 @@ vtkA0PacketInterpreter::vtkA0PacketInterpreter()
   // Meta data required to correctly parse the data contained within the udp packets
   this->ParserMetaData.SpecificInformation = std::make_shared<AsensingSpecificFrameInformation>();
 
-  for (int j = 0; j < CIRCLE; j++)
-  {
-    double angle = j / 100.0;
-    this->Cos_all_angle.push_back(std::cos(degreeToRadian(angle)));
-    this->Sin_all_angle.push_back(std::sin(degreeToRadian(angle)));
-  }
+  this->Kernel.SetMirrorAngles(this->m_angles, ANGLE_SIZE - 1, this->m_angles[ANGLE_SIZE - 1]);
 }
 
 //-----------------------------------------------------------------------------
-vtkA0PacketInterpreter::~vtkA0PacketInterpreter() {}
+vtkA0PacketInterpreter::~vtkA0PacketInterpreter()
+{
+  // The workers use the calibration, stop them before it is destroyed
+  this->Workers.reset();
+}
 
 #include "cJSON.h"
 //-----------------------------------------------------------------------------
 void vtkA0PacketInterpreter::LoadCalibration(const std::string& filename)
 {
+  // Do not change the calibration under the feet of the decode workers
+  this->WaitForDecodedUnits();
+
   if (filename.empty())
   {
     this->IsCalibrated = false;
@@ -173,6 +282,7 @@ void vtkA0PacketInterpreter::LoadCalibration(const std::string& filename)
     m_angles[i] = cJSON_GetArrayItem(module_angles, i)->valuedouble;
     std::cout << "angle " << i << " : " << m_angles[i] << std::endl;
   }
+  this->Kernel.SetMirrorAngles(this->m_angles, ANGLE_SIZE - 1, this->m_angles[ANGLE_SIZE - 1]);
 
   cJSON* channels = cJSON_GetObjectItem(root, "module");
   if (cJSON_IsArray(channels))
@@ -410,25 +520,29 @@ void vtkA0PacketInterpreter::LoadCalibration(const std::string& filename)
 
 void vtkA0PacketInterpreter::ProcessPacket(unsigned char const* data, unsigned int dataLength)
 {
-  auto start = high_resolution_clock::now();
+  ASENSING_PROFILE_PACKET(this->Profiler);
   if (!this->IsLidarPacket(data, dataLength))
   {
     return;
   }
 
-  const AsensingPacket* dataPacket = reinterpret_cast<const AsensingPacket*>(data);
+  const int decodeThreads = std::max(this->DecodeThreads, 0);
+  if (decodeThreads != (this->Workers ? this->Workers->GetNumberOfThreads() : 0))
+  {
+    this->Workers.reset();
+    if (decodeThreads > 0)
+    {
+      this->Workers.reset(new DecodeWorkers(this, decodeThreads));
+    }
+  }
 
-  struct tm t;
-  t.tm_year = dataPacket->header.GetUTCTime0();
-  t.tm_mon = dataPacket->header.GetUTCTime1() - 1;
-  t.tm_mday = dataPacket->header.GetUTCTime2();
-  t.tm_hour = dataPacket->header.GetUTCTime3();
-  t.tm_min = dataPacket->header.GetUTCTime4();
-  t.tm_sec = dataPacket->header.GetUTCTime5();
-  t.tm_isdst = 0;
+  const AsensingPacket* dataPacket = reinterpret_cast<const AsensingPacket*>(data);
 
   // Time in second of the packets
-  time_t unix_second = (mktime(&t));
+  time_t unix_second = this->HeaderTime.Get(dataPacket->header.GetUTCTime0(),
+    dataPacket->header.GetUTCTime1(), dataPacket->header.GetUTCTime2(),
+    dataPacket->header.GetUTCTime3(), dataPacket->header.GetUTCTime4(),
+    dataPacket->header.GetUTCTime5());
 
   int mode = 0;
   int state = 0;
@@ -445,8 +559,6 @@ void vtkA0PacketInterpreter::ProcessPacket(unsigned char const* data, unsigned i
   echo_count = dataPacket->header.GetEchoCount();
   current_frame_id = dataPacket->header.GetFrameID();
   current_seq_num = dataPacket->header.GetSeqNum();
-  auto MeasureMode = dataPacket->header.GetMeasureMode();
-  auto distResolutionFlag = MeasureMode & (0x01 << 2);
   seq_num_counter++;
 
   if (dataPacket->header.GetPointNum() > 0) {
@@ -486,378 +598,261 @@ void vtkA0PacketInterpreter::ProcessPacket(unsigned char const* data, unsigned i
     structured_pt_id += ASENSING_POINT_PER_PACKET;
   }
 
-  for (int blockID = start_block; blockID < end_block; blockID++)
+  // Assign its slot to each point sequentially, as it depends on the previous packets.
+  // The points themselves are computed by DecodeUnits, possibly on a worker thread.
+  DecodeRange range;
+  range.Arrays = this->CurrentArrays;
+  range.FirstUnit = start_block * ASENSING_LASER_NUM;
+  range.FirstPointId = current_pt_id;
+  range.FirstStructuredPointId = structured_pt_id;
+  range.Timestamp = timestamp;
+
+  const int lastUnit = end_block * ASENSING_LASER_NUM;
+  for (int unit = range.FirstUnit; unit < lastUnit; unit++)
   {
-    AsensingBlock currentBlock = dataPacket->blocks[blockID];
+    const AsensingBlock& currentBlock = dataPacket->blocks[unit / ASENSING_LASER_NUM];
+    const int laserID = unit % ASENSING_LASER_NUM;
+    if (this->channels[laserID] == 1 && IsInvalidUnit(currentBlock.units[laserID]))
+    {
+      continue;
+    }
 
-    for (int laserID = 0; laserID < ASENSING_LASER_NUM; laserID++)
+    if (current_pt_id >= this->points_per_frame)
     {
-      if(this->channels[laserID] == 1) {
-          /* Eliminate invalid points */
-          if (0 == currentBlock.units[laserID].GetAzimuth() &&
-              0 == currentBlock.units[laserID].GetElevation() &&
-              0 == currentBlock.units[laserID].GetDistance() &&
-              0 == currentBlock.units[laserID].GetIntensity()) {
-                continue;
-          }
+#if PACKET_STAT_DEBUG
+      // SplitFrame for safety to not overflow allcoated arrays
+      vtkWarningMacro(<< "Received more datapoints than expected" << " (" << current_pt_id << ", " << current_frame_id << ")");
 
-          double x, y, z, azimuth, pitch;
+      if (current_frame_id > 0 && this->seq_num_counter < (this->points_per_frame / ASENSING_POINT_PER_PACKET)) {
 
-          // 距离分辨率0代表0.01，1代表0.005
-          double distance = 0;
-          if(distResolutionFlag)
-          {
-             distance = static_cast<double>(currentBlock.units[laserID].GetDistance()) * ASENSING_LOW_DISTANCE_UNIT;
-          }
-          else
-          {
-             distance = static_cast<double>(currentBlock.units[laserID].GetDistance()) * ASENSING_HIGH_DISTANCE_UNIT;
-          }
+        vtkWarningMacro(<< "Incomplete frame 2 (id: " << (current_frame_id - 1)
+                        << ", packets: " << seq_num_counter
+                        << ", total: " << (this->points_per_frame / ASENSING_POINT_PER_PACKET)
+                        << ", lsn: " << this->last_seq_num
+                        << ", points: " << this->points_per_frame << ")" );
+      }
+#endif
+      // The previous units belong to the frame being split
+      range.LastUnit = unit;
+      this->DispatchUnits(*dataPacket, range);
+      this->SplitFrame();
+
+      range.Arrays = this->CurrentArrays;
+      range.FirstUnit = unit;
+      range.FirstPointId = current_pt_id;
+      range.FirstStructuredPointId = structured_pt_id;
+      range.Timestamp = timestamp;
+    }
 
-          if (this->CalibEnabled)
-          {
-            x = distance * this->XCorrection[current_pt_id];
-            y = distance * this->YCorrection[current_pt_id];
-            z = distance * this->ZCorrection[current_pt_id];
-          }
-          else
-          {
-            // double azimuth_correction = this->AzimuthCorrection[laserID];
-            // double elevation_correction = this->ElevationCorrection[laserID];
-
-            azimuth = static_cast<float>(currentBlock.units[laserID].GetAzimuth()) * ASENSING_AZIMUTH_UNIT;
-            pitch = static_cast<float>(currentBlock.units[laserID].GetElevation()) * ASENSING_ELEVATION_UNIT;
-
-            if (pitch < 0)
-            {
-                pitch += 360.0f;
-            }
-            else if (pitch >= 360.0f)
-            {
-                pitch -= 360.0f;
-            }
-
-            float xyDistance = distance * this->Cos_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-
-            int azimuthIdx = static_cast<int>(azimuth * 100 + 0.5);
-            if (azimuthIdx >= CIRCLE)
-            {
-              azimuthIdx -= CIRCLE;
-            }
-            else if (azimuthIdx < 0)
-            {
-              azimuthIdx += CIRCLE;
-            }
-
-    #if USING_MATH_LIB
-           double x = xyDistance * sin(degreeToRadian(azimuth)); // this->Sin_all_angle[azimuthIdx];
-           double y = xyDistance * cos(degreeToRadian(azimuth)); // this->Cos_all_angle[azimuthIdx];
-           double z = distance * sin(degreeToRadian(pitch));     // this->Sin_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-    #else
-            x = xyDistance * this->Cos_all_angle[azimuthIdx];
-            y = xyDistance * this->Sin_all_angle[azimuthIdx];
-            z = distance * this->Sin_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-    #endif
-          } /* End of this->CalibEnabled */
-
-    #if USING_RT_MATRIX
-          /* Matrix processing */
-          if (this->RTMatEnabled)
-          {
-            double x_ = x, y_ = y, z_ = z;
+    // Compute timestamp of the point
+    timestamp += currentBlock.GettimeOffSet();
+    current_pt_id++;
+    structured_pt_id++;
+  }
+  range.LastUnit = lastUnit;
+  this->DispatchUnits(*dataPacket, range);
 
-            if (laserID == 0 || laserID == 1)
-            {
-              x = this->matrix_RT0[0][0] * x_ + this->matrix_RT0[0][1] * y_ +
-                this->matrix_RT0[0][2] * z_ + this->matrix_RT0[0][3];
-              y = this->matrix_RT0[1][0] * x_ + this->matrix_RT0[1][1] * y_ +
-                this->matrix_RT0[1][2] * z_ + this->matrix_RT0[1][3];
-              z = this->matrix_RT0[2][0] * x_ + this->matrix_RT0[2][1] * y_ +
-                this->matrix_RT0[2][2] * z_ + this->matrix_RT0[2][3];
-            }
-            else if (laserID == 2 || laserID == 3)
-            {
-              x = this->matrix_RT1[0][0] * x_ + this->matrix_RT1[0][1] * y_ +
-                this->matrix_RT1[0][2] * z_ + this->matrix_RT1[0][3];
-              y = this->matrix_RT1[1][0] * x_ + this->matrix_RT1[1][1] * y_ +
-                this->matrix_RT1[1][2] * z_ + this->matrix_RT1[1][3];
-              z = this->matrix_RT1[2][0] * x_ + this->matrix_RT1[2][1] * y_ +
-                this->matrix_RT1[2][2] * z_ + this->matrix_RT1[2][3];
-            }
-            else if (laserID == 4 || laserID == 5)
-            {
-              x = this->matrix_RT2[0][0] * x_ + this->matrix_RT2[0][1] * y_ +
-                this->matrix_RT2[0][2] * z_ + this->matrix_RT2[0][3];
-              y = this->matrix_RT2[1][0] * x_ + this->matrix_RT2[1][1] * y_ +
-                this->matrix_RT2[1][2] * z_ + this->matrix_RT2[1][3];
-              z = this->matrix_RT2[2][0] * x_ + this->matrix_RT2[2][1] * y_ +
-                this->matrix_RT2[2][2] * z_ + this->matrix_RT2[2][3];
-            }
-            else if (laserID == 6 || laserID == 7)
-            {
-              x = this->matrix_RT3[0][0] * x_ + this->matrix_RT3[0][1] * y_ +
-                this->matrix_RT3[0][2] * z_ + this->matrix_RT3[0][3];
-              y = this->matrix_RT3[1][0] * x_ + this->matrix_RT3[1][1] * y_ +
-                this->matrix_RT3[1][2] * z_ + this->matrix_RT3[1][3];
-              z = this->matrix_RT3[2][0] * x_ + this->matrix_RT3[2][1] * y_ +
-                this->matrix_RT3[2][2] * z_ + this->matrix_RT3[2][3];
-            }
-          }
-    #endif /* USING_RT_MATRIX */
+  this->last_seq_num = current_seq_num;
+}
 
-          uint8_t intensity = currentBlock.units[laserID].GetIntensity();
+//-----------------------------------------------------------------------------
+void vtkA0PacketInterpreter::DecodeUnits(const AsensingPacket& packet, const DecodeRange& range) const
+{
+  const FrameArrays& arrays = range.Arrays;
+  const auto distResolutionFlag = packet.header.GetMeasureMode() & (0x01 << 2);
+  const auto type = packet.header.GetLidarInfo() >> 6;
+
+  // Gather the units in structure of arrays layout, to convert all of them at once
+  static_assert(ASENSING_POINT_PER_PACKET <= AsensingPointKernel::MaxUnits, "Packet larger than the point kernel batches");
+  AsensingPointKernel::UnitBatch units;
+  double timestamps[AsensingPointKernel::MaxUnits];
+  double timestamp = range.Timestamp;
+  units.Size = 0;
+  for (int unit = range.FirstUnit; unit < range.LastUnit; unit++)
+  {
+    const AsensingBlock& currentBlock = packet.blocks[unit / ASENSING_LASER_NUM];
+    const int laserID = unit % ASENSING_LASER_NUM;
+    const AsensingUnit& currentUnit = currentBlock.units[laserID];
 
-          int offset = currentBlock.GettimeOffSet();
+    /* Eliminate invalid points */
+    if (this->channels[laserID] == 1 && IsInvalidUnit(currentUnit))
+    {
+      continue;
+    }
 
-          // Compute timestamp of the point
-          timestamp += offset;
+    // Compute timestamp of the point
+    timestamp += currentBlock.GettimeOffSet();
 
-    #if DEBUG
-           //std::cout << "Point " << current_frame_id << ": " << distance << ", " << azimuth << ", " << pitch << ", " << x << ", " << y << ", " << z << std::endl;
-           std::cout << "Point " << current_frame_id << ": " << currentBlock.units[laserID].GetDistance()
-                     << ", " << currentBlock.units[laserID].GetAzimuth()
-                     << ", " << currentBlock.units[laserID].GetElevation() << ", " << x << ", " << y << ", " << z << std::endl;
-    #endif
+    const int index = units.Size++;
+    units.Distance[index] = currentUnit.GetDistance();
+    units.Azimuth[index] = static_cast<float>(currentUnit.GetAzimuth()) * ASENSING_AZIMUTH_UNIT;
+    units.Elevation[index] = static_cast<float>(currentUnit.GetElevation()) * ASENSING_ELEVATION_UNIT;
+    units.Intensity[index] = currentUnit.GetIntensity();
+    units.Laser[index] = laserID;
+    timestamps[index] = timestamp;
+  }
 
-          if (current_pt_id >= this->points_per_frame)
-          {
-    #if PACKET_STAT_DEBUG
-            // SplitFrame for safety to not overflow allcoated arrays
-            vtkWarningMacro(<< "Received more datapoints than expected" << " (" << current_pt_id << ", " << current_frame_id << ")");
-
-            if (current_frame_id > 0 && this->seq_num_counter < (this->points_per_frame / ASENSING_POINT_PER_PACKET)) {
-
-              vtkWarningMacro(<< "Incomplete frame 2 (id: " << (current_frame_id - 1)
-                              << ", packets: " << seq_num_counter
-                              << ", total: " << (this->points_per_frame / ASENSING_POINT_PER_PACKET)
-                              << ", lsn: " << this->last_seq_num
-                              << ", points: " << this->points_per_frame << ")" );
-            }
-    #endif
-            this->SplitFrame();
-          }
+  // 角度算法处理x，y，z: 0x02 -> 0°, 0x03 -> 25°
+  AsensingPointKernel::Model model = AsensingPointKernel::Model::Spherical;
+  if (type == 0x02)
+  {
+    model = AsensingPointKernel::Model::Mirror;
+  }
+  else if (type == 0x03)
+  {
+    model = AsensingPointKernel::Model::TiltedMirror;
+  }
 
-          // 角度算法处理x，y，z
-          auto type = dataPacket->header.GetLidarInfo() >> 6;
-          if(type == 0x02 || type == 0x03)  // 0x02 -> 0°, 0x03 -> 25°
-          {
-              // 入射向量求解
-              float vector[VECTOR_SIZE] = {0};
-              float theta = degreeToRadian(m_angles[laserID / 2]);
-              float gamma0 = degreeToRadian(m_angles[ANGLE_SIZE-1]);
-              float sin_gamma0 = std::sin(gamma0);
-              float cos_gamma0 = std::cos(gamma0);
-              float cos_theta = std::cos(theta);
-              vector[0] = cos_theta - 2.0 * cos_theta * cos_gamma0 * cos_gamma0;
-              vector[1] = std::sin(theta);
-              vector[2] =  2.0 * cos_theta * sin_gamma0 * cos_gamma0;
-
-              // 法向量求解
-              float normal[VECTOR_SIZE] = {0};
-              float angle = currentBlock.units[laserID].GetAzimuth() * ASENSING_AZIMUTH_UNIT;
-              angle = (angle > 120) ? (angle - 360) : angle;
-              if(type == 0x03)
-              {
-                  if(laserID / 2 == 0)
-                  {
-                      angle += 50;
-                  }
-                  else if(laserID / 2 == 1)
-                  {
-                      angle += 25;
-                  }
-                  else if(laserID / 2 == 3)
-                  {
-                      angle -= 25;
-                  }
-                  else if(laserID / 2 == 4)
-                  {
-                      angle -= 50;
-                  }
-              }
-              float gamma = degreeToRadian(-angle);
-              angle = static_cast<float>(currentBlock.units[laserID].GetElevation()) * ASENSING_ELEVATION_UNIT;
-              angle = (angle > 120) ? (angle - 360) : angle;
-              float beta = - 1 * degreeToRadian(angle);
-              float sin_gamma = std::sin(gamma);
-              float cos_gamma = std::cos(gamma);
-              float sin_beta = std::sin(beta);
-              float cos_beta = std::cos(beta);
-              normal[0] = cos_beta * cos_gamma * cos_gamma0 - sin_beta * sin_gamma0;
-              normal[1] = sin_gamma * cos_gamma0;
-              normal[2] = -cos_gamma0 * sin_beta * cos_gamma - cos_beta * sin_gamma0;
-
-              // 最终向量求解
-              float out[VECTOR_SIZE] = {0};
-              float k = vector[0] * normal[0] + vector[1] * normal[1] + vector[2] * normal[2];
-              for(int i = 0; i < VECTOR_SIZE; i++)
-              {
-                  out[i] = vector[i] - 2 * k * normal[i];
-              }
-              x = distance * out[0];
-              y = distance * out[1];
-              z = distance * out[2];
-          }
+  // 距离分辨率0代表0.01，1代表0.005
+  const double distanceUnit = distResolutionFlag ? ASENSING_LOW_DISTANCE_UNIT : ASENSING_HIGH_DISTANCE_UNIT;
 
-          if (azimuth < 0)
-          {
-              azimuth += 360.0f;
-          }
-          else if (azimuth >= 270.0f)
-          {
-              azimuth -= 360.0f;
-          }
+  // The corrections of the calibration file are applied below, one product per coordinate
+  // is cheaper than the kernel
+  const bool calibrated = model == AsensingPointKernel::Model::Spherical && this->CalibEnabled;
+  AsensingPointKernel::PointBatch points;
+  if (!calibrated)
+  {
+    this->Kernel.Convert(model, units, distanceUnit, points);
+  }
 
-          if (pitch < 0)
+  for (int index = 0; index < units.Size; index++)
+  {
+    const uint32_t pointId = range.FirstPointId + index;
+    const uint32_t structuredPointId = range.FirstStructuredPointId + index;
+    const int laserID = units.Laser[index];
+
+    if (this->channels[laserID] == 1 &&
+        ((this->filter_point_id != -1 && filter_point_id == (int)pointId) || this->filter_point_id == -1)) {
+        double x, y, z, distance;
+        if (calibrated)
+        {
+          distance = static_cast<double>(units.Distance[index]) * distanceUnit;
+          x = distance * this->XCorrection[pointId];
+          y = distance * this->YCorrection[pointId];
+          z = distance * this->ZCorrection[pointId];
+        }
+        else
+        {
+          x = points.X[index];
+          y = points.Y[index];
+          z = points.Z[index];
+          distance = points.Distance[index];
+        }
+
+  #if USING_RT_MATRIX
+        /* Matrix processing */
+        if (this->RTMatEnabled)
+        {
+          const double (*matrix)[4] = nullptr;
+          if (laserID == 0 || laserID == 1)
           {
-              pitch += 360.0f;
+            matrix = this->matrix_RT0;
           }
-          else if (pitch >= 270.0f)
+          else if (laserID == 2 || laserID == 3)
           {
-              pitch -= 360.0f;
-          }
-
-          if((this->filter_point_id != -1 && filter_point_id == (int)current_pt_id) || this->filter_point_id == -1) {
-              this->Points->SetPoint(current_pt_id, x, y, z);
-              TrySetValue(this->PointsX, current_pt_id, x);
-              TrySetValue(this->PointsY, current_pt_id, y);
-              TrySetValue(this->PointsZ, current_pt_id, z);
-              TrySetValue(this->Azimuth, current_pt_id, azimuth);
-              TrySetValue(this->Elevation, current_pt_id, pitch);
-              TrySetValue(this->PointID, current_pt_id, structured_pt_id);
-              TrySetValue(this->LaserID, current_pt_id, laserID);
-              TrySetValue(this->Intensities, current_pt_id, intensity);
-              TrySetValue(this->Timestamps, current_pt_id, timestamp);
-              TrySetValue(this->Distances, current_pt_id, distance);
-          }
-          else {
-              this->Points->SetPoint(current_pt_id, NAN, NAN, NAN);
-              TrySetValue(this->PointsX, current_pt_id, NAN);
-              TrySetValue(this->PointsY, current_pt_id, NAN);
-              TrySetValue(this->PointsZ, current_pt_id, NAN);
-              TrySetValue(this->Azimuth, current_pt_id, NAN);
-              TrySetValue(this->Elevation, current_pt_id, NAN);
-              TrySetValue(this->PointID, current_pt_id, structured_pt_id);
-              TrySetValue(this->LaserID, current_pt_id, laserID);
-              TrySetValue(this->Intensities, current_pt_id, NAN);
-              TrySetValue(this->Timestamps, current_pt_id, NAN);
-              TrySetValue(this->Distances, current_pt_id, NAN);
-
+            matrix = this->matrix_RT1;
           }
-          current_pt_id++;
-          structured_pt_id++;
-      }
-      else {
-
-          double x, y, z, azimuth, pitch;
-
-          // 距离分辨率0代表0.01，1代表0.005
-          double distance = 0;
-          if(distResolutionFlag)
+          else if (laserID == 4 || laserID == 5)
           {
-             distance = static_cast<double>(currentBlock.units[laserID].GetDistance()) * ASENSING_LOW_DISTANCE_UNIT;
+            matrix = this->matrix_RT2;
           }
-          else
+          else if (laserID == 6 || laserID == 7)
           {
-             distance = static_cast<double>(currentBlock.units[laserID].GetDistance()) * ASENSING_HIGH_DISTANCE_UNIT;
+            matrix = this->matrix_RT3;
           }
 
-          if (this->CalibEnabled)
-          {
-            x = distance * this->XCorrection[current_pt_id];
-            y = distance * this->YCorrection[current_pt_id];
-            z = distance * this->ZCorrection[current_pt_id];
-          }
-          else
-          {
-            // double azimuth_correction = this->AzimuthCorrection[laserID];
-            // double elevation_correction = this->ElevationCorrection[laserID];
-
-            azimuth = static_cast<float>(currentBlock.units[laserID].GetAzimuth()) * ASENSING_AZIMUTH_UNIT;
-            pitch = static_cast<float>(currentBlock.units[laserID].GetElevation()) * ASENSING_ELEVATION_UNIT;
-
-            if (pitch < 0)
-            {
-                pitch += 360.0f;
-            }
-            else if (pitch >= 360.0f)
-            {
-                pitch -= 360.0f;
-            }
-
-            float xyDistance = distance * this->Cos_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-
-            int azimuthIdx = static_cast<int>(azimuth * 100 + 0.5);
-            if (azimuthIdx >= CIRCLE)
-            {
-              azimuthIdx -= CIRCLE;
-            }
-            else if (azimuthIdx < 0)
-            {
-              azimuthIdx += CIRCLE;
-            }
-
-    #if USING_MATH_LIB
-           double x = xyDistance * sin(degreeToRadian(azimuth)); // this->Sin_all_angle[azimuthIdx];
-           double y = xyDistance * cos(degreeToRadian(azimuth)); // this->Cos_all_angle[azimuthIdx];
-           double z = distance * sin(degreeToRadian(pitch));     // this->Sin_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-    #else
-            x = xyDistance * this->Cos_all_angle[azimuthIdx];
-            y = xyDistance * this->Sin_all_angle[azimuthIdx];
-            z = distance * this->Sin_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-    #endif
-          } /* End of this->CalibEnabled */
-
-
-          uint8_t intensity = currentBlock.units[laserID].GetIntensity();
-
-          int offset = currentBlock.GettimeOffSet();
-
-          // Compute timestamp of the point
-          timestamp += offset;
-
-
-          if (current_pt_id >= this->points_per_frame)
+          if (matrix)
           {
-    #if PACKET_STAT_DEBUG
-            // SplitFrame for safety to not overflow allcoated arrays
-            vtkWarningMacro(<< "Received more datapoints than expected" << " (" << current_pt_id << ", " << current_frame_id << ")");
-
-            if (current_frame_id > 0 && this->seq_num_counter < (this->points_per_frame / ASENSING_POINT_PER_PACKET)) {
-
-              vtkWarningMacro(<< "Incomplete frame 2 (id: " << (current_frame_id - 1)
-                              << ", packets: " << seq_num_counter
-                              << ", total: " << (this->points_per_frame / ASENSING_POINT_PER_PACKET)
-                              << ", lsn: " << this->last_seq_num
-                              << ", points: " << this->points_per_frame << ")" );
-            }
-    #endif
-            this->SplitFrame();
+            double x_ = x, y_ = y, z_ = z;
+            x = matrix[0][0] * x_ + matrix[0][1] * y_ + matrix[0][2] * z_ + matrix[0][3];
+            y = matrix[1][0] * x_ + matrix[1][1] * y_ + matrix[1][2] * z_ + matrix[1][3];
+            z = matrix[2][0] * x_ + matrix[2][1] * y_ + matrix[2][2] * z_ + matrix[2][3];
           }
-
-          this->Points->SetPoint(current_pt_id, NAN, NAN, NAN);
-
-          TrySetValue(this->PointsX, current_pt_id, NAN);
-          TrySetValue(this->PointsY, current_pt_id, NAN);
-          TrySetValue(this->PointsZ, current_pt_id, NAN);
-          TrySetValue(this->Azimuth, current_pt_id, NAN);
-          TrySetValue(this->Elevation, current_pt_id, NAN);
-          TrySetValue(this->PointID, current_pt_id, structured_pt_id);
-          TrySetValue(this->LaserID, current_pt_id, laserID);
-          TrySetValue(this->Intensities, current_pt_id, NAN);
-          TrySetValue(this->Timestamps, current_pt_id, NAN);
-          TrySetValue(this->Distances, current_pt_id, NAN);
-          current_pt_id++;
-          structured_pt_id++;
-      }
+        }
+  #endif /* USING_RT_MATRIX */
+
+        double azimuth = units.Azimuth[index];
+        if (azimuth < 0)
+        {
+            azimuth += 360.0f;
+        }
+        else if (azimuth >= 270.0f)
+        {
+            azimuth -= 360.0f;
+        }
+
+        // Same wrapping as the spherical conversion, then as the display
+        double pitch = units.Elevation[index];
+        if (pitch >= 360.0f)
+        {
+            pitch -= 360.0f;
+        }
+        if (pitch >= 270.0f)
+        {
+            pitch -= 360.0f;
+        }
+
+  #if DEBUG
+        std::cout << "Point " << packet.header.GetFrameID() << ": " << units.Distance[index]
+                  << ", " << units.Azimuth[index] << ", " << units.Elevation[index]
+                  << ", " << x << ", " << y << ", " << z << std::endl;
+  #endif
+
+        SetPoint(arrays.Points, pointId, x, y, z);
+        arrays.Azimuth.Set(pointId, azimuth);
+        arrays.Elevation.Set(pointId, pitch);
+        TrySetValue(arrays.PointID, pointId, structuredPointId);
+        TrySetValue(arrays.LaserID, pointId, laserID);
+        TrySetValue(arrays.Intensities, pointId, units.Intensity[index]);
+        TrySetValue(arrays.Timestamps, pointId, timestamps[index]);
+        arrays.Distances.Set(pointId, distance);
+    }
+    else {
+        SetPoint(arrays.Points, pointId, NAN, NAN, NAN);
+        arrays.Azimuth.Set(pointId, NAN);
+        arrays.Elevation.Set(pointId, NAN);
+        TrySetValue(arrays.PointID, pointId, structuredPointId);
+        TrySetValue(arrays.LaserID, pointId, laserID);
+        TrySetValue(arrays.Intensities, pointId, NAN);
+        TrySetValue(arrays.Timestamps, pointId, NAN);
+        arrays.Distances.Set(pointId, NAN);
     }
   }
+}
 
-  this->last_seq_num = current_seq_num;
+//-----------------------------------------------------------------------------
+void vtkA0PacketInterpreter::DispatchUnits(const AsensingPacket& packet, const DecodeRange& range)
+{
+  if (range.FirstUnit >= range.LastUnit)
+  {
+    return;
+  }
+
+  if (this->Workers)
+  {
+    this->Workers->Push(packet, range);
+  }
+  else
+  {
+    this->DecodeUnits(packet, range);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkA0PacketInterpreter::WaitForDecodedUnits()
+{
+  if (this->Workers)
+  {
+    this->Workers->Wait();
+  }
+}
 
-  auto stop = high_resolution_clock::now();
-  duration<double, std::micro> ms_double = stop - start;
-  // std::cout << ms_double.count() << "micro seconds\n";
+//-----------------------------------------------------------------------------
+bool vtkA0PacketInterpreter::SplitFrame(bool force, FramingMethod_t framingMethodAskingForSplitFrame)
+{
+  // Only publish the frame once all of its points have landed
+  this->WaitForDecodedUnits();
+  return this->Superclass::SplitFrame(force, framingMethodAskingForSplitFrame);
 }
 
 //-----------------------------------------------------------------------------
@@ -891,48 +886,56 @@ bool vtkA0PacketInterpreter::IsLidarPacket(
   return true; // dataLength == PACKET_SIZE;
 }
 
+//-----------------------------------------------------------------------------
+void vtkA0PacketInterpreter::CompleteFrame()
+{
+  FillCoordinateArray(this->Points, 0, this->PointsX);
+  FillCoordinateArray(this->Points, 1, this->PointsY);
+  FillCoordinateArray(this->Points, 2, this->PointsZ);
+}
+
 //-----------------------------------------------------------------------------
 vtkSmartPointer<vtkPolyData> vtkA0PacketInterpreter::CreateNewEmptyFrame(
-  vtkIdType numberOfPoints, vtkIdType vtkNotUsed(prereservedNumberOfPoints))
+  vtkIdType vtkNotUsed(numberOfPoints), vtkIdType vtkNotUsed(prereservedNumberOfPoints))
 {
-  const int defaultPrereservedNumberOfPointsPerFrame = this->points_per_frame;
-  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  // The points still being decoded belong to the previous frame
+  this->WaitForDecodedUnits();
+  this->CompleteFrame();
+
+  // The frames have a slot for each point of the sensor, the points and arrays
+  // of a released frame are reused instead of allocating new ones
+  vtkSmartPointer<vtkPolyData> polyData = this->FramePool.NewFrame(this->points_per_frame);
 
   // points
   structured_pt_id = 0;
   current_pt_id = 0;
   current_seq_num = 0;
   seq_num_counter = 0;
-  vtkNew<vtkPoints> points;
-  points->SetDataTypeToFloat();
-  points->SetNumberOfPoints(defaultPrereservedNumberOfPointsPerFrame);
+  vtkPoints* points = polyData->GetPoints();
   points->GetData()->SetName("Points_m_XYZ");
-  polyData->SetPoints(points.GetPointer());
 
   // intensity
-  this->Points = points.GetPointer();
-  this->PointsX = CreateDataArray<vtkDoubleArray>(
-    true, "X", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->PointsY = CreateDataArray<vtkDoubleArray>(
-    true, "Y", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->PointsZ = CreateDataArray<vtkDoubleArray>(
-    true, "Z", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Azimuth = CreateDataArray<vtkDoubleArray>(
-    false, "Azimuth", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Elevation = CreateDataArray<vtkDoubleArray>(
-    false, "Elevation", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-
-  this->PointID = CreateDataArray<vtkUnsignedIntArray>(
-    false, "PointID", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->LaserID = CreateDataArray<vtkUnsignedCharArray>(
-    false, "LaserID", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Intensities = CreateDataArray<vtkUnsignedCharArray>(
-    false, "Intensity", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Timestamps = CreateDataArray<vtkDoubleArray>(
-    false, "Timestamp", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Distances = CreateDataArray<vtkDoubleArray>(
-    false, "Distance", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
+  this->Points = points;
+  FrameArrays& arrays = this->CurrentArrays;
+  AsensingAttribute unused;
+  this->PointsX = CreateAttributeArray(true, AsensingAttributeKind::Coordinate, "X", polyData, unused);
+  this->PointsY = CreateAttributeArray(true, AsensingAttributeKind::Coordinate, "Y", polyData, unused);
+  this->PointsZ = CreateAttributeArray(true, AsensingAttributeKind::Coordinate, "Z", polyData, unused);
+  this->Azimuth = CreateAttributeArray(false, AsensingAttributeKind::Angle, "Azimuth", polyData, arrays.Azimuth);
+  this->Elevation = CreateAttributeArray(false, AsensingAttributeKind::Angle, "Elevation", polyData, arrays.Elevation);
+
+  this->PointID = CreateDataArray<vtkUnsignedIntArray>(false, "PointID", polyData);
+  this->LaserID = CreateDataArray<vtkUnsignedCharArray>(false, "LaserID", polyData);
+  this->Intensities = CreateDataArray<vtkUnsignedCharArray>(false, "Intensity", polyData);
+  this->Timestamps = CreateDataArray<vtkDoubleArray>(false, "Timestamp", polyData);
+  this->Distances = CreateAttributeArray(false, AsensingAttributeKind::Distance, "Distance", polyData, arrays.Distances);
   polyData->GetPointData()->SetActiveScalars("Intensity");
+
+  arrays.Points = static_cast<float*>(points->GetVoidPointer(0));
+  arrays.PointID = GetRawPointer(this->PointID);
+  arrays.LaserID = GetRawPointer(this->LaserID);
+  arrays.Intensities = GetRawPointer(this->Intensities);
+  arrays.Timestamps = GetRawPointer(this->Timestamps);
   return polyData;
 }
 
@@ -967,6 +970,34 @@ bool vtkA0PacketInterpreter::PreProcessPacket(unsigned char const* data,
   return isNewFrame;
 }
 
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkLidarPacketInterpreter> vtkA0PacketInterpreter::CreateIndexingClone()
+{
+  // The frames are only detected from the frame id of the packets,
+  // the calibration is not needed to build the catalog
+  auto clone = vtkSmartPointer<vtkA0PacketInterpreter>::New();
+  clone->SetFramingMethod(this->FramingMethod);
+  clone->SetFrameDuration_s(this->FrameDuration_s);
+  return clone;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkLidarPacketInterpreter> vtkA0PacketInterpreter::CreateDecodingClone()
+{
+  // The corrections are only read from the calibration file,
+  // reloading it gives the clone the same state.
+  // DecodeThreads is left to 0: the clones already decode several parts
+  // of the capture concurrently, they do not need decode workers of their own
+  auto clone = vtkSmartPointer<vtkA0PacketInterpreter>::New();
+  this->CopyDecodingParameters(clone);
+  clone->SetFrameSchema(this->FrameSchema);
+  if (this->IsCalibrated)
+  {
+    clone->LoadCalibration(this->CalibrationFileName);
+  }
+  return clone;
+}
+
 //-----------------------------------------------------------------------------
 std::string vtkA0PacketInterpreter::GetSensorInformation(bool vtkNotUsed(shortVersion))
 {
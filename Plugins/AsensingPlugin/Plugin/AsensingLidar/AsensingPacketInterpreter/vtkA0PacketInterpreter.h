@@ -8,7 +8,11 @@
 #include <vtkUnsignedIntArray.h>
 
 #include "A0PacketFormat.h"
+#include "AsensingFrameSchema.h"
+#include "AsensingPacketTime.h"
+#include "AsensingPointKernel.h"
 
+#include <cstring>
 #include <memory>
 
 #define USING_ANGLE_MODEL        1
@@ -84,28 +88,58 @@ public:
 
   bool IsLidarPacket(unsigned char const * data, unsigned int dataLength) override;
 
+  vtkSmartPointer<vtkLidarPacketInterpreter> CreateIndexingClone() override;
+
+  vtkSmartPointer<vtkLidarPacketInterpreter> CreateDecodingClone() override;
+
+  bool CanCreateDecodingClone() override { return true; }
+
   void ProcessPacket(unsigned char const * data, unsigned int dataLength) override;
 
   std::string GetSensorInformation(bool shortVersion = false) override;
 
+  bool SplitFrame(bool force = false, FramingMethod_t framingMethodAskingForSplitFrame = FramingMethod_t::INTERPRETER_FRAMING) override;
+
+  /**
+   * @brief SetDecodeThreads set the number of worker threads decoding the packets.
+   * 0 decodes each packet on the thread calling ProcessPacket. Otherwise the points of
+   * each packet are decoded by a worker straight into the slots preassigned to them
+   * in the current frame, which is only split once all of its packets have been decoded.
+   * The frames are the same whatever the number of threads, so this does not modify the interpreter.
+   */
+  void SetDecodeThreads(int numberOfThreads) { this->DecodeThreads = numberOfThreads; }
+  vtkGetMacro(DecodeThreads, int)
+
+  /**
+   * @brief SetFrameSchema select the types of the arrays of the next frames, see AsensingFrameSchema.
+   * 0 (Full) double attributes, 1 (Compact) float attributes, 2 (Quantized) 16 bits integer
+   * angles and distance.
+   */
+  vtkSetClampMacro(FrameSchema, int, 0, 2)
+  vtkGetMacro(FrameSchema, int)
+
 protected:
-  template<typename T>
-  vtkSmartPointer<T> CreateDataArray(bool isAdvanced, const char* name, vtkIdType np, vtkIdType prereserved_np, vtkPolyData* pd);
+  //! @brief CreateAttributeArray CreateDataArray for an attribute whose type depends on the FrameSchema
+  vtkSmartPointer<vtkDataArray> CreateAttributeArray(bool isAdvanced, AsensingAttributeKind kind,
+    const char* name, vtkPolyData* pd, AsensingAttribute& attribute);
+
+  //! @brief CompleteFrame fill the coordinate arrays of the current frame from its points
+  void CompleteFrame();
 
   vtkSmartPointer<vtkPolyData> CreateNewEmptyFrame(vtkIdType numberOfPoints, vtkIdType prereservedNumberOfPoints = 60000) override;
 
   vtkSmartPointer<vtkPoints> Points;
-  vtkSmartPointer<vtkDoubleArray> PointsX;
-  vtkSmartPointer<vtkDoubleArray> PointsY;
-  vtkSmartPointer<vtkDoubleArray> PointsZ;
-  vtkSmartPointer<vtkDoubleArray> Azimuth;
-  vtkSmartPointer<vtkDoubleArray> Elevation;
+  vtkSmartPointer<vtkDataArray> PointsX;
+  vtkSmartPointer<vtkDataArray> PointsY;
+  vtkSmartPointer<vtkDataArray> PointsZ;
+  vtkSmartPointer<vtkDataArray> Azimuth;
+  vtkSmartPointer<vtkDataArray> Elevation;
 
   vtkSmartPointer<vtkUnsignedIntArray> PointID;
   vtkSmartPointer<vtkUnsignedCharArray> LaserID;
   vtkSmartPointer<vtkUnsignedCharArray> Intensities;
   vtkSmartPointer<vtkDoubleArray> Timestamps;
-  vtkSmartPointer<vtkDoubleArray> Distances;
+  vtkSmartPointer<vtkDataArray> Distances;
 
 
   vtkA0PacketInterpreter();
@@ -115,8 +149,65 @@ private:
   vtkA0PacketInterpreter(const vtkA0PacketInterpreter&) = delete;
   void operator=(const vtkA0PacketInterpreter&) = delete;
 
-  std::vector<double> Cos_all_angle;
-  std::vector<double> Sin_all_angle;
+  //! @brief Raw pointers to the arrays of the current frame, nullptr for disabled arrays.
+  //! The coordinate arrays are not written by the decoding, see CompleteFrame.
+  struct FrameArrays
+  {
+    float* Points = nullptr;
+    AsensingAttribute Azimuth;
+    AsensingAttribute Elevation;
+    unsigned int* PointID = nullptr;
+    unsigned char* LaserID = nullptr;
+    unsigned char* Intensities = nullptr;
+    double* Timestamps = nullptr;
+    AsensingAttribute Distances;
+  };
+
+  //! @brief Consecutive units of a packet, and the slots of the frame they are decoded to
+  struct DecodeRange
+  {
+    FrameArrays Arrays;
+    int FirstUnit = 0;             /*!< index of the first unit, blockID * ASENSING_LASER_NUM + laserID */
+    int LastUnit = 0;              /*!< index after the last unit */
+    uint32_t FirstPointId = 0;     /*!< slot of the first decoded point */
+    uint32_t FirstStructuredPointId = 0;
+    double Timestamp = 0;          /*!< timestamp before the first unit */
+  };
+
+  /**
+   * @brief DecodeUnits compute the points of a range of units and write them to their slots.
+   * Only reads the calibration, so that several ranges can be decoded concurrently.
+   */
+  void DecodeUnits(const AsensingPacket& packet, const DecodeRange& range) const;
+
+  //! @brief DispatchUnits decode the range now, or hand it to the decode workers
+  void DispatchUnits(const AsensingPacket& packet, const DecodeRange& range);
+
+  //! @brief WaitForDecodedUnits block until all the dispatched ranges have been decoded
+  void WaitForDecodedUnits();
+
+  //! Number of threads decoding the packets, see SetDecodeThreads
+  int DecodeThreads = 0;
+
+  //! Worker pool, only created when DecodeThreads > 0
+  class DecodeWorkers;
+  std::unique_ptr<DecodeWorkers> Workers;
+
+  //! Arrays of the current frame, updated by CreateNewEmptyFrame
+  FrameArrays CurrentArrays;
+
+  //! Types of the arrays of the frames, see SetFrameSchema
+  int FrameSchema = static_cast<int>(AsensingFrameSchema::Full);
+
+  //! Conversion of the units to points, holds the trigonometric tables and the calibration
+  AsensingPointKernel Kernel;
+
+  //! Seconds since epoch of the UTC fields of the last headers
+  AsensingHeaderTimeCache HeaderTime;
+
+#if ASENSING_PACKET_PROFILING
+  AsensingPacketProfiler Profiler{ "A0" };
+#endif
 
   //! @brief Calibration of each laser get from the calibration file
   std::vector<double> ElevationCorrection;
@@ -189,6 +280,24 @@ struct AsensingSpecificFrameInformation : public SpecificFrameInformation
 
   void reset() override { *this = AsensingSpecificFrameInformation(); }
   std::unique_ptr<SpecificFrameInformation> clone() override { return std::make_unique<AsensingSpecificFrameInformation>(*this); }
+
+  bool serialize(std::string& buffer) const override
+  {
+    buffer.append(reinterpret_cast<const char*>(this->LastAzimuth), sizeof(this->LastAzimuth));
+    buffer.append(reinterpret_cast<const char*>(this->LastFrameID), sizeof(this->LastFrameID));
+    return true;
+  }
+
+  bool deserialize(const char* data, size_t size) override
+  {
+    if (size != sizeof(this->LastAzimuth) + sizeof(this->LastFrameID))
+    {
+      return false;
+    }
+    std::memcpy(this->LastAzimuth, data, sizeof(this->LastAzimuth));
+    std::memcpy(this->LastFrameID, data + sizeof(this->LastAzimuth), sizeof(this->LastFrameID));
+    return true;
+  }
 };
 
 #endif // VTKA0PacketInterpreter_h
@@ -14,55 +14,51 @@
 #include <fenv.h>
 #include <math.h>
 
-#include <chrono>
 #include <vtkDelimitedTextReader.h>
 
 #define TEST_LASER_NUM (128) /* Just for testing */
 
 //#define FIX_WRONG_PCAP_PROBLEM
 
-using std::chrono::duration;
-using std::chrono::duration_cast;
-using std::chrono::high_resolution_clock;
-using std::chrono::milliseconds;
-
 namespace
 {
-
-double degreeToRadian(double degree)
+//-----------------------------------------------------------------------------
+template<typename T>
+auto GetRawPointer(const vtkSmartPointer<T>& array) -> decltype(array->GetPointer(0))
 {
-  return degree * vtkMath::Pi() / 180.0;
-}
+  return array != nullptr ? array->GetPointer(0) : nullptr;
 }
 
-//! @todo this method are actually usefull for every Interpreter and should go to the top
-template<typename T>
-vtkSmartPointer<T> vtkA2PacketInterpreter::CreateDataArray(bool isAdvanced, const char* name,
-  vtkIdType vtkNotUsed(np), vtkIdType prereserved_np, vtkPolyData* pd)
+//-----------------------------------------------------------------------------
+template<typename T, typename U>
+void TrySetValue(T* array, uint32_t pos, U value)
 {
-  if (isAdvanced && !this->EnableAdvancedArrays)
-  {
-    return nullptr;
-  }
-  vtkSmartPointer<T> array = vtkSmartPointer<T>::New();
-  array->SetNumberOfValues(prereserved_np);
-  array->SetName(name);
-  if (pd)
+  if (array != nullptr)
   {
-    pd->GetPointData()->AddArray(array);
+    array[pos] = static_cast<T>(value);
   }
+}
 
-  array->FillValue(0);
-  return array;
+//-----------------------------------------------------------------------------
+void SetPoint(float* points, uint32_t pos, double x, double y, double z)
+{
+  points[3 * pos] = static_cast<float>(x);
+  points[3 * pos + 1] = static_cast<float>(y);
+  points[3 * pos + 2] = static_cast<float>(z);
+}
 }
 
-template<typename T, typename U>
-void TrySetValue(T& array, int pos, U value)
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkDataArray> vtkA2PacketInterpreter::CreateAttributeArray(bool isAdvanced,
+  AsensingAttributeKind kind, const char* name, vtkPolyData* pd, AsensingAttribute& attribute)
 {
-  if (array != nullptr)
+  attribute = AsensingAttribute();
+  if (isAdvanced && !this->EnableAdvancedArrays)
   {
-    array->SetValue(pos, value);
+    return nullptr;
   }
+  return AddAttributeArray(this->FramePool, pd, static_cast<AsensingFrameSchema>(this->FrameSchema),
+    kind, name, attribute);
 }
 
 //-----------------------------------------------------------------------------
@@ -89,13 +85,6 @@ vtkA2PacketInterpreter::vtkA2PacketInterpreter()
   // SpecificFrameInformation placeholder for specific sensor implementation
   // Meta data required to correctly parse the data contained within the udp packets
   this->ParserMetaData.SpecificInformation = std::make_shared<AsensingSpecificFrameInformation>();
-
-  for (int j = 0; j < CIRCLE; j++)
-  {
-    double angle = j / 100.0;
-    this->Cos_all_angle.push_back(std::cos(degreeToRadian(angle)));
-    this->Sin_all_angle.push_back(std::sin(degreeToRadian(angle)));
-  }
 }
 
 //-----------------------------------------------------------------------------
@@ -256,7 +245,7 @@ void vtkA2PacketInterpreter::LoadCalibration(const std::string& filename)
 
 void vtkA2PacketInterpreter::ProcessPacket(unsigned char const* data, unsigned int dataLength)
 {
-  auto start = high_resolution_clock::now();
+  ASENSING_PROFILE_PACKET(this->Profiler);
   if (!this->IsLidarPacket(data, dataLength))
   {
     return;
@@ -267,17 +256,11 @@ void vtkA2PacketInterpreter::ProcessPacket(unsigned char const* data, unsigned i
   auto face_id = current_frame_id % 4;
   if(this->faces[face_id] == 0) return ;
 
-  struct tm t;
-  t.tm_year = dataPacket->header.GetUTCTime0();
-  t.tm_mon = dataPacket->header.GetUTCTime1() - 1;
-  t.tm_mday = dataPacket->header.GetUTCTime2();
-  t.tm_hour = dataPacket->header.GetUTCTime3();
-  t.tm_min = dataPacket->header.GetUTCTime4();
-  t.tm_sec = dataPacket->header.GetUTCTime5();
-  t.tm_isdst = 0;
-
   // Time in second of the packets
-  time_t unix_second = (mktime(&t));
+  time_t unix_second = this->HeaderTime.Get(dataPacket->header.GetUTCTime0(),
+    dataPacket->header.GetUTCTime1(), dataPacket->header.GetUTCTime2(),
+    dataPacket->header.GetUTCTime3(), dataPacket->header.GetUTCTime4(),
+    dataPacket->header.GetUTCTime5());
   int returnMode = 0;
 
   // Timestamp contains in the packet
@@ -324,67 +307,68 @@ void vtkA2PacketInterpreter::ProcessPacket(unsigned char const* data, unsigned i
           this->seq_num_counter = 0;
       }
 
+      // Gather the valid units in structure of arrays layout, to convert all of them at once
+      static_assert(A2_CHANNEL_NUM <= AsensingPointKernel::MaxUnits, "Block larger than the point kernel batches");
+      AsensingPointKernel::UnitBatch units;
+      units.Size = 0;
+      const float evevation_offset = dataPacket->header.GetReserved1() * ASENSING_ELEVATION_UNIT;
+      const float face_elevation = this->elevation_mirror_offset_enable ? this->elevation_mirror_offset[face_id] : evevation_offset;
       for (int chan = 0; chan < A2_CHANNEL_NUM; chan++)
       {
           const A2Unit &unit = currentBlock.units[chan];
-
-          double x, y, z, azimuth, pitch;
-          double distance = static_cast<double>(unit.GetDistance()) * ASENSING_DISTANCE_UNIT;
-          auto confidence = unit.GetConfidence();
           if (0 == currentBlock.GetAzimuth() && 0 == unit.GetDistance() && 0 == unit.GetIntensity()) {
               continue;
           }
 
-          {
-              auto evevation_offset = dataPacket->header.GetReserved1() * ASENSING_ELEVATION_UNIT;
-              azimuth = static_cast<float>(currentBlock.GetAzimuth()) * ASENSING_AZIMUTH_UNIT + azimuth_offset_[chan];
-			  pitch = elevation_offset_[chan] + (this->elevation_mirror_offset_enable ? this->elevation_mirror_offset[face_id] : evevation_offset);
-			  if (pitch < 0)
-			  {
-				  pitch += 360.0f;
-			  }
-			  else if (pitch >= 360.0f)
-			  {
-				  pitch -= 360.0f;
-			  }
-			  float xyDistance = distance * this->Cos_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-              int azimuthIdx = static_cast<int>(azimuth * 100 + 0.5);
-              if (azimuthIdx >= CIRCLE)
-              {
-                  azimuthIdx -= CIRCLE;
-              }
-              else if (azimuthIdx < 0)
-              {
-                  azimuthIdx += CIRCLE;
-              }
+          const int index = units.Size++;
+          units.Distance[index] = unit.GetDistance();
+          units.Azimuth[index] = static_cast<float>(currentBlock.GetAzimuth()) * ASENSING_AZIMUTH_UNIT + azimuth_offset_[chan];
+          units.Elevation[index] = elevation_offset_[chan] + face_elevation;
+          units.Intensity[index] = unit.GetIntensity();
+          units.Laser[index] = chan;
+      }
 
-          #if USING_MATH_LIB
-              double x = xyDistance * sin(degreeToRadian(azimuth)); // this->Sin_all_angle[azimuthIdx];
-              double y = xyDistance * cos(degreeToRadian(azimuth)); // this->Cos_all_angle[azimuthIdx];
-              double z = distance * sin(degreeToRadian(pitch));     // this->Sin_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-          #else
-              x = xyDistance * this->Cos_all_angle[azimuthIdx];
-              y = xyDistance * this->Sin_all_angle[azimuthIdx];
-              z = distance * this->Sin_all_angle[static_cast<int>(pitch * 100 + 0.5)];
-          #endif
-			  if (azimuth > 180)
-				  azimuth -= 360.0f;
+      AsensingPointKernel::PointBatch points;
+      this->Kernel.Convert(AsensingPointKernel::Model::Spherical, units, ASENSING_DISTANCE_UNIT, points);
 
-			  if (pitch > 180)
-				  pitch -= 360.0f;
-          } /* End of this->CalibEnabled */
+      // Updated by SplitFrame
+      const FrameArrays& arrays = this->CurrentArrays;
+
+      for (int index = 0; index < units.Size; index++)
+      {
+          const int chan = units.Laser[index];
+          auto confidence = currentBlock.units[chan].GetConfidence();
+
+          double x = points.X[index];
+          double y = points.Y[index];
+          double z = points.Z[index];
+          double distance = points.Distance[index];
+          uint8_t intensity = points.Intensity[index];
+
+          double azimuth = units.Azimuth[index];
+          double pitch = units.Elevation[index];
+          if (pitch < 0)
+          {
+              pitch += 360.0f;
+          }
+          else if (pitch >= 360.0f)
+          {
+              pitch -= 360.0f;
+          }
+          if (azimuth > 180)
+              azimuth -= 360.0f;
 
-          uint8_t intensity = unit.GetIntensity();
+          if (pitch > 180)
+              pitch -= 360.0f;
 
           // Compute timestamp of the point
           // int offset = currentBlock.GettimeOffSet();
           // timestamp += offset;
 
           #if DEBUG
-          //std::cout << "Point " << current_frame_id << ": " << distance << ", " << azimuth << ", " << pitch << ", " << x << ", " << y << ", " << z << std::endl;
-          std::cout << "Point " << current_frame_id << ": " << currentBlock.units[chan].GetDistance()
-                    << ", " << currentBlock.units[chan].GetAzimuth()
-                    << ", " << currentBlock.units[chan].GetElevation() << ", " << x << ", " << y << ", " << z << std::endl;
+          std::cout << "Point " << current_frame_id << ": " << units.Distance[index]
+                    << ", " << units.Azimuth[index]
+                    << ", " << units.Elevation[index] << ", " << x << ", " << y << ", " << z << std::endl;
           #endif
 
           if (current_pt_id >= this->points_per_frame)
@@ -407,53 +391,44 @@ void vtkA2PacketInterpreter::ProcessPacket(unsigned char const* data, unsigned i
           }
 
           if(this->channels[chan] == 0) {
-              this->Points->SetPoint(current_pt_id, NAN, NAN, NAN);
-              TrySetValue(this->PointsX, current_pt_id, NAN);
-              TrySetValue(this->PointsY, current_pt_id, NAN);
-              TrySetValue(this->PointsZ, current_pt_id, NAN);
-              TrySetValue(this->Azimuth, current_pt_id, NAN);
-              TrySetValue(this->Elevation, current_pt_id, NAN);
-              TrySetValue(this->PointID, current_pt_id, current_pt_id);
-              TrySetValue(this->Seq, current_pt_id, NAN);
-              TrySetValue(this->FaceID, current_pt_id, NAN);
-              TrySetValue(this->Channel, current_pt_id, NAN);
-              TrySetValue(this->Confidence, current_pt_id, NAN);
-              TrySetValue(this->Intensities, current_pt_id, NAN);
-              TrySetValue(this->Timestamps, current_pt_id, NAN);
-              TrySetValue(this->Distances, current_pt_id, NAN);
+              SetPoint(arrays.Points, current_pt_id, NAN, NAN, NAN);
+              arrays.Azimuth.Set(current_pt_id, NAN);
+              arrays.Elevation.Set(current_pt_id, NAN);
+              TrySetValue(arrays.PointID, current_pt_id, current_pt_id);
+              TrySetValue(arrays.Seq, current_pt_id, NAN);
+              TrySetValue(arrays.FaceID, current_pt_id, NAN);
+              TrySetValue(arrays.Channel, current_pt_id, NAN);
+              TrySetValue(arrays.Confidence, current_pt_id, NAN);
+              TrySetValue(arrays.Intensities, current_pt_id, NAN);
+              TrySetValue(arrays.Timestamps, current_pt_id, NAN);
+              arrays.Distances.Set(current_pt_id, NAN);
           }
           else {
               if((this->filter_point_id != -1 && filter_point_id == (int)current_pt_id) || this->filter_point_id == -1) {
-                  this->Points->SetPoint(current_pt_id, x, y, z);
-                  TrySetValue(this->PointsX, current_pt_id, x);
-                  TrySetValue(this->PointsY, current_pt_id, y);
-                  TrySetValue(this->PointsZ, current_pt_id, z);
-                  TrySetValue(this->Azimuth, current_pt_id, azimuth);
-                  TrySetValue(this->Elevation, current_pt_id, pitch);
-                  TrySetValue(this->PointID, current_pt_id, current_pt_id);
-                  TrySetValue(this->Seq, current_pt_id, current_seq_num);
-                  TrySetValue(this->FaceID, current_pt_id, face_id);
-                  TrySetValue(this->Channel, current_pt_id, chan);
-                  TrySetValue(this->Confidence, current_pt_id, confidence);
-                  TrySetValue(this->Intensities, current_pt_id, intensity);
-                  TrySetValue(this->Timestamps, current_pt_id, timestamp);
-                  TrySetValue(this->Distances, current_pt_id, distance);
+                  SetPoint(arrays.Points, current_pt_id, x, y, z);
+                  arrays.Azimuth.Set(current_pt_id, azimuth);
+                  arrays.Elevation.Set(current_pt_id, pitch);
+                  TrySetValue(arrays.PointID, current_pt_id, current_pt_id);
+                  TrySetValue(arrays.Seq, current_pt_id, current_seq_num);
+                  TrySetValue(arrays.FaceID, current_pt_id, face_id);
+                  TrySetValue(arrays.Channel, current_pt_id, chan);
+                  TrySetValue(arrays.Confidence, current_pt_id, confidence);
+                  TrySetValue(arrays.Intensities, current_pt_id, intensity);
+                  TrySetValue(arrays.Timestamps, current_pt_id, timestamp);
+                  arrays.Distances.Set(current_pt_id, distance);
               }
               else {
-                  this->Points->SetPoint(current_pt_id, NAN, NAN, NAN);
-                  TrySetValue(this->PointsX, current_pt_id, NAN);
-                  TrySetValue(this->PointsY, current_pt_id, NAN);
-                  TrySetValue(this->PointsZ, current_pt_id, NAN);
-                  TrySetValue(this->Azimuth, current_pt_id, NAN);
-                  TrySetValue(this->Elevation, current_pt_id, NAN);
-                  TrySetValue(this->PointID, current_pt_id, current_pt_id);
-                  TrySetValue(this->Seq, current_pt_id, NAN);
-                  TrySetValue(this->FaceID, current_pt_id, NAN);
-                  TrySetValue(this->Channel, current_pt_id, NAN);
-                  TrySetValue(this->Confidence, current_pt_id, NAN);
-                  TrySetValue(this->Intensities, current_pt_id, NAN);
-                  TrySetValue(this->Timestamps, current_pt_id, NAN);
-                  TrySetValue(this->Distances, current_pt_id, NAN);
+                  SetPoint(arrays.Points, current_pt_id, NAN, NAN, NAN);
+                  arrays.Azimuth.Set(current_pt_id, NAN);
+                  arrays.Elevation.Set(current_pt_id, NAN);
+                  TrySetValue(arrays.PointID, current_pt_id, current_pt_id);
+                  TrySetValue(arrays.Seq, current_pt_id, NAN);
+                  TrySetValue(arrays.FaceID, current_pt_id, NAN);
+                  TrySetValue(arrays.Channel, current_pt_id, NAN);
+                  TrySetValue(arrays.Confidence, current_pt_id, NAN);
+                  TrySetValue(arrays.Intensities, current_pt_id, NAN);
+                  TrySetValue(arrays.Timestamps, current_pt_id, NAN);
+                  arrays.Distances.Set(current_pt_id, NAN);
               }
           }
           current_pt_id++;
@@ -461,10 +436,6 @@ void vtkA2PacketInterpreter::ProcessPacket(unsigned char const* data, unsigned i
   }
 
   this->last_seq_num = current_seq_num;
-
-  auto stop = high_resolution_clock::now();
-  duration<double, std::micro> ms_double = stop - start;
-  // std::cout << ms_double.count() << "micro seconds\n";
 }
 
 //-----------------------------------------------------------------------------
@@ -497,52 +468,58 @@ bool vtkA2PacketInterpreter::IsLidarPacket(
   return true; // dataLength == PACKET_SIZE;
 }
 
+//-----------------------------------------------------------------------------
+void vtkA2PacketInterpreter::CompleteFrame()
+{
+  FillCoordinateArray(this->Points, 0, this->PointsX);
+  FillCoordinateArray(this->Points, 1, this->PointsY);
+  FillCoordinateArray(this->Points, 2, this->PointsZ);
+}
+
 //-----------------------------------------------------------------------------
 vtkSmartPointer<vtkPolyData> vtkA2PacketInterpreter::CreateNewEmptyFrame(
-  vtkIdType numberOfPoints, vtkIdType vtkNotUsed(prereservedNumberOfPoints))
+  vtkIdType vtkNotUsed(numberOfPoints), vtkIdType vtkNotUsed(prereservedNumberOfPoints))
 {
-  const int defaultPrereservedNumberOfPointsPerFrame = this->points_per_frame;
-  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  this->CompleteFrame();
+
+  // The frames have a slot for each point of the sensor, the points and arrays
+  // of a released frame are reused instead of allocating new ones
+  vtkSmartPointer<vtkPolyData> polyData = this->FramePool.NewFrame(this->points_per_frame);
 
   // points
   current_pt_id = 0;
   current_seq_num = 0;
-  vtkNew<vtkPoints> points;
-  points->SetDataTypeToFloat();
-  points->SetNumberOfPoints(defaultPrereservedNumberOfPointsPerFrame);
+  vtkPoints* points = polyData->GetPoints();
   points->GetData()->SetName("Points_m_XYZ");
-  polyData->SetPoints(points.GetPointer());
 
   // intensity
-  this->Points = points.GetPointer();
-  this->PointsX = CreateDataArray<vtkDoubleArray>(
-    true, "X", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->PointsY = CreateDataArray<vtkDoubleArray>(
-    true, "Y", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->PointsZ = CreateDataArray<vtkDoubleArray>(
-    true, "Z", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Azimuth = CreateDataArray<vtkDoubleArray>(
-    false, "Azimuth", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Elevation = CreateDataArray<vtkDoubleArray>(
-    false, "Elevation", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-
-  this->PointID = CreateDataArray<vtkUnsignedIntArray>(
-    false, "PointID", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Seq = CreateDataArray<vtkUnsignedIntArray>(
-    false, "Seq", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->FaceID = CreateDataArray<vtkUnsignedCharArray>(
-    false, "FaceID", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Channel = CreateDataArray<vtkUnsignedCharArray>(
-    false, "Channel", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Confidence = CreateDataArray<vtkUnsignedCharArray>(
-    false, "Confidence", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Intensities = CreateDataArray<vtkUnsignedCharArray>(
-    false, "Intensity", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Timestamps = CreateDataArray<vtkDoubleArray>(
-    false, "Timestamp", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
-  this->Distances = CreateDataArray<vtkDoubleArray>(
-    false, "Distance", numberOfPoints, defaultPrereservedNumberOfPointsPerFrame, polyData);
+  this->Points = points;
+  FrameArrays& arrays = this->CurrentArrays;
+  AsensingAttribute unused;
+  this->PointsX = CreateAttributeArray(true, AsensingAttributeKind::Coordinate, "X", polyData, unused);
+  this->PointsY = CreateAttributeArray(true, AsensingAttributeKind::Coordinate, "Y", polyData, unused);
+  this->PointsZ = CreateAttributeArray(true, AsensingAttributeKind::Coordinate, "Z", polyData, unused);
+  this->Azimuth = CreateAttributeArray(false, AsensingAttributeKind::Angle, "Azimuth", polyData, arrays.Azimuth);
+  this->Elevation = CreateAttributeArray(false, AsensingAttributeKind::Angle, "Elevation", polyData, arrays.Elevation);
+
+  this->PointID = CreateDataArray<vtkUnsignedIntArray>(false, "PointID", polyData);
+  this->Seq = CreateDataArray<vtkUnsignedIntArray>(false, "Seq", polyData);
+  this->FaceID = CreateDataArray<vtkUnsignedCharArray>(false, "FaceID", polyData);
+  this->Channel = CreateDataArray<vtkUnsignedCharArray>(false, "Channel", polyData);
+  this->Confidence = CreateDataArray<vtkUnsignedCharArray>(false, "Confidence", polyData);
+  this->Intensities = CreateDataArray<vtkUnsignedCharArray>(false, "Intensity", polyData);
+  this->Timestamps = CreateDataArray<vtkDoubleArray>(false, "Timestamp", polyData);
+  this->Distances = CreateAttributeArray(false, AsensingAttributeKind::Distance, "Distance", polyData, arrays.Distances);
   polyData->GetPointData()->SetActiveScalars("Intensity");
+
+  arrays.Points = static_cast<float*>(points->GetVoidPointer(0));
+  arrays.PointID = GetRawPointer(this->PointID);
+  arrays.Seq = GetRawPointer(this->Seq);
+  arrays.FaceID = GetRawPointer(this->FaceID);
+  arrays.Channel = GetRawPointer(this->Channel);
+  arrays.Confidence = GetRawPointer(this->Confidence);
+  arrays.Intensities = GetRawPointer(this->Intensities);
+  arrays.Timestamps = GetRawPointer(this->Timestamps);
   return polyData;
 }
 
@@ -585,6 +562,32 @@ bool vtkA2PacketInterpreter::PreProcessPacket(unsigned char const* data,
   return isNewFrame;
 }
 
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkLidarPacketInterpreter> vtkA2PacketInterpreter::CreateIndexingClone()
+{
+  // The frames are only detected from the frame id of the packets,
+  // the calibration is not needed to build the catalog
+  auto clone = vtkSmartPointer<vtkA2PacketInterpreter>::New();
+  clone->SetFramingMethod(this->FramingMethod);
+  clone->SetFrameDuration_s(this->FrameDuration_s);
+  return clone;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkLidarPacketInterpreter> vtkA2PacketInterpreter::CreateDecodingClone()
+{
+  // The calibration (corrections, enabled faces and channels, ...) is only read from
+  // the calibration file, reloading it gives the clone the same state
+  auto clone = vtkSmartPointer<vtkA2PacketInterpreter>::New();
+  this->CopyDecodingParameters(clone);
+  clone->SetFrameSchema(this->FrameSchema);
+  if (this->IsCalibrated)
+  {
+    clone->LoadCalibration(this->CalibrationFileName);
+  }
+  return clone;
+}
+
 //-----------------------------------------------------------------------------
 std::string vtkA2PacketInterpreter::GetSensorInformation(bool vtkNotUsed(shortVersion))
 {
@@ -8,7 +8,11 @@
 #include <vtkUnsignedIntArray.h>
 
 #include "A2PacketFormat.h"
+#include "AsensingFrameSchema.h"
+#include "AsensingPacketTime.h"
+#include "AsensingPointKernel.h"
 
+#include <cstring>
 #include <memory>
 
 #define USING_MATH_LIB           0
@@ -78,22 +82,40 @@ public:
 
   bool IsLidarPacket(unsigned char const * data, unsigned int dataLength) override;
 
+  vtkSmartPointer<vtkLidarPacketInterpreter> CreateIndexingClone() override;
+
+  vtkSmartPointer<vtkLidarPacketInterpreter> CreateDecodingClone() override;
+
+  bool CanCreateDecodingClone() override { return true; }
+
   void ProcessPacket(unsigned char const * data, unsigned int dataLength) override;
 
   std::string GetSensorInformation(bool shortVersion = false) override;
 
+  /**
+   * @brief SetFrameSchema select the types of the arrays of the next frames, see AsensingFrameSchema.
+   * 0 (Full) double attributes, 1 (Compact) float attributes, 2 (Quantized) 16 bits integer
+   * angles and distance.
+   */
+  vtkSetClampMacro(FrameSchema, int, 0, 2)
+  vtkGetMacro(FrameSchema, int)
+
 protected:
-  template<typename T>
-  vtkSmartPointer<T> CreateDataArray(bool isAdvanced, const char* name, vtkIdType np, vtkIdType prereserved_np, vtkPolyData* pd);
+  //! @brief CreateAttributeArray CreateDataArray for an attribute whose type depends on the FrameSchema
+  vtkSmartPointer<vtkDataArray> CreateAttributeArray(bool isAdvanced, AsensingAttributeKind kind,
+    const char* name, vtkPolyData* pd, AsensingAttribute& attribute);
+
+  //! @brief CompleteFrame fill the coordinate arrays of the current frame from its points
+  void CompleteFrame();
 
   vtkSmartPointer<vtkPolyData> CreateNewEmptyFrame(vtkIdType numberOfPoints, vtkIdType prereservedNumberOfPoints = 60000) override;
 
   vtkSmartPointer<vtkPoints> Points;
-  vtkSmartPointer<vtkDoubleArray> PointsX;
-  vtkSmartPointer<vtkDoubleArray> PointsY;
-  vtkSmartPointer<vtkDoubleArray> PointsZ;
-  vtkSmartPointer<vtkDoubleArray> Azimuth;
-  vtkSmartPointer<vtkDoubleArray> Elevation;
+  vtkSmartPointer<vtkDataArray> PointsX;
+  vtkSmartPointer<vtkDataArray> PointsY;
+  vtkSmartPointer<vtkDataArray> PointsZ;
+  vtkSmartPointer<vtkDataArray> Azimuth;
+  vtkSmartPointer<vtkDataArray> Elevation;
 
   vtkSmartPointer<vtkUnsignedIntArray> PointID;
   vtkSmartPointer<vtkUnsignedIntArray> Seq;
@@ -102,7 +124,7 @@ protected:
   vtkSmartPointer<vtkUnsignedCharArray> Confidence;
   vtkSmartPointer<vtkUnsignedCharArray> Intensities;
   vtkSmartPointer<vtkDoubleArray> Timestamps;
-  vtkSmartPointer<vtkDoubleArray> Distances;
+  vtkSmartPointer<vtkDataArray> Distances;
 
 
   vtkA2PacketInterpreter();
@@ -112,8 +134,38 @@ private:
   vtkA2PacketInterpreter(const vtkA2PacketInterpreter&) = delete;
   void operator=(const vtkA2PacketInterpreter&) = delete;
 
-  std::vector<double> Cos_all_angle;
-  std::vector<double> Sin_all_angle;
+  //! @brief Raw pointers to the arrays of the current frame, nullptr for disabled arrays.
+  //! The coordinate arrays are not written by the decoding, see CompleteFrame.
+  struct FrameArrays
+  {
+    float* Points = nullptr;
+    AsensingAttribute Azimuth;
+    AsensingAttribute Elevation;
+    unsigned int* PointID = nullptr;
+    unsigned int* Seq = nullptr;
+    unsigned char* FaceID = nullptr;
+    unsigned char* Channel = nullptr;
+    unsigned char* Confidence = nullptr;
+    unsigned char* Intensities = nullptr;
+    double* Timestamps = nullptr;
+    AsensingAttribute Distances;
+  };
+
+  //! Arrays of the current frame, updated by CreateNewEmptyFrame
+  FrameArrays CurrentArrays;
+
+  //! Types of the arrays of the frames, see SetFrameSchema
+  int FrameSchema = static_cast<int>(AsensingFrameSchema::Full);
+
+  //! Conversion of the units to points, holds the trigonometric tables
+  AsensingPointKernel Kernel;
+
+  //! Seconds since epoch of the UTC fields of the last headers
+  AsensingHeaderTimeCache HeaderTime;
+
+#if ASENSING_PACKET_PROFILING
+  AsensingPacketProfiler Profiler{ "A2" };
+#endif
 
   //! @brief Calibration of each laser get from the calibration file
   std::vector<double> ElevationCorrection;
@@ -174,6 +226,24 @@ struct AsensingSpecificFrameInformation : public SpecificFrameInformation
 
   void reset() override { *this = AsensingSpecificFrameInformation(); }
   std::unique_ptr<SpecificFrameInformation> clone() override { return std::make_unique<AsensingSpecificFrameInformation>(*this); }
+
+  bool serialize(std::string& buffer) const override
+  {
+    buffer.append(reinterpret_cast<const char*>(this->LastAzimuth), sizeof(this->LastAzimuth));
+    buffer.append(reinterpret_cast<const char*>(this->LastFrameID), sizeof(this->LastFrameID));
+    return true;
+  }
+
+  bool deserialize(const char* data, size_t size) override
+  {
+    if (size != sizeof(this->LastAzimuth) + sizeof(this->LastFrameID))
+    {
+      return false;
+    }
+    std::memcpy(this->LastAzimuth, data, sizeof(this->LastAzimuth));
+    std::memcpy(this->LastFrameID, data + sizeof(this->LastAzimuth), sizeof(this->LastFrameID));
+    return true;
+  }
 };
 
 #endif // VTKA2PacketInterpreter_h
@@ -0,0 +1,263 @@
+// Microbenchmark of AsensingPointKernel against the former unit by unit conversion
+// of vtkA0PacketInterpreter, on random A0 packets. The calibrated conversion is not
+// measured, the interpreter still converts those units one by one.
+//
+// Usage: BenchmarkAsensingPointKernel [numberOfPackets]
+
+#include "AsensingPointKernel.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+constexpr int UnitsPerPacket = 120; // ASENSING_POINT_PER_PACKET
+constexpr int Lasers = 10;          // ASENSING_LASER_NUM
+constexpr int Circle = 36000;
+constexpr float DistanceUnit = 0.01f;
+constexpr float AngleUnit = 0.01f;
+const float ModuleAngles[6] = { -47.176f, -23.548f, 0.f, 23.548f, 47.176f, 17.8f };
+
+struct RawUnit
+{
+  uint16_t Distance;
+  uint16_t Azimuth;
+  uint16_t Elevation;
+  uint8_t Intensity;
+};
+
+double DegreeToRadian(double degree)
+{
+  return degree * 3.14159265358979323846 / 180.0;
+}
+
+//-----------------------------------------------------------------------------
+// Former conversion of vtkA0PacketInterpreter::ProcessPacket, one unit at a time in double
+class Reference
+{
+public:
+  Reference()
+  {
+    for (int j = 0; j < Circle; j++)
+    {
+      this->Cos.push_back(std::cos(DegreeToRadian(j / 100.0)));
+      this->Sin.push_back(std::sin(DegreeToRadian(j / 100.0)));
+    }
+  }
+
+  void Convert(AsensingPointKernel::Model model, const RawUnit* units, double* xyz) const
+  {
+    for (int i = 0; i < UnitsPerPacket; i++)
+    {
+      const RawUnit& unit = units[i];
+      const int laserID = i % Lasers;
+      double x, y, z;
+      double distance = static_cast<double>(unit.Distance) * DistanceUnit;
+
+      double azimuth = static_cast<float>(unit.Azimuth) * AngleUnit;
+      double pitch = static_cast<float>(unit.Elevation) * AngleUnit;
+      if (pitch < 0)
+      {
+        pitch += 360.0f;
+      }
+      else if (pitch >= 360.0f)
+      {
+        pitch -= 360.0f;
+      }
+      float xyDistance = distance * this->Cos[static_cast<int>(pitch * 100 + 0.5)];
+      int azimuthIdx = static_cast<int>(azimuth * 100 + 0.5);
+      if (azimuthIdx >= Circle)
+      {
+        azimuthIdx -= Circle;
+      }
+      else if (azimuthIdx < 0)
+      {
+        azimuthIdx += Circle;
+      }
+      x = xyDistance * this->Cos[azimuthIdx];
+      y = xyDistance * this->Sin[azimuthIdx];
+      z = distance * this->Sin[static_cast<int>(pitch * 100 + 0.5)];
+
+      if (model == AsensingPointKernel::Model::Mirror || model == AsensingPointKernel::Model::TiltedMirror)
+      {
+        float vector[3];
+        float theta = DegreeToRadian(ModuleAngles[laserID / 2]);
+        float gamma0 = DegreeToRadian(ModuleAngles[5]);
+        float sin_gamma0 = std::sin(gamma0);
+        float cos_gamma0 = std::cos(gamma0);
+        float cos_theta = std::cos(theta);
+        vector[0] = cos_theta - 2.0 * cos_theta * cos_gamma0 * cos_gamma0;
+        vector[1] = std::sin(theta);
+        vector[2] = 2.0 * cos_theta * sin_gamma0 * cos_gamma0;
+
+        float normal[3];
+        float angle = unit.Azimuth * AngleUnit;
+        angle = (angle > 120) ? (angle - 360) : angle;
+        if (model == AsensingPointKernel::Model::TiltedMirror)
+        {
+          const float tilt[5] = { 50, 25, 0, -25, -50 };
+          angle += tilt[laserID / 2];
+        }
+        float gamma = DegreeToRadian(-angle);
+        angle = static_cast<float>(unit.Elevation) * AngleUnit;
+        angle = (angle > 120) ? (angle - 360) : angle;
+        float beta = -1 * DegreeToRadian(angle);
+        float sin_gamma = std::sin(gamma);
+        float cos_gamma = std::cos(gamma);
+        float sin_beta = std::sin(beta);
+        float cos_beta = std::cos(beta);
+        normal[0] = cos_beta * cos_gamma * cos_gamma0 - sin_beta * sin_gamma0;
+        normal[1] = sin_gamma * cos_gamma0;
+        normal[2] = -cos_gamma0 * sin_beta * cos_gamma - cos_beta * sin_gamma0;
+
+        float k = vector[0] * normal[0] + vector[1] * normal[1] + vector[2] * normal[2];
+        x = distance * (vector[0] - 2 * k * normal[0]);
+        y = distance * (vector[1] - 2 * k * normal[1]);
+        z = distance * (vector[2] - 2 * k * normal[2]);
+      }
+
+      xyz[3 * i] = x;
+      xyz[3 * i + 1] = y;
+      xyz[3 * i + 2] = z;
+    }
+  }
+
+  std::vector<double> Cos, Sin;
+};
+
+//-----------------------------------------------------------------------------
+void FillBatch(const RawUnit* units, AsensingPointKernel::UnitBatch& batch)
+{
+  batch.Size = UnitsPerPacket;
+  for (int i = 0; i < UnitsPerPacket; i++)
+  {
+    batch.Distance[i] = units[i].Distance;
+    batch.Azimuth[i] = static_cast<float>(units[i].Azimuth) * AngleUnit;
+    batch.Elevation[i] = static_cast<float>(units[i].Elevation) * AngleUnit;
+    batch.Intensity[i] = units[i].Intensity;
+    batch.Laser[i] = i % Lasers;
+  }
+}
+
+template <typename Function>
+double NanosecondsPerPoint(int numberOfPackets, Function function)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (int packet = 0; packet < numberOfPackets; packet++)
+  {
+    function(packet);
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (static_cast<double>(numberOfPackets) * UnitsPerPacket);
+}
+}
+
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+  const int numberOfPackets = argc > 1 ? std::atoi(argv[1]) : 20000;
+  if (numberOfPackets <= 0)
+  {
+    std::cerr << "Usage: " << argv[0] << " [numberOfPackets]" << std::endl;
+    return 1;
+  }
+
+  // Random units in the field of view of the A0, angles above 120 degrees are negative ones
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<int> distance(1, 20000);
+  std::uniform_int_distribution<int> angle(-6000, 6000);
+  std::uniform_int_distribution<int> intensity(0, 255);
+  std::vector<RawUnit> units(static_cast<size_t>(numberOfPackets) * UnitsPerPacket);
+  for (RawUnit& unit : units)
+  {
+    const int azimuth = angle(generator);
+    const int elevation = angle(generator) / 3;
+    unit.Distance = static_cast<uint16_t>(distance(generator));
+    unit.Azimuth = static_cast<uint16_t>(azimuth < 0 ? azimuth + Circle : azimuth);
+    unit.Elevation = static_cast<uint16_t>(elevation < 0 ? elevation + Circle : elevation);
+    unit.Intensity = static_cast<uint8_t>(intensity(generator));
+  }
+
+  Reference reference;
+  AsensingPointKernel kernel;
+  kernel.SetMirrorAngles(ModuleAngles, 5, ModuleAngles[5]);
+
+  const struct
+  {
+    AsensingPointKernel::Model Model;
+    const char* Name;
+  } models[] = { { AsensingPointKernel::Model::Spherical, "Spherical" },
+    { AsensingPointKernel::Model::Mirror, "Mirror" },
+    { AsensingPointKernel::Model::TiltedMirror, "TiltedMirror" } };
+
+  std::cout << "Converting " << numberOfPackets << " packets of " << UnitsPerPacket << " units, "
+            << "best instruction set: "
+            << AsensingPointKernel::GetInstructionSetName(AsensingPointKernel::GetSupportedInstructionSet())
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(2);
+
+  // Part of the kernel timings spent gathering the fields of the units in the batch
+  AsensingPointKernel::UnitBatch batch;
+  const double fillTime = NanosecondsPerPoint(numberOfPackets,
+    [&](int packet) { FillBatch(&units[packet * UnitsPerPacket], batch); });
+  std::cout << "Filling the batches: " << fillTime << " ns/point, included below" << std::endl;
+
+  double worstDeviation = 0;
+  std::vector<double> expected(3 * UnitsPerPacket);
+  AsensingPointKernel::PointBatch points;
+  for (const auto& model : models)
+  {
+    std::cout << model.Name << std::endl;
+    const double referenceTime = NanosecondsPerPoint(numberOfPackets, [&](int packet) {
+      reference.Convert(model.Model, &units[packet * UnitsPerPacket], expected.data());
+    });
+    std::cout << "  reference      " << std::setw(8) << referenceTime << " ns/point" << std::endl;
+
+    for (auto instructions : { AsensingPointKernel::InstructionSet::Scalar,
+           AsensingPointKernel::InstructionSet::SSE41, AsensingPointKernel::InstructionSet::AVX2 })
+    {
+      kernel.SetInstructionSet(instructions);
+      if (kernel.GetInstructionSet() != instructions)
+      {
+        continue;
+      }
+
+      // Deviation from the reference, over all the packets
+      double deviation = 0;
+      for (int packet = 0; packet < numberOfPackets; packet++)
+      {
+        reference.Convert(model.Model, &units[packet * UnitsPerPacket], expected.data());
+        FillBatch(&units[packet * UnitsPerPacket], batch);
+        kernel.Convert(model.Model, batch, DistanceUnit, points);
+        for (int i = 0; i < UnitsPerPacket; i++)
+        {
+          deviation = std::max(deviation, std::abs(points.X[i] - expected[3 * i]));
+          deviation = std::max(deviation, std::abs(points.Y[i] - expected[3 * i + 1]));
+          deviation = std::max(deviation, std::abs(points.Z[i] - expected[3 * i + 2]));
+        }
+      }
+      worstDeviation = std::max(worstDeviation, deviation);
+
+      const double time = NanosecondsPerPoint(numberOfPackets, [&](int packet) {
+        FillBatch(&units[packet * UnitsPerPacket], batch);
+        kernel.Convert(model.Model, batch, DistanceUnit, points);
+      });
+      std::cout << "  " << std::left << std::setw(15) << AsensingPointKernel::GetInstructionSetName(instructions)
+                << std::right << std::setw(8) << time << " ns/point, x" << referenceTime / time
+                << ", max deviation " << std::scientific << deviation << std::fixed << " m" << std::endl;
+    }
+  }
+
+  // Single precision on distances up to 200 m
+  if (worstDeviation > 1e-3)
+  {
+    std::cerr << "The kernel does not match the reference conversion" << std::endl;
+    return 1;
+  }
+  return 0;
+}